@@ -17,6 +17,7 @@
 #include "eckit/codec/Exceptions.h"
 #include "eckit/codec/Stream.h"
 #include "eckit/codec/detail/Checksum.h"
+#include "eckit/io/BufferPool.h"
 #include "eckit/utils/Compressor.h"
 
 namespace eckit::codec {
@@ -25,6 +26,10 @@ namespace eckit::codec {
 
 Data::Data(void* p, size_t size) : buffer_(p, size), size_(size) {}
 
+Data::~Data() {
+    BufferPool::instance().release(std::move(buffer_));
+}
+
 std::uint64_t Data::write(Stream& out) const {
     if (size() > 0) {
         ASSERT(buffer_.size() >= size());
@@ -49,8 +54,10 @@ void Data::compress(const std::string& compression) {
             return;
         }
 
-        Buffer compressed(static_cast<size_t>(1.2 * static_cast<double>(size_)));
-        size_   = compressor->compress(buffer_, size_, compressed);
+        auto& pool        = BufferPool::instance();
+        Buffer compressed = pool.acquire(static_cast<size_t>(1.2 * static_cast<double>(size_)));
+        size_             = compressor->compress(buffer_, size_, compressed);
+        pool.release(std::move(buffer_));
         buffer_ = std::move(compressed);
     }
 }
@@ -61,13 +68,16 @@ void Data::decompress(const std::string& compression, size_t uncompressed_size)
         return;
     }
 
-    Buffer uncompressed(static_cast<size_t>(1.2 * static_cast<double>(uncompressed_size)));
+    auto& pool          = BufferPool::instance();
+    Buffer uncompressed = pool.acquire(static_cast<size_t>(1.2 * static_cast<double>(uncompressed_size)));
     compressor->uncompress(buffer_, size_, uncompressed, uncompressed_size);
-    size_   = uncompressed_size;
+    size_ = uncompressed_size;
+    pool.release(std::move(buffer_));
     buffer_ = std::move(uncompressed);
 }
 
 void Data::clear() {
+    BufferPool::instance().release(std::move(buffer_));
     buffer_ = Buffer{};
     size_   = 0;
 }
@@ -30,6 +30,9 @@ public:
     Data(Data&&)            = default;
     Data& operator=(Data&&) = default;
 
+    /// Gives the buffer back to the BufferPool
+    ~Data();
+
     operator const void*() const { return data(); }
     const void* data() const { return buffer_.data(); }
     size_t size() const { return size_; }
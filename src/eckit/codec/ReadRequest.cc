@@ -55,7 +55,8 @@ ReadRequest::ReadRequest(ReadRequest&& other) :
     decoder_(std::move(other.decoder_)),
     item_(std::move(other.item_)),
     do_checksum_{other.do_checksum_},
-    finished_{other.finished_} {
+    finished_{other.finished_},
+    future_{std::move(other.future_)} {
     other.do_checksum_ = true;
     other.finished_    = true;
 }
@@ -63,6 +64,9 @@ ReadRequest::ReadRequest(ReadRequest&& other) :
 //---------------------------------------------------------------------------------------------------------------------
 
 ReadRequest::~ReadRequest() {
+    if (future_.valid()) {
+        future_.wait();
+    }
     if (item_) {
         if (not finished_) {
             Log::error() << "Request for " << uri_ << " was not completed." << std::endl;
@@ -83,6 +87,23 @@ void ReadRequest::read() {
     }
 }
 
+void ReadRequest::read(Stream in) {
+    if (item_->empty()) {
+        RecordItem::URI uri = stream_ ? RecordItem::URI{"", offset_, key_} : RecordItem::URI{uri_};
+
+        RecordItemReader reader{in, uri.offset, uri.key};
+
+        Metadata metadata;
+        reader.read(metadata, false);
+        if (metadata.link()) {
+            read();
+            return;
+        }
+
+        reader.read(*item_);
+    }
+}
+
 //---------------------------------------------------------------------------------------------------------------------
 
 void ReadRequest::checksum(bool b) {
@@ -131,7 +152,10 @@ void ReadRequest::decode() {
 
 void ReadRequest::wait() {
     if (item_) {
-        if (not finished_) {
+        if (future_.valid()) {
+            future_.get();
+        }
+        else if (not finished_) {
             read();
             checksum();
             decompress();
@@ -143,4 +167,15 @@ void ReadRequest::wait() {
 
 //---------------------------------------------------------------------------------------------------------------------
 
+void ReadRequest::async(std::shared_future<void> future) {
+    ASSERT(pending());
+    future_ = std::move(future);
+}
+
+bool ReadRequest::pending() const {
+    return item_ && not finished_ && not future_.valid();
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+
 }  // namespace eckit::codec
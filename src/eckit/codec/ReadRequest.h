@@ -13,6 +13,7 @@
 #pragma once
 
 #include <cstdint>
+#include <future>
 #include <memory>
 #include <string>
 
@@ -40,20 +41,32 @@ public:
     ReadRequest()                   = delete;
     ReadRequest(const ReadRequest&) = delete;
 
+    /// Waits for the request to be completed if it was handed over with async()
     ~ReadRequest();
 
     void read();
 
+    /// Reads the item through a stream already opened on its record, rather than opening the file again
+    /// @note Linked items are still read from the file they refer to
+    void read(Stream);
+
     void checksum();
 
     void decompress();
 
     void decode();
 
+    /// Completes the request, or waits for it to be completed if it was handed over with async()
     void wait();
 
     void checksum(bool);
 
+    /// Hands the request over to be completed elsewhere, wait() then blocks on the future
+    void async(std::shared_future<void>);
+
+    /// @returns true if the request was neither completed nor handed over with async()
+    bool pending() const;
+
 private:
     ReadRequest(const std::string& URI, Decoder* decoder);
     ReadRequest(Stream, size_t offset, const std::string& key, Decoder*);
@@ -66,6 +79,7 @@ private:
     std::unique_ptr<RecordItem> item_;
     bool do_checksum_{true};
     bool finished_{false};
+    std::shared_future<void> future_;
 };
 
 //---------------------------------------------------------------------------------------------------------------------
@@ -12,11 +12,101 @@
 
 #include "eckit/codec/RecordReader.h"
 
+#include <algorithm>
+#include <exception>
+#include <future>
+#include <memory>
+#include <vector>
+
+#include "eckit/codec/FileStream.h"
 #include "eckit/codec/Metadata.h"
 #include "eckit/codec/RecordItemReader.h"
+#include "eckit/codec/detail/Defaults.h"
+#include "eckit/thread/ThreadPool.h"
 
 namespace eckit::codec {
 
+namespace {
+
+//---------------------------------------------------------------------------------------------------------------------
+
+ThreadPool* pool() {
+    static ThreadPool* pool
+        = defaults::read_threads() ? new ThreadPool("eckit::codec::RecordReader", defaults::read_threads()) : nullptr;
+    return pool;
+}
+
+struct Pending {
+    std::string key;
+    ReadRequest* request;
+    std::shared_ptr<std::promise<void>> done;
+    size_t section;
+};
+
+/// Reads the items in file order through one stream, the checksum, decompression and decoding of each item are
+/// handed over to the pool as soon as it is read.
+/// @note Each request is only accessed until its promise is fulfilled. The stream and the record are resolved by the
+///       caller, the session of the reader is active until all the promises are fulfilled
+void complete(Stream in, Record record, std::uint64_t offset, std::vector<Pending> pending) {
+    if (in) {
+        try {
+            if (record.empty()) {
+                in.seek(offset);
+                record.read(in);
+            }
+
+            for (auto& p : pending) {
+                p.section = record.has(p.key) ? size_t(record.metadata(p.key).data.section()) : 0;
+            }
+            std::stable_sort(pending.begin(), pending.end(),
+                             [](const Pending& a, const Pending& b) { return a.section < b.section; });
+        }
+        catch (...) {
+            // Reported by each request
+            in = Stream{};
+        }
+    }
+
+    ThreadPool* threads = pool();
+
+    for (auto& p : pending) {
+        try {
+            if (in) {
+                p.request->read(in);
+            }
+            else {
+                p.request->read();
+            }
+        }
+        catch (...) {
+            p.done->set_exception(std::current_exception());
+            continue;
+        }
+
+        auto decode = [request = p.request, done = p.done] {
+            try {
+                request->checksum();
+                request->decode();
+                done->set_value();
+            }
+            catch (...) {
+                done->set_exception(std::current_exception());
+            }
+        };
+
+        if (threads) {
+            threads->submit(std::move(decode));
+        }
+        else {
+            decode();
+        }
+    }
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+
+}  // namespace
+
 //---------------------------------------------------------------------------------------------------------------------
 
 RecordReader::RecordReader(const Record::URI& ref) : RecordReader(ref.path, ref.offset) {}
@@ -48,6 +138,52 @@ void RecordReader::trace(const std::string&, const char* file, int line, const c
 
 //---------------------------------------------------------------------------------------------------------------------
 
+void RecordReader::start() {
+    std::vector<Pending> pending;
+    for (auto& pair : requests_) {
+        auto& request = pair.second;
+        if (request.pending()) {
+            auto done = std::make_shared<std::promise<void>>();
+            request.async(done->get_future().share());
+            pending.push_back(Pending{pair.first, &request, done, 0});
+        }
+    }
+
+    if (pending.empty()) {
+        return;
+    }
+
+    // On the calling thread, in the session of the reader. The session is not pushed or popped on the pool: it is held
+    // until the requests, which wait for their promises, are destroyed
+    Stream in;
+    Record record;
+    try {
+        if (stream_) {
+            in = stream_;
+        }
+        else {
+            in = InputFileStream(path_);
+            Session::store(in);  // the records read are cached against its address
+        }
+        record = Session::record(in, offset_);
+    }
+    catch (...) {
+        // Reported by each request
+        in = Stream{};
+    }
+
+    if (ThreadPool* threads = pool()) {
+        threads->submit([in, record, offset = offset_, pending = std::move(pending)]() mutable {
+            complete(in, record, offset, std::move(pending));
+        });
+    }
+    else {
+        complete(in, record, offset_, std::move(pending));
+    }
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+
 void RecordReader::wait(const std::string& key) {
     request(key).wait();
 }
@@ -55,10 +191,23 @@ void RecordReader::wait(const std::string& key) {
 //---------------------------------------------------------------------------------------------------------------------
 
 void RecordReader::wait() {
-    // This can be optimized perhaps to overlap IO with decoding in multithreaded environment
+    start();
+
+    std::exception_ptr error;
     for (auto& pair : requests_) {
         auto& request = pair.second;
-        request.wait();
+        try {
+            request.wait();
+        }
+        catch (...) {
+            if (!error) {
+                error = std::current_exception();
+            }
+        }
+    }
+
+    if (error) {
+        std::rethrow_exception(error);
     }
 }
 
@@ -24,6 +24,13 @@ namespace eckit::codec {
 
 //---------------------------------------------------------------------------------------------------------------------
 
+/// Reads items of a record.
+///
+/// Requests are collected with read() and completed with wait(), or started in the background with start(). The
+/// items are then read in file order through a single stream, and checksummed, decompressed and decoded on a thread
+/// pool of eckit.codec.read.threads ($ECKIT_CODEC_READ_THREADS, 4) threads, 0 completing them on the calling thread.
+///
+/// @note A Stream given to the reader must not be used elsewhere while requests are in progress
 class RecordReader {
 public:
     explicit RecordReader(const Record::URI& ref);
@@ -47,8 +54,14 @@ public:
         return requests_.at(key);
     }
 
+    /// Starts completing the pending requests in the background
+    void start();
+
+    /// Completes the request for key, or waits for it once started
     void wait(const std::string& key);
 
+    /// Completes all the requests
+    /// @throws the first error met, once all the requests are completed
     void wait();
 
     ReadRequest& request(const std::string& key);
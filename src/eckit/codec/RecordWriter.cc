@@ -12,115 +12,169 @@
 
 #include "eckit/codec/RecordWriter.h"
 
+#include <cstring>
+#include <utility>
+#include <vector>
+
 #include "eckit/codec/Exceptions.h"
 #include "eckit/codec/detail/Checksum.h"
 #include "eckit/codec/detail/Defaults.h"
 #include "eckit/codec/detail/Encoder.h"
 #include "eckit/codec/detail/RecordSections.h"
+#include "eckit/io/BufferPool.h"
+#include "eckit/thread/ThreadPool.h"
 
 namespace eckit::codec {
 
 //---------------------------------------------------------------------------------------------------------------------
 
-template <typename OStream, typename Struct>
-inline void write_struct(OStream& out, const Struct& s) {
-    static_assert(Struct::bytes == sizeof(Struct));
-    if (out.write(reinterpret_cast<const char*>(&s), sizeof(s)) != sizeof(s)) {
-        throw WriteError("Could not write struct to stream");
-    }
+namespace {
+
+ThreadPool* pool() {
+    static ThreadPool* pool
+        = defaults::write_threads() ? new ThreadPool("eckit::codec::RecordWriter", defaults::write_threads()) : nullptr;
+    return pool;
 }
 
-//---------------------------------------------------------------------------------------------------------------------
+/// The parts of a record, in order
+class Sections {
+public:
+    template <typename Struct>
+    void add(const Struct& s) {
+        static_assert(Struct::bytes == sizeof(Struct));
+        add(&s, sizeof(s));
+    }
 
-template <typename OStream>
-inline void write_string(OStream& out, const std::string& s) {
-    if (out.write(s.data(), s.size()) != s.size()) {
-        throw WriteError("Could not write string to stream");
+    void add(const void* data, size_t size) {
+        if (size > 0) {
+            parts_.emplace_back(data, size);
+            size_ += size;
+        }
     }
-}
+
+    size_t size() const { return size_; }
+
+    void write(Stream& out) const {
+        if (size_ <= defaults::write_buffer_size()) {
+            PooledBuffer buffer(size_);
+            char* p = buffer;
+            for (const auto& part : parts_) {
+                std::memcpy(p, part.first, part.second);
+                p += part.second;
+            }
+            write(out, buffer, size_);
+            return;
+        }
+
+        for (const auto& part : parts_) {
+            write(out, part.first, part.second);
+        }
+    }
+
+private:
+    static void write(Stream& out, const void* data, size_t size) {
+        if (out.write(data, size) != size) {
+            throw WriteError("Could not write record to stream");
+        }
+    }
+
+    std::vector<std::pair<const void*, size_t>> parts_;
+    size_t size_{0};
+};
+
+}  // namespace
 
 //---------------------------------------------------------------------------------------------------------------------
 
 size_t RecordWriter::write(Stream out) const {
-    RecordHead r;
+    // Data sections, encoded, compressed and checksummed in parallel
+    // -------------
 
-    auto begin_of_record = out.position();
-
-    auto position = [&begin_of_record, &out]() { return out.position() - begin_of_record; };
-
-    std::vector<RecordDataIndexSection::Entry> index;
-
-    // Begin Record
-    // ------------
-    write_struct(out, r);
-
-    // Metadata section
-    // ----------------
-    {
-        r.metadata_offset = position();
-        write_struct(out, RecordMetadataSection::Begin());
-        auto metadata_str = metadata();
-        write_string(out, metadata_str);
-        write_struct(out, RecordMetadataSection::End());
-        r.metadata_length = position() - r.metadata_offset;
-        r.metadata_checksum
-            = do_checksum_ != 0 ? codec::checksum(metadata_str.data(), metadata_str.size()) : std::string("none:");
-
-        // Index section
-        // -------------
-        auto nb_data_sections = static_cast<size_t>(nb_data_sections_);
-        r.index_offset        = position();
-        write_struct(out, RecordDataIndexSection::Begin());
-        index.resize(nb_data_sections);
-        for (size_t i = 0; i < nb_data_sections; ++i) {
-            write_struct(out, index[i]);
+    std::vector<const std::string*> keys;
+    for (const auto& key : keys_) {
+        if (info_.at(key).section() != 0) {
+            keys.push_back(&key);
         }
-        write_struct(out, RecordDataIndexSection::End());
-        r.index_length = position() - r.index_offset;
     }
+    ASSERT(keys.size() <= static_cast<size_t>(nb_data_sections_));
 
-    // Data sections
-    // -------------
-    {
-        size_t i{0};
-        for (const auto& key : keys_) {
-            const auto& encoder = encoders_.at(key);
-            const auto& info    = info_.at(key);
-            if (info.section() == 0) {
-                continue;
-            }
-            Data data;
-            encode_data(encoder, data);
-            data.compress(info.compression());
-            auto& data_section  = index[i];
-            data_section.offset = position();
-            write_struct(out, RecordDataSection::Begin());
-            if (data.write(out) != data.size()) {
-                throw WriteError("Could not write data for item " + key + " to stream");
-            }
-            write_struct(out, RecordDataSection::End());
-            data_section.length   = position() - data_section.offset;
-            data_section.checksum = do_checksum_ != 0 ? data.checksum() : std::string("none:");
-            ++i;
+    std::vector<Data> data(keys.size());
+    std::vector<std::string> checksums(keys.size());
+
+    auto encode = [&](size_t i) {
+        const auto& key = *keys[i];
+        encode_data(encoders_.at(key), data[i]);
+        data[i].compress(info_.at(key).compression());
+        checksums[i] = do_checksum_ != 0 ? data[i].checksum() : std::string("none:");
+    };
+
+    ThreadPool* threads = pool();
+    if (threads != nullptr && keys.size() > 1) {
+        threads->parallel_for(0, keys.size(), encode, 1);
+    }
+    else {
+        for (size_t i = 0; i < keys.size(); ++i) {
+            encode(i);
         }
     }
 
-    // End Record
-    // ----------
-    write_struct(out, RecordEnd());
-    auto end_of_record = out.position();
+    // Layout, all offsets are known so the record is written in one go
+    // ------
 
-    r.record_length = end_of_record - begin_of_record;
+    RecordHead r;
+    const RecordMetadataSection::Begin metadata_begin;
+    const RecordMetadataSection::End metadata_end;
+    const RecordDataIndexSection::Begin index_begin;
+    const RecordDataIndexSection::End index_end;
+    const RecordDataSection::Begin data_begin;
+    const RecordDataSection::End data_end;
+    const RecordEnd record_end;
+
+    auto metadata_str = metadata();
+
+    r.metadata_offset = sizeof(RecordHead);
+    r.metadata_length = sizeof(metadata_begin) + metadata_str.size() + sizeof(metadata_end);
+    r.metadata_checksum
+        = do_checksum_ != 0 ? codec::checksum(metadata_str.data(), metadata_str.size()) : std::string("none:");
+
+    std::vector<RecordDataIndexSection::Entry> index(static_cast<size_t>(nb_data_sections_));
+    r.index_offset = r.metadata_offset + r.metadata_length;
+    r.index_length = sizeof(index_begin) + index.size() * sizeof(RecordDataIndexSection::Entry) + sizeof(index_end);
+
+    auto position = r.index_offset + r.index_length;
+    for (size_t i = 0; i < data.size(); ++i) {
+        index[i].offset   = position;
+        index[i].length   = sizeof(data_begin) + data[i].size() + sizeof(data_end);
+        index[i].checksum = checksums[i];
+        position += index[i].length;
+    }
+
+    r.record_length = position + sizeof(record_end);
     r.time          = Time::now();
 
-    out.seek(begin_of_record);
-    write_struct(out, r);
+    Sections sections;
+    sections.add(r);
+
+    sections.add(metadata_begin);
+    sections.add(metadata_str.data(), metadata_str.size());
+    sections.add(metadata_end);
 
-    out.seek(begin_of_record + r.index_offset + sizeof(RecordDataIndexSection::Begin));
-    for (auto& entry : index) {
-        write_struct(out, entry);
+    sections.add(index_begin);
+    for (const auto& entry : index) {
+        sections.add(entry);
     }
-    out.seek(end_of_record);  // So that following writes will not overwrite
+    sections.add(index_end);
+
+    for (const auto& d : data) {
+        sections.add(data_begin);
+        sections.add(d.data(), d.size());
+        sections.add(data_end);
+    }
+
+    sections.add(record_end);
+    ASSERT(sections.size() == r.record_length);
+
+    sections.write(out);
     return r.record_length;
 }
 
@@ -42,6 +42,11 @@ Interpreted interprete(T& in) {
 
 /// @class RecordWriter
 /// @brief Write record
+///
+/// The items are encoded, compressed and checksummed in parallel on a thread pool of eckit.codec.write.threads
+/// ($ECKIT_CODEC_WRITE_THREADS, 4) threads, 0 encoding them on the calling thread. The whole record is held in memory
+/// and written with a single write when smaller than eckit.codec.write.buffer.size ($ECKIT_CODEC_WRITE_BUFFER_SIZE,
+/// 64 MiB), one write per section otherwise.
 class RecordWriter {
 public:
     using Key = std::string;
@@ -105,6 +110,7 @@ public:
 
     /// @brief Write new record to a Stream
     /// @pre The Stream must be opened for Write access.
+    /// @note The Stream is only written to, it does not need to support seeking
     size_t write(Stream) const;
 
     /// @brief estimate maximum size of record
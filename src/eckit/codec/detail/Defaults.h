@@ -33,6 +33,22 @@ namespace eckit::codec::defaults {
     return checksum;
 }
 
+[[maybe_unused]] static size_t read_threads() {
+    static const auto threads = Resource<size_t>("eckit.codec.read.threads;$ECKIT_CODEC_READ_THREADS", 4);
+    return threads;
+}
+
+[[maybe_unused]] static size_t write_threads() {
+    static const auto threads = Resource<size_t>("eckit.codec.write.threads;$ECKIT_CODEC_WRITE_THREADS", 4);
+    return threads;
+}
+
+[[maybe_unused]] static size_t write_buffer_size() {
+    static const auto size
+        = Resource<size_t>("eckit.codec.write.buffer.size;$ECKIT_CODEC_WRITE_BUFFER_SIZE", 64 * 1024 * 1024);
+    return size;
+}
+
 [[maybe_unused]] static const std::string& compression_algorithm() {
     static const auto compression = Resource<std::string>("eckit.codec.compression;$ECKIT_CODEC_COMPRESSION", "none");
     return compression;
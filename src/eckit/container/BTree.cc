@@ -9,6 +9,8 @@
  */
 
 #include <sys/file.h>
+#include <sys/mman.h>
+#include <algorithm>
 #include <ostream>
 #ifdef __linux__
 #include <linux/errno.h>
@@ -17,8 +19,10 @@
 #endif
 #endif
 
+#include "eckit/config/Resource.h"
 #include "eckit/exception/Exceptions.h"
 #include "eckit/io/FDataSync.h"
+#include "eckit/memory/MMap.h"
 #include "eckit/memory/Zero.h"
 
 namespace eckit {
@@ -62,7 +66,21 @@ void BTree<K, V, S, L>::_NodePage::print(std::ostream& s) const {
 
 template <class K, class V, int S, class L>
 BTree<K, V, S, L>::BTree(const PathName& path, bool readOnly, off_t offset) :
-    path_(path), file_(path, readOnly), cacheReads_(true), cacheWrites_(true), readOnly_(readOnly), offset_(offset) {
+    path_(path),
+    file_(path, readOnly),
+    readOnly_(readOnly),
+    offset_(offset),
+    hand_(0),
+    cacheLimit_(0),
+    mmap_(false),
+    map_(nullptr),
+    mapLength_(0) {
+    static size_t btreeCacheLimit = Resource<size_t>("btreeCacheLimit;$ECKIT_BTREE_CACHE_LIMIT", 0);
+    static bool btreeMmap         = Resource<bool>("btreeMmap;$ECKIT_BTREE_MMAP", false);
+
+    cacheLimit_ = btreeCacheLimit;
+    mmap_       = readOnly_ && btreeMmap;
+
     file_.open();
 
     AutoLock<BTree<K, V, S, L> > lock(this);
@@ -109,27 +127,78 @@ BTree<K, V, S, L>::~BTree() {
         file_.close();
     }
 
-    for (typename Cache::iterator j = cache_.begin(); j != cache_.end(); ++j)
-        delete (*j).second.page_;
+    unmap();
+
+    for (typename std::vector<_PageInfo>::iterator j = slots_.begin(); j != slots_.end(); ++j)
+        delete (*j).page_;
 }
 
 template <class K, class V, int S, class L>
 void BTree<K, V, S, L>::flush() {
-    for (typename Cache::iterator j = cache_.begin(); j != cache_.end(); ++j) {
-        // Log::info() << "BTree<K,V,S,L>::flush() " << path_ << " " << (*j).first << ", " <<
-        // (*j).second.dirty_ << std::endl;
-        if ((*j).second.dirty_) {
-            _savePage(*(*j).second.page_);
-            (*j).second.dirty_ = false;
+    // Write back in page order, so the I/O is sequential
+    std::vector<_PageInfo*> dirty;
+    for (typename std::vector<_PageInfo>::iterator j = slots_.begin(); j != slots_.end(); ++j) {
+        if ((*j).dirty_) {
+            dirty.push_back(&(*j));
         }
     }
+
+    std::sort(dirty.begin(), dirty.end(),
+              [](const _PageInfo* a, const _PageInfo* b) { return a->page_->id_ < b->page_->id_; });
+
+    for (typename std::vector<_PageInfo*>::iterator j = dirty.begin(); j != dirty.end(); ++j) {
+        // Log::info() << "BTree<K,V,S,L>::flush() " << path_ << " " << (*j)->page_->id_ << std::endl;
+        _savePage(*(*j)->page_);
+        (*j)->dirty_ = false;
+        stats_.writeBacks_++;
+    }
 }
 
 template <class K, class V, int S, class L>
 void BTree<K, V, S, L>::sync() {
+    flush();
     file_.sync();
 }
 
+template <class K, class V, int S, class L>
+void BTree<K, V, S, L>::cacheLimit(size_t bytes) {
+    cacheLimit_ = bytes;
+
+    // Shrink now, the slots beyond the limit are dropped from the end of the ring
+    size_t maxSlots = cacheLimit_ ? std::max<size_t>(cacheLimit_ / sizeof(Page), 1) : slots_.size();
+    while (slots_.size() > maxSlots) {
+        size_t slot = victim();
+        if (slot == size_t(-1)) {
+            break;  // all pinned
+        }
+
+        _PageInfo& info = slots_[slot];
+        if (info.dirty_) {
+            _savePage(*info.page_);
+            stats_.writeBacks_++;
+        }
+        cache_.erase(info.page_->id_);
+        delete info.page_;
+        stats_.evictions_++;
+
+        if (slot != slots_.size() - 1) {
+            info = slots_.back();
+            cache_[info.page_->id_] = slot;
+        }
+        slots_.pop_back();
+        hand_ = 0;
+    }
+}
+
+template <class K, class V, int S, class L>
+void BTree<K, V, S, L>::memoryMap(bool on) {
+    ASSERT(!on || readOnly_);
+    mmap_ = on;
+    if (!mmap_) {
+        unmap();
+    }
+}
+
 template <class K, class V, int S, class L>
 void BTree<K, V, S, L>::dump(std::ostream& s, unsigned long page, int depth) const {
     Page p;
@@ -425,8 +494,8 @@ bool BTree<K, V, S, L>::get(const K& key, V& value) {
 
 template <class K, class V, int S, class L>
 bool BTree<K, V, S, L>::search(unsigned long page, const K& key, V& result) const {
-    Page p;
-    loadPage(page, p);
+    // Node pages are pinned, so only the leaf may be evicted while we hold the reference
+    const Page& p = fetch(page);
 
     // std::cout << "Search " << key << ", Visit " << p << std::endl;
 
@@ -455,6 +524,200 @@ void BTree<K, V, S, L>::range(const K& key1, const K& key2, T& result) {
     search(1, key1, key2, result);
 }
 
+template <class K, class V, int S, class L>
+template <class T>
+size_t BTree<K, V, S, L>::getMany(const std::vector<K>& keys, T& result) {
+    AutoSharedLock<BTree<K, V, S, L> > lock(this);
+    result.clear();
+
+    // The path below holds on to pages, so map the whole file now rather than letting fetch() remap under them.
+    // The file cannot grow while we hold the lock.
+    if (mmap_ && size_t(file_.seekEnd()) > mapLength_) {
+        map();
+    }
+
+    // Node pages from the root down to the current leaf, each with the (exclusive) upper bound of its keys
+    struct Level {
+        const Page* page_;
+        bool bounded_;
+        K upper_;
+    };
+
+    std::vector<Level> path;
+    path.push_back(Level{&fetch(1), false, K()});
+
+    const Page* leaf     = nullptr;
+    const LeafEntry* e   = nullptr;
+    const LeafEntry* end = nullptr;
+    typename std::vector<K>::const_iterator previous = keys.end();
+
+    for (typename std::vector<K>::const_iterator k = keys.begin(); k != keys.end(); ++k) {
+        const K& key = *k;
+
+        ASSERT_MSG(previous == keys.end() || !(key < *previous), "BTree::getMany: keys must be in ascending order");
+        previous = k;
+
+        if (!leaf || (path.back().bounded_ && !(key < path.back().upper_))) {
+
+            // Climb to the lowest node covering the key, the root covers all keys
+            while (path.size() > 1 && path.back().bounded_ && !(key < path.back().upper_)) {
+                path.pop_back();
+            }
+
+            // Descend, node pages are pinned in the cache so the references in path stay valid
+            const Page* p = path.back().page_;
+            while (p->node_) {
+                const NodeEntry* nbegin = p->nodePage().nentries_;
+                const NodeEntry* nend   = nbegin + p->count_;
+                const NodeEntry* u      = std::upper_bound(nbegin, nend, key,
+                                                           [](const K& k, const NodeEntry& n) { return k < n.key_; });
+
+                unsigned long child = (u == nbegin) ? p->left_ : (u - 1)->page_;
+
+                Level level = path.back();
+                if (u != nend) {
+                    level.bounded_ = true;
+                    level.upper_   = (*u).key_;
+                }
+
+                p           = &fetch(child);
+                level.page_ = p;
+                path.push_back(level);
+            }
+
+            leaf = p;
+            e    = leaf->leafPage().lentries_;
+            end  = e + leaf->count_;
+        }
+
+        e = std::lower_bound(e, end, key);
+        if ((e != end) && ((*e).key_ == key)) {
+            result.push_back(result_type((*e).key_, (*e).value_));
+        }
+    }
+
+    return result.size();
+}
+
+template <class K, class V, int S, class L>
+template <class Iterator>
+size_t BTree<K, V, S, L>::bulkLoad(Iterator begin, Iterator end) {
+    AutoLock<BTree<K, V, S, L> > lock(this);
+
+    ASSERT(!readOnly_);
+    {
+        const Page& root = fetch(1);
+        ASSERT_MSG(!root.node_ && root.count_ == 0 && file_.seekEnd() == pageOffset(2),
+                   "BTree::bulkLoad: the tree must be empty");
+    }
+
+    // Pages are filled to one entry less than the maximum, as insert() splits pages that become full
+    const size_t leafCapacity = maxLeafEntries_ - 1;
+    const size_t nodeCapacity = maxNodeEntries_;  // children, one more than entries
+
+    std::vector<NodeEntry> level;  // first key and id of each page of the level below
+    unsigned long nextId = 2;      // pages are appended after the root
+    unsigned long left   = 0;
+    size_t count         = 0;
+    K last{};
+
+    Page p;
+    zero(p);
+
+    for (Iterator j = begin; j != end; ++j) {
+        const K& key = (*j).first;
+
+        if (p.count_ == leafCapacity) {
+            // More entries follow, so the leaf has a right sibling
+            p.id_    = nextId++;
+            p.left_  = left;
+            p.right_ = nextId;
+            _savePage(p);
+
+            level.push_back(NodeEntry{p.leafPage().lentries_[0].key_, p.id_});
+            left = p.id_;
+            zero(p);
+        }
+
+        ASSERT_MSG(count == 0 || last < key, "BTree::bulkLoad: keys must be unique and in ascending order");
+        last = key;
+
+        p.leafPage().lentries_[p.count_].key_   = key;
+        p.leafPage().lentries_[p.count_].value_ = (*j).second;
+        p.count_++;
+        count++;
+    }
+
+    if (level.empty()) {
+        // A single leaf, or nothing, the root is that leaf
+        p.id_ = 1;
+        savePage(p);
+        flush();
+        return count;
+    }
+
+    p.id_    = nextId++;
+    p.left_  = left;
+    p.right_ = 0;
+    _savePage(p);
+    level.push_back(NodeEntry{p.leafPage().lentries_[0].key_, p.id_});
+
+    while (level.size() > nodeCapacity) {
+        std::vector<NodeEntry> upper;
+        size_t n = level.size();
+        for (size_t i = 0; i < n;) {
+            size_t take = std::min(nodeCapacity, n - i);
+            if (n - i - take == 1) {
+                take--;  // a node needs at least two children
+            }
+
+            Page q;
+            zero(q);
+            q.id_   = nextId++;
+            q.node_ = true;
+            q.left_ = level[i].page_;
+            for (size_t k = 1; k < take; ++k) {
+                q.nodePage().nentries_[q.count_++] = level[i + k];
+            }
+            _savePage(q);
+
+            upper.push_back(NodeEntry{level[i].key_, q.id_});
+            i += take;
+        }
+        level.swap(upper);
+    }
+
+    Page root;
+    zero(root);
+    root.id_   = 1;
+    root.node_ = true;
+    root.left_ = level[0].page_;
+    for (size_t k = 1; k < level.size(); ++k) {
+        root.nodePage().nentries_[root.count_++] = level[k];
+    }
+    savePage(root);
+    flush();
+
+    return count;
+}
+
+template <class K, class V, int S, class L>
+size_t BTree<K, V, S, L>::bulkLoad(std::vector<result_type>& entries) {
+    std::stable_sort(entries.begin(), entries.end(),
+                     [](const result_type& a, const result_type& b) { return a.first < b.first; });
+
+    size_t n = 0;
+    for (size_t i = 0; i < entries.size(); ++i) {
+        if (i + 1 < entries.size() && !(entries[i].first < entries[i + 1].first)) {
+            continue;  // the last duplicate wins
+        }
+        entries[n++] = entries[i];
+    }
+    entries.erase(entries.begin() + n, entries.end());
+
+    return bulkLoad(entries.begin(), entries.end());
+}
+
 template <class K, class V, int S, class L>
 bool BTree<K, V, S, L>::remove(const K&) {
     NOTIMP;
@@ -463,17 +726,16 @@ bool BTree<K, V, S, L>::remove(const K&) {
 template <class K, class V, int S, class L>
 template <class T>
 void BTree<K, V, S, L>::search(unsigned long page, const K& key1, const K& key2, T& result) {
-    Page p;
-    loadPage(page, p);
+    const Page* p = &fetch(page);
 
     // std::cout << "Search " << key << ", Visit " << p << std::endl;
 
-    if (p.node_) {
-        return search(next(key1, p), key1, key2, result);
+    if (p->node_) {
+        return search(next(key1, *p), key1, key2, result);
     }
 
-    const LeafEntry* begin = p.leafPage().lentries_;
-    const LeafEntry* end   = begin + p.count_;
+    const LeafEntry* begin = p->leafPage().lentries_;
+    const LeafEntry* end   = begin + p->count_;
 
     const LeafEntry* e = std::lower_bound(begin, end, key1);
 
@@ -487,7 +749,7 @@ void BTree<K, V, S, L>::search(unsigned long page, const K& key1, const K& key2,
     // std::endl;
 
     // std::cout << " begin " << (*begin).key_ << std::endl;
-    if (p.count_) {
+    if (p->count_) {
         // unused		const LeafEntry *last   = begin + p.count_ -1;
         // std::cout << " last "   << (*last).key_ << std::endl;
     }
@@ -499,11 +761,11 @@ void BTree<K, V, S, L>::search(unsigned long page, const K& key1, const K& key2,
 
         ++e;
         if (e == end) {
-            if (p.right_) {
-                loadPage(p.right_, p);
-                ASSERT(!p.node_);
-                e   = p.leafPage().lentries_;
-                end = e + p.count_;
+            if (p->right_) {
+                p = &fetch(p->right_);
+                ASSERT(!p->node_);
+                e   = p->leafPage().lentries_;
+                end = e + p->count_;
             }
             else {
                 return;
@@ -534,23 +796,136 @@ void BTree<K, V, S, L>::_loadPage(unsigned long page, Page& p) const {
 }
 
 template <class K, class V, int S, class L>
-void BTree<K, V, S, L>::loadPage(unsigned long page, Page& p) const {
+const typename BTree<K, V, S, L>::Page& BTree<K, V, S, L>::fetch(unsigned long page) const {
     BTree<K, V, S, L>* self = const_cast<BTree<K, V, S, L>*>(this);
 
+    if (mmap_) {
+        size_t end = size_t(pageOffset(page)) + sizeof(Page);
+        if (end > mapLength_) {
+            self->map();  // the file has grown
+            ASSERT(end <= mapLength_);
+        }
+        self->stats_.hits_++;
+        const Page& p = *reinterpret_cast<const Page*>(map_ + pageOffset(page));
+        ASSERT(page == p.id_);
+        return p;
+    }
+
     typename Cache::iterator j = self->cache_.find(page);
     if (j != self->cache_.end()) {
-        // TODO: find someting better...
-        memcpy(&p, (*j).second.page_, sizeof(Page));
+        _PageInfo& info  = self->slots_[(*j).second];
+        info.referenced_ = true;
+        self->stats_.hits_++;
+        return *info.page_;
+    }
+
+    self->stats_.misses_++;
+
+    _PageInfo& info = self->slots_[self->allocate(page)];
+    try {
+        _loadPage(page, *info.page_);
+    }
+    catch (...) {
+        // Leave a harmless empty slot behind
+        self->cache_.erase(page);
+        zero(*info.page_);
+        info.referenced_ = false;
+        throw;
+    }
+    info.pinned_ = (page == 1 || info.page_->node_);
+    return *info.page_;
+}
+
+template <class K, class V, int S, class L>
+void BTree<K, V, S, L>::loadPage(unsigned long page, Page& p) const {
+    // TODO: find someting better...
+    memcpy(&p, &fetch(page), sizeof(Page));
+}
+
+template <class K, class V, int S, class L>
+size_t BTree<K, V, S, L>::victim() {
+    size_t n = slots_.size();
+    for (size_t i = 0; i < 2 * n; ++i) {
+        size_t slot     = hand_;
+        _PageInfo& info = slots_[slot];
+        hand_           = (hand_ + 1) % n;
+        if (info.pinned_) {
+            continue;
+        }
+        if (info.referenced_) {
+            info.referenced_ = false;
+            continue;
+        }
+        return slot;
+    }
+    return size_t(-1);
+}
+
+template <class K, class V, int S, class L>
+typename BTree<K, V, S, L>::Page* BTree<K, V, S, L>::cachePage(const Page& p, bool dirty) {
+    _PageInfo& info = slots_[allocate(p.id_)];
+    memcpy(info.page_, &p, sizeof(Page));
+    info.dirty_  = dirty;
+    info.pinned_ = (p.id_ == 1 || p.node_);
+    return info.page_;
+}
+
+template <class K, class V, int S, class L>
+size_t BTree<K, V, S, L>::allocate(unsigned long page) {
+    size_t slot = size_t(-1);
+
+    if (cacheLimit_ && slots_.size() >= std::max<size_t>(cacheLimit_ / sizeof(Page), 1)) {
+        slot = victim();
+    }
+
+    if (slot == size_t(-1)) {
+        // Below the limit, or all pages pinned
+        slots_.push_back(_PageInfo(new Page()));
+        slot = slots_.size() - 1;
+    }
+    else {
+        _PageInfo& info = slots_[slot];
+        if (info.dirty_) {
+            _savePage(*info.page_);
+            stats_.writeBacks_++;
+        }
+        cache_.erase(info.page_->id_);
+        stats_.evictions_++;
+    }
+
+    _PageInfo& info  = slots_[slot];
+    info.dirty_      = false;
+    info.pinned_     = false;
+    info.referenced_ = true;
+    cache_[page]     = slot;
+
+    return slot;
+}
+
+template <class K, class V, int S, class L>
+void BTree<K, V, S, L>::map() {
+    unmap();
+
+    off_t length = file_.seekEnd();
+    if (length <= 0) {
         return;
     }
 
+    void* address = MMap::mmap(nullptr, size_t(length), PROT_READ, MAP_SHARED, file_.fileno(), 0);
+    if (address == MAP_FAILED) {
+        throw FailedSystemCall("mmap " + path_, Here());
+    }
 
-    _loadPage(page, p);
+    map_       = static_cast<char*>(address);
+    mapLength_ = size_t(length);
+}
 
-    if (cacheReads_) {
-        Page* q = new Page();
-        memcpy(q, &p, sizeof(Page));
-        self->cache_[p.id_] = _PageInfo(q);
+template <class K, class V, int S, class L>
+void BTree<K, V, S, L>::unmap() {
+    if (map_) {
+        SYSCALL(MMap::munmap(map_, mapLength_));
+        map_       = nullptr;
+        mapLength_ = 0;
     }
 }
 
@@ -570,27 +945,18 @@ void BTree<K, V, S, L>::_savePage(const Page& p) {
 
 template <class K, class V, int S, class L>
 void BTree<K, V, S, L>::savePage(const Page& p) {
-    BTree<K, V, S, L>* self    = const_cast<BTree<K, V, S, L>*>(this);
-    typename Cache::iterator j = self->cache_.find(p.id_);
-    if (j != self->cache_.end()) {
+    typename Cache::iterator j = cache_.find(p.id_);
+    if (j != cache_.end()) {
         // TODO: find someting better...
-        memcpy((*j).second.page_, &p, sizeof(Page));
-        (*j).second.dirty_ = true;
-        (*j).second.count_++;
-        return;
-    }
-
-    if (cacheWrites_) {
-        Page* q = new Page();
-        memcpy(q, &p, sizeof(Page));
-        self->cache_[p.id_] = _PageInfo(q);
-        j                   = self->cache_.find(p.id_);
-        (*j).second.dirty_  = true;
-        (*j).second.count_++;
+        _PageInfo& info = slots_[(*j).second];
+        memcpy(info.page_, &p, sizeof(Page));
+        info.dirty_      = true;
+        info.pinned_     = (p.id_ == 1 || p.node_);
+        info.referenced_ = true;
         return;
     }
 
-    _savePage(p);
+    cachePage(p, true);
 }
 
 template <class K, class V, int S, class L>
@@ -617,12 +983,7 @@ void BTree<K, V, S, L>::_newPage(Page& p) {
 template <class K, class V, int S, class L>
 void BTree<K, V, S, L>::newPage(Page& p) {
     _newPage(p);
-
-    if (cacheReads_ || cacheWrites_) {
-        Page* q = new Page();
-        memcpy(q, &p, sizeof(Page));
-        cache_[p.id_] = _PageInfo(q);
-    }
+    cachePage(p, false);
 }
 
 template <class K, class V, int S, class L>
@@ -17,6 +17,9 @@
 #include <fcntl.h>
 #include <sys/stat.h>
 #include <cstring>
+#include <iosfwd>
+#include <unordered_map>
+#include <vector>
 
 #include "eckit/container/BTree.h"
 #include "eckit/exception/Exceptions.h"
@@ -52,10 +55,35 @@ public:
 
 //----------------------------------------------------------------------------------------------------------------------
 
+struct BTreeCacheStats {
+    size_t hits_       = 0;
+    size_t misses_     = 0;  ///< each one costs a page read
+    size_t evictions_  = 0;
+    size_t writeBacks_ = 0;  ///< dirty pages written on eviction or flush
+
+    void reset() { *this = BTreeCacheStats(); }
+
+    void print(std::ostream& s) const {
+        s << "BTreeCacheStats[hits=" << hits_ << ",misses=" << misses_ << ",evictions=" << evictions_
+          << ",writeBacks=" << writeBacks_ << "]";
+    }
+
+    friend std::ostream& operator<<(std::ostream& s, const BTreeCacheStats& p) {
+        p.print(s);
+        return s;
+    }
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+
 /// B+Tree index
 ///
+/// Pages are kept in an in-process cache, evicted with the CLOCK algorithm once the cache reaches its limit
+/// (resource btreeCacheLimit / $ECKIT_BTREE_CACHE_LIMIT, in bytes, 0 for unbounded). The root and the node pages
+/// are pinned. Modified pages are written back on eviction, flush() and sync().
+/// Read-only trees may instead map the file in memory (resource btreeMmap / $ECKIT_BTREE_MMAP).
+///
 /// @todo Deletion
-/// @todo Cache pages
 /// @invariant K and V needs to be PODs
 /// @invariant S is the page size padding
 /// @invariant L implements locking policy
@@ -85,6 +113,19 @@ public:
     template <class T>
     void range(const K& key1, const K& key2, T& result);
 
+    /// Looks up keys given in ascending order. Pages are visited once per run of keys falling in them, instead of
+    /// descending from the root for every key. Found entries are returned as in range(), the count is returned
+    template <class T>
+    size_t getMany(const std::vector<K>& keys, T& result);
+
+    /// Builds an empty tree bottom-up from (key, value) pairs in strictly ascending key order: leaves are packed
+    /// and written sequentially, then each level of nodes above them. Returns the number of entries
+    template <class Iterator>
+    size_t bulkLoad(Iterator begin, Iterator end);
+
+    /// As above, sorting the entries first. For duplicate keys, the last one wins
+    size_t bulkLoad(std::vector<result_type>& entries);
+
     bool remove(const K&);
 
     void dump(std::ostream& s = std::cout) const;
@@ -106,6 +147,15 @@ public:
     void flush();
     void sync();
 
+    /// Bounds the page cache, in bytes, 0 for unbounded. Pinned pages may exceed the limit
+    void cacheLimit(size_t bytes);
+
+    /// Serve pages from a read-only memory mapping of the file instead of the page cache
+    void memoryMap(bool);
+
+    const BTreeCacheStats& cacheStats() const { return stats_; }
+    void resetCacheStats() { stats_.reset(); }
+
     const PathName& path() const { return path_; }
 
 private:  // methods
@@ -223,23 +273,30 @@ private:
 
     mutable PooledFileDescriptor file_;
 
-    bool cacheReads_;
-    bool cacheWrites_;
     bool readOnly_;
     off_t offset_;
 
     struct _PageInfo {
         Page* page_;
-        unsigned long long count_;
-        time_t last_;
         bool dirty_;
+        bool pinned_;
+        bool referenced_;  // CLOCK bit
 
         _PageInfo(Page* page = 0) :
-            page_(page), count_(0), last_(time(nullptr)), dirty_(false) {}
+            page_(page), dirty_(false), pinned_(false), referenced_(true) {}
     };
 
-    typedef std::map<unsigned long, _PageInfo> Cache;
+    typedef std::unordered_map<unsigned long, size_t> Cache;  // page id -> slot
     Cache cache_;
+    std::vector<_PageInfo> slots_;
+    size_t hand_;
+    size_t cacheLimit_;
+
+    BTreeCacheStats stats_;
+
+    bool mmap_;
+    char* map_;
+    size_t mapLength_;
 
     void lockRange(off_t start, off_t len, int cmd, int type);
     bool search(unsigned long page, const K&, V&) const;
@@ -255,6 +312,14 @@ private:
     void loadPage(unsigned long, Page&) const;
     void newPage(Page&);
 
+    /// Reference valid until the next cache operation, unless the page is pinned
+    const Page& fetch(unsigned long) const;
+    Page* cachePage(const Page&, bool dirty);
+    size_t allocate(unsigned long);
+    size_t victim();
+    void map();
+    void unmap();
+
     void _savePage(const Page&);
     void _loadPage(unsigned long, Page&) const;
     void _newPage(Page&);
@@ -15,14 +15,15 @@
 #define eckit_container_Cache_h
 
 #include <stdint.h>
-#include <sys/time.h>
 
+#include <chrono>
 #include <iostream>
 #include <map>
 #include <utility>
 
 #include "eckit/eckit.h"
 
+#include "eckit/exception/Exceptions.h"
 #include "eckit/memory/NonCopyable.h"
 
 //-----------------------------------------------------------------------------
@@ -31,31 +32,39 @@ namespace eckit {
 
 //-----------------------------------------------------------------------------
 
-
+/// Entries are kept on intrusive lists in recency order, in insertion order, and in frequency buckets, so that the
+/// expiry policies only visit the entries they expire, and purge() only visits expired entries.
+///
+/// The frequency of an entry is aged (LFU with dynamic aging): its priority is its number of hits plus the priority
+/// of the last entry expireLFU() removed, so entries that were popular long ago eventually give way to new ones.
+///
 /// @todo make an apply() method
-/// @todo implement the expire() and the different policies
 
 template <typename K, typename V>
 class Cache : private NonCopyable {
 
 public:  // types
+    typedef std::chrono::steady_clock clock_type;
+
+    struct Entry;
+
+    struct Links {
+        Entry* prev_ = nullptr;
+        Entry* next_ = nullptr;
+    };
+
     struct Entry {
         Entry(const V& v) :
-            v_(v), expired_(false), hits_(0) {
-            gettimeofday(&age_, 0);
-            last_ = age_;
-        }
+            v_(v), expired_(false), hits_(0), age_(clock_type::now()), priority_(0), key_(nullptr) {}
 
         void reset(const V& v) {
             v_       = v;
             expired_ = false;
             hits_    = 0;
-            gettimeofday(&age_, 0);
-            last_ = age_;
+            age_     = clock_type::now();
         }
 
         V& access() {
-            gettimeofday(&last_, 0);
             ++hits_;
             return v_;
         }
@@ -63,8 +72,14 @@ public:  // types
         V v_;
         bool expired_;
         uint64_t hits_;
-        struct ::timeval age_;
-        struct ::timeval last_;
+        clock_type::time_point age_;
+
+        uint64_t priority_;
+        const K* key_;
+
+        Links recency_;  // also links the expired entries
+        Links insertion_;
+        Links frequency_;
     };
 
     typedef K key_type;
@@ -73,18 +88,6 @@ public:  // types
 
     typedef std::map<key_type, entry_type> store_type;
 
-    class Policy {
-        /// Expires the Least Recently Used (LRU) entries
-        /// @returns true if any entries were expired
-        static bool expireLRU(store_type& c, const size_t& maxSize);
-        /// Expires the Least Frequently Used (LFU) entries
-        /// @returns true if any entries were expired
-        static bool expireLFU(store_type& c, const size_t& maxSize);
-        /// Expires the entries older than a certain age
-        /// @returns true if any entries were expired
-        static bool expireAge(store_type& c, struct ::timeval& maxAge);
-    };
-
 public:  // methods
     Cache();
 
@@ -108,6 +111,18 @@ public:  // methods
     /// @returns true if object was present and is marked as expired
     bool expire(const K&);
 
+    /// Expires the Least Recently Used (LRU) entries, keeping at most maxSize valid entries
+    /// @returns the number of entries expired
+    size_t expireLRU(size_t maxSize);
+
+    /// Expires the Least Frequently Used (LFU) entries, keeping at most maxSize valid entries
+    /// @returns the number of entries expired
+    size_t expireLFU(size_t maxSize);
+
+    /// Expires the entries inserted (or updated) more than maxAge seconds ago
+    /// @returns the number of entries expired
+    size_t expireAge(double maxAge);
+
     /// evicts entries that are considered expired
     void purge();
 
@@ -120,6 +135,9 @@ public:  // methods
     /// @returns the number of entries in the cache, expired or not
     size_t size() const;
 
+    /// @returns the number of entries in the cache that are not expired
+    size_t validSize() const { return recency_.size(); }
+
     void print(std::ostream&) const;
 
     friend std::ostream& operator<<(std::ostream& s, const Cache& p) {
@@ -127,20 +145,91 @@ public:  // methods
         return s;
     }
 
+private:  // types
+    /// Doubly linked list threaded through the entries themselves
+    template <Links Entry::*L>
+    class List {
+    public:
+        Entry* front() const { return head_; }
+        size_t size() const { return size_; }
+        bool empty() const { return size_ == 0; }
+
+        void push_back(Entry* e) {
+            Links& l = e->*L;
+            l.prev_  = tail_;
+            l.next_  = nullptr;
+            if (tail_) {
+                (tail_->*L).next_ = e;
+            }
+            else {
+                head_ = e;
+            }
+            tail_ = e;
+            size_++;
+        }
+
+        void remove(Entry* e) {
+            Links& l = e->*L;
+            if (l.prev_) {
+                (l.prev_->*L).next_ = l.next_;
+            }
+            else {
+                head_ = l.next_;
+            }
+            if (l.next_) {
+                (l.next_->*L).prev_ = l.prev_;
+            }
+            else {
+                tail_ = l.prev_;
+            }
+            l.prev_ = l.next_ = nullptr;
+            size_--;
+        }
+
+        void clear() {
+            head_ = tail_ = nullptr;
+            size_         = 0;
+        }
+
+    private:
+        Entry* head_ = nullptr;
+        Entry* tail_ = nullptr;
+        size_t size_ = 0;
+    };
+
+    typedef List<&Entry::recency_> recency_list;
+    typedef List<&Entry::insertion_> insertion_list;
+    typedef List<&Entry::frequency_> frequency_list;
+
 private:  // methods
     /// marks an object as expired
-    /// @returns true if object was present and is marked as expired
-    void expire(typename store_type::iterator i);
+    void expire(Entry* e);
+
+    /// adds a valid entry to the lists
+    void link(Entry* e);
+
+    /// removes a valid entry from the lists
+    void unlink(Entry* e);
+
+    void bucket(Entry* e);
+    void unbucket(Entry* e);
 
 private:  // members
     store_type storage_;
+
+    recency_list recency_;      // valid entries, least recently used first
+    insertion_list insertion_;  // valid entries, oldest first
+    recency_list expired_;
+
+    std::map<uint64_t, frequency_list> buckets_;  // valid entries by priority, then least recently used first
+    uint64_t aging_;
 };
 
 //-----------------------------------------------------------------------------
 
 template <typename K, typename V>
 Cache<K, V>::Cache() :
-    storage_() {}
+    storage_(), aging_(0) {}
 
 template <typename K, typename V>
 Cache<K, V>::~Cache() {
@@ -157,10 +246,14 @@ bool Cache<K, V>::insert(const K& k, const V& v) {
             return false;
         }
 
+        expired_.remove(&e);
         e.reset(v);
+        link(&e);
     }
     else {
-        storage_.insert(std::make_pair(k, Entry(v)));
+        i              = storage_.insert(std::make_pair(k, Entry(v))).first;
+        i->second.key_ = &i->first;
+        link(&i->second);
     }
 
     return true;
@@ -171,10 +264,19 @@ bool Cache<K, V>::update(const K& k, const V& v) {
     typename store_type::iterator i = storage_.find(k);
     if (i != storage_.end()) {
         Entry& e = i->second;
+        if (e.expired_) {
+            expired_.remove(&e);
+        }
+        else {
+            unlink(&e);
+        }
         e.reset(v);
+        link(&e);
         return true;
     }
-    storage_.insert(std::make_pair(k, Entry(v)));
+    i              = storage_.insert(std::make_pair(k, Entry(v))).first;
+    i->second.key_ = &i->first;
+    link(&i->second);
     return false;
 }
 
@@ -185,6 +287,13 @@ bool Cache<K, V>::fetch(const K& k, V& v) {
         Entry& e = i->second;
         if (!e.expired_) {
             v = e.access();
+
+            recency_.remove(&e);
+            recency_.push_back(&e);
+
+            unbucket(&e);
+            bucket(&e);
+
             return true;
         }
     }
@@ -195,36 +304,71 @@ template <typename K, typename V>
 bool Cache<K, V>::expire(const K& k) {
     typename store_type::iterator i = storage_.find(k);
     if (i != storage_.end()) {
-        this->expire(i);
+        this->expire(&i->second);
         return true;
     }
     return false;
 }
 
 template <typename K, typename V>
-void Cache<K, V>::expire(typename store_type::iterator i) {
-    Entry& e   = i->second;
-    e.expired_ = true;
+void Cache<K, V>::expire(Entry* e) {
+    if (!e->expired_) {
+        unlink(e);
+        e->expired_ = true;
+        expired_.push_back(e);
+    }
 }
 
 template <typename K, typename V>
-void Cache<K, V>::purge() {
-    // collect all expired
-    typedef typename store_type::iterator siterator;
-    std::vector<siterator> expired;
-    for (siterator i = storage_.begin(); i != storage_.end(); ++i) {
-        if (i->second.expired_) {
-            expired.push_back(i);
-        }
+size_t Cache<K, V>::expireLRU(size_t maxSize) {
+    size_t count = 0;
+    while (recency_.size() > maxSize) {
+        expire(recency_.front());
+        count++;
+    }
+    return count;
+}
+
+template <typename K, typename V>
+size_t Cache<K, V>::expireLFU(size_t maxSize) {
+    size_t count = 0;
+    while (recency_.size() > maxSize) {
+        Entry* e = buckets_.begin()->second.front();
+        aging_   = e->priority_;
+        expire(e);
+        count++;
+    }
+    return count;
+}
+
+template <typename K, typename V>
+size_t Cache<K, V>::expireAge(double maxAge) {
+    clock_type::time_point limit =
+        clock_type::now() - std::chrono::duration_cast<clock_type::duration>(std::chrono::duration<double>(maxAge));
+
+    size_t count = 0;
+    while (!insertion_.empty() && insertion_.front()->age_ < limit) {
+        expire(insertion_.front());
+        count++;
     }
-    // remove them
-    for (typename std::vector<siterator>::iterator e = expired.begin(); e != expired.end(); ++e) {
-        storage_.erase(*e);
+    return count;
+}
+
+template <typename K, typename V>
+void Cache<K, V>::purge() {
+    while (!expired_.empty()) {
+        Entry* e = expired_.front();
+        expired_.remove(e);
+        storage_.erase(*e->key_);
     }
 }
 
 template <typename K, typename V>
 void Cache<K, V>::clear() {
+    recency_.clear();
+    insertion_.clear();
+    expired_.clear();
+    buckets_.clear();
     storage_.clear();
 }
 
@@ -250,27 +394,34 @@ void Cache<K, V>::print(std::ostream& out) const {
     }
 }
 
-//-----------------------------------------------------------------------------
+template <typename K, typename V>
+void Cache<K, V>::link(Entry* e) {
+    recency_.push_back(e);
+    insertion_.push_back(e);
+    bucket(e);
+}
 
 template <typename K, typename V>
-bool Cache<K, V>::Policy::expireLRU(typename Cache<K, V>::store_type& c, const size_t& maxSize) {
-    //    typedef std::vector< std::pair<
-    //    typedef typename store_type::iterator siterator;
-    //    for( siterator i = storage_.begin(); i != storage_.end(); ++i )
-
-    //    bool found = false;
-    //    typedef typename store_type::iterator siterator;
-    //    for( siterator i = storage_.begin(); i != storage_.end(); ++i )
-    //    {
-    //        if( !i->second.expired_ && policy_->toExpire( i->second ) )
-    //        {
-    //            Entry& e = i->second;
-    //            e.expired_ = true;
-    //            found = true;
-    //        }
-    //    }
-    //    return found;
-    return false;
+void Cache<K, V>::unlink(Entry* e) {
+    recency_.remove(e);
+    insertion_.remove(e);
+    unbucket(e);
+}
+
+template <typename K, typename V>
+void Cache<K, V>::bucket(Entry* e) {
+    e->priority_ = aging_ + e->hits_ + 1;
+    buckets_[e->priority_].push_back(e);
+}
+
+template <typename K, typename V>
+void Cache<K, V>::unbucket(Entry* e) {
+    typename std::map<uint64_t, frequency_list>::iterator b = buckets_.find(e->priority_);
+    ASSERT(b != buckets_.end());
+    b->second.remove(e);
+    if (b->second.empty()) {
+        buckets_.erase(b);
+    }
 }
 
 //-----------------------------------------------------------------------------
@@ -12,8 +12,8 @@
 
 #include <algorithm>
 #include <cstring>
-#include <deque>
 #include <fstream>
+#include <vector>
 
 #include "eckit/container/BTree.h"
 #include "eckit/container/CacheManager.h"
@@ -35,14 +35,10 @@ std::string CacheManagerBase::loader() const {
     return loaderName_;
 }
 
+/// Heap order putting the least recently touched entry on top
 template <class T>
-static bool compare(const T& a, const T& b) {
-
-    if (a.second.last_ == 0) {
-        return false;
-    }
-
-    return a.second.last_ < b.second.last_;
+static bool touchedLater(const T& a, const T& b) {
+    return a.second.last_ > b.second.last_;
 }
 
 static bool sub_path_of(const eckit::PathName& base, const eckit::PathName& path) {
@@ -201,7 +197,7 @@ void CacheManagerBase::touch(const eckit::PathName& base, const eckit::PathName&
                 }
 
 
-                std::deque<cache_btree_t::result_type> result;
+                std::vector<cache_btree_t::result_type> result;
 
                 cache_key_t first;
                 memset(first.data(), '0', cache_key_t::static_size());
@@ -210,17 +206,20 @@ void CacheManagerBase::touch(const eckit::PathName& base, const eckit::PathName&
 
                 btree.range(first, last, result);
 
-                std::sort(result.begin(), result.end(), compare<cache_btree_t::result_type>);
+                // entries that were cleared are skipped, its important else below we retrigger scan
+                result.erase(std::remove_if(result.begin(), result.end(),
+                                            [](const cache_btree_t::result_type& r) { return r.second.last_ == 0; }),
+                             result.end());
+
+                // a heap rather than a full sort, as only the few oldest entries are usually removed
+                std::make_heap(result.begin(), result.end(), touchedLater<cache_btree_t::result_type>);
 
                 size_t deleted = 0;
                 while (deleted < remove && !result.empty()) {
 
-                    cache_btree_t::result_type p = result.front();
-                    result.pop_front();
-
-                    if (p.second.last_ == 0) {  // entry was cleared, its important to skip else below we retrigger scan
-                        continue;
-                    }
+                    std::pop_heap(result.begin(), result.end(), touchedLater<cache_btree_t::result_type>);
+                    cache_btree_t::result_type p = result.back();
+                    result.pop_back();
 
                     std::map<std::string, eckit::PathName>::iterator j = md5_to_path.find(p.first);
                     if (j == md5_to_path.end()) {  // in the btree, but not file mapping. Path may exist on disk
@@ -0,0 +1,304 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+#include "eckit/container/ConcurrentCacheLRU.h"
+
+namespace eckit {
+
+//----------------------------------------------------------------------------------------------------------------------
+
+template <typename K, typename V, typename HASH>
+ConcurrentCacheLRU<K, V, HASH>::ConcurrentCacheLRU(size_t capacity, purge_handler_type purge, sizer_type sizer,
+                                                   size_t shards) :
+    shardCount_(1), shardBits_(0), capacity_(capacity), ttl_(0), purge_(purge), sizer_(sizer) {
+    ASSERT(shards > 0);
+    while (shardCount_ < shards && shardCount_ * 2 <= std::max<size_t>(capacity, 1)) {
+        shardCount_ <<= 1;
+        shardBits_++;
+    }
+    shards_.reset(new Shard[shardCount_]);
+}
+
+template <typename K, typename V, typename HASH>
+ConcurrentCacheLRU<K, V, HASH>::~ConcurrentCacheLRU() {
+    clear();
+}
+
+template <typename K, typename V, typename HASH>
+bool ConcurrentCacheLRU<K, V, HASH>::insert(const key_type& key, const value_type& value) {
+    const clock_type::rep ttl = ttl_.load(std::memory_order_relaxed);
+
+    const size_t weight                  = sizer_ ? sizer_(key, value) : 1;
+    const clock_type::time_point expires = ttl ? clock_type::now() + clock_type::duration(ttl)
+                                               : clock_type::time_point::max();
+
+    bool existed = false;
+    storage_type purged;
+
+    Shard& s = shard(key);
+    {
+        std::lock_guard<std::mutex> lock(s.mutex_);
+
+        typename map_type::iterator itr = s.map_.find(key);
+        if (itr != s.map_.end()) {
+            existed = true;
+
+            // erase the key from where it is
+            // we'll reinsert it again so it comes on top
+
+            erase(s, itr);
+        }
+
+        s.storage_.emplace_front(key, value, weight, expires);
+        s.map_[key] = s.storage_.begin();
+        s.weight_ += weight;
+
+        trim(s, purged);
+    }
+
+    purge(purged);
+
+    return existed;
+}
+
+template <typename K, typename V, typename HASH>
+V ConcurrentCacheLRU<K, V, HASH>::access(const key_type& key) {
+    value_type value;
+    if (!access(key, value)) {
+        throw eckit::OutOfRange("key not in ConcurrentCacheLRU", Here());
+    }
+    return value;
+}
+
+template <typename K, typename V, typename HASH>
+bool ConcurrentCacheLRU<K, V, HASH>::access(const key_type& key, value_type& value) {
+    storage_type purged;
+
+    Shard& s = shard(key);
+    {
+        std::lock_guard<std::mutex> lock(s.mutex_);
+
+        typename map_type::iterator itr = s.map_.find(key);
+        if (itr == s.map_.end()) {
+            s.stats_.misses_++;
+            return false;
+        }
+
+        if (expired(*itr->second, clock_type::now())) {
+            s.stats_.misses_++;
+            s.stats_.expirations_++;
+            erase(s, itr, &purged);
+        }
+        else {
+            s.stats_.hits_++;
+
+            // move entry of list to front
+            // this keeps the most popular in front
+
+            s.storage_.splice(s.storage_.begin(), s.storage_, itr->second);
+            value = itr->second->value_;
+            return true;
+        }
+    }
+
+    purge(purged);
+    return false;
+}
+
+template <typename K, typename V, typename HASH>
+V ConcurrentCacheLRU<K, V, HASH>::extract(const key_type& key) {
+    storage_type extracted;
+
+    Shard& s = shard(key);
+    {
+        std::lock_guard<std::mutex> lock(s.mutex_);
+
+        typename map_type::iterator itr = s.map_.find(key);
+        if (itr == s.map_.end()) {
+            throw OutOfRange("key not in ConcurrentCacheLRU", Here());
+        }
+
+        erase(s, itr, &extracted);
+    }
+
+    return extracted.front().value_;
+}
+
+template <typename K, typename V, typename HASH>
+bool ConcurrentCacheLRU<K, V, HASH>::remove(const key_type& key) {
+    storage_type purged;
+
+    Shard& s = shard(key);
+    {
+        std::lock_guard<std::mutex> lock(s.mutex_);
+
+        typename map_type::iterator itr = s.map_.find(key);
+        if (itr == s.map_.end()) {
+            return false;
+        }
+
+        erase(s, itr, &purged);
+    }
+
+    purge(purged);
+    return true;
+}
+
+template <typename K, typename V, typename HASH>
+bool ConcurrentCacheLRU<K, V, HASH>::exists(const key_type& key) const {
+    Shard& s = shard(key);
+    std::lock_guard<std::mutex> lock(s.mutex_);
+
+    typename map_type::const_iterator itr = s.map_.find(key);
+    return itr != s.map_.end() && !expired(*itr->second, clock_type::now());
+}
+
+template <typename K, typename V, typename HASH>
+void ConcurrentCacheLRU<K, V, HASH>::clear() {
+    for (size_t i = 0; i < shardCount_; ++i) {
+        Shard& s = shards_[i];
+        storage_type purged;
+        {
+            std::lock_guard<std::mutex> lock(s.mutex_);
+            purged.splice(purged.end(), s.storage_);
+            s.map_.clear();
+            s.weight_ = 0;
+        }
+        purge(purged);
+    }
+}
+
+template <typename K, typename V, typename HASH>
+void ConcurrentCacheLRU<K, V, HASH>::capacity(size_t size) {
+    capacity_.store(size, std::memory_order_relaxed);
+
+    for (size_t i = 0; i < shardCount_; ++i) {
+        Shard& s = shards_[i];
+        storage_type purged;
+        {
+            std::lock_guard<std::mutex> lock(s.mutex_);
+            trim(s, purged);
+        }
+        purge(purged);
+    }
+}
+
+template <typename K, typename V, typename HASH>
+size_t ConcurrentCacheLRU<K, V, HASH>::size() const {
+    size_t result = 0;
+    for (size_t i = 0; i < shardCount_; ++i) {
+        std::lock_guard<std::mutex> lock(shards_[i].mutex_);
+        result += shards_[i].map_.size();
+    }
+    return result;
+}
+
+template <typename K, typename V, typename HASH>
+size_t ConcurrentCacheLRU<K, V, HASH>::footprint() const {
+    size_t result = 0;
+    for (size_t i = 0; i < shardCount_; ++i) {
+        std::lock_guard<std::mutex> lock(shards_[i].mutex_);
+        result += shards_[i].weight_;
+    }
+    return result;
+}
+
+template <typename K, typename V, typename HASH>
+void ConcurrentCacheLRU<K, V, HASH>::ttl(double seconds) {
+    ASSERT(seconds >= 0);
+    clock_type::duration d = std::chrono::duration_cast<clock_type::duration>(std::chrono::duration<double>(seconds));
+    ttl_.store(d.count(), std::memory_order_relaxed);
+}
+
+template <typename K, typename V, typename HASH>
+CacheLRUStats ConcurrentCacheLRU<K, V, HASH>::stats() const {
+    CacheLRUStats result;
+    for (size_t i = 0; i < shardCount_; ++i) {
+        std::lock_guard<std::mutex> lock(shards_[i].mutex_);
+        result += shards_[i].stats_;
+    }
+    return result;
+}
+
+template <typename K, typename V, typename HASH>
+void ConcurrentCacheLRU<K, V, HASH>::resetStats() {
+    for (size_t i = 0; i < shardCount_; ++i) {
+        std::lock_guard<std::mutex> lock(shards_[i].mutex_);
+        shards_[i].stats_ = CacheLRUStats();
+    }
+}
+
+template <typename K, typename V, typename HASH>
+typename ConcurrentCacheLRU<K, V, HASH>::Shard& ConcurrentCacheLRU<K, V, HASH>::shard(const key_type& key) const {
+    if (!shardBits_) {
+        return shards_[0];
+    }
+    // Fibonacci hashing: the high bits of the product select the shard, the map buckets use the low bits of the hash
+    uint64_t h = uint64_t(hash_(key)) * 0x9E3779B97F4A7C15ULL;
+    return shards_[h >> (64 - shardBits_)];
+}
+
+template <typename K, typename V, typename HASH>
+size_t ConcurrentCacheLRU<K, V, HASH>::shardCapacity() const {
+    return (capacity_.load(std::memory_order_relaxed) + shardCount_ - 1) >> shardBits_;
+}
+
+template <typename K, typename V, typename HASH>
+void ConcurrentCacheLRU<K, V, HASH>::erase(Shard& s, typename map_type::iterator itr, storage_type* purged) {
+    storage_iterator e = itr->second;
+    s.weight_ -= e->weight_;
+    s.map_.erase(itr);
+    if (purged) {
+        purged->splice(purged->end(), s.storage_, e);
+    }
+    else {
+        s.storage_.erase(e);
+    }
+}
+
+template <typename K, typename V, typename HASH>
+void ConcurrentCacheLRU<K, V, HASH>::trim(Shard& s, storage_type& purged) {
+    const size_t capacity            = shardCapacity();
+    const clock_type::time_point now = clock_type::now();
+    while (s.weight_ > capacity && !s.storage_.empty()) {
+        // The most recent entry stays if it fits in the whole cache, even if not in the share of its shard
+        if (s.storage_.size() == 1 && s.weight_ <= capacity_.load(std::memory_order_relaxed)) {
+            break;
+        }
+
+        Entry& entry = s.storage_.back();
+        if (expired(entry, now)) {
+            s.stats_.expirations_++;
+        }
+        else {
+            s.stats_.evictions_++;
+        }
+        erase(s, s.map_.find(entry.key_), &purged);
+    }
+}
+
+template <typename K, typename V, typename HASH>
+void ConcurrentCacheLRU<K, V, HASH>::purge(storage_type& purged) const {
+    if (purge_) {
+        for (storage_iterator itr = purged.begin(); itr != purged.end(); ++itr) {
+            purge_(itr->key_, itr->value_);
+        }
+    }
+}
+
+template <typename K, typename V, typename HASH>
+void ConcurrentCacheLRU<K, V, HASH>::print(std::ostream& os) const {
+    os << "ConcurrentCacheLRU(capacity=" << capacity() << ",size=" << size() << ",footprint=" << footprint()
+       << ",shards=" << shardCount_ << "," << stats() << ")";
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // namespace eckit
@@ -0,0 +1,212 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+/// @date   Oct 2026
+
+#ifndef eckit_container_ConcurrentCacheLRU_h
+#define eckit_container_ConcurrentCacheLRU_h
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <unordered_map>
+
+#include "eckit/exception/Exceptions.h"
+#include "eckit/log/CodeLocation.h"
+#include "eckit/memory/NonCopyable.h"
+
+namespace eckit {
+
+//----------------------------------------------------------------------------------------------------------------------
+
+struct CacheLRUStats {
+    size_t hits_        = 0;
+    size_t misses_      = 0;
+    size_t evictions_   = 0;
+    size_t expirations_ = 0;
+
+    CacheLRUStats& operator+=(const CacheLRUStats& other) {
+        hits_ += other.hits_;
+        misses_ += other.misses_;
+        evictions_ += other.evictions_;
+        expirations_ += other.expirations_;
+        return *this;
+    }
+
+    void print(std::ostream& s) const {
+        s << "CacheLRUStats[hits=" << hits_ << ",misses=" << misses_ << ",evictions=" << evictions_
+          << ",expirations=" << expirations_ << "]";
+    }
+
+    friend std::ostream& operator<<(std::ostream& s, const CacheLRUStats& p) {
+        p.print(s);
+        return s;
+    }
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/// Thread-safe counterpart of CacheLRU.
+///
+/// Keys are spread by hash over a power of two number of shards, each a hash map and a recency list under its own
+/// mutex, so threads touching different shards do not contend, and lookups, inserts and evictions are O(1).
+/// Recency is tracked per shard, and each shard gets an equal share of the capacity. A shard still keeps its most
+/// recent entry when it is larger than that share but not than the capacity, so the footprint can exceed the
+/// capacity while a shard holds such an entry.
+///
+/// The capacity counts entries, or bytes when a sizer is given, which returns the weight of each entry.
+/// With a TTL, entries expire that many seconds after their insertion.
+/// The purge handler is called for evicted, expired, removed and cleared entries, outside of the shard lock.
+
+template <typename K, typename V, typename HASH = std::hash<K> >
+class ConcurrentCacheLRU : private NonCopyable {
+
+public:  // types
+    typedef K key_type;
+    typedef V value_type;
+
+    typedef void (*purge_handler_type)(key_type&, value_type&);
+    typedef size_t (*sizer_type)(const key_type&, const value_type&);
+
+public:  // methods
+    /// @param shards is rounded up to a power of two, and reduced when larger than the capacity
+    ConcurrentCacheLRU(size_t capacity, purge_handler_type purge = 0, sizer_type sizer = 0, size_t shards = 16);
+
+    ~ConcurrentCacheLRU();
+
+    /// Inserts an entry into the cache, overwrites if already exists
+    /// @returns true if a key already existed
+    bool insert(const key_type& key, const value_type& value);
+
+    /// Accesses a key that must already exist
+    /// @throws OutOfRange exception is key not in cache
+    value_type access(const key_type& key);
+
+    /// Accesses a key, without throwing
+    /// @returns false if the key is not in the cache
+    bool access(const key_type& key, value_type& value);
+
+    /// Extracts the key from the cache without purging
+    /// @pre Key must exist in cache
+    /// @throws OutOfRange exception if key not in cache
+    value_type extract(const key_type& key);
+
+    /// Remove a key-value pair from the cache
+    /// No effect if key is not present
+    ///
+    /// @return true if removed
+    bool remove(const key_type& key);
+
+    /// @returns true if the key exists in the cache
+    bool exists(const key_type& key) const;
+
+    /// Clears all entries in the cache
+    void clear();
+
+    /// @returns the maximum size of the cache, in entries or bytes
+    size_t capacity() const { return capacity_.load(std::memory_order_relaxed); }
+
+    /// resizes the cache capacity
+    void capacity(size_t size);
+
+    /// @returns the current number of entries
+    size_t size() const;
+
+    /// @returns the current weight of the entries, their number without a sizer
+    size_t footprint() const;
+
+    /// Entries inserted from now on expire after this many seconds, 0 disables
+    void ttl(double seconds);
+
+    double ttl() const {
+        return std::chrono::duration<double>(clock_type::duration(ttl_.load(std::memory_order_relaxed))).count();
+    }
+
+    size_t shards() const { return shardCount_; }
+
+    CacheLRUStats stats() const;
+
+    void resetStats();
+
+    void print(std::ostream& os) const;
+
+    friend std::ostream& operator<<(std::ostream& s, const ConcurrentCacheLRU& p) {
+        p.print(s);
+        return s;
+    }
+
+private:  // types
+    typedef std::chrono::steady_clock clock_type;
+
+    struct Entry {
+        key_type key_;
+        value_type value_;
+        size_t weight_;
+        clock_type::time_point expires_;
+
+        Entry(const key_type& k, const value_type& v, size_t weight, clock_type::time_point expires) :
+            key_(k), value_(v), weight_(weight), expires_(expires) {}
+    };
+
+    typedef std::list<Entry> storage_type;
+    typedef typename storage_type::iterator storage_iterator;
+    typedef std::unordered_map<key_type, storage_iterator, HASH> map_type;
+
+    struct alignas(64) Shard {
+        mutable std::mutex mutex_;
+        storage_type storage_;
+        map_type map_;
+        size_t weight_ = 0;
+        CacheLRUStats stats_;
+    };
+
+private:  // methods
+    Shard& shard(const key_type& key) const;
+
+    size_t shardCapacity() const;
+
+    /// Entries without a TTL expire at clock_type::time_point::max()
+    bool expired(const Entry& e, clock_type::time_point now) const { return e.expires_ <= now; }
+
+    /// Unlinks the entry, moving it to purged if given
+    void erase(Shard& s, typename map_type::iterator itr, storage_type* purged = nullptr);
+
+    void trim(Shard& s, storage_type& purged);
+
+    void purge(storage_type& purged) const;
+
+private:  // members
+    std::unique_ptr<Shard[]> shards_;
+    size_t shardCount_;
+    size_t shardBits_;
+
+    std::atomic<size_t> capacity_;
+
+    std::atomic<clock_type::rep> ttl_;
+
+    HASH hash_;
+
+    purge_handler_type purge_;
+    sizer_type sizer_;
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // namespace eckit
+
+#include "ConcurrentCacheLRU.cc"
+
+#endif
@@ -0,0 +1,142 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+#include "KDFlat.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <unistd.h>
+#include <cstdlib>
+
+#include "eckit/log/Log.h"
+#include "eckit/memory/MMap.h"
+#include "eckit/os/Stat.h"
+
+
+namespace eckit {
+
+//----------------------------------------------------------------------------------------------------------------------
+
+namespace {
+
+constexpr size_t alignment = 64;
+
+size_t align(size_t n) {
+    return (n + alignment - 1) / alignment * alignment;
+}
+
+}  // namespace
+
+KDFlatHeader::KDFlatHeader(size_t itemCount, size_t itemSize, size_t dimensions, size_t bucketSize,
+                           size_t metadataSize) :
+    headerSize_(sizeof(KDFlatHeader)),
+    version_(1),
+    itemCount_(itemCount),
+    itemSize_(itemSize),
+    dimensions_(dimensions),
+    bucketSize_(bucketSize),
+    leafCount_(1),
+    metadataSize_(metadataSize) {
+    size_t buckets = (itemCount + bucketSize - 1) / bucketSize;
+    while (leafCount_ < buckets) {
+        leafCount_ *= 2;
+    }
+}
+
+KDFlatLayout::KDFlatLayout(const KDFlatHeader& h) {
+    metadata_    = align(h.headerSize_);
+    splits_      = align(metadata_ + h.metadataSize_);
+    axes_        = align(splits_ + (h.leafCount_ - 1) * sizeof(double));
+    offsets_     = align(axes_ + (h.leafCount_ - 1) * sizeof(uint8_t));
+    coordinates_ = align(offsets_ + (h.leafCount_ + 1) * sizeof(uint64_t));
+    values_      = align(coordinates_ + h.itemCount_ * h.dimensions_ * sizeof(double));
+    size_        = align(values_ + h.itemCount_ * h.itemSize_);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+KDFlatBuffer::KDFlatBuffer() :
+    data_(nullptr), size_(0), readOnly_(false), mapped_(false) {}
+
+KDFlatBuffer::~KDFlatBuffer() {
+    release();
+}
+
+void KDFlatBuffer::release() {
+    if (data_) {
+        if (mapped_) {
+            SYSCALL(MMap::munmap(data_, size_));
+        }
+        else {
+            ::free(data_);
+        }
+    }
+    data_     = nullptr;
+    size_     = 0;
+    readOnly_ = false;
+    mapped_   = false;
+}
+
+void KDFlatBuffer::allocate(size_t size) {
+    release();
+    data_ = static_cast<char*>(::aligned_alloc(alignment, align(size)));
+    ASSERT(data_);
+    size_ = size;
+}
+
+void KDFlatBuffer::create(const PathName& path, size_t size) {
+    release();
+
+    int fd;
+    SYSCALL(fd = ::open(path.localPath(), O_RDWR | O_CREAT | O_TRUNC, 0777));
+    SYSCALL(::ftruncate(fd, size));
+
+    void* addr = MMap::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (addr == MAP_FAILED) {
+        Log::error() << "create(" << path << ')' << Log::syserr << std::endl;
+        SYSCALL(::close(fd));
+        throw FailedSystemCall("mmap");
+    }
+    SYSCALL(::close(fd));
+
+    data_   = static_cast<char*>(addr);
+    size_   = size;
+    mapped_ = true;
+}
+
+void KDFlatBuffer::open(const PathName& path) {
+    release();
+
+    int fd;
+    SYSCALL(fd = ::open(path.localPath(), O_RDONLY));
+
+    Stat::Struct s;
+    SYSCALL(Stat::fstat(fd, &s));
+    ASSERT(size_t(s.st_size) >= sizeof(KDFlatHeader));
+
+    void* addr = MMap::mmap(nullptr, s.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    if (addr == MAP_FAILED) {
+        Log::error() << "open(" << path << ')' << Log::syserr << std::endl;
+        SYSCALL(::close(fd));
+        throw FailedSystemCall("mmap");
+    }
+    SYSCALL(::close(fd));
+
+    data_     = static_cast<char*>(addr);
+    size_     = s.st_size;
+    readOnly_ = true;
+    mapped_   = true;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // namespace eckit
@@ -0,0 +1,534 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+/// @date   Oct 2026
+
+#ifndef KDFlat_H
+#define KDFlat_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <new>
+#include <ostream>
+#include <utility>
+#include <vector>
+
+#include "eckit/container/sptree/SPMetadata.h"
+#include "eckit/container/sptree/SPValue.h"
+#include "eckit/exception/Exceptions.h"
+#include "eckit/filesystem/PathName.h"
+#include "eckit/memory/NonCopyable.h"
+
+namespace eckit {
+
+//----------------------------------------------------------------------------------------------------------------------
+
+struct KDFlatHeader {
+    size_t headerSize_;
+    size_t version_;
+    size_t itemCount_;
+    size_t itemSize_;
+    size_t dimensions_;
+    size_t bucketSize_;
+    size_t leafCount_;
+    size_t metadataSize_;
+
+    KDFlatHeader(size_t itemCount, size_t itemSize, size_t dimensions, size_t bucketSize, size_t metadataSize);
+};
+
+/// Byte offsets of the arrays of a KDTreeFlat, each aligned to a cache line
+struct KDFlatLayout {
+    size_t metadata_;
+    size_t splits_;
+    size_t axes_;
+    size_t offsets_;
+    size_t coordinates_;
+    size_t values_;
+    size_t size_;
+
+    explicit KDFlatLayout(const KDFlatHeader&);
+};
+
+/// The memory of a KDTreeFlat: allocated, or a file mapped read-write to build it, or read-only to use it
+class KDFlatBuffer : private NonCopyable {
+public:
+    KDFlatBuffer();
+    ~KDFlatBuffer();
+
+    void allocate(size_t size);
+    void create(const PathName&, size_t size);
+    void open(const PathName&);
+
+    char* data() { return data_; }
+    const char* data() const { return data_; }
+    size_t size() const { return size_; }
+    bool readOnly() const { return readOnly_; }
+
+private:
+    void release();
+
+    char* data_;
+    size_t size_;
+    bool readOnly_;
+    bool mapped_;
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/// KD-tree stored in one contiguous block, in memory or in a file, for fast nearest neighbour searches.
+///
+/// The tree is balanced and complete: its internal nodes are an implicit binary heap in breadth-first order (the
+/// children of node i are 2i+1 and 2i+2), holding only the split value and axis, and its leaves are buckets of a
+/// few points, split along the axis of largest extent. The points of the buckets are stored consecutively, with their
+/// coordinates as one array per axis so buckets are scanned with vector instructions, and the values alongside.
+///
+/// Like KDTreeMapped, a tree built in a file with (path, itemCount, metadataSize) is opened read-only with
+/// (path, 0, 0), as the file is mapped in memory.
+///
+/// Distances are Euclidean, as Point::distance is for KPoint. Values must be trivially copyable to be saved.
+
+template <class Traits>
+class KDTreeFlat : private NonCopyable {
+public:
+    typedef typename Traits::Point Point;
+    typedef typename Traits::Payload Payload;
+    typedef SPValue<Traits> Value;
+    typedef SPMetadata<Traits> Metadata;
+
+    typedef Point PointType;
+    typedef Payload PayloadType;
+
+    static constexpr size_t DIMS = Point::DIMS;
+
+    static constexpr size_t maxBucketSize = 64;
+
+    struct NodeInfo {
+        const Value* value_;
+        double distance_;
+
+        NodeInfo() :
+            value_(nullptr), distance_(0) {}
+
+        NodeInfo(const Value* value, double distance) :
+            value_(value), distance_(distance) {}
+
+        bool operator<(const NodeInfo& other) const { return distance_ < other.distance_; }
+
+        const Point& point() const { return value_->point(); }
+        const Payload& payload() const { return value_->payload(); }
+        const Value& value() const { return *value_; }
+
+        double distance() const { return distance_; }
+    };
+
+    typedef std::vector<NodeInfo> NodeList;
+
+public:
+    /// A tree in memory
+    explicit KDTreeFlat(size_t bucketSize = 16) :
+        bucketSize_(bucketSize), metadataSize_(0), path_(), fileItemCount_(0) {
+        ASSERT(0 < bucketSize_ && bucketSize_ <= maxBucketSize);
+        reset();
+    }
+
+    /// A tree in a file, built if itemCount is not 0, or else opened read-only
+    KDTreeFlat(const PathName& path, size_t itemCount, size_t metadataSize, size_t bucketSize = 16) :
+        bucketSize_(bucketSize), metadataSize_(metadataSize), path_(path), fileItemCount_(itemCount) {
+        ASSERT(0 < bucketSize_ && bucketSize_ <= maxBucketSize);
+        if (itemCount) {
+            reset();
+        }
+        else {
+            buffer_.open(path);
+            attach();
+        }
+    }
+
+    /// ITER must be a random access iterator over Values, the container is not changed
+    template <typename ITER>
+    void build(ITER begin, ITER end);
+
+    template <typename Container>
+    void build(const Container& c) {
+        build(c.begin(), c.end());
+    }
+
+    NodeInfo nearestNeighbour(const Point& p) const;
+    NodeList kNearestNeighbours(const Point& p, size_t k) const;
+    NodeList findInSphere(const Point& p, double radius) const;
+
+    void setMetadata(const Point& offset, const Point& scale);
+    void getMetadata(Point& offset, Point& scale) const;
+
+    size_t size() const { return header().itemCount_; }
+    bool empty() const { return size() == 0; }
+
+    size_t bucketSize() const { return header().bucketSize_; }
+
+    /// The values, in the order of the buckets
+    const Value* begin() const { return values_; }
+    const Value* end() const { return values_ + size(); }
+
+    void print(std::ostream& o) const { o << "KDTreeFlat[size=" << size() << ",buckets=" << leafCount_ << "]"; }
+
+    friend std::ostream& operator<<(std::ostream& o, const KDTreeFlat& t) {
+        t.print(o);
+        return o;
+    }
+
+private:
+    const KDFlatHeader& header() const { return *reinterpret_cast<const KDFlatHeader*>(buffer_.data()); }
+
+    /// Creates the file for fileItemCount_ values, or an empty tree in memory
+    void reset();
+
+    /// Writes the header for count values at the start of the buffer
+    void initialise(size_t count);
+
+    /// Sets the views into the buffer from its header
+    void attach();
+
+    /// Splits the values [first, last) for node, recursively down to the buckets
+    void split(Value* values, double* splits, uint8_t* axes, uint64_t* offsets, size_t node, size_t first,
+               size_t last);
+
+    /// Visits the buckets that may hold points within visitor.bound() (a squared distance) of q
+    template <class Visitor>
+    void search(size_t node, const double* q, Visitor& v) const;
+
+    /// Squared distances from q to the points [first, last) of a bucket
+    void distances(size_t first, size_t last, const double* q, double* d2) const {
+        const size_t n = last - first;
+        for (size_t j = 0; j < n; ++j) {
+            d2[j] = 0;
+        }
+        for (size_t k = 0; k < DIMS; ++k) {
+            const double* c = coordinates_ + k * size() + first;
+            const double x  = q[k];
+            for (size_t j = 0; j < n; ++j) {
+                const double t = c[j] - x;
+                d2[j] += t * t;
+            }
+        }
+    }
+
+    static void coordinates(const Point& p, double* q) {
+        for (size_t k = 0; k < DIMS; ++k) {
+            q[k] = p.x(k);
+        }
+    }
+
+private:
+    size_t bucketSize_;
+    size_t metadataSize_;
+    PathName path_;
+    size_t fileItemCount_;
+
+    KDFlatBuffer buffer_;
+
+    // Views into buffer_
+    size_t leafCount_          = 0;
+    const double* splits_      = nullptr;
+    const uint8_t* axes_       = nullptr;
+    const uint64_t* offsets_   = nullptr;
+    const double* coordinates_ = nullptr;
+    const Value* values_       = nullptr;
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+
+template <class Traits>
+void KDTreeFlat<Traits>::reset() {
+    if (fileItemCount_) {
+        KDFlatHeader h(fileItemCount_, sizeof(Value), DIMS, bucketSize_, metadataSize_);
+        buffer_.create(path_, KDFlatLayout(h).size_);
+    }
+    else {
+        KDFlatHeader h(0, sizeof(Value), DIMS, bucketSize_, metadataSize_);
+        buffer_.allocate(KDFlatLayout(h).size_);
+    }
+    initialise(0);
+}
+
+template <class Traits>
+void KDTreeFlat<Traits>::initialise(size_t count) {
+    KDFlatHeader* h = new (buffer_.data()) KDFlatHeader(count, sizeof(Value), DIMS, bucketSize_, metadataSize_);
+
+    // An empty tree is one empty bucket
+    KDFlatLayout layout(*h);
+    uint64_t* offsets = reinterpret_cast<uint64_t*>(buffer_.data() + layout.offsets_);
+    offsets[0] = offsets[1] = 0;
+
+    attach();
+}
+
+template <class Traits>
+void KDTreeFlat<Traits>::attach() {
+    const KDFlatHeader& h = header();
+    ASSERT(h.headerSize_ == sizeof(KDFlatHeader));
+    ASSERT(h.itemSize_ == sizeof(Value));
+    ASSERT(h.dimensions_ == DIMS);
+
+    KDFlatLayout layout(h);
+    ASSERT(layout.size_ <= buffer_.size());
+
+    const char* base = buffer_.data();
+    leafCount_       = h.leafCount_;
+    splits_          = reinterpret_cast<const double*>(base + layout.splits_);
+    axes_            = reinterpret_cast<const uint8_t*>(base + layout.axes_);
+    offsets_         = reinterpret_cast<const uint64_t*>(base + layout.offsets_);
+    coordinates_     = reinterpret_cast<const double*>(base + layout.coordinates_);
+    values_          = reinterpret_cast<const Value*>(base + layout.values_);
+}
+
+template <class Traits>
+template <typename ITER>
+void KDTreeFlat<Traits>::build(ITER begin, ITER end) {
+    ASSERT(!buffer_.readOnly());
+
+    const size_t n = end - begin;
+
+    if (fileItemCount_) {
+        ASSERT(n == fileItemCount_);
+    }
+    else {
+        KDFlatHeader h(n, sizeof(Value), DIMS, bucketSize_, metadataSize_);
+        buffer_.allocate(KDFlatLayout(h).size_);
+    }
+    initialise(n);
+
+    KDFlatLayout layout(header());
+    char* base = buffer_.data();
+
+    Value* values = reinterpret_cast<Value*>(base + layout.values_);
+    for (size_t i = 0; i < n; ++i, ++begin) {
+        new (values + i) Value(*begin);
+    }
+
+    uint64_t* offsets = reinterpret_cast<uint64_t*>(base + layout.offsets_);
+    split(values, reinterpret_cast<double*>(base + layout.splits_), reinterpret_cast<uint8_t*>(base + layout.axes_),
+          offsets, 0, 0, n);
+    offsets[leafCount_] = n;
+
+    double* coordinates = reinterpret_cast<double*>(base + layout.coordinates_);
+    for (size_t k = 0; k < DIMS; ++k) {
+        for (size_t i = 0; i < n; ++i) {
+            coordinates[k * n + i] = values[i].point().x(k);
+        }
+    }
+}
+
+template <class Traits>
+void KDTreeFlat<Traits>::split(Value* values, double* splits, uint8_t* axes, uint64_t* offsets, size_t node,
+                               size_t first, size_t last) {
+    if (node >= leafCount_ - 1) {
+        offsets[node - (leafCount_ - 1)] = first;
+        return;
+    }
+
+    double lo[DIMS];
+    double hi[DIMS];
+    for (size_t k = 0; k < DIMS; ++k) {
+        lo[k] = std::numeric_limits<double>::max();
+        hi[k] = -std::numeric_limits<double>::max();
+    }
+    for (size_t i = first; i < last; ++i) {
+        for (size_t k = 0; k < DIMS; ++k) {
+            double x = values[i].point().x(k);
+            lo[k]    = std::min(lo[k], x);
+            hi[k]    = std::max(hi[k], x);
+        }
+    }
+
+    size_t axis = 0;
+    for (size_t k = 1; k < DIMS; ++k) {
+        if (hi[k] - lo[k] > hi[axis] - lo[axis]) {
+            axis = k;
+        }
+    }
+
+    size_t middle = first + (last - first) / 2;
+    std::nth_element(values + first, values + middle, values + last, [axis](const Value& a, const Value& b) {
+        return a.point().x(axis) < b.point().x(axis);
+    });
+
+    splits[node] = middle < last ? values[middle].point().x(axis) : 0;
+    axes[node]   = uint8_t(axis);
+
+    split(values, splits, axes, offsets, 2 * node + 1, first, middle);
+    split(values, splits, axes, offsets, 2 * node + 2, middle, last);
+}
+
+template <class Traits>
+template <class Visitor>
+void KDTreeFlat<Traits>::search(size_t node, const double* q, Visitor& v) const {
+    if (node >= leafCount_ - 1) {
+        size_t leaf = node - (leafCount_ - 1);
+        v.scan(offsets_[leaf], offsets_[leaf + 1]);
+        return;
+    }
+
+    const double diff  = q[axes_[node]] - splits_[node];
+    const size_t right = diff >= 0 ? 1 : 0;
+
+    search(2 * node + 1 + right, q, v);
+    if (diff * diff <= v.bound()) {
+        search(2 * node + 2 - right, q, v);
+    }
+}
+
+template <class Traits>
+typename KDTreeFlat<Traits>::NodeInfo KDTreeFlat<Traits>::nearestNeighbour(const Point& p) const {
+    ASSERT(!empty());
+
+    struct Nearest {
+        const KDTreeFlat& tree_;
+        const double* q_;
+        double best_;
+        size_t index_;
+
+        double bound() const { return best_; }
+
+        void scan(size_t first, size_t last) {
+            double d2[maxBucketSize];
+            tree_.distances(first, last, q_, d2);
+            for (size_t j = 0; j < last - first; ++j) {
+                if (d2[j] < best_) {
+                    best_  = d2[j];
+                    index_ = first + j;
+                }
+            }
+        }
+    };
+
+    double q[DIMS];
+    coordinates(p, q);
+
+    Nearest v{*this, q, std::numeric_limits<double>::max(), 0};
+    search(0, q, v);
+
+    return NodeInfo(values_ + v.index_, std::sqrt(v.best_));
+}
+
+template <class Traits>
+typename KDTreeFlat<Traits>::NodeList KDTreeFlat<Traits>::kNearestNeighbours(const Point& p, size_t k) const {
+    ASSERT(!empty());
+
+    typedef std::pair<double, size_t> Candidate;
+
+    struct Nearest {
+        const KDTreeFlat& tree_;
+        const double* q_;
+        size_t k_;
+        std::vector<Candidate> heap_;  // largest distance on top
+
+        double bound() const {
+            return heap_.size() < k_ ? std::numeric_limits<double>::max() : heap_.front().first;
+        }
+
+        void scan(size_t first, size_t last) {
+            double d2[maxBucketSize];
+            tree_.distances(first, last, q_, d2);
+            for (size_t j = 0; j < last - first; ++j) {
+                if (heap_.size() < k_) {
+                    heap_.emplace_back(d2[j], first + j);
+                    std::push_heap(heap_.begin(), heap_.end());
+                }
+                else if (d2[j] < heap_.front().first) {
+                    std::pop_heap(heap_.begin(), heap_.end());
+                    heap_.back() = Candidate(d2[j], first + j);
+                    std::push_heap(heap_.begin(), heap_.end());
+                }
+            }
+        }
+    };
+
+    double q[DIMS];
+    coordinates(p, q);
+
+    Nearest v{*this, q, k, {}};
+    v.heap_.reserve(k);
+    search(0, q, v);
+
+    std::sort_heap(v.heap_.begin(), v.heap_.end());
+
+    NodeList result;
+    result.reserve(v.heap_.size());
+    for (const Candidate& c : v.heap_) {
+        result.push_back(NodeInfo(values_ + c.second, std::sqrt(c.first)));
+    }
+    return result;
+}
+
+template <class Traits>
+typename KDTreeFlat<Traits>::NodeList KDTreeFlat<Traits>::findInSphere(const Point& p, double radius) const {
+    struct InSphere {
+        const KDTreeFlat& tree_;
+        const double* q_;
+        double radius2_;
+        NodeList& result_;
+
+        double bound() const { return radius2_; }
+
+        void scan(size_t first, size_t last) {
+            double d2[maxBucketSize];
+            tree_.distances(first, last, q_, d2);
+            for (size_t j = 0; j < last - first; ++j) {
+                if (d2[j] <= radius2_) {
+                    result_.push_back(NodeInfo(tree_.values_ + first + j, std::sqrt(d2[j])));
+                }
+            }
+        }
+    };
+
+    NodeList result;
+    if (empty()) {
+        return result;
+    }
+
+    double q[DIMS];
+    coordinates(p, q);
+
+    InSphere v{*this, q, radius * radius, result};
+    search(0, q, v);
+
+    std::sort(result.begin(), result.end());
+    return result;
+}
+
+template <class Traits>
+void KDTreeFlat<Traits>::setMetadata(const Point& offset, const Point& scale) {
+    ASSERT(!buffer_.readOnly());
+    ASSERT(header().metadataSize_ == sizeof(Metadata));
+
+    Metadata meta;
+    meta.offset_ = offset;
+    meta.scale_  = scale;
+    ::memcpy(buffer_.data() + KDFlatLayout(header()).metadata_, &meta, sizeof(meta));
+}
+
+template <class Traits>
+void KDTreeFlat<Traits>::getMetadata(Point& offset, Point& scale) const {
+    ASSERT(header().metadataSize_ == sizeof(Metadata));
+
+    Metadata meta;
+    ::memcpy(&meta, buffer_.data() + KDFlatLayout(header()).metadata_, sizeof(meta));
+    offset = meta.offset_;
+    scale  = meta.scale_;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // namespace eckit
+
+#endif
@@ -11,8 +11,12 @@
 #ifndef KDTree_H
 #define KDTree_H
 
+#include <utility>
+#include <vector>
+
 #include "eckit/container/kdtree/KDNode.h"
 #include "eckit/container/sptree/SPTree.h"
+#include "eckit/thread/ThreadPool.h"
 
 #include "KDMapped.h"
 #include "KDMemory.h"
@@ -53,6 +57,59 @@ public:
         build(b, e);
     }
 
+    /// As build(), partitioning on the threads of the pool: the upper levels split their ranges concurrently, level
+    /// by level, then the subtrees below are ordered as independent tasks. The nodes are created afterwards, in the
+    /// order build() creates them, so the tree is the same.
+    /// ITER must be a random access iterator
+    /// WARNING: container is changed (sorted)
+    template <typename ITER>
+    void build(ITER begin, ITER end, ThreadPool& pool) {
+        typedef std::pair<ITER, ITER> Range;
+
+        // Enough subtrees to keep all threads busy even if they are unevenly fast
+        const size_t subtrees = 8 * pool.size();
+
+        std::vector<Range> ranges(1, Range(begin, end));
+        int depth = 0;
+
+        while (!ranges.empty() && ranges.size() < subtrees) {
+            std::vector<ITER> medians(ranges.size());
+            pool.parallel_for(
+                0, ranges.size(),
+                [&ranges, &medians, depth](size_t i) {
+                    medians[i] = Node::split(ranges[i].first, ranges[i].second, depth);
+                },
+                1);
+
+            std::vector<Range> next;
+            for (size_t i = 0; i < ranges.size(); ++i) {
+                if (medians[i] - ranges[i].first > 1) {
+                    next.push_back(Range(ranges[i].first, medians[i]));
+                }
+                if (ranges[i].second - medians[i] > 2) {
+                    next.push_back(Range(medians[i] + 1, ranges[i].second));
+                }
+            }
+            ranges.swap(next);
+            depth++;
+        }
+
+        pool.parallel_for(
+            0, ranges.size(), [&ranges, depth](size_t i) { Node::arrange(ranges[i].first, ranges[i].second, depth); },
+            1);
+
+        Alloc& a    = this->alloc_;
+        this->root_ = a.convert(Node::assemble(a, begin, end));
+        a.root(this->root_);
+    }
+
+    /// Container must be a random access
+    /// WARNING: container is changed (sorted)
+    template <typename Container>
+    void build(Container& c, ThreadPool& pool) {
+        build(c.begin(), c.end(), pool);
+    }
+
     //
     void insert(const Value& value) {
         Alloc& a   = this->alloc_;
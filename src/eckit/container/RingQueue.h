@@ -0,0 +1,277 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+/// @date   Oct 2026
+
+#ifndef eckit_container_RingQueue_h
+#define eckit_container_RingQueue_h
+
+#include <atomic>
+#include <cstdint>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "eckit/exception/Exceptions.h"
+#include "eckit/memory/Padded.h"
+#include "eckit/thread/EventCount.h"
+
+namespace eckit {
+
+//----------------------------------------------------------------------------------------------------------------------
+
+enum class RingQueueAccess
+{
+    MultiProducerMultiConsumer,
+    SingleProducerSingleConsumer
+};
+
+/// Fixed capacity lock-free queue with the push/pop/close/interrupt semantics of eckit::Queue.
+///
+/// Each slot carries a sequence number telling whether it is ready for the producer or the consumer of a given
+/// position (D. Vyukov's bounded MPMC queue), so producers and consumers only contend on their own index.
+/// Blocking operations spin briefly, then sleep on an EventCount; nobody is woken when nobody waits.
+/// With RingQueueAccess::SingleProducerSingleConsumer the index updates need no compare-and-swap.
+///
+/// The capacity is rounded up to a power of two, and is at least 2.
+
+template <typename ELEM, RingQueueAccess ACCESS = RingQueueAccess::MultiProducerMultiConsumer>
+class RingQueue {
+
+    static constexpr bool multiProducer_ = (ACCESS == RingQueueAccess::MultiProducerMultiConsumer);
+    static constexpr bool multiConsumer_ = (ACCESS == RingQueueAccess::MultiProducerMultiConsumer);
+
+    static constexpr size_t spins_ = 64;
+
+    struct Cell {
+        std::atomic<size_t> sequence_;
+        alignas(ELEM) unsigned char storage_[sizeof(ELEM)];
+
+        ELEM* elem() { return std::launder(reinterpret_cast<ELEM*>(storage_)); }
+    };
+
+    using Index = Padded<std::atomic<size_t>, 64>;
+
+public:  // methods
+    explicit RingQueue(size_t max) :
+        closed_(false), interrupted_(false) {
+        ASSERT(max > 0);
+        size_t capacity = 2;  // with a single slot, "full at pos" and "empty at pos + 1" are indistinguishable
+        while (capacity < max) {
+            capacity <<= 1;
+        }
+        mask_  = capacity - 1;
+        cells_ = std::unique_ptr<Cell[]>(new Cell[capacity]);
+        for (size_t i = 0; i < capacity; ++i) {
+            cells_[i].sequence_.store(i, std::memory_order_relaxed);
+        }
+        enqueuePos_.store(0, std::memory_order_relaxed);
+        dequeuePos_.store(0, std::memory_order_relaxed);
+    }
+
+    ~RingQueue() {
+        size_t end = enqueuePos_.load(std::memory_order_relaxed);
+        for (size_t pos = dequeuePos_.load(std::memory_order_relaxed); pos != end; ++pos) {
+            cells_[pos & mask_].elem()->~ELEM();
+        }
+    }
+
+    RingQueue(const RingQueue&)            = delete;
+    RingQueue& operator=(const RingQueue&) = delete;
+    RingQueue(RingQueue&&)                 = delete;
+    RingQueue& operator=(RingQueue&&)      = delete;
+
+    size_t maxSize() const { return mask_ + 1; }
+
+    /// Approximate when called concurrently with push/pop
+    size_t size() const {
+        size_t d = dequeuePos_.load(std::memory_order_acquire);
+        size_t e = enqueuePos_.load(std::memory_order_acquire);
+        return e > d ? e - d : 0;
+    }
+
+    bool empty() const { return size() == 0; }
+
+    void close() {
+        closed_.store(true, std::memory_order_seq_cst);
+        notEmpty_.notifyAll();
+        notFull_.notifyAll();
+    }
+
+    bool closed() const {
+        return closed_.load(std::memory_order_acquire) || interrupted_.load(std::memory_order_acquire);
+    }
+
+    bool checkInterrupt() {
+        if (interrupted_.load(std::memory_order_acquire)) {
+            std::lock_guard<std::mutex> lock(interruptMutex_);
+            std::rethrow_exception(interrupt_);
+        }
+        return true;
+    }
+
+    void interrupt(std::exception_ptr expn) {
+        {
+            std::lock_guard<std::mutex> lock(interruptMutex_);
+            interrupt_ = expn;
+        }
+        interrupted_.store(true, std::memory_order_seq_cst);
+        notEmpty_.notifyAll();
+        notFull_.notifyAll();
+    }
+
+    /// Non-blocking, returns false if the queue is full
+    template <typename... Args>
+    bool tryEmplace(Args&&... args) {
+        size_t pos;
+        Cell* cell = claim(enqueuePos_, 0, multiProducer_, pos);
+        if (!cell) {
+            return false;
+        }
+        new (cell->storage_) ELEM(std::forward<Args>(args)...);
+        cell->sequence_.store(pos + 1, std::memory_order_release);
+        notEmpty_.notifyOne();
+        return true;
+    }
+
+    bool tryPush(const ELEM& e) { return tryEmplace(e); }
+
+    /// Non-blocking, returns false if the queue is empty
+    bool tryPop(ELEM& e) {
+        size_t pos;
+        Cell* cell = claim(dequeuePos_, 1, multiConsumer_, pos);
+        if (!cell) {
+            return false;
+        }
+        ELEM* p = cell->elem();
+        e       = std::move(*p);
+        p->~ELEM();
+        cell->sequence_.store(pos + mask_ + 1, std::memory_order_release);
+        notFull_.notifyOne();
+        return true;
+    }
+
+    /// Blocks while the queue is full, returns the (approximate) size after the push
+    size_t push(const ELEM& e) { return emplace(e); }
+
+    template <typename... Args>
+    size_t emplace(Args&&... args) {
+        for (size_t i = 0;; ++i) {
+            checkInterrupt();
+            ASSERT(!closed_.load(std::memory_order_relaxed));
+            if (tryEmplace(std::forward<Args>(args)...)) {  // args are only consumed on success
+                return size();
+            }
+            if (i < spins_) {
+                std::this_thread::yield();
+                continue;
+            }
+            uint32_t key = notFull_.prepareWait();
+            if (size() < maxSize() || interrupted_.load() || closed_.load()) {
+                notFull_.cancelWait();
+                continue;
+            }
+            notFull_.wait(key);
+        }
+    }
+
+    /// Blocks while the queue is empty, returns the (approximate) size after the pop, or -1 once closed and empty
+    long pop(ELEM& e) {
+        for (size_t i = 0;; ++i) {
+            checkInterrupt();
+            if (tryPop(e)) {
+                return long(size());
+            }
+            if (closed_.load(std::memory_order_acquire) && empty()) {
+                return -1;
+            }
+            if (i < spins_) {
+                std::this_thread::yield();
+                continue;
+            }
+            uint32_t key = notEmpty_.prepareWait();
+            if (!empty() || interrupted_.load() || closed_.load()) {
+                notEmpty_.cancelWait();
+                continue;
+            }
+            notEmpty_.wait(key);
+        }
+    }
+
+    /// Pops up to elems.size() elements, blocking until at least one is available. Returns -1 once closed and empty
+    long pop(std::vector<ELEM>& elems) {
+        if (elems.empty()) {
+            return 0;
+        }
+        if (pop(elems[0]) < 0) {
+            return -1;
+        }
+        long count = 1;
+        while (size_t(count) < elems.size() && tryPop(elems[count])) {
+            count++;
+        }
+        return count;
+    }
+
+private:  // methods
+    /// Claims the cell at the current position of idx, if its sequence says it is ready (lag is 0 for producers,
+    /// 1 for consumers). Returns nullptr if the queue is full (resp. empty).
+    Cell* claim(Index& idx, size_t lag, bool shared, size_t& pos) {
+        pos = idx.load(std::memory_order_relaxed);
+        for (;;) {
+            Cell* cell   = &cells_[pos & mask_];
+            size_t seq   = cell->sequence_.load(std::memory_order_acquire);
+            intptr_t dif = intptr_t(seq) - intptr_t(pos + lag);
+            if (dif == 0) {
+                if (!shared) {
+                    idx.store(pos + 1, std::memory_order_relaxed);
+                    return cell;
+                }
+                if (idx.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    return cell;
+                }
+            }
+            else if (dif < 0) {
+                return nullptr;
+            }
+            else {
+                pos = idx.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+private:  // members
+    alignas(64) Index enqueuePos_;
+    alignas(64) Index dequeuePos_;
+
+    std::unique_ptr<Cell[]> cells_;
+    size_t mask_;
+
+    EventCount notEmpty_;
+    EventCount notFull_;
+
+    std::atomic<bool> closed_;
+    std::atomic<bool> interrupted_;
+    std::mutex interruptMutex_;
+    std::exception_ptr interrupt_;
+};
+
+template <typename ELEM>
+using SPSCRingQueue = RingQueue<ELEM, RingQueueAccess::SingleProducerSingleConsumer>;
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // namespace eckit
+
+#endif  // eckit_container_RingQueue_h
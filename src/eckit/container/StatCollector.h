@@ -38,16 +38,36 @@ struct StatCollector {
     // -- Methods
 
     void statsCall() { calls_++; }
-    void statsVisitNode() { nodes_++; }
+    void statsVisitNode() {
+        if (collecting_) {
+            nodes_++;
+        }
+    }
     void statsDepth(size_t d) {
         if (d > depth_) {
             depth_ = d;
         }
     }
 
-    void statsNewCandidateOK() { newCandidateOK_++; }
-    void statsNewCandidateMiss() { newCandidateMiss_++; }
-    void statsCrossOver() { crossOvers_++; }
+    void statsNewCandidateOK() {
+        if (collecting_) {
+            newCandidateOK_++;
+        }
+    }
+    void statsNewCandidateMiss() {
+        if (collecting_) {
+            newCandidateMiss_++;
+        }
+    }
+    void statsCrossOver() {
+        if (collecting_) {
+            crossOvers_++;
+        }
+    }
+
+    /// Searches running on several threads turn off the counters of the nodes visited, rather than share them
+    void statsCollect(bool on) { collecting_ = on; }
+
     void statsReset() { crossOvers_ = calls_ = newCandidateOK_ = newCandidateMiss_ = nodes_ = 0; }
 
     void print(std::ostream& s) const {
@@ -80,6 +100,8 @@ struct StatCollector {
     size_t newCandidateOK_;
     size_t crossOvers_;
 
+    bool collecting_ = true;
+
 
     // -- Friends
 
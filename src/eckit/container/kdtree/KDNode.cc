@@ -158,6 +158,52 @@ KDNode<Traits>* KDNode<Traits>::build(Alloc& a, const ITER& begin, const ITER& e
 }
 
 
+template <class Traits>
+template <typename ITER>
+ITER KDNode<Traits>::split(const ITER& begin, const ITER& end, int depth) {
+    size_t axis   = depth % Point::DIMS;
+    size_t median = (end - begin) / 2;
+
+    std::nth_element(begin, begin + median, end, sorter<Value>(axis));
+
+    return begin + median;
+}
+
+
+template <class Traits>
+template <typename ITER>
+void KDNode<Traits>::arrange(const ITER& begin, const ITER& end, int depth) {
+    if (end - begin < 2)
+        return;
+
+    ITER e2 = split(begin, end, depth);
+
+    arrange(begin, e2, depth + 1);
+    arrange(e2 + 1, end, depth + 1);
+}
+
+
+template <class Traits>
+template <typename ITER>
+KDNode<Traits>* KDNode<Traits>::assemble(Alloc& a, const ITER& begin, const ITER& end, int depth) {
+    if (end == begin)
+        return 0;
+
+    a.statsDepth(depth);
+
+    size_t axis = depth % Point::DIMS;
+
+    ITER e2 = begin + (end - begin) / 2;
+
+    KDNode* n = a.newNode2(*e2, axis, (KDNode*)0);
+
+    n->left(a, assemble(a, begin, e2, depth + 1));
+    n->right(a, assemble(a, e2 + 1, end, depth + 1));
+
+    return n;
+}
+
+
 template <class Traits>
 KDNode<Traits>* KDNode<Traits>::insert(Alloc& a, const Value& value, KDNode<Traits>* node, int depth) {
 
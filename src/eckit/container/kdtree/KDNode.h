@@ -42,6 +42,19 @@ public:
     template <typename ITER>
     static KDNode* build(Alloc& a, const ITER& begin, const ITER& end, int depth = 0);
 
+    /// Partitions [begin, end) around its median along the axis of this depth, as build() does.
+    /// @returns the median
+    template <typename ITER>
+    static ITER split(const ITER& begin, const ITER& end, int depth);
+
+    /// Orders [begin, end) the way build() leaves it, without creating any node
+    template <typename ITER>
+    static void arrange(const ITER& begin, const ITER& end, int depth = 0);
+
+    /// Creates the nodes for a range ordered by arrange(), giving the same tree as build()
+    template <typename ITER>
+    static KDNode* assemble(Alloc& a, const ITER& begin, const ITER& end, int depth = 0);
+
     static KDNode<Traits>* insert(Alloc& a, const Value& value, KDNode<Traits>* node, int depth = 0);
 
     /// Return the axis along which this node is split.
@@ -73,6 +73,15 @@ typename SPNode<Traits, NodeType>::NodeList SPNode<Traits, NodeType>::kNearestNe
     return result;
 }
 
+template <class Traits, class NodeType>
+void SPNode<Traits, NodeType>::kNearestNeighbours(Alloc& a, const Point& p, size_t k, NodeQueue& queue,
+                                                  NodeList& result) {
+    queue.reset(k);
+    result.clear();
+    asNode()->kNearestNeighboursX(a, p, k, queue, 0);
+    queue.fill(result);
+}
+
 template <class Traits, class NodeType>
 void SPNode<Traits, NodeType>::kNearestNeighboursBruteForceX(Alloc& a, const Point& p, size_t k, NodeQueue& result,
                                                              int depth) {
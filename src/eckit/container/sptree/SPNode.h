@@ -57,6 +57,9 @@ public:
     NodeList findInSphere(Alloc& a, const Point& p, double radius);
     NodeList kNearestNeighbours(Alloc& a, const Point& p, size_t k);
 
+    /// As above, reusing the queue and the storage of result
+    void kNearestNeighbours(Alloc& a, const Point& p, size_t k, NodeQueue& queue, NodeList& result);
+
     const Point& point() const { return value_.point(); }
     const Payload& payload() const { return value_.payload(); }
     Value& value() { return value_; }
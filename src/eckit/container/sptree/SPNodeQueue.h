@@ -52,6 +52,14 @@ public:
     SPNodeQueue(size_t k) :
         k_(k) {}
 
+    /// Empties the queue for another search, keeping its storage
+    void reset(size_t k) {
+        k_ = k;
+        while (!queue_.empty()) {
+            queue_.pop();
+        }
+    }
+
     void push(Node* n, ID id, double d) {
         NodeInfo info(n, id, d);
         queue_.push(info);
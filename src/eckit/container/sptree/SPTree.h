@@ -11,10 +11,15 @@
 #ifndef SPTree_H
 #define SPTree_H
 
+#include <algorithm>
+#include <atomic>
+#include <vector>
+
 #include "eckit/container/sptree/SPIterator.h"
 #include "eckit/container/sptree/SPMetadata.h"
 #include "eckit/container/sptree/SPNode.h"
 #include "eckit/exception/Exceptions.h"
+#include "eckit/thread/ThreadPool.h"
 
 namespace eckit {
 
@@ -93,6 +98,48 @@ public:
         return alloc_.convert(root_, (Node*)0)->kNearestNeighbours(alloc_, p, k);
     }
 
+    /// Finds the k nearest neighbours of each of the points, in result[i], on the threads of the pool.
+    /// Each worker reuses one search queue for all its points, and the storage of result is reused across calls.
+    /// Only the calls are counted in the statistics, not the nodes visited.
+    void kNearestNeighbours(const std::vector<Point>& points, size_t k, std::vector<NodeList>& result,
+                            ThreadPool& pool) {
+        if (!root_) {
+            root_ = alloc_.root();
+        }
+        ASSERT(root_);
+
+        Node* root = alloc_.convert(root_, (Node*)0);
+        result.resize(points.size());
+
+        // Workers take blocks of points in turn, so they stay busy even if unevenly fast
+        const size_t block   = 256;
+        const size_t blocks  = (points.size() + block - 1) / block;
+        const size_t workers = std::min(blocks, pool.size() + 1);  // the calling thread takes part
+        std::atomic<size_t> next(0);
+
+        alloc_.statsCollect(false);
+        try {
+            pool.parallel_for(
+                0, workers,
+                [this, root, k, block, blocks, &next, &points, &result](size_t) {
+                    typename Node::NodeQueue queue(k);
+                    for (size_t b = next++; b < blocks; b = next++) {
+                        size_t end = std::min(points.size(), (b + 1) * block);
+                        for (size_t i = b * block; i < end; ++i) {
+                            root->kNearestNeighbours(alloc_, points[i], k, queue, result[i]);
+                        }
+                    }
+                },
+                1);
+        }
+        catch (...) {
+            alloc_.statsCollect(true);
+            throw;
+        }
+        alloc_.statsCollect(true);
+        alloc_.calls_ += points.size();
+    }
+
     // For testing only...
     NodeInfo nearestNeighbourBruteForce(const Point& p) {
         if (!root_) {
@@ -0,0 +1,666 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+
+#include <fcntl.h>
+#include <pthread.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <ctime>
+#include <new>
+#include <sstream>
+
+#include "eckit/config/LibEcKit.h"
+#include "eckit/exception/Exceptions.h"
+#include "eckit/log/Bytes.h"
+#include "eckit/log/Log.h"
+#include "eckit/log/Plural.h"
+#include "eckit/log/TimeStamp.h"
+#include "eckit/maths/Functions.h"
+#include "eckit/memory/MMap.h"
+#include "eckit/option/CmdArgs.h"
+#include "eckit/os/Stat.h"
+#include "eckit/runtime/Main.h"
+
+#include "eckit/distributed/Actor.h"
+#include "eckit/distributed/Message.h"
+#include "eckit/distributed/shm/SharedMemoryTransport.h"
+
+using namespace eckit;
+
+namespace eckit::distributed {
+
+//----------------------------------------------------------------------------------------------------------------------
+
+namespace shm {
+
+constexpr uint32_t version = 1;
+
+constexpr size_t max_workers = 256;
+
+enum SlotState : uint32_t
+{
+    FREE,
+    WRITING,
+    READY,
+    READING
+};
+
+/// Followed by the payload
+struct Slot {
+    uint32_t state_;
+    int32_t tag_;
+    pid_t owner_;  // process writing or reading the slot
+    int32_t source_;
+    uint64_t size_;
+};
+
+// Slot headers are padded to a cache line
+constexpr size_t slot_header = 64;
+static_assert(sizeof(Slot) <= slot_header, "shm::Slot too large");
+
+/// Written by any process, read by any process: head_ and tail_ are only moved with the segment mutex held,
+/// the payloads are copied without it
+struct Ring {
+    pthread_cond_t notEmpty_;
+    pthread_cond_t notFull_;
+    uint64_t head_;    // next slot to read
+    uint64_t tail_;    // next slot to write
+    uint64_t slots_;
+    uint64_t offset_;  // of the first slot from the start of the segment
+};
+
+struct Segment {
+    std::atomic<uint32_t> ready_;
+    uint32_t version_;
+    uint64_t length_;
+    uint64_t slotSize_;
+
+    pthread_mutex_t mutex_;
+    pthread_cond_t attached_;
+
+    pid_t producer_;
+    uint32_t aborted_;
+    uint32_t workers_;         // attached so far
+    pid_t pids_[max_workers];  // 0 once finished
+
+    Ring work_;     // producer to workers
+    Ring results_;  // workers to producer
+};
+
+}  // namespace shm
+
+using namespace shm;
+
+namespace {
+
+size_t stride(const Segment& segment) {
+    return slot_header + segment.slotSize_;
+}
+
+Slot& slot(Segment& segment, Ring& ring, uint64_t n) {
+    char* base = reinterpret_cast<char*>(&segment) + ring.offset_;
+    return *reinterpret_cast<Slot*>(base + (n % ring.slots_) * stride(segment));
+}
+
+char* payload(Slot& s) {
+    return reinterpret_cast<char*>(&s) + slot_header;
+}
+
+bool alive(pid_t pid) {
+    return pid != 0 && (::kill(pid, 0) == 0 || errno != ESRCH);
+}
+
+/// @returns whether any of the workers attached so far is still running
+bool workersAlive(const Segment& segment) {
+    for (uint32_t i = 0; i < segment.workers_; ++i) {
+        if (alive(segment.pids_[i])) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/// Undoes what a process that died holding the mutex left half done: each section under the mutex changes a single
+/// field, except claiming a slot, which sets its state before moving the head or tail of the ring
+void recover(Segment& segment, Ring& ring) {
+    Slot& writing = slot(segment, ring, ring.tail_);
+    if (ring.tail_ - ring.head_ < ring.slots_ && writing.state_ == WRITING && !alive(writing.owner_)) {
+        writing.state_ = FREE;
+    }
+
+    Slot& reading = slot(segment, ring, ring.head_);
+    if (ring.tail_ > ring.head_ && reading.state_ == READING && !alive(reading.owner_)) {
+        // The message is lost with its reader
+        reading.state_ = FREE;
+        ring.head_++;
+    }
+
+    THRCALL(::pthread_cond_broadcast(&ring.notEmpty_));
+    THRCALL(::pthread_cond_broadcast(&ring.notFull_));
+}
+
+/// The mutex is robust: when its owner dies, the next process to lock it gets EOWNERDEAD and repairs the segment
+void recovered(Segment& segment, int e) {
+    if (e == EOWNERDEAD) {
+        Log::error() << "SharedMemoryTransport: a process died holding the segment lock, recovering" << std::endl;
+        recover(segment, segment.work_);
+        recover(segment, segment.results_);
+        e = ::pthread_mutex_consistent(&segment.mutex_);
+    }
+    THRCALL(e);
+}
+
+class AutoSegmentLock {
+    Segment& segment_;
+
+public:
+    explicit AutoSegmentLock(Segment& segment) : segment_(segment) {
+        recovered(segment_, ::pthread_mutex_lock(&segment_.mutex_));
+    }
+    ~AutoSegmentLock() { THRCALL(::pthread_mutex_unlock(&segment_.mutex_)); }
+};
+
+/// @returns false on timeout
+bool wait(pthread_cond_t& cond, Segment& segment, int seconds) {
+    ::timespec ts;
+    ::clock_gettime(CLOCK_REALTIME, &ts);
+    ts.tv_sec += seconds;
+
+    int e = ::pthread_cond_timedwait(&cond, &segment.mutex_, &ts);
+    if (e == ETIMEDOUT) {
+        return false;
+    }
+    recovered(segment, e);
+    return true;
+}
+
+void initialiseCond(pthread_cond_t& cond) {
+    pthread_condattr_t attr;
+    THRCALL(::pthread_condattr_init(&attr));
+    THRCALL(::pthread_condattr_setpshared(&attr, PTHREAD_PROCESS_SHARED));
+    THRCALL(::pthread_cond_init(&cond, &attr));
+    THRCALL(::pthread_condattr_destroy(&attr));
+}
+
+void initialiseRing(Segment& segment, Ring& ring, uint64_t slots, uint64_t offset) {
+    initialiseCond(ring.notEmpty_);
+    initialiseCond(ring.notFull_);
+    ring.head_   = 0;
+    ring.tail_   = 0;
+    ring.slots_  = slots;
+    ring.offset_ = offset;
+
+    for (uint64_t i = 0; i < slots; ++i) {
+        slot(segment, ring, i).state_ = FREE;
+    }
+}
+
+}  // namespace
+
+//----------------------------------------------------------------------------------------------------------------------
+
+SharedMemoryTransport::SharedMemoryTransport(const option::CmdArgs &args):
+    Transport(args),
+    segment_(nullptr),
+    length_(0),
+    worker_(false),
+    index_(-1) {
+
+    std::ostringstream oss;
+    oss << "/eckit-distributed-" << ::getuid();
+    name_ = oss.str();
+    args.get("shm", name_);
+
+    args.get("worker", worker_);
+
+    std::string hostname = Main::hostname();
+
+    std::ostringstream title;
+    if (worker_) {
+        attach();
+        title << "Consumer-" << ::getpid() << "@" << hostname;
+    }
+    else {
+        size_t slots    = 32;
+        size_t slotSize = 1024 * 1024;
+        args.get("slots", slots);
+        args.get("slot-size", slotSize);
+        create(slots, slotSize);
+        title << "Producer-" << ::getpid() << "@" << hostname;
+    }
+
+    title_ = title.str();
+
+    std::ostringstream oid;
+    oid << hostname << "@" << ::getpid();
+    id_ = oid.str();
+}
+
+SharedMemoryTransport::~SharedMemoryTransport() {
+    if (segment_) {
+        MMap::munmap(segment_, length_);
+    }
+    if (!worker_) {
+        ::shm_unlink(name_.c_str());
+    }
+}
+
+void SharedMemoryTransport::create(size_t slots, size_t slotSize) {
+    ASSERT(slots > 0);
+
+    // Left over by a producer that did not exit cleanly, unless that producer is still running
+    int fd = ::shm_open(name_.c_str(), O_RDWR, 0);
+    if (fd >= 0) {
+        pid_t producer = 0;
+
+        Stat::Struct s;
+        if (Stat::fstat(fd, &s) == 0 && size_t(s.st_size) >= sizeof(Segment)) {
+            void* map = MMap::mmap(nullptr, sizeof(Segment), PROT_READ, MAP_SHARED, fd, 0);
+            if (map != MAP_FAILED) {
+                const Segment* existing = reinterpret_cast<const Segment*>(map);
+                if (existing->ready_.load(std::memory_order_acquire)) {
+                    producer = existing->producer_;
+                }
+                MMap::munmap(map, sizeof(Segment));
+            }
+        }
+        ::close(fd);
+
+        if (alive(producer)) {
+            std::ostringstream oss;
+            oss << "SharedMemoryTransport: " << name_ << " is used by producer process " << producer
+                << ", see option --shm";
+            throw UserError(oss.str());
+        }
+
+        ::shm_unlink(name_.c_str());
+    }
+
+    fd = ::shm_open(name_.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+    if (fd < 0) {
+        Log::error() << "shm_open(" << name_ << ')' << Log::syserr << std::endl;
+        throw FailedSystemCall("shm_open", Here());
+    }
+
+    slotSize = eckit::round(slotSize, slot_header);
+
+    // The results are only the statistics sent by the workers when they finish
+    size_t resultSlots = 4;
+
+    size_t header = eckit::round(sizeof(Segment), 4096);
+    length_       = header + (slots + resultSlots) * (slot_header + slotSize);
+
+    if (::ftruncate(fd, off_t(length_)) < 0) {
+        ::close(fd);
+        throw FailedSystemCall("ftruncate", Here());
+    }
+
+    void* map = MMap::mmap(nullptr, length_, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (map == MAP_FAILED) {
+        Log::error() << "SharedMemoryTransport name=" << name_ << " size=" << Bytes(length_) << " fails to mmap"
+                     << Log::syserr << std::endl;
+        throw FailedSystemCall("mmap", Here());
+    }
+
+    segment_ = new (map) Segment();
+    segment_->ready_    = 0;
+    segment_->version_  = shm::version;
+    segment_->length_   = length_;
+    segment_->slotSize_ = slotSize;
+
+    pthread_mutexattr_t attr;
+    THRCALL(::pthread_mutexattr_init(&attr));
+    THRCALL(::pthread_mutexattr_setpshared(&attr, PTHREAD_PROCESS_SHARED));
+    THRCALL(::pthread_mutexattr_setrobust(&attr, PTHREAD_MUTEX_ROBUST));
+    THRCALL(::pthread_mutex_init(&segment_->mutex_, &attr));
+    THRCALL(::pthread_mutexattr_destroy(&attr));
+
+    initialiseCond(segment_->attached_);
+
+    segment_->producer_ = ::getpid();
+    segment_->aborted_  = 0;
+    segment_->workers_  = 0;
+    std::fill(segment_->pids_, segment_->pids_ + max_workers, 0);
+
+    initialiseRing(*segment_, segment_->work_, slots, header);
+    initialiseRing(*segment_, segment_->results_, resultSlots, header + slots * stride(*segment_));
+
+    segment_->ready_.store(1, std::memory_order_release);
+
+    LOG_DEBUG_LIB(LibEcKit) << "SharedMemoryTransport created " << name_ << ", " << Plural(slots, "slot") << " of "
+                            << Bytes(slotSize) << std::endl;
+}
+
+void SharedMemoryTransport::attach() {
+
+    // The producer may not have started yet
+
+    int fd = -1;
+    for (int i = 0; i < 600; ++i) {
+        if ((fd = ::shm_open(name_.c_str(), O_RDWR, 0)) >= 0) {
+            Stat::Struct s;
+            SYSCALL(Stat::fstat(fd, &s));
+            if (size_t(s.st_size) >= sizeof(Segment)) {
+                length_ = size_t(s.st_size);
+                break;
+            }
+            ::close(fd);
+            fd = -1;
+        }
+        ::usleep(100 * 1000);
+    }
+
+    if (fd < 0) {
+        Log::error() << "shm_open(" << name_ << ')' << Log::syserr << std::endl;
+        throw FailedSystemCall("shm_open", Here());
+    }
+
+    void* map = MMap::mmap(nullptr, length_, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (map == MAP_FAILED) {
+        throw FailedSystemCall("mmap", Here());
+    }
+
+    segment_ = reinterpret_cast<Segment*>(map);
+    while (segment_->ready_.load(std::memory_order_acquire) == 0) {
+        ::usleep(1000);
+    }
+
+    ASSERT(segment_->version_ == shm::version);
+    ASSERT(segment_->length_ == length_);
+
+    AutoSegmentLock lock(*segment_);
+
+    if (segment_->aborted_) {
+        throw SeriousBug("SharedMemoryTransport: producer has aborted");
+    }
+
+    ASSERT_MSG(segment_->workers_ < max_workers, "SharedMemoryTransport: too many workers");
+    // Recorded before it is counted, see recover()
+    index_ = int(segment_->workers_);
+    segment_->pids_[index_] = ::getpid();
+    segment_->workers_++;
+
+    THRCALL(::pthread_cond_broadcast(&segment_->attached_));
+}
+
+void SharedMemoryTransport::push(Ring& ring, int tag, const void* data, size_t size) {
+
+    if (size > segment_->slotSize_) {
+        std::ostringstream oss;
+        oss << "SharedMemoryTransport: message of " << Bytes(size) << " larger than the slots of "
+            << Bytes(segment_->slotSize_) << ", see option --slot-size";
+        throw BadValue(oss.str());
+    }
+
+    Slot* s;
+
+    {
+        AutoSegmentLock lock(*segment_);
+        for (size_t waited = 1;; ++waited) {
+            if (segment_->aborted_) {
+                throw SeriousBug("SharedMemoryTransport: aborted");
+            }
+
+            s = &slot(*segment_, ring, ring.tail_);
+            if (s->state_ == FREE) {
+                break;
+            }
+
+            if (!wait(ring.notFull_, *segment_, 1)) {
+                // Its reader has gone, the message is lost
+                if (s->state_ == READING && !alive(s->owner_)) {
+                    Log::error() << TimeStamp() << " " << title() << ", lost message read by process "
+                                 << s->owner_ << std::endl;
+                    s->state_ = FREE;
+                }
+
+                // Nobody is left to read the ring
+                if (worker_ && !alive(segment_->producer_)) {
+                    throw SeriousBug("SharedMemoryTransport: producer has gone");
+                }
+                if (!worker_ && !workersAlive(*segment_)) {
+                    throw SeriousBug("SharedMemoryTransport: no more workers");
+                }
+
+                if (waited % 30 == 0) {
+                    Log::info() << TimeStamp() << " " << title() << ", waiting for a free slot" << std::endl;
+                }
+            }
+        }
+
+        s->state_ = WRITING;
+        s->owner_ = ::getpid();
+        ring.tail_++;
+    }
+
+    ::memcpy(payload(*s), data, size);
+    s->tag_    = tag;
+    s->source_ = index_;
+    s->size_   = size;
+
+    {
+        AutoSegmentLock lock(*segment_);
+        s->state_ = READY;
+        THRCALL(::pthread_cond_signal(&ring.notEmpty_));
+    }
+}
+
+bool SharedMemoryTransport::pop(Ring& ring, Message& message, int timeout) {
+
+    Slot* s;
+
+    {
+        AutoSegmentLock lock(*segment_);
+        for (;;) {
+            if (segment_->aborted_) {
+                throw SeriousBug("SharedMemoryTransport: aborted");
+            }
+
+            s = &slot(*segment_, ring, ring.head_);
+            if (s->state_ == READY) {
+                break;
+            }
+
+            if (!wait(ring.notEmpty_, *segment_, timeout)) {
+                if (s->state_ == WRITING && !alive(s->owner_)) {
+                    // Its writer has gone, skip it
+                    s->state_ = FREE;
+                    ring.head_++;
+                    THRCALL(::pthread_cond_broadcast(&ring.notFull_));
+                    continue;
+                }
+
+                if (worker_ && !alive(segment_->producer_)) {
+                    throw SeriousBug("SharedMemoryTransport: producer has gone");
+                }
+
+                return false;
+            }
+        }
+
+        s->state_ = READING;
+        s->owner_ = ::getpid();
+        ring.head_++;
+    }
+
+    int tag    = s->tag_;
+    int source = s->source_;
+    size_t size = s->size_;
+
+    message.reserve(size);
+    ::memcpy(message.messageData(), payload(*s), size);
+
+    {
+        AutoSegmentLock lock(*segment_);
+        s->state_ = FREE;
+        THRCALL(::pthread_cond_broadcast(&ring.notFull_));
+    }
+
+    message.rewind();
+    message.messageReceived(tag, source);
+
+    return true;
+}
+
+bool SharedMemoryTransport::single() const {
+    return false;
+}
+
+bool SharedMemoryTransport::producer() const {
+    return !worker_;
+}
+
+bool SharedMemoryTransport::writer() const {
+    return false;
+}
+
+void SharedMemoryTransport::initialise() {
+    if (worker_) {
+        return;
+    }
+
+    AutoSegmentLock lock(*segment_);
+    while (segment_->workers_ == 0) {
+        if (!wait(segment_->attached_, *segment_, 30)) {
+            Log::info() << TimeStamp() << " " << title() << ", waiting for a worker on " << name_ << std::endl;
+        }
+    }
+}
+
+void SharedMemoryTransport::synchronise() {
+}
+
+void SharedMemoryTransport::abort() {
+    AutoSegmentLock lock(*segment_);
+    segment_->aborted_ = 1;
+    for (Ring* ring : {&segment_->work_, &segment_->results_}) {
+        THRCALL(::pthread_cond_broadcast(&ring->notEmpty_));
+        THRCALL(::pthread_cond_broadcast(&ring->notFull_));
+    }
+}
+
+void SharedMemoryTransport::sendMessageToNextWorker(const Message &message) {
+    push(segment_->work_, message.tag(), message.messageData(), message.messageSize());
+    statistics_.sendCount_++;
+    statistics_.sendSize_ += message.messageSize();
+}
+
+void SharedMemoryTransport::getNextWorkMessage(Message &message) {
+    while (!pop(segment_->work_, message, 30)) {
+        ;
+    }
+
+    ASSERT(message.tag() == Actor::WORK || message.tag() == Actor::SHUTDOWN);
+
+    LOG_DEBUG_LIB(LibEcKit) << TimeStamp() << " " << title() << " SharedMemoryTransport::getNextWorkMessage got "
+                            << Actor::tagName(message.tag()) << std::endl;
+
+    if (message.tag() == Actor::WORK) {
+        statistics_.receiveCount_++;
+    }
+}
+
+void SharedMemoryTransport::sendStatisticsToProducer(const Message &message) {
+    push(segment_->results_, Actor::STATISTICS, message.messageData(), message.messageSize());
+}
+
+bool SharedMemoryTransport::finish(size_t worker) {
+    // Called with the segment lock held
+    bool active = segment_->pids_[worker] != 0;
+    segment_->pids_[worker] = 0;
+    return active;
+}
+
+void SharedMemoryTransport::sendShutDownMessage(const Actor& actor) {
+
+    // SHUTDOWN is queued after the work, once for each worker, including those attaching meanwhile
+
+    size_t sent     = 0;
+    size_t finished = 0;
+
+    for (;;) {
+        size_t workers;
+        {
+            AutoSegmentLock lock(*segment_);
+            workers = segment_->workers_;
+        }
+
+        if (finished == workers) {
+            break;
+        }
+
+        for (; sent < workers; ++sent) {
+            push(segment_->work_, Actor::SHUTDOWN, nullptr, 0);
+        }
+
+        Message message;
+        if (pop(segment_->results_, message, 1)) {
+            ASSERT(message.tag() == Actor::STATISTICS);
+            bool counted;
+            {
+                AutoSegmentLock lock(*segment_);
+                counted = finish(message.source());
+            }
+            if (counted) {
+                actor.messageFromWorker(message, message.source());
+                finished++;
+            }
+            continue;
+        }
+
+        // Count the workers that died without sending their statistics. The statistics of a worker that exits
+        // after sending them are still queued, so the results are read first
+        AutoSegmentLock lock(*segment_);
+        if (segment_->results_.tail_ != segment_->results_.head_) {
+            continue;
+        }
+
+        for (size_t i = 0; i < workers; ++i) {
+            pid_t pid = segment_->pids_[i];
+            if (pid && !alive(pid) && finish(i)) {
+                Log::error() << TimeStamp() << " " << title() << ", lost worker " << i << " (process " << pid << ")"
+                             << std::endl;
+                finished++;
+            }
+        }
+
+        Log::info() << TimeStamp() << " " << title() << ", waiting... " << Plural(workers - finished, "worker")
+                    << " still active" << std::endl;
+    }
+}
+
+void SharedMemoryTransport::sendToWriter(size_t writer, const Message &message) {
+    NOTIMP;
+}
+
+void SharedMemoryTransport::getNextWriteMessage(Message &message) {
+    NOTIMP;
+}
+
+void SharedMemoryTransport::print(std::ostream &out) const {
+    out << "SharedMemoryTransport[" << name_ << "]";
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+static TransportBuilder<SharedMemoryTransport> builder("shm");
+
+
+} // namespace eckit::distributed
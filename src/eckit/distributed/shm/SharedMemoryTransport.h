@@ -0,0 +1,95 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+/// @file   SharedMemoryTransport.h
+/// @date   October 2026
+
+#ifndef eckit_SharedMemoryTransport_H
+#define eckit_SharedMemoryTransport_H
+
+#include <string>
+
+#include "eckit/distributed/Transport.h"
+
+namespace eckit::option {
+class Option;
+class CmdArgs;
+}
+
+namespace eckit::distributed {
+
+class Message;
+
+namespace shm {
+struct Segment;
+struct Ring;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/// Producer and workers running on the same host, exchanging messages through rings of slots in a POSIX shared
+/// memory segment. Payloads are copied into and out of the slots directly, without going through the kernel.
+///
+/// The producer creates the segment (option --shm, /eckit-distributed-<uid> by default) with --slots slots of
+/// --slot-size bytes (32 slots of 1 MiB by default), the workers are started with --worker and attach to it.
+/// A segment left over by a producer that has exited is replaced, that of a producer still running is not.
+/// Workers all take the next message from the same ring, so the least busy one gets it.
+
+class SharedMemoryTransport : public Transport {
+public: // methods
+
+    SharedMemoryTransport(const eckit::option::CmdArgs &args);
+    virtual ~SharedMemoryTransport() override;
+
+protected: // methods
+
+    virtual void sendMessageToNextWorker(const Message &message) override;
+    virtual void getNextWorkMessage(Message &message) override;
+    virtual void sendStatisticsToProducer(const Message &message) override;
+    virtual void sendShutDownMessage(const Actor&) override;
+
+    virtual bool producer() const override;
+    virtual bool single() const override;
+    virtual void initialise() override;
+    virtual void abort() override;
+    virtual void synchronise() override;
+    virtual bool writer() const override;
+    virtual void sendToWriter(size_t writer, const Message &message) override;
+    virtual void getNextWriteMessage(Message &message) override;
+
+    void print(std::ostream& out) const override;
+
+private: // methods
+
+    void create(size_t slots, size_t slotSize);
+    void attach();
+
+    void push(shm::Ring&, int tag, const void* data, size_t size);
+    bool pop(shm::Ring&, Message&, int timeout);
+
+    /// @returns true the first time a worker is marked as finished
+    bool finish(size_t worker);
+
+private: // members
+
+    std::string name_;
+    shm::Segment* segment_;
+    size_t length_;
+
+    bool worker_;
+    int index_;  // of the worker
+
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+
+} // namespace eckit::distributed
+
+#endif
@@ -11,6 +11,7 @@
 
 #include <unistd.h>
 
+#include "eckit/config/LibEcKit.h"
 #include "eckit/log/Log.h"
 #include "eckit/log/Seconds.h"
 #include "eckit/log/Plural.h"
@@ -36,12 +37,24 @@ namespace eckit::distributed {
 
 //----------------------------------------------------------------------------------------------------------------------
 
+namespace {
+
+// Size of the frames messages are combined into
+constexpr size_t frame_size = 64 * 1024;
+
+}  // namespace
+
 class Connection : public InstantTCPStream {
     Select& select_;
     TCPSocket socket_;
     size_t id_;
     bool active_;
 
+    // Producer side
+    size_t window_;   // slots advertised by the worker
+    size_t credits_;  // free slots
+    size_t pending_;  // messages not written out yet
+
 private:
 
     TCPSocket& socket() { return socket_; }
@@ -52,8 +65,12 @@ public:
         select_(select),
         socket_(socket),
         id_(id),
-        active_(true) {
+        active_(true),
+        window_(0),
+        credits_(0),
+        pending_(0) {
         select_.add(socket_);
+        writeBufferSize(frame_size);
     }
 
     ~Connection() {
@@ -68,6 +85,14 @@ public:
 
     void disconnect() {
         active_ = false;
+
+        // Nothing must be left to write once the socket is closed
+        try {
+            flush();
+        }
+        catch (std::exception&) {
+        }
+
         select_.remove(socket_);
         socket_.close();
     }
@@ -83,6 +108,56 @@ public:
     int remotePort() {
         return socket_.remotePort();
     }
+
+    size_t window() const { return window_; }
+
+    size_t credits() const { return credits_; }
+
+    size_t pending() const { return pending_; }
+
+    /// Messages the worker has received but not consumed yet, as far as we know
+    size_t queued() const { return window_ - credits_ - pending_; }
+
+    void receiveCredits() {
+        size_t tag;
+        size_t count;
+        (*this) >> tag;
+        ASSERT(tag == Actor::READY);
+        (*this) >> count;
+
+        if (window_ == 0) {
+            window_ = count;
+        }
+        credits_ += count;
+        ASSERT(credits_ <= window_);
+    }
+
+    void send(const Message& message) {
+        ASSERT(credits_ > 0);
+
+        (*this) << size_t(message.tag());
+        (*this) << message.messageSize();
+        writeBlob(message.messageData(), message.messageSize());
+
+        credits_--;
+
+        // A payload the size of the buffer is written straight out, after what was buffered before it
+        if (message.messageSize() < frame_size) {
+            pending_++;
+        }
+    }
+
+    void flushMessages() {
+        pending_ = 0;
+        flush();
+    }
+
+    // Every flush of the stream ends up here, including those done by Stream::readBytes() before reading credits,
+    // and writes out the messages sent so far
+    long write(const void* buf, long len) override {
+        pending_ = 0;
+        return InstantTCPStream::write(buf, len);
+    }
 };
 
 TCPTransport::TCPTransport(const option::CmdArgs &args):
@@ -90,12 +165,21 @@ TCPTransport::TCPTransport(const option::CmdArgs &args):
     nextId_(0),
     master_(false),
     worker_(false),
-    writer_(false) {
+    writer_(false),
+    credits_(16),
+    batch_(8),
+    consumed_(0),
+    started_(false) {
 
 
     size_t port = 7777;
     args.get("port", port);
 
+    args.get("credits", credits_);
+    args.get("batch", batch_);
+    ASSERT(credits_ > 0);
+    ASSERT(batch_ > 0);
+
     std::string hostname = Main::hostname();
 
     std::ostringstream oss;
@@ -105,6 +189,7 @@ TCPTransport::TCPTransport(const option::CmdArgs &args):
         // We are a consumer
         TCPClient client;
         producer_.reset(new Connection(select_, client.connect(host, port, 10, 60)));
+        producer_->readBufferSize(frame_size);
         oss << "Consumer-" << ::getpid() << "@" << hostname;
 
     } else {
@@ -156,14 +241,24 @@ void TCPTransport::sendMessageToNextWorker(const Message &message) {
 }
 
 
-bool TCPTransport::send(const Message &message) {
+Connection* TCPTransport::nextWorker() const {
+    // The worker with the most free slots, which is the least busy one
+    Connection* next = nullptr;
+    for (auto j = connections_.begin(); j != connections_.end(); ++j) {
+        Connection* connection = *j;
+        if (connection->active() && connection->credits() > 0) {
+            if (!next || connection->credits() > next->credits()) {
+                next = connection;
+            }
+        }
+    }
+    return next;
+}
 
-    cleanup();
 
-    bool more = true;
-    while (more) {
-        more = false;
+void TCPTransport::receiveCredits(bool wait) {
 
+    if (wait) {
         while (!select_.ready(30)) {
             Log::info() <<  TimeStamp()
                       << " "
@@ -173,47 +268,85 @@ bool TCPTransport::send(const Message &message) {
                       << " still active"
                       << std::endl;
         }
+    }
+    else if (!select_.ready(0)) {
+        return;
+    }
 
-        if (select_.set(*accept_)) {
-            accept();
-            more = true;
-        }
+    if (select_.set(*accept_)) {
+        accept();
     }
 
-    for (auto j = connections_.rbegin(); j != connections_.rend(); ++j) {
+    for (auto j = connections_.begin(); j != connections_.end(); ++j) {
         Connection &connection = **j;
         if (connection.ready()) {
             try {
+                connection.receiveCredits();
+            } catch (std::exception &e) {
+                disconnect(e, connection);
+            }
+        }
+    }
+}
 
-                size_t tag;
-                connection >> tag;
 
-                ASSERT(tag == Actor::READY);
+void TCPTransport::flush() {
+    for (auto j = connections_.begin(); j != connections_.end(); ++j) {
+        Connection &connection = **j;
+        if (connection.active() && connection.pending()) {
+            try {
+                connection.flushMessages();
+            } catch (std::exception &e) {
+                disconnect(e, connection);
+            }
+        }
+    }
+}
 
-                // Log::info() << TimeStamp()
-                //           << " "
-                //           << title()
-                //           << " sending to worker "
-                //           << connection.id()
-                //           << " tag " << message.tag()
-                //           << std::endl;
 
-                connection << size_t(message.tag());
-                connection << message.messageSize();
-                connection.writeBlob(message.messageData(), message.messageSize());
+bool TCPTransport::send(const Message &message) {
 
-                // Next time, we consider other connections first
-                std::swap(*j, connections_[0]);
+    cleanup();
 
-                return true;
+    receiveCredits(false);
 
-            } catch (std::exception &e) {
-                disconnect(e, connection);
-                continue;
-            }
+    Connection* connection;
+    while ((connection = nextWorker()) == nullptr) {
+        // Every worker is busy, they may be waiting for what we have not written out yet
+        flush();
+        cleanup();
+        if (connections_.empty()) {
+            return false;
         }
+        receiveCredits(true);
+    }
+
+    try {
+
+        LOG_DEBUG_LIB(LibEcKit) << TimeStamp()
+                                << " "
+                                << title()
+                                << " sending to worker "
+                                << connection->id()
+                                << " tag " << message.tag()
+                                << std::endl;
+
+        connection->send(message);
+
+        // Write out the frame when full, or if the worker could run out of work before the next one
+        if (connection->pending() >= batch_ || connection->queued() <= connection->window() / 2) {
+            connection->flushMessages();
+        }
+
+        statistics_.sendCount_++;
+        statistics_.sendSize_ += message.messageSize();
+
+        return true;
+
+    } catch (std::exception &e) {
+        disconnect(e, *connection);
+        return false;
     }
-    return false;
 }
 
 
@@ -250,21 +383,30 @@ void TCPTransport::getNextWorkMessage(Message &message) {
 
     auto& connection = producerConnection();
 
-    Log::info() << TimeStamp()
-              << " "
-              << title()
-              << " TCPTransport::getNextWorkMessage -> send"
-              << std::endl;
+    // Advertise our slots, then give them back in groups as the messages are consumed
 
-    connection << size_t(Actor::READY);
+    if (!started_) {
+        connection << size_t(Actor::READY);
+        connection << credits_;
+        connection.flush();
+        started_ = true;
+    }
+    else if (++consumed_ >= (credits_ + 1) / 2) {
+        connection << size_t(Actor::READY);
+        connection << consumed_;
+        connection.flush();
+        consumed_ = 0;
+    }
 
     size_t tag;
     connection >> tag;
-    Log::info() << TimeStamp()
-              << " "
-              << title()
-              << " TCPTransport::getNextWorkMessage got reply"
-              << std::endl;
+
+    LOG_DEBUG_LIB(LibEcKit) << TimeStamp()
+                            << " "
+                            << title()
+                            << " TCPTransport::getNextWorkMessage got "
+                            << Actor::tagName(tag)
+                            << std::endl;
 
     size_t size;
 
@@ -274,6 +416,8 @@ void TCPTransport::getNextWorkMessage(Message &message) {
         connection >> size;
         ASSERT(size <= message.bufferSize());
         connection.readBlob(message.messageData(), size);
+        statistics_.receiveCount_++;
+        statistics_.receiveSize_ += size;
         break;
 
     case Actor::SHUTDOWN:
@@ -296,6 +440,7 @@ void TCPTransport::sendStatisticsToProducer(const Message &message) {
     connection << size_t(Actor::STATISTICS);
     connection << message.messageSize();
     connection.writeBlob(message.messageData(), message.messageSize());
+    connection.flush();
 
 
     // Close connection to producer
@@ -399,36 +544,39 @@ void TCPTransport::sendShutDownMessage(const Actor& actor) {
 
     select_.remove(*accept_);
 
-    while (connections_.size()) {
-
-        bool more = true;
-        while (more) {
-            more = false;
-
-            while (!select_.ready(30)) {
-                Log::info() <<  TimeStamp()
-                          << " "
-                          << title()
-                          << ", waiting... "
-                          << Plural(connections_.size(), "worker")
-                          << " still active"
-                          << std::endl;
-            }
+    // Queued after the work already sent, workers stop once they have consumed it
 
-            // if (select_.set(*accept_)) {
-            //     accept();
-            //     more = true;
-            // }
+    for (auto j = connections_.begin(); j != connections_.end(); ++j) {
+        Connection &connection = **j;
+        try {
+            Log::info() << TimeStamp()
+                      << " "
+                      << title()
+                      << " shutdown worker "
+                      << connection.id()
+                      << std::endl;
+            connection << size_t(Actor::SHUTDOWN);
+            connection.flushMessages();
+        } catch (std::exception &e) {
+            disconnect(e, connection);
         }
+    }
 
-        Log::info() << TimeStamp()
-                  << " "
-                  << title()
-                  << " "
-                  << Plural(connections_.size(), "worker")
-                  << " remaining"
-                  << std::endl;
+    cleanup();
+
+    while (connections_.size()) {
 
+        bool finished = false;
+
+        while (!select_.ready(30)) {
+            Log::info() <<  TimeStamp()
+                      << " "
+                      << title()
+                      << ", waiting... "
+                      << Plural(connections_.size(), "worker")
+                      << " still active"
+                      << std::endl;
+        }
 
         for (auto j = connections_.begin(); j != connections_.end(); ++j) {
             Connection &connection = **j;
@@ -445,13 +593,8 @@ void TCPTransport::sendShutDownMessage(const Actor& actor) {
                     switch (tag) {
 
                     case Actor::READY:
-                        Log::info() << TimeStamp()
-                                  << " "
-                                  << title()
-                                  << " shutdown worker "
-                                  << connection.id()
-                                  << std::endl;
-                        connection << size_t(Actor::SHUTDOWN);
+                        // Slots given back, no more work to send
+                        connection >> size;
                         break;
 
                     case Actor::STATISTICS:
@@ -461,6 +604,7 @@ void TCPTransport::sendShutDownMessage(const Actor& actor) {
                         connection.readBlob(message.messageData(), size);
                         actor.messageFromWorker(message, connection.id());
                         disconnect(connection);
+                        finished = true;
                         break;
 
                     default:
@@ -475,6 +619,16 @@ void TCPTransport::sendShutDownMessage(const Actor& actor) {
         }
 
         cleanup();
+
+        if (finished) {
+            Log::info() << TimeStamp()
+                      << " "
+                      << title()
+                      << " "
+                      << Plural(connections_.size(), "worker")
+                      << " remaining"
+                      << std::endl;
+        }
     }
 }
 //----------------------------------------------------------------------------------------------------------------------
@@ -41,6 +41,13 @@ class Message;
 
 class Connection;
 
+/// Producer and workers connected with TCP.
+///
+/// Flow control is credit based: each worker advertises a number of slots (option --credits, 16 by default) and
+/// gives them back as it consumes the messages, the producer streams messages ahead to the workers with free slots.
+/// Consecutive messages to the same worker are combined into one write (up to --batch messages, 8 by default), as
+/// long as the worker has enough work queued not to wait for them.
+
 class TCPTransport : public Transport {
 public: // methods
 
@@ -86,6 +93,10 @@ private: // members
     bool send(const Message &message);
     void cleanup();
 
+    Connection* nextWorker() const;
+    void receiveCredits(bool wait);
+    void flush();
+
     mutable std::unique_ptr<Connection> producer_;
 
     mutable std::unique_ptr<eckit::net::TCPServer> accept_;
@@ -100,6 +111,13 @@ private: // members
     bool worker_;
     bool writer_;
 
+    size_t credits_;
+    size_t batch_;
+
+    // Worker side
+    size_t consumed_;
+    bool started_;
+
 };
 
 //----------------------------------------------------------------------------------------------------------------------
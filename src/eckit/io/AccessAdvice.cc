@@ -0,0 +1,141 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <cstdint>
+
+#include "eckit/exception/Exceptions.h"
+#include "eckit/io/AccessAdvice.h"
+
+namespace eckit {
+
+//----------------------------------------------------------------------------------------------------------------------
+
+namespace {
+
+/// Extends [addr, addr + length) to whole pages, as madvise() requires
+void pages(const void* addr, size_t length, void*& start, size_t& size) {
+    static const uintptr_t page = uintptr_t(::sysconf(_SC_PAGESIZE));
+
+    uintptr_t a = reinterpret_cast<uintptr_t>(addr);
+    uintptr_t b = a + length;
+    a           = a / page * page;
+    b           = (b + page - 1) / page * page;
+
+    start = reinterpret_cast<void*>(a);
+    size  = size_t(b - a);
+}
+
+#if defined(POSIX_FADV_NORMAL)
+int fadvice(AccessPattern p) {
+    switch (p) {
+        case AccessPattern::Sequential:
+            return POSIX_FADV_SEQUENTIAL;
+        case AccessPattern::Random:
+            return POSIX_FADV_RANDOM;
+        default:
+            return POSIX_FADV_NORMAL;
+    }
+}
+#endif
+
+int madvice(AccessPattern p) {
+    switch (p) {
+        case AccessPattern::Sequential:
+            return MADV_SEQUENTIAL;
+        case AccessPattern::Random:
+            return MADV_RANDOM;
+        default:
+            return MADV_NORMAL;
+    }
+}
+
+}  // namespace
+
+//----------------------------------------------------------------------------------------------------------------------
+
+AccessPattern AccessAdvice::pattern(const std::string& name) {
+    if (name == "normal") {
+        return AccessPattern::Normal;
+    }
+    if (name == "sequential") {
+        return AccessPattern::Sequential;
+    }
+    if (name == "random") {
+        return AccessPattern::Random;
+    }
+    throw BadValue("AccessAdvice: unknown access pattern '" + name + "', expected normal, sequential or random");
+}
+
+const char* AccessAdvice::name(AccessPattern p) {
+    switch (p) {
+        case AccessPattern::Sequential:
+            return "sequential";
+        case AccessPattern::Random:
+            return "random";
+        default:
+            return "normal";
+    }
+}
+
+void AccessAdvice::pattern(int fd, AccessPattern p, off_t offset, size_t length) {
+#if defined(POSIX_FADV_NORMAL)
+    ::posix_fadvise(fd, offset, off_t(length), fadvice(p));
+#endif
+}
+
+void AccessAdvice::willNeed(int fd, off_t offset, size_t length) {
+#if defined(__linux__)
+    if (::readahead(fd, offset, length) == 0) {
+        return;
+    }
+#endif
+#if defined(POSIX_FADV_WILLNEED)
+    ::posix_fadvise(fd, offset, off_t(length), POSIX_FADV_WILLNEED);
+#endif
+}
+
+void AccessAdvice::dontNeed(int fd, off_t offset, size_t length) {
+#if defined(POSIX_FADV_DONTNEED)
+    ::posix_fadvise(fd, offset, off_t(length), POSIX_FADV_DONTNEED);
+#endif
+}
+
+void AccessAdvice::pattern(const void* addr, size_t length, AccessPattern p) {
+    void* start;
+    size_t size;
+    pages(addr, length, start, size);
+    ::madvise(start, size, madvice(p));
+}
+
+void AccessAdvice::willNeed(const void* addr, size_t length) {
+    void* start;
+    size_t size;
+    pages(addr, length, start, size);
+    ::madvise(start, size, MADV_WILLNEED);
+}
+
+void AccessAdvice::dontNeed(const void* addr, size_t length) {
+    // Only whole pages within the range, not to drop pages still in use on either side
+    static const uintptr_t page = uintptr_t(::sysconf(_SC_PAGESIZE));
+
+    uintptr_t a = (reinterpret_cast<uintptr_t>(addr) + page - 1) / page * page;
+    uintptr_t b = (reinterpret_cast<uintptr_t>(addr) + length) / page * page;
+    if (b > a) {
+        ::madvise(reinterpret_cast<void*>(a), size_t(b - a), MADV_DONTNEED);
+    }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // namespace eckit
@@ -0,0 +1,67 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+#ifndef eckit_io_AccessAdvice_h
+#define eckit_io_AccessAdvice_h
+
+#include <sys/types.h>
+
+#include <cstddef>
+#include <string>
+
+namespace eckit {
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/// How a file or a mapping is going to be read, to tune the kernel readahead
+enum class AccessPattern
+{
+    Normal,
+    Sequential,  // larger readahead, pages can be dropped early once read
+    Random       // no readahead
+};
+
+/// Hints to the kernel about file descriptors (posix_fadvise, readahead) and mappings (madvise).
+///
+/// Hints are advisory: failures, or platforms without them, are silently ignored.
+
+class AccessAdvice {
+public:
+    /// @returns the pattern named "normal", "sequential" or "random"
+    /// @throws BadValue for other names
+    static AccessPattern pattern(const std::string&);
+
+    static const char* name(AccessPattern);
+
+    // File descriptors, a length of 0 means up to the end of the file
+
+    static void pattern(int fd, AccessPattern, off_t offset = 0, size_t length = 0);
+
+    /// Starts reading the range into the page cache.
+    /// @note on Linux this uses readahead(2), which returns once the reads are issued and may block on a busy device
+    static void willNeed(int fd, off_t offset, size_t length);
+
+    /// The range is not needed anymore, its clean pages can be dropped from the page cache
+    static void dontNeed(int fd, off_t offset, size_t length);
+
+    // Mappings, the range is extended to whole pages
+
+    static void pattern(const void* addr, size_t length, AccessPattern);
+    static void willNeed(const void* addr, size_t length);
+
+    /// @pre the mapping must be read-only or shared, the pages are read again from the file if used later
+    static void dontNeed(const void* addr, size_t length);
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // namespace eckit
+
+#endif
@@ -12,30 +12,22 @@
 
 #include "eckit/exception/Exceptions.h"
 #include "eckit/io/Buffer.h"
+#include "eckit/memory/BufferAllocator.h"
 
 namespace eckit {
 
 //----------------------------------------------------------------------------------------------------------------------
 
-namespace {
-
-static char* allocate(size_t size) {
-    return new char[size];
-}
-
-static void deallocate(char* buffer) {
-    delete[] buffer;
-}
-
-}  // namespace
-
-//----------------------------------------------------------------------------------------------------------------------
-
 Buffer::Buffer(size_t size) :
     buffer_{nullptr}, size_{size} {
     create();
 }
 
+Buffer::Buffer(size_t size, const BufferAllocator& allocator) :
+    buffer_{nullptr}, size_{size}, allocator_{&allocator}, fixed_{true} {
+    create();
+}
+
 Buffer::Buffer(const void* p, size_t len) :
     buffer_{nullptr}, size_{len} {
     create();
@@ -49,7 +41,7 @@ Buffer::Buffer(const std::string& s) :
 }
 
 Buffer::Buffer(Buffer&& rhs) noexcept :
-    buffer_{rhs.buffer_}, size_{rhs.size_} {
+    buffer_{rhs.buffer_}, size_{rhs.size_}, allocator_{rhs.allocator_}, fixed_{rhs.fixed_} {
     rhs.buffer_ = nullptr;
     rhs.size_   = 0;
 }
@@ -59,10 +51,14 @@ Buffer& Buffer::operator=(Buffer&& rhs) noexcept {
         return *this;
     }
 
-    deallocate(buffer_);
+    if (buffer_) {
+        allocator_->deallocate(buffer_, size_);
+    }
 
-    buffer_ = rhs.buffer_;
-    size_   = rhs.size_;
+    buffer_    = rhs.buffer_;
+    size_      = rhs.size_;
+    allocator_ = rhs.allocator_;
+    fixed_     = rhs.fixed_;
 
     rhs.buffer_ = nullptr;
     rhs.size_   = 0;
@@ -80,13 +76,18 @@ void Buffer::zero() {
     }
 }
 
+const BufferAllocator& Buffer::allocatorFor(size_t size) const {
+    return fixed_ ? *allocator_ : BufferAllocator::get(size);
+}
+
 void Buffer::create() {
-    buffer_ = allocate(size_);
+    allocator_ = &allocatorFor(size_);
+    buffer_    = allocator_->allocate(size_);
 }
 
 void Buffer::destroy() {
     if (buffer_) {
-        deallocate(buffer_);
+        allocator_->deallocate(buffer_, size_);
         buffer_ = nullptr;
         size_   = 0;
     }
@@ -106,18 +107,19 @@ void Buffer::copy(const void* p, size_t size, size_t pos) {
 
 void Buffer::resize(size_t size, bool preserveData) {
     if (size != size_) {
-        if (preserveData) {
-            char* newbuffer = allocate(size);
+        const BufferAllocator& allocator = allocatorFor(size);
+        if (preserveData && buffer_) {
+            char* newbuffer = allocator.allocate(size);
             ::memcpy(newbuffer, buffer_, std::min(size_, size));
-            deallocate(buffer_);
-            size_   = size;
+            allocator_->deallocate(buffer_, size_);
             buffer_ = newbuffer;
         }
         else {
-            deallocate(buffer_);
-            size_   = size;
-            buffer_ = allocate(size);
+            destroy();
+            buffer_ = allocator.allocate(size);
         }
+        size_      = size;
+        allocator_ = &allocator;
     }
 }
 
@@ -22,13 +22,20 @@
 
 namespace eckit {
 
+class BufferAllocator;
+
 /// Simple class to implement memory buffers
+///
+/// Large buffers are allocated as configured for BufferAllocator (e.g. with huge pages or on given NUMA nodes)
 
 class Buffer : private NonCopyable {
 public:  // methods
     explicit Buffer(size_t size = 0);
     explicit Buffer(const std::string& s);
 
+    /// Allocates with the given allocator, rather than the one selected for the size
+    Buffer(size_t size, const BufferAllocator&);
+
     /// Allocate and copy memory of given length in bytes
     Buffer(const void*, size_t len);
 
@@ -62,15 +69,22 @@ public:  // methods
     /// @pre Buffer must have sufficient size
     void copy(const void*, size_t size, size_t pos = 0);
 
+    const BufferAllocator& allocator() const { return *allocator_; }
+
 protected:  // methods
     void create();
     void destroy();
 
     void copy(const std::string& s);
 
+private:  // methods
+    const BufferAllocator& allocatorFor(size_t) const;
+
 private:  // members
     char* buffer_{nullptr};
     size_t size_{0};
+    const BufferAllocator* allocator_{nullptr};  // of buffer_
+    bool fixed_{false};                          // allocator given by the user
 };
 
 }  // namespace eckit
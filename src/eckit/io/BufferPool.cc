@@ -0,0 +1,105 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+#include <ostream>
+
+#include "eckit/config/Resource.h"
+#include "eckit/io/BufferPool.h"
+#include "eckit/log/Bytes.h"
+#include "eckit/thread/AutoLock.h"
+
+namespace eckit {
+
+//----------------------------------------------------------------------------------------------------------------------
+
+BufferPool::BufferPool(size_t maxBytes, size_t minSize, size_t maxBuffers) :
+    maxBytes_(maxBytes), minSize_(minSize), maxBuffers_(maxBuffers), cached_(0) {}
+
+BufferPool& BufferPool::instance() {
+    // Never destroyed, PooledBuffers may be released during static destruction
+    static BufferPool* pool =
+        new BufferPool(Resource<size_t>("bufferPoolSize;$ECKIT_BUFFER_POOL_SIZE", 256 * 1024 * 1024),
+                       Resource<size_t>("bufferPoolMinSize;$ECKIT_BUFFER_POOL_MIN_SIZE", 64 * 1024),
+                       Resource<size_t>("bufferPoolMaxBuffers;$ECKIT_BUFFER_POOL_MAX_BUFFERS", 64));
+    return *pool;
+}
+
+Buffer BufferPool::acquire(size_t size) {
+    if (size >= minSize_) {
+        AutoLock<Mutex> lock(mutex_);
+
+        // Best fit, not wasting more than half of the buffer
+        auto best = buffers_.end();
+        for (auto j = buffers_.begin(); j != buffers_.end(); ++j) {
+            size_t s = j->size();
+            if (s >= size && s / 2 <= size && (best == buffers_.end() || s < best->size())) {
+                best = j;
+            }
+        }
+
+        if (best != buffers_.end()) {
+            Buffer buffer(std::move(*best));
+            buffers_.erase(best);
+            cached_ -= buffer.size();
+            statistics_.hits_++;
+            return buffer;
+        }
+
+        statistics_.misses_++;
+    }
+
+    return Buffer(size);
+}
+
+void BufferPool::release(Buffer&& buffer) {
+    size_t size = buffer.size();
+    if (size == 0 || size < minSize_ || size > maxBytes_ || maxBuffers_ == 0) {
+        return;
+    }
+
+    std::list<Buffer> evicted;  // freed outside the lock
+
+    AutoLock<Mutex> lock(mutex_);
+
+    buffers_.emplace_front(std::move(buffer));
+    cached_ += size;
+
+    while (cached_ > maxBytes_ || buffers_.size() > maxBuffers_) {
+        cached_ -= buffers_.back().size();
+        evicted.splice(evicted.end(), buffers_, std::prev(buffers_.end()));
+    }
+}
+
+void BufferPool::clear() {
+    std::list<Buffer> buffers;
+    AutoLock<Mutex> lock(mutex_);
+    std::swap(buffers, buffers_);
+    cached_ = 0;
+}
+
+size_t BufferPool::cached() const {
+    AutoLock<Mutex> lock(mutex_);
+    return cached_;
+}
+
+BufferPool::Statistics BufferPool::statistics() const {
+    AutoLock<Mutex> lock(mutex_);
+    return statistics_;
+}
+
+void BufferPool::print(std::ostream& s) const {
+    AutoLock<Mutex> lock(mutex_);
+    s << "BufferPool[buffers=" << buffers_.size() << ",cached=" << Bytes(cached_) << ",max=" << Bytes(maxBytes_)
+      << ",hits=" << statistics_.hits_ << ",misses=" << statistics_.misses_ << "]";
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // namespace eckit
@@ -0,0 +1,113 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+#ifndef eckit_io_BufferPool_h
+#define eckit_io_BufferPool_h
+
+#include <cstddef>
+#include <iosfwd>
+#include <list>
+
+#include "eckit/io/Buffer.h"
+#include "eckit/memory/NonCopyable.h"
+#include "eckit/thread/Mutex.h"
+
+namespace eckit {
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/// Keeps released buffers to hand them out again, so that hot paths (transfers, codecs) do not map and fault in
+/// fresh memory each time.
+///
+/// A buffer is reused for requests between half its size and its size. The pool holds at most maxBytes in at most
+/// maxBuffers buffers, releasing the least recently used buffers first. Buffers smaller than minSize are not worth
+/// the lock and the search, they are neither kept nor looked for. The shared instance holds up to bufferPoolSize
+/// ($ECKIT_BUFFER_POOL_SIZE, 256 MiB), 0 disables it, in bufferPoolMaxBuffers ($ECKIT_BUFFER_POOL_MAX_BUFFERS, 64)
+/// buffers of at least bufferPoolMinSize ($ECKIT_BUFFER_POOL_MIN_SIZE, 64 KiB).
+
+class BufferPool : private NonCopyable {
+public:  // types
+    struct Statistics {
+        size_t hits_   = 0;
+        size_t misses_ = 0;
+    };
+
+public:  // methods
+    explicit BufferPool(size_t maxBytes, size_t minSize = 0, size_t maxBuffers = 64);
+
+    static BufferPool& instance();
+
+    /// @returns a buffer of at least size bytes, its contents are undefined
+    Buffer acquire(size_t size);
+
+    /// Gives the buffer back to the pool
+    void release(Buffer&&);
+
+    /// Frees the buffers held
+    void clear();
+
+    /// @returns the bytes held
+    size_t cached() const;
+
+    Statistics statistics() const;
+
+    void print(std::ostream&) const;
+
+    friend std::ostream& operator<<(std::ostream& s, const BufferPool& p) {
+        p.print(s);
+        return s;
+    }
+
+private:  // members
+    size_t maxBytes_;
+    size_t minSize_;
+    size_t maxBuffers_;
+    size_t cached_;
+    std::list<Buffer> buffers_;  // most recently released first
+    Statistics statistics_;
+
+    mutable Mutex mutex_;
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/// A buffer taken from a BufferPool for the lifetime of the object
+
+class PooledBuffer : private NonCopyable {
+public:
+    explicit PooledBuffer(size_t size, BufferPool& pool = BufferPool::instance()) :
+        pool_(pool), buffer_(pool.acquire(size)) {}
+
+    ~PooledBuffer() { pool_.release(std::move(buffer_)); }
+
+    operator char*() { return buffer_; }
+    operator const char*() const { return buffer_; }
+
+    operator void*() { return buffer_; }
+    operator const void*() const { return buffer_; }
+
+    void* data() { return buffer_.data(); }
+    const void* data() const { return buffer_.data(); }
+
+    /// @returns the size of the buffer, which may be larger than asked for
+    size_t size() const { return buffer_.size(); }
+
+    Buffer& buffer() { return buffer_; }
+
+private:
+    BufferPool& pool_;
+    Buffer buffer_;
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // namespace eckit
+
+#endif
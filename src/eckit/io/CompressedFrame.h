@@ -0,0 +1,84 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+/// @file CompressedFrame.h
+/// @date October 2026
+///
+/// Internal to eckit: the frames shared by CompressStage, UncompressStage, CompressingHandle and
+/// DecompressingHandle, and the big-endian integers of the compressed formats.
+
+#ifndef eckit_io_CompressedFrame_h
+#define eckit_io_CompressedFrame_h
+
+#include <cstddef>
+#include <cstdint>
+
+#include "eckit/exception/Exceptions.h"
+#include "eckit/io/DataHandle.h"
+
+namespace eckit::frame {
+
+//----------------------------------------------------------------------------------------------------------------------
+
+inline void put64(char* p, uint64_t v) {
+    for (int i = 7; i >= 0; --i) {
+        p[i] = char(v & 0xff);
+        v >>= 8;
+    }
+}
+
+inline uint64_t get64(const char* p) {
+    uint64_t v = 0;
+    for (int i = 0; i < 8; ++i) {
+        v = (v << 8) | uint64_t(static_cast<unsigned char>(p[i]));
+    }
+    return v;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/// A frame is its header, the compressed and uncompressed sizes, followed by the compressed bytes
+constexpr size_t headerSize = 16;
+
+struct Header {
+    size_t compressed;
+    size_t uncompressed;
+};
+
+inline void encode(char* header, size_t compressed, size_t uncompressed) {
+    put64(header, compressed);
+    put64(header + 8, uncompressed);
+}
+
+inline Header decode(const char* header) {
+    return {size_t(get64(header)), size_t(get64(header + 8))};
+}
+
+/// @returns the bytes read, less than length only at the end of the input
+inline size_t readFully(DataHandle& in, char* buffer, size_t length) {
+    size_t done = 0;
+    while (done < length) {
+        long n = in.read(buffer + done, long(length - done));
+        if (n < 0) {
+            throw ReadError(in.name());
+        }
+        if (n == 0) {
+            break;
+        }
+        done += size_t(n);
+    }
+    return done;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // namespace eckit::frame
+
+#endif
@@ -0,0 +1,293 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <ostream>
+#include <sstream>
+
+#include "eckit/config/Resource.h"
+#include "eckit/exception/Exceptions.h"
+#include "eckit/io/CompressedFrame.h"
+#include "eckit/io/CompressingHandle.h"
+#include "eckit/log/Bytes.h"
+#include "eckit/runtime/Metrics.h"
+#include "eckit/utils/Compressor.h"
+
+namespace eckit {
+
+//----------------------------------------------------------------------------------------------------------------------
+
+CompressingHandle::CompressingHandle(DataHandle* h, const std::string& compression, size_t blockSize) :
+    HandleHolder(h), compression_(compression), blockSize_(blockSize) {
+    init();
+}
+
+CompressingHandle::CompressingHandle(DataHandle& h, const std::string& compression, size_t blockSize) :
+    HandleHolder(h), compression_(compression), blockSize_(blockSize) {
+    init();
+}
+
+CompressingHandle::~CompressingHandle() {}
+
+void CompressingHandle::init() {
+    static size_t defaultBlockSize = Resource<size_t>(
+        "compressingHandleBlockSize;$ECKIT_COMPRESSING_HANDLE_BLOCK_SIZE", 4 * 1024 * 1024);
+
+    if (blockSize_ == 0) {
+        blockSize_ = defaultBlockSize;
+    }
+    ASSERT(blockSize_ > 0);
+
+    compressor_.reset(CompressorFactory::instance().build(compression_));
+
+    used_       = 0;
+    opened_     = false;
+    written_    = 0;
+    compressed_ = 0;
+}
+
+void CompressingHandle::openForWrite(const Length&) {
+    // The compressed size is not known
+    handle().openForWrite(0);
+    block_.resize(blockSize_);
+    used_       = 0;
+    opened_     = true;
+    written_    = 0;
+    compressed_ = 0;
+}
+
+void CompressingHandle::openForAppend(const Length&) {
+    // Frames can be appended to a stream of frames
+    handle().openForAppend(0);
+    block_.resize(blockSize_);
+    used_       = 0;
+    opened_     = true;
+    written_    = 0;
+    compressed_ = 0;
+}
+
+void CompressingHandle::writeBlock(const void* data, size_t length) {
+    if (length == 0) {
+        return;
+    }
+
+    // Reused from block to block, compressors only grow it if needed
+    size_t size = compressor_->compress(data, length, compressedBlock_);
+
+    char header[frame::headerSize];
+    frame::encode(header, size, length);
+
+    if (handle().write(header, frame::headerSize) != long(frame::headerSize)
+        || handle().write(compressedBlock_, long(size)) != long(size)) {
+        std::ostringstream s;
+        s << handle() << ": failed to write " << Bytes(frame::headerSize + size);
+        throw WriteError(s.str(), Here());
+    }
+
+    compressed_ += Length(frame::headerSize + size);
+}
+
+long CompressingHandle::write(const void* buffer, long length) {
+    ASSERT(opened_);
+    ASSERT(length >= 0);
+
+    const char* p = static_cast<const char*>(buffer);
+    size_t left   = size_t(length);
+
+    while (left > 0) {
+        // Whole blocks go straight from the caller's buffer
+        if (used_ == 0 && left >= blockSize_) {
+            writeBlock(p, blockSize_);
+            p += blockSize_;
+            left -= blockSize_;
+            continue;
+        }
+
+        size_t n = std::min(left, blockSize_ - used_);
+        ::memcpy(static_cast<char*>(block_) + used_, p, n);
+        used_ += n;
+        p += n;
+        left -= n;
+
+        if (used_ == blockSize_) {
+            writeBlock(block_, used_);
+            used_ = 0;
+        }
+    }
+
+    written_ += length;
+    return length;
+}
+
+void CompressingHandle::flush() {
+    if (opened_ && used_) {
+        writeBlock(block_, used_);
+        used_ = 0;
+    }
+    handle().flush();
+}
+
+void CompressingHandle::close() {
+    if (opened_) {
+        opened_ = false;
+        if (used_) {
+            writeBlock(block_, used_);
+            used_ = 0;
+        }
+        block_           = Buffer();
+        compressedBlock_ = Buffer();
+    }
+    handle().close();
+}
+
+Length CompressingHandle::estimate() {
+    return 0;
+}
+
+Offset CompressingHandle::position() {
+    return Offset(static_cast<unsigned long long>(written_));
+}
+
+void CompressingHandle::print(std::ostream& s) const {
+    s << "CompressingHandle[compression=" << compression_ << ",blockSize=" << blockSize_ << ",handle=";
+    handle().print(s);
+    s << ']';
+}
+
+std::string CompressingHandle::title() const {
+    return std::string("<") + compression_ + ">" + handle().title();
+}
+
+void CompressingHandle::collectMetrics(const std::string& what) const {
+    handle().collectMetrics(what);
+    Metrics::set(what + "_compression", compression_);
+    Metrics::set(what + "_uncompressed_size", written_);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+DecompressingHandle::DecompressingHandle(DataHandle* h, const std::string& compression) :
+    HandleHolder(h), compression_(compression) {
+    init();
+}
+
+DecompressingHandle::DecompressingHandle(DataHandle& h, const std::string& compression) :
+    HandleHolder(h), compression_(compression) {
+    init();
+}
+
+DecompressingHandle::~DecompressingHandle() {}
+
+void DecompressingHandle::init() {
+    compressor_.reset(CompressorFactory::instance().build(compression_));
+    blockLength_ = 0;
+    cursor_      = 0;
+    read_        = 0;
+}
+
+Length DecompressingHandle::openForRead() {
+    handle().openForRead();
+    blockLength_ = 0;
+    cursor_      = 0;
+    read_        = 0;
+    return 0;
+}
+
+bool DecompressingHandle::nextBlock() {
+    char header[frame::headerSize];
+    size_t n = frame::readFully(handle(), header, frame::headerSize);
+    if (n == 0) {
+        return false;
+    }
+    if (n != frame::headerSize) {
+        throw ReadError(handle().name() + ": truncated frame header", Here());
+    }
+
+    frame::Header sizes = frame::decode(header);
+    size_t size         = sizes.compressed;
+    size_t length       = sizes.uncompressed;
+
+    if (compressedBlock_.size() < size) {
+        compressedBlock_.resize(size);
+    }
+    if (frame::readFully(handle(), compressedBlock_, size) != size) {
+        throw ReadError(handle().name() + ": truncated frame", Here());
+    }
+
+    compressor_->uncompress(compressedBlock_, size, block_, length);
+
+    blockLength_ = length;
+    cursor_      = 0;
+    return true;
+}
+
+long DecompressingHandle::read(void* buffer, long length) {
+    char* p   = static_cast<char*>(buffer);
+    long done = 0;
+
+    while (done < length) {
+        if (cursor_ == blockLength_ && !nextBlock()) {
+            break;
+        }
+
+        size_t n = std::min(size_t(length - done), blockLength_ - cursor_);
+        ::memcpy(p + done, static_cast<const char*>(block_) + cursor_, n);
+        cursor_ += n;
+        done += long(n);
+    }
+
+    read_ += done;
+    return done;
+}
+
+void DecompressingHandle::close() {
+    compressedBlock_ = Buffer();
+    block_           = Buffer();
+    blockLength_     = 0;
+    cursor_          = 0;
+    handle().close();
+}
+
+void DecompressingHandle::rewind() {
+    handle().rewind();
+    blockLength_ = 0;
+    cursor_      = 0;
+    read_        = 0;
+}
+
+Length DecompressingHandle::estimate() {
+    return 0;
+}
+
+Offset DecompressingHandle::position() {
+    return Offset(static_cast<unsigned long long>(read_));
+}
+
+void DecompressingHandle::print(std::ostream& s) const {
+    s << "DecompressingHandle[compression=" << compression_ << ",handle=";
+    handle().print(s);
+    s << ']';
+}
+
+std::string DecompressingHandle::title() const {
+    return std::string("<") + compression_ + ">" + handle().title();
+}
+
+void DecompressingHandle::collectMetrics(const std::string& what) const {
+    handle().collectMetrics(what);
+    Metrics::set(what + "_compression", compression_);
+    Metrics::set(what + "_uncompressed_size", read_);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // namespace eckit
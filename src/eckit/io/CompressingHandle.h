@@ -0,0 +1,143 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+#ifndef eckit_io_CompressingHandle_h
+#define eckit_io_CompressingHandle_h
+
+#include <memory>
+#include <string>
+
+#include "eckit/io/Buffer.h"
+#include "eckit/io/HandleHolder.h"
+
+namespace eckit {
+
+class Compressor;
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/// Compresses the data written to it on the fly, block by block, into another handle.
+///
+/// Only one block is held in memory, whatever the size of the data. Each block is written as a frame: the
+/// compressed and uncompressed sizes (8 bytes each, big-endian) followed by the compressed bytes, as written by
+/// the CompressStage of a TransferPipeline. Any compressor of the CompressorFactory can be used.
+///
+/// The block size is given by the resource compressingHandleBlockSize ($ECKIT_COMPRESSING_HANDLE_BLOCK_SIZE,
+/// 4 MiB) if not passed.
+
+class CompressingHandle : public DataHandle, public HandleHolder {
+public:
+    /// Contructor, taking ownership
+    CompressingHandle(DataHandle*, const std::string& compression, size_t blockSize = 0);
+
+    /// Contructor, not taking ownership
+    CompressingHandle(DataHandle&, const std::string& compression, size_t blockSize = 0);
+
+    ~CompressingHandle() override;
+
+    // From DataHandle
+
+    void openForWrite(const Length&) override;
+    void openForAppend(const Length&) override;
+
+    long write(const void*, long) override;
+    void close() override;
+
+    /// Writes the current block, even if partial, and flushes the target
+    void flush() override;
+
+    void print(std::ostream&) const override;
+
+    Length estimate() override;
+
+    /// @returns the uncompressed bytes written
+    Offset position() override;
+
+    std::string title() const override;
+    void collectMetrics(const std::string& what) const override;
+
+    /// @returns the compressed bytes written to the target, headers included
+    Length compressedSize() const { return compressed_; }
+
+private:  // methods
+    void init();
+    void writeBlock(const void*, size_t);
+
+private:  // members
+    std::string compression_;
+    std::unique_ptr<Compressor> compressor_;
+
+    size_t blockSize_;
+    Buffer block_;
+    size_t used_;
+    Buffer compressedBlock_;
+
+    bool opened_;
+    Length written_;
+    Length compressed_;
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/// Reads the frames written by a CompressingHandle (or a CompressStage) from another handle and uncompresses them
+/// on the fly, one at a time.
+
+class DecompressingHandle : public DataHandle, public HandleHolder {
+public:
+    /// Contructor, taking ownership
+    DecompressingHandle(DataHandle*, const std::string& compression);
+
+    /// Contructor, not taking ownership
+    DecompressingHandle(DataHandle&, const std::string& compression);
+
+    ~DecompressingHandle() override;
+
+    // From DataHandle
+
+    /// @returns 0, as the uncompressed size is not known before the end
+    Length openForRead() override;
+
+    long read(void*, long) override;
+    void close() override;
+    void rewind() override;
+
+    void print(std::ostream&) const override;
+
+    Length estimate() override;
+
+    /// @returns the uncompressed bytes read
+    Offset position() override;
+
+    std::string title() const override;
+    void collectMetrics(const std::string& what) const override;
+
+private:  // methods
+    void init();
+
+    /// @returns false at the end of the input
+    bool nextBlock();
+
+private:  // members
+    std::string compression_;
+    std::unique_ptr<Compressor> compressor_;
+
+    Buffer compressedBlock_;
+    Buffer block_;
+    size_t blockLength_;
+    size_t cursor_;
+
+    Length read_;
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // namespace eckit
+
+#endif
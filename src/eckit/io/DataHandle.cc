@@ -8,16 +8,26 @@
  * does it submit to any jurisdiction.
  */
 
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cerrno>
 #include <cmath>
 #include <cstring>
 
 #include "eckit/eckit.h"
 
+#if eckit_HAVE_SENDFILE
+#include <sys/sendfile.h>
+#endif
+
 #include "eckit/config/LibEcKit.h"
 #include "eckit/config/Resource.h"
 #include "eckit/exception/Exceptions.h"
 #include "eckit/filesystem/PathName.h"
 #include "eckit/io/Buffer.h"
+#include "eckit/io/BufferPool.h"
 #include "eckit/io/DataHandle.h"
 #include "eckit/io/DblBuffer.h"
 #include "eckit/io/MoverTransfer.h"
@@ -51,6 +61,124 @@ AutoClose::~AutoClose() noexcept(false) {
 
 //----------------------------------------------------------------------------------------------------------------------
 
+namespace {
+
+/// Moves the data from one descriptor to another in the kernel, without a copy through user space
+class KernelTransfer {
+public:
+    KernelTransfer(int in, int out, long chunk, Progress& progress, TransferWatcher& watcher) :
+        in_(in), out_(out), chunk_(chunk), progress_(progress), watcher_(watcher) {}
+
+    ~KernelTransfer() {
+        if (pipe_[0] >= 0) {
+            ::close(pipe_[0]);
+            ::close(pipe_[1]);
+        }
+    }
+
+    /// @returns the system call used, or nullptr if none is possible, in which case nothing has been moved
+    const char* transfer(Length& total) {
+        struct stat in;
+        struct stat out;
+        if (::fstat(in_, &in) != 0 || ::fstat(out_, &out) != 0) {
+            return nullptr;
+        }
+
+        // Appending is not supported by all the calls, possibly after some data is already in flight
+        int flags = ::fcntl(out_, F_GETFL);
+        if (flags < 0 || (flags & O_APPEND)) {
+            return nullptr;
+        }
+
+#if eckit_HAVE_COPY_FILE_RANGE
+        // File to file, possibly without moving the data at all (reflinks, server-side copies)
+        if (S_ISREG(in.st_mode) && S_ISREG(out.st_mode) && run(total, [this](size_t n) { return ::copy_file_range(in_, nullptr, out_, nullptr, n, 0); })) {
+            return "copy_file_range";
+        }
+#endif
+
+#if eckit_HAVE_SENDFILE
+        // From a file, to a file or a socket
+        if (S_ISREG(in.st_mode) && run(total, [this](size_t n) { return ::sendfile(out_, in_, nullptr, n); })) {
+            return "sendfile";
+        }
+#endif
+
+#if eckit_HAVE_SPLICE
+        // From a socket or a pipe, through a pipe
+        if (!S_ISREG(in.st_mode) && ::pipe2(pipe_, O_CLOEXEC) == 0) {
+            ::fcntl(pipe_[1], F_SETPIPE_SZ, 1024 * 1024);  // best effort
+            if (run(total, [this](size_t n) { return splice(n); })) {
+                return "splice";
+            }
+        }
+#endif
+        return nullptr;
+    }
+
+private:
+    template <typename Call>
+    bool run(Length& total, Call call) {
+        const Length start = total;
+        for (;;) {
+            ssize_t n = call(size_t(chunk_));
+            if (n < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                if (total == start && unsupported(errno)) {
+                    return false;
+                }
+                throw FailedSystemCall("Moving data in the kernel");
+            }
+            if (n == 0) {
+                return true;
+            }
+
+            total += n;
+            progress_(total);
+            watcher_.watch(nullptr, long(n));
+        }
+    }
+
+#if eckit_HAVE_SPLICE
+    ssize_t splice(size_t length) {
+        ssize_t n = ::splice(in_, nullptr, pipe_[1], nullptr, length, SPLICE_F_MOVE | SPLICE_F_MORE);
+        if (n <= 0) {
+            return n;
+        }
+
+        // The pipe must be drained, or the data would be lost
+        for (ssize_t left = n; left > 0;) {
+            ssize_t m = ::splice(pipe_[0], nullptr, out_, nullptr, size_t(left), SPLICE_F_MOVE | SPLICE_F_MORE);
+            if (m < 0 && errno == EINTR) {
+                continue;
+            }
+            if (m <= 0) {
+                throw FailedSystemCall("splice");
+            }
+            left -= m;
+        }
+        return n;
+    }
+#endif
+
+    static bool unsupported(int e) {
+        return e == EINVAL || e == ENOSYS || e == EXDEV || e == EOPNOTSUPP || e == EBADF || e == EPERM;
+    }
+
+    int in_;
+    int out_;
+    long chunk_;
+    Progress& progress_;
+    TransferWatcher& watcher_;
+    int pipe_[2] = {-1, -1};
+};
+
+}  // namespace
+
+//----------------------------------------------------------------------------------------------------------------------
+
 
 ClassSpec DataHandle::classSpec_ = {
     &Streamable::classSpec(),
@@ -103,8 +231,6 @@ Length DataHandle::saveInto(DataHandle& other, TransferWatcher& watcher) {
     static const long bufsize = Resource<long>("bufferSize;$ECKIT_DATAHANDLE_SAVEINTO_BUFFER_SIZE",
                                                64 * 1024 * 1024);
 
-    Buffer buffer(bufsize);
-
     watcher.watch(0, 0);
 
     Length estimate = openForRead();
@@ -125,6 +251,23 @@ Length DataHandle::saveInto(DataHandle& other, TransferWatcher& watcher) {
     Timer timer("Save into");
     bool more = true;
 
+    // Between descriptors (files, sockets), the kernel can move the data without copying it through user space
+    static const bool kernelTransfer = Resource<bool>("kernelTransfer;$ECKIT_DATAHANDLE_KERNEL_TRANSFER", true);
+    const int in  = fileDescriptor();
+    const int out = other.fileDescriptor();
+
+    if (kernelTransfer && !watcher.wantsData() && in >= 0 && out >= 0) {
+        if (const char* how = KernelTransfer(in, out, bufsize, progress, watcher).transfer(total)) {
+            Log::debug<LibEcKit>() << "DataHandle::saveInto using " << how << std::endl;
+            Metrics::set("kernel_transfer", std::string(how));
+            readTime = writeTime = timer.elapsed();
+            length               = 0;
+            more                 = false;
+        }
+    }
+
+    PooledBuffer buffer(more ? bufsize : 0);
+
     while (more) {
         more = false;
         try {
@@ -201,7 +344,7 @@ Length DataHandle::copyTo(DataHandle& other, long bufsize, Length maxsize, Trans
     if (bufsize == -1) {
         bufsize = Resource<long>("bufferSize;$ECKIT_DATAHANDLE_COPYTO_BUFFER_SIZE", 64 * 1024 * 1024);
     }
-    Buffer buffer(bufsize);
+    PooledBuffer buffer(bufsize);
 
     Length estimate = openForRead();
     watcher.fromHandleOpened();
@@ -265,8 +408,8 @@ Streamable* Reanimator<DataHandle>::ressucitate(Stream& s) const {
 bool DataHandle::compare(DataHandle& other) {
     size_t bufsize = static_cast<size_t>(Resource<long>("compareBufferSize", 10 * 1024 * 1024));
 
-    Buffer buffer1(bufsize);
-    Buffer buffer2(bufsize);
+    PooledBuffer buffer1(bufsize);
+    PooledBuffer buffer2(bufsize);
 
     DataHandle& self = *this;
 
@@ -287,8 +430,9 @@ bool DataHandle::compare(DataHandle& other) {
     Length total = 0;
 
     for (;;) {
-        long len1 = self.read(buffer1, buffer1.size());
-        long len2 = other.read(buffer2, buffer2.size());
+        // Pooled buffers may be larger than asked for, read the same amount from both
+        long len1 = self.read(buffer1, long(bufsize));
+        long len2 = other.read(buffer2, long(bufsize));
 
         if (len1 != len2) {
             Log::error() << "DataHandle::compare(" << self << "," << other << ") failed: read() returns " << len1
@@ -147,6 +147,9 @@ public:
 
     virtual bool doubleBufferOK() const { return true; }
 
+    // Descriptor of the open handle, so saveInto() can move the data in the kernel, or -1
+    virtual int fileDescriptor() const { return -1; }
+
     // -- Overridden methods
 
     // From Streamble
@@ -12,6 +12,7 @@
 #include "eckit/io/DblBuffer.h"
 #include "eckit/io/AutoCloser.h"
 #include "eckit/io/Buffer.h"
+#include "eckit/io/BufferPool.h"
 #include "eckit/log/Bytes.h"
 #include "eckit/log/Log.h"
 #include "eckit/log/Progress.h"
@@ -128,7 +129,7 @@ Length DblBuffer::copy(DataHandle& in, DataHandle& out) {
 }
 
 Length DblBuffer::copy(DataHandle& in, DataHandle& out, const Length& estimate) {
-    Buffer bigbuf(count_ * bufSize_);
+    PooledBuffer bigbuf(count_ * bufSize_);
 
     OneBuffer* buffers = new OneBuffer[count_];
 
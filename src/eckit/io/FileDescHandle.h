@@ -49,6 +49,7 @@ public:
     Offset seek(const Offset&) override;
     bool canSeek() const override { return true; }
     void skip(const Length&) override;
+    int fileDescriptor() const override { return fd_; }
 
     // From Streamable
 
@@ -190,6 +190,14 @@ void FileHandle::close() {
     file_ = nullptr;
 }
 
+int FileHandle::fileDescriptor() const {
+    // Only when nothing has been buffered by stdio yet
+    if (file_ == nullptr || ::ftello(file_) != 0) {
+        return -1;
+    }
+    return ::fileno(file_);
+}
+
 void FileHandle::rewind() {
     ::rewind(file_);
 }
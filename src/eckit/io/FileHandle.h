@@ -69,6 +69,7 @@ public:
 
     DataHandle* clone() const override;
     void hash(MD5& md5) const override;
+    int fileDescriptor() const override;
 
     // From Streamable
 
@@ -14,9 +14,13 @@
 #include <sys/mman.h>
 #include <unistd.h>
 
+#include <algorithm>
+
+#include "eckit/config/Resource.h"
 #include "eckit/exception/Exceptions.h"
 #include "eckit/io/MMappedFileHandle.h"
 #include "eckit/io/MemoryHandle.h"
+#include "eckit/io/Prefetcher.h"
 #include "eckit/memory/MMap.h"
 #include "eckit/os/Stat.h"
 #include "eckit/utils/MD5.h"
@@ -24,6 +28,34 @@
 
 namespace eckit {
 
+namespace {
+
+AccessPattern defaultAccess() {
+    static std::string access = Resource<std::string>("mmapAccessPattern;$ECKIT_MMAP_ACCESS_PATTERN", "normal");
+    return AccessAdvice::pattern(access);
+}
+
+bool defaultPrefetch() {
+    static bool prefetch = Resource<bool>("mmapPrefetch;$ECKIT_MMAP_PREFETCH", false);
+    return prefetch;
+}
+
+size_t prefetchDepth() {
+    static size_t depth = Resource<size_t>("mmapPrefetchDepth;$ECKIT_MMAP_PREFETCH_DEPTH", 8);
+    return depth;
+}
+
+/// Clips [offset, offset + length) to the file
+bool clip(off_t size, off_t offset, size_t& length) {
+    if (offset < 0 || offset >= size) {
+        return false;
+    }
+    length = std::min(length, size_t(size - offset));
+    return length > 0;
+}
+
+}  // namespace
+
 
 ClassSpec MMappedFileHandle::classSpec_ = {
     &DataHandle::classSpec(),
@@ -41,15 +73,42 @@ void MMappedFileHandle::encode(Stream& s) const {
 }
 
 MMappedFileHandle::MMappedFileHandle(Stream& s) :
-    DataHandle(s), mmap_(nullptr), fd_(-1) {
+    DataHandle(s), mmap_(nullptr), fd_(-1), length_(0), access_(defaultAccess()), prefetch_(defaultPrefetch()) {
     s >> path_;
 }
 
 MMappedFileHandle::MMappedFileHandle(const std::string& path) :
-    path_(path), mmap_(nullptr), fd_(-1) {}
+    path_(path), mmap_(nullptr), fd_(-1), length_(0), access_(defaultAccess()), prefetch_(defaultPrefetch()) {}
 
 MMappedFileHandle::~MMappedFileHandle() {}
 
+void MMappedFileHandle::advise(AccessPattern access) {
+    access_ = access;
+    if (mmap_) {
+        AccessAdvice::pattern(mmap_, length_, access_);
+    }
+}
+
+void MMappedFileHandle::prefetch(bool on) {
+    prefetch_ = on;
+}
+
+void MMappedFileHandle::willNeed(const Offset& offset, const Length& length) {
+    ASSERT(mmap_);
+    size_t len = length;
+    if (clip(length_, offset, len)) {
+        AccessAdvice::willNeed(static_cast<char*>(mmap_) + off_t(offset), len);
+    }
+}
+
+void MMappedFileHandle::dontNeed(const Offset& offset, const Length& length) {
+    ASSERT(mmap_);
+    size_t len = length;
+    if (clip(length_, offset, len)) {
+        AccessAdvice::dontNeed(static_cast<char*>(mmap_) + off_t(offset), len);
+    }
+}
+
 
 Length MMappedFileHandle::openForRead() {
     ASSERT(!handle_.get());
@@ -69,6 +128,32 @@ Length MMappedFileHandle::openForRead() {
 
     handle_.reset(new MemoryHandle(mmap_, length_));
 
+    if (access_ != AccessPattern::Normal) {
+        AccessAdvice::pattern(mmap_, length_, access_);
+    }
+
+    if (prefetch_) {
+        char* base = static_cast<char*>(mmap_);
+        off_t size = length_;
+
+        Prefetcher::Action release;
+        if (access_ == AccessPattern::Sequential) {
+            release = [base, size](off_t offset, size_t length) {
+                if (clip(size, offset, length)) {
+                    AccessAdvice::dontNeed(base + offset, length);
+                }
+            };
+        }
+
+        prefetcher_.reset(new Prefetcher(
+            [base, size](off_t offset, size_t length) {
+                if (clip(size, offset, length)) {
+                    AccessAdvice::willNeed(base + offset, length);
+                }
+            },
+            prefetchDepth(), release));
+    }
+
     return handle_->openForRead();
 }
 
@@ -82,7 +167,16 @@ void MMappedFileHandle::openForAppend(const Length&) {
 
 long MMappedFileHandle::read(void* buffer, long length) {
     ASSERT(handle_.get());
-    return handle_->read(buffer, length);
+    if (!prefetcher_) {
+        return handle_->read(buffer, length);
+    }
+
+    off_t position = handle_->position();
+    long len       = handle_->read(buffer, length);
+    if (len > 0) {
+        prefetcher_->observe(position, size_t(len));
+    }
+    return len;
 }
 
 long MMappedFileHandle::write(const void* buffer, long length) {
@@ -96,6 +190,7 @@ void MMappedFileHandle::flush() {
 }
 
 void MMappedFileHandle::close() {
+    prefetcher_.reset();
     if (handle_.get()) {
         handle_->close();
         handle_.reset(0);
@@ -15,11 +15,20 @@
 #define eckit_io_MMappedFileHandle_h
 
 #include <memory>
+#include "eckit/io/AccessAdvice.h"
 #include "eckit/io/DataHandle.h"
 
 
 namespace eckit {
 
+class Prefetcher;
+
+/// Reads a file through a shared read-only mapping.
+///
+/// The access pattern given to the kernel defaults to mmapAccessPattern ($ECKIT_MMAP_ACCESS_PATTERN, normal). With
+/// mmapPrefetch ($ECKIT_MMAP_PREFETCH), the reads following a constant stride are prefetched from a background thread,
+/// and with a sequential pattern the pages already read are then released.
+
 class MMappedFileHandle : public DataHandle {
 
 public:
@@ -30,6 +39,21 @@ public:
 
     const std::string& path() const { return path_; }
 
+    // -- Access hints
+
+    /// Applies from the next openForRead(), or to the mapping if already open
+    void advise(AccessPattern);
+
+    /// Enables or disables the prefetching of strided reads, from the next openForRead()
+    void prefetch(bool);
+
+    /// @pre opened for read
+    void willNeed(const Offset&, const Length&);
+    void dontNeed(const Offset&, const Length&);
+
+    /// @returns the prefetcher while open, if enabled
+    const Prefetcher* prefetcher() const { return prefetcher_.get(); }
+
     // -- Overridden methods
 
     // From DataHandle
@@ -79,6 +103,10 @@ private:  // members
     int fd_;
     off_t length_;
 
+    AccessPattern access_;
+    bool prefetch_;
+    std::unique_ptr<Prefetcher> prefetcher_;
+
 private:  // methods
     void open(const char*);
 
@@ -12,6 +12,7 @@
 
 #include "eckit/config/Resource.h"
 #include "eckit/io/MultiHandle.h"
+#include "eckit/io/PartFileHandle.h"
 #include "eckit/log/Timer.h"
 #include "eckit/runtime/Metrics.h"
 #include "eckit/types/Types.h"
@@ -94,11 +95,15 @@ Length MultiHandle::openForRead() {
 
     read_ = true;
 
+    // Consecutive parts of the same file are read as one handle, so their reads can be coalesced
+    static bool compressOnRead = Resource<bool>("multiHandleCompressOnRead;$ECKIT_MULTIHANDLE_COMPRESS_ON_READ", true);
+    if (compressOnRead) {
+        compress();
+    }
+
     current_ = datahandles_.begin();
     openCurrent();
 
-    // compress();
-
     return estimate();
 }
 
@@ -453,11 +458,51 @@ void MultiHandle::collectMetrics(const std::string& what) const {
     }
 
     Metrics::set(what, v);
+
+    PartFileHandle::Statistics statistics;
+    bool parts = false;
+    for (size_t i = 0; i < datahandles_.size(); i++) {
+        if (const auto* h = dynamic_cast<const PartFileHandle*>(datahandles_[i])) {
+            statistics += h->statistics();
+            parts = true;
+        }
+    }
+
+    if (parts) {
+        Metrics::set(what + "_reads", statistics.reads_);
+        Metrics::set(what + "_bytes_read", statistics.bytesRead_);
+        Metrics::set(what + "_bytes_delivered", statistics.bytesDelivered_);
+    }
 }
 
 
 bool MultiHandle::compress(bool) {
-    return false;
+    // Not when writing, each handle has its length, nor with a handle open
+    if (datahandles_.size() < 2 || !length_.empty() || current_ != datahandles_.end()) {
+        return false;
+    }
+
+    HandleList merged;
+    merged.reserve(datahandles_.size());
+
+    // Only parts of files, merge() is not implemented by all the handles
+    auto mergeable = [](DataHandle* h) { return dynamic_cast<PartFileHandle*>(h) != nullptr; };
+
+    for (size_t i = 0; i < datahandles_.size(); i++) {
+        if (!merged.empty() && mergeable(merged.back()) && mergeable(datahandles_[i]) &&
+            merged.back()->merge(datahandles_[i])) {
+            delete datahandles_[i];
+        }
+        else {
+            merged.push_back(datahandles_[i]);
+        }
+    }
+
+    bool changed = merged.size() != datahandles_.size();
+    datahandles_.swap(merged);
+    current_ = datahandles_.end();
+
+    return changed;
 }
 
 //----------------------------------------------------------------------------------------------------------------------
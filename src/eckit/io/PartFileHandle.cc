@@ -9,16 +9,24 @@
  */
 
 
+#include <sys/uio.h>
+
+#include <algorithm>
+#include <climits>
+#include <cstring>
 #include <numeric>
+#include <vector>
 
 #include "eckit/io/cluster/NodeInfo.h"
 #include "eckit/log/Log.h"
 
+#include "eckit/config/Resource.h"
 #include "eckit/exception/Exceptions.h"
 #include "eckit/io/PartFileHandle.h"
 
 #include "eckit/io/PooledHandle.h"
 #include "eckit/io/MoverTransferSelection.h"
+#include "eckit/runtime/Metrics.h"
 
 namespace eckit {
 
@@ -30,6 +38,29 @@ ClassSpec PartFileHandle::classSpec_ = {
 };
 Reanimator<PartFileHandle> PartFileHandle::reanimator_;
 
+#ifdef IOV_MAX
+static constexpr size_t maxIov = IOV_MAX;
+#else
+static constexpr size_t maxIov = 1024;
+#endif
+
+static size_t readGap() {
+    static size_t gap = Resource<size_t>("partFileHandleReadGap;$ECKIT_PART_FILE_HANDLE_READ_GAP", 64 * 1024);
+    return gap;
+}
+
+static size_t readAhead() {
+    static size_t ahead = Resource<size_t>("partFileHandleReadAhead;$ECKIT_PART_FILE_HANDLE_READ_AHEAD", 1024 * 1024);
+    return ahead;
+}
+
+PartFileHandle::Statistics& PartFileHandle::Statistics::operator+=(const Statistics& other) {
+    reads_ += other.reads_;
+    bytesRead_ += other.bytesRead_;
+    bytesDelivered_ += other.bytesDelivered_;
+    return *this;
+}
+
 void PartFileHandle::print(std::ostream& s) const {
     if (format(s) == Log::compactFormat) {
         s << "PartFileHandle";
@@ -48,7 +79,7 @@ void PartFileHandle::encode(Stream& s) const {
 }
 
 PartFileHandle::PartFileHandle(Stream& s) :
-    DataHandle(s), pos_(0), index_(0) {
+    DataHandle(s), pos_(0), index_(0), aheadPos_(0), aheadLen_(0) {
     s >> path_;
     s >> offset_;
     s >> length_;
@@ -57,14 +88,14 @@ PartFileHandle::PartFileHandle(Stream& s) :
 }
 
 PartFileHandle::PartFileHandle(const PathName& name, const OffsetList& offset, const LengthList& length) :
-    path_(name), handle_(), pos_(0), index_(0), offset_(offset), length_(length) {
+    path_(name), handle_(), pos_(0), index_(0), offset_(offset), length_(length), aheadPos_(0), aheadLen_(0) {
     //    Log::info() << "PartFileHandle::PartFileHandle " << name << std::endl;
     ASSERT(offset_.size() == length_.size());
     compress(false);
 }
 
 PartFileHandle::PartFileHandle(const PathName& name, const Offset& offset, const Length& length) :
-    path_(name), handle_(), pos_(0), index_(0), offset_(1, offset), length_(1, length) {}
+    path_(name), handle_(), pos_(0), index_(0), offset_(1, offset), length_(1, length), aheadPos_(0), aheadLen_(0) {}
 
 
 DataHandle* PartFileHandle::clone() const {
@@ -124,6 +155,8 @@ long PartFileHandle::read1(char* buffer, long length) {
     ASSERT(Length(size) == lsize);
 
     long n = handle_->read(buffer, size);
+    statistics_.reads_++;
+    statistics_.bytesRead_ += n;
 
     if (n != size) {
         std::ostringstream s;
@@ -141,19 +174,166 @@ long PartFileHandle::read1(char* buffer, long length) {
 }
 
 
+long PartFileHandle::scatter(char* buffer, long length) {
+    struct Segment {
+        long long offset_;
+        size_t length_;
+        char* data_;
+    };
+
+    // The parts from the current position, without moving it
+    std::vector<Segment> segments;
+    long total    = 0;
+    long long pos = pos_;
+    for (Ordinal i = index_; i < offset_.size() && total < length; ++i, pos = 0) {
+        long long left = (long long)length_[i] - pos;
+        if (left > 0) {
+            size_t n = size_t(std::min<long long>(left, length - total));
+            segments.push_back({(long long)offset_[i] + pos, n, buffer + total});
+            total += long(n);
+        }
+    }
+
+    std::stable_sort(segments.begin(), segments.end(),
+                     [](const Segment& a, const Segment& b) { return a.offset_ < b.offset_; });
+
+    // Runs of parts with small gaps, read with one preadv each
+    const size_t gap = readGap();
+    std::vector<char> scratch;
+    std::vector<struct iovec> iov;
+
+    for (size_t i = 0; i < segments.size();) {
+        const long long start = segments[i].offset_;
+        long long end         = start;
+
+        iov.clear();
+        for (; i < segments.size(); ++i) {
+            const Segment& s = segments[i];
+            if (!iov.empty()) {
+                if (s.offset_ < end || size_t(s.offset_ - end) > gap || iov.size() + 2 > maxIov) {
+                    break;
+                }
+                if (s.offset_ > end) {
+                    scratch.resize(gap);
+                    iov.push_back({scratch.data(), size_t(s.offset_ - end)});
+                }
+            }
+            iov.push_back({s.data_, s.length_});
+            end = s.offset_ + (long long)s.length_;
+        }
+
+        struct iovec* v = iov.data();
+        int count       = int(iov.size());
+        long long done  = 0;
+        while (start + done < end) {
+            long n = handle_->readv(v, count, start + done);
+            statistics_.reads_++;
+
+            if (n == 0) {
+                std::ostringstream s;
+                s << path_ << ": cannot read " << (end - start) << ", got only " << done;
+                throw ReadError(s.str());
+            }
+
+            statistics_.bytesRead_ += n;
+            done += n;
+
+            // Skip what was read, in case of a short read
+            size_t m = size_t(n);
+            while (count > 0 && m >= v->iov_len) {
+                m -= v->iov_len;
+                ++v;
+                --count;
+            }
+            if (m > 0) {
+                v->iov_base = static_cast<char*>(v->iov_base) + m;
+                v->iov_len -= m;
+            }
+        }
+    }
+
+    return total;
+}
+
+void PartFileHandle::advance(long length) {
+    while (length > 0 && index_ < offset_.size()) {
+        long long left = (long long)length_[index_] - pos_;
+        if (length < left) {
+            pos_ += length;
+            return;
+        }
+        length -= long(left);
+        index_++;
+        pos_ = 0;
+    }
+}
+
 long PartFileHandle::read(void* buffer, long length) {
+    ASSERT(handle_);
+
     char* p = (char*)buffer;
 
-    long n     = 0;
+    if (!handle_->canReadVectored()) {
+        long n     = 0;
+        long total = 0;
+
+        while (length > 0 && (n = read1(p, length)) > 0) {
+            length -= n;
+            total += n;
+            p += n;
+        }
+
+        statistics_.bytesDelivered_ += total;
+        return total > 0 ? total : n;
+    }
+
     long total = 0;
 
-    while (length > 0 && (n = read1(p, length)) > 0) {
-        length -= n;
+    // What is left from the last read-ahead
+    if (aheadPos_ < aheadLen_) {
+        long n = std::min(length, long(aheadLen_ - aheadPos_));
+        ::memcpy(p, ahead_ + aheadPos_, n);
+        aheadPos_ += n;
+        advance(n);
         total += n;
-        p += n;
     }
 
-    return total > 0 ? total : n;
+    if (total < length) {
+        const size_t ahead = readAhead();
+
+        if (size_t(length - total) >= ahead) {
+            // Large enough, straight into the caller's buffer
+            long n = scatter(p + total, length - total);
+            advance(n);
+            total += n;
+        }
+        else {
+            // Read-ahead, no more than what is left to read
+            size_t want   = 0;
+            long long pos = pos_;
+            for (Ordinal i = index_; i < offset_.size() && want < ahead; ++i, pos = 0) {
+                want += size_t((long long)length_[i] - pos);
+            }
+            want = std::min(want, ahead);
+
+            if (want > 0) {
+                if (ahead_.size() < want) {
+                    ahead_.resize(want);
+                }
+                aheadLen_ = size_t(scatter(ahead_, long(want)));
+                aheadPos_ = 0;
+
+                long n = std::min(length - total, long(aheadLen_));
+                ::memcpy(p + total, ahead_, n);
+                aheadPos_ = size_t(n);
+                advance(n);
+                total += n;
+            }
+        }
+    }
+
+    statistics_.bytesDelivered_ += total;
+    return total;
 }
 
 long PartFileHandle::write(const void*, long) {
@@ -169,11 +349,16 @@ void PartFileHandle::close() {
         // a multihandle that points many time to the same path
         // handle_.reset();
     }
+
+    // There may be many handles, e.g. in a MultiHandle
+    ahead_    = Buffer();
+    aheadPos_ = aheadLen_ = 0;
 }
 
 void PartFileHandle::rewind() {
-    pos_   = 0;
-    index_ = 0;
+    pos_      = 0;
+    index_    = 0;
+    aheadPos_ = aheadLen_ = 0;
 }
 
 void PartFileHandle::restartReadFrom(const Offset& from) {
@@ -286,6 +471,13 @@ std::string PartFileHandle::metricsTag() const {
     return PathName::metricsTag(path_);
 }
 
+void PartFileHandle::collectMetrics(const std::string& what) const {
+    DataHandle::collectMetrics(what);
+    Metrics::set(what + "_reads", statistics_.reads_);
+    Metrics::set(what + "_bytes_read", statistics_.bytesRead_);
+    Metrics::set(what + "_bytes_delivered", statistics_.bytesDelivered_);
+}
+
 //----------------------------------------------------------------------------------------------------------------------
 
 }  // namespace eckit
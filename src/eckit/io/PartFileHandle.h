@@ -20,6 +20,7 @@
 #include <memory>
 
 #include "eckit/filesystem/PathName.h"
+#include "eckit/io/Buffer.h"
 #include "eckit/io/DataHandle.h"
 #include "eckit/types/Types.h"
 
@@ -29,7 +30,23 @@ class PooledHandle;
 
 //----------------------------------------------------------------------------------------------------------------------
 
+/// Reads parts (offset, length) of a file, delivered in the order given.
+///
+/// On local files, the parts needed to fill a read() are sorted by offset and coalesced into runs when they are
+/// less than partFileHandleReadGap bytes apart; each run is read with a single preadv() straight into the caller's
+/// buffer (the gaps into a scratch buffer). Reads smaller than partFileHandleReadAhead are served from a buffer
+/// filled the same way, so many small parts still need few system calls.
+
 class PartFileHandle : public DataHandle {
+public:  // types
+    struct Statistics {
+        size_t reads_                      = 0;  // system calls
+        unsigned long long bytesRead_      = 0;  // including gaps
+        unsigned long long bytesDelivered_ = 0;
+
+        Statistics& operator+=(const Statistics&);
+    };
+
 public:  // methods
     PartFileHandle(const PathName&, const OffsetList&, const LengthList&);
     PartFileHandle(const PathName&, const Offset&, const Length&);
@@ -39,6 +56,8 @@ public:  // methods
 
     const PathName& path() const { return path_; }
 
+    const Statistics& statistics() const { return statistics_; }
+
     // -- Overridden methods
 
     // From DataHandle
@@ -67,7 +86,7 @@ public:  // methods
 
     std::string title() const override;
     std::string metricsTag() const override;
-
+    void collectMetrics(const std::string& what) const override;
 
     bool moveable() const override { return true; }
     DataHandle* clone() const override;
@@ -89,9 +108,18 @@ private:  // members
     OffsetList offset_;
     LengthList length_;
 
+    Buffer ahead_;
+    size_t aheadPos_;
+    size_t aheadLen_;
+
+    Statistics statistics_;
+
 private:  // methods
     long read1(char*, long);
 
+    long scatter(char*, long);
+    void advance(long);
+
     static ClassSpec classSpec_;
     static Reanimator<PartFileHandle> reanimator_;
 };
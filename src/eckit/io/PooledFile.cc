@@ -23,6 +23,7 @@
 #include "eckit/exception/Exceptions.h"
 #include "eckit/filesystem/PathName.h"
 #include "eckit/io/Buffer.h"
+#include "eckit/io/Prefetcher.h"
 #include "eckit/log/Bytes.h"
 
 namespace eckit {
@@ -142,6 +143,12 @@ public:
         s->second.opened_ = false;
     }
 
+    off_t position(const PooledFile* file) const {
+        auto s = statuses_.find(file);
+        ASSERT(s != statuses_.end());
+        return s->second.position_;
+    }
+
     int fileno(const PooledFile* file) const {
         auto s = statuses_.find(file);
         ASSERT(s != statuses_.end());
@@ -215,27 +222,68 @@ public:
 };
 
 
+static bool defaultPrefetch() {
+    static bool prefetch = Resource<bool>("pooledFilePrefetch;$ECKIT_POOLED_FILE_PREFETCH", false);
+    return prefetch;
+}
+
 PooledFile::PooledFile(const PathName& name) :
-    name_(name), entry_(Pool::instance().get(name)) {
+    name_(name),
+    entry_(Pool::instance().get(name)),
+    access_(AccessPattern::Normal),
+    prefetch_(defaultPrefetch()) {
 
     entry_->add(this);
 }
 
 PooledFile::~PooledFile() {
     ASSERT(entry_);
+    prefetcher_.reset();
     entry_->remove(this);
 }
 
 void PooledFile::open() {
     ASSERT(entry_);
     entry_->open(this);
+
+    if (prefetch_) {
+        static size_t depth = Resource<size_t>("pooledFilePrefetchDepth;$ECKIT_POOLED_FILE_PREFETCH_DEPTH", 8);
+
+        int fd = fileno();
+
+        Prefetcher::Action release;
+        if (access_ == AccessPattern::Sequential) {
+            release = [fd](off_t offset, size_t length) { AccessAdvice::dontNeed(fd, offset, length); };
+        }
+
+        prefetcher_.reset(new Prefetcher(
+            [fd](off_t offset, size_t length) { AccessAdvice::willNeed(fd, offset, length); }, depth, release));
+    }
 }
 
 void PooledFile::close() {
     ASSERT(entry_);
+    prefetcher_.reset();
     entry_->close(this);
 }
 
+void PooledFile::advise(AccessPattern access) {
+    access_ = access;
+    AccessAdvice::pattern(fileno(), access_);
+}
+
+void PooledFile::prefetch(bool on) {
+    prefetch_ = on;
+}
+
+void PooledFile::willNeed(off_t offset, size_t length) {
+    AccessAdvice::willNeed(fileno(), offset, length);
+}
+
+void PooledFile::dontNeed(off_t offset, size_t length) {
+    AccessAdvice::dontNeed(fileno(), offset, length);
+}
+
 off_t PooledFile::seek(off_t offset) {
     ASSERT(entry_);
     return entry_->seek(this, offset);
@@ -272,7 +320,16 @@ size_t PooledFile::nbSeeks() const {
 
 long PooledFile::read(void* buffer, long len) {
     ASSERT(entry_);
-    return entry_->read(this, buffer, len);
+    if (!prefetcher_) {
+        return entry_->read(this, buffer, len);
+    }
+
+    off_t position = entry_->position(this);
+    long n         = entry_->read(this, buffer, len);
+    if (n > 0) {
+        prefetcher_->observe(position, size_t(n));
+    }
+    return n;
 }
 
 PooledFileError::PooledFileError(const std::string& file, const std::string& msg, const CodeLocation& loc) :
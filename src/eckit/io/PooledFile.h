@@ -15,14 +15,23 @@
 #ifndef eckit_io_PooledFile_h
 #define eckit_io_PooledFile_h
 
+#include <memory>
+
 #include "eckit/exception/Exceptions.h"
 #include "eckit/filesystem/PathName.h"
+#include "eckit/io/AccessAdvice.h"
 #include "eckit/memory/NonCopyable.h"
 
 
 namespace eckit {
 
 class PoolFileEntry;
+class Prefetcher;
+
+/// Reads a file whose descriptor is shared between all the PooledFiles opened on the same path.
+///
+/// With pooledFilePrefetch ($ECKIT_POOLED_FILE_PREFETCH), the reads following a constant stride are prefetched into
+/// the page cache from a background thread.
 
 class PooledFile : private NonCopyable {
 public:
@@ -45,6 +54,22 @@ public:
 
     int fileno() const;
 
+    // Access hints
+
+    /// @pre opened
+    /// @note applies to the descriptor, so to all the PooledFiles on this path
+    void advise(AccessPattern);
+
+    /// Enables or disables the prefetching of strided reads, from the next open()
+    void prefetch(bool);
+
+    /// @pre opened
+    void willNeed(off_t offset, size_t length);
+    void dontNeed(off_t offset, size_t length);
+
+    /// @returns the prefetcher while open, if enabled
+    const Prefetcher* prefetcher() const { return prefetcher_.get(); }
+
     // for testing
 
     size_t nbOpens() const;
@@ -54,6 +79,10 @@ public:
 private:
     PathName name_;
     PoolFileEntry* entry_;
+
+    AccessPattern access_;
+    bool prefetch_;
+    std::unique_ptr<Prefetcher> prefetcher_;
 };
 
 
@@ -8,8 +8,14 @@
  * does it submit to any jurisdiction.
  */
 
+#include <fcntl.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include <cerrno>
 #include <cstdio>
 #include <memory>
+#include <sstream>
 #include <string>
 
 #include "eckit/config/LibEcKit.h"
@@ -17,6 +23,7 @@
 #include "eckit/exception/Exceptions.h"
 #include "eckit/filesystem/PathName.h"
 #include "eckit/io/Buffer.h"
+#include "eckit/io/FileHandle.h"
 #include "eckit/io/PooledHandle.h"
 #include "eckit/utils/MD5.h"
 
@@ -52,6 +59,9 @@ public:
 
     size_t count_;
 
+    // Descriptor for positional reads, opened on first use: -2 not tried, -1 not a local file
+    int fd_;
+
     std::map<const PooledHandle*, PoolHandleEntryStatus> statuses_;
 
     size_t nbOpens_  = 0;
@@ -61,7 +71,7 @@ public:
 
 public:
     explicit PoolHandleEntry(const PathName& path) :
-        path_(path), handle_(nullptr), count_(0) {}
+        path_(path), handle_(nullptr), count_(0), fd_(-2) {}
     ~PoolHandleEntry() { LOG_DEBUG_LIB(LibEcKit) << *this << std::endl; }
 
     friend std::ostream& operator<<(std::ostream& s, const PoolHandleEntry& e) {
@@ -80,6 +90,10 @@ public:
             handle_->close();
             handle_.reset();
         }
+        if (fd_ >= 0) {
+            ::close(fd_);
+        }
+        fd_ = -2;
     }
 
     void add(const PooledHandle* file) {
@@ -176,6 +190,40 @@ public:
         return n;
     }
 
+    bool canReadVectored(const PooledHandle* handle) {
+        auto s = statuses_.find(handle);
+        ASSERT(s != statuses_.end());
+        ASSERT(s->second.opened_);
+
+        if (fd_ == -2) {
+            fd_ = -1;
+            if (dynamic_cast<FileHandle*>(handle_.get())) {
+                fd_ = ::open(path_.localPath(), O_RDONLY | O_CLOEXEC);
+                if (fd_ < 0) {
+                    LOG_DEBUG_LIB(LibEcKit) << "PooledHandle: no vectored reads for " << path_ << Log::syserr
+                                            << std::endl;
+                }
+            }
+        }
+        return fd_ >= 0;
+    }
+
+    long readv(const PooledHandle* handle, const struct iovec* iov, int count, off_t offset) {
+        ASSERT(canReadVectored(handle));
+
+        ssize_t n;
+        while ((n = ::preadv(fd_, iov, count, offset)) < 0 && errno == EINTR) {}
+        if (n < 0) {
+            std::ostringstream s;
+            s << path_ << ": cannot read at " << offset;
+            throw ReadError(s.str());
+        }
+
+        nbReads_++;
+
+        return long(n);
+    }
+
     long seek(const PooledHandle* handle, Offset position) {
         auto s = statuses_.find(handle);
         ASSERT(s != statuses_.end());
@@ -263,6 +311,16 @@ long PooledHandle::read(void* buffer, long len) {
     return entry_->read(this, buffer, len);
 }
 
+bool PooledHandle::canReadVectored() {
+    ASSERT(entry_);
+    return entry_->canReadVectored(this);
+}
+
+long PooledHandle::readv(const struct iovec* iov, int count, const Offset& offset) {
+    ASSERT(entry_);
+    return entry_->readv(this, iov, count, off_t(offset));
+}
+
 void PooledHandle::hash(MD5& md5) const {
     md5 << "PooledHandle";
     md5 << std::string(entry_->path_);
@@ -20,6 +20,8 @@
 #include "eckit/io/DataHandle.h"
 
 
+struct iovec;
+
 namespace eckit {
 
 class PoolHandleEntry;
@@ -43,6 +45,13 @@ public:
     void hash(MD5& md5) const override;
     Offset position() override;
 
+    /// @returns true if readv() can be used, i.e. the file is local
+    bool canReadVectored();
+
+    /// Reads into the buffers of iov at the given offset of the file (preadv), independently of the position
+    /// @returns the bytes read, which may be fewer than requested
+    long readv(const struct iovec* iov, int count, const Offset&);
+
     // for testing
 
     size_t nbOpens() const;
@@ -0,0 +1,131 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+#include <algorithm>
+
+#include "eckit/exception/Exceptions.h"
+#include "eckit/io/Prefetcher.h"
+
+namespace eckit {
+
+//----------------------------------------------------------------------------------------------------------------------
+
+Prefetcher::Prefetcher(Action willNeed, size_t depth, Action dontNeed) :
+    willNeed_(std::move(willNeed)), dontNeed_(std::move(dontNeed)), depth_(depth) {
+    ASSERT(willNeed_);
+    ASSERT(depth_ > 0);
+    thread_ = std::thread([this] { run(); });
+}
+
+Prefetcher::~Prefetcher() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+    }
+    cond_.notify_one();
+    thread_.join();
+}
+
+void Prefetcher::observe(off_t offset, size_t length) {
+    if (length == 0) {
+        return;
+    }
+
+    off_t previous = last_;
+    off_t stride   = offset - previous;
+    bool follows   = previous >= 0 && stride > 0 && stride == stride_ && length == length_;
+
+    stride_ = previous >= 0 ? stride : 0;
+    last_   = offset;
+    length_ = length;
+
+    if (!follows) {
+        // A new pattern may start with the previous read
+        streak_   = 0;
+        ahead_    = 0;
+        released_ = stride_ > 0 ? previous : offset;
+        return;
+    }
+
+    streak_++;
+
+    // Ask for the reads up to depth strides ahead that were not asked for yet
+
+    off_t limit = offset + off_t(depth_) * stride_;
+    ahead_      = std::max(ahead_, offset + stride_);
+
+    if (stride_ == off_t(length_)) {
+        if (ahead_ <= limit) {
+            push(ahead_, size_t(limit - ahead_) + length_, false);
+            ahead_ = limit + stride_;
+        }
+
+        if (dontNeed_ && released_ < offset) {
+            push(released_, size_t(offset - released_), true);
+            released_ = offset;
+        }
+    }
+    else {
+        for (; ahead_ <= limit; ahead_ += stride_) {
+            push(ahead_, length_, false);
+        }
+    }
+}
+
+void Prefetcher::push(off_t offset, size_t length, bool release) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+
+        // The reader is ahead of the oldest requests, they would only compete with its reads
+        while (requests_.size() >= depth_) {
+            requests_.pop_front();
+            dropped_++;
+        }
+
+        requests_.push_back(Request{offset, length, release});
+    }
+    cond_.notify_one();
+}
+
+void Prefetcher::run() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    for (;;) {
+        cond_.wait(lock, [this] { return stop_ || !requests_.empty(); });
+        if (stop_) {
+            return;
+        }
+
+        Request r = requests_.front();
+        requests_.pop_front();
+
+        lock.unlock();
+        if (r.release_) {
+            dontNeed_(r.offset_, r.length_);
+        }
+        else {
+            willNeed_(r.offset_, r.length_);
+            issued_++;
+            bytes_ += r.length_;
+        }
+        lock.lock();
+    }
+}
+
+Prefetcher::Statistics Prefetcher::statistics() const {
+    Statistics s;
+    s.requests_ = issued_;
+    s.bytes_    = bytes_;
+    s.dropped_  = dropped_;
+    return s;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // namespace eckit
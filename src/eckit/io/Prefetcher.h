@@ -0,0 +1,107 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+#ifndef eckit_io_Prefetcher_h
+#define eckit_io_Prefetcher_h
+
+#include <sys/types.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+#include "eckit/memory/NonCopyable.h"
+
+namespace eckit {
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/// Watches the reads done on a file and, once they follow a constant forward stride (sequential reads being the
+/// stride equal to the length read), asks for the next ones ahead of time from a background thread.
+///
+/// The actions are typically AccessAdvice::willNeed and AccessAdvice::dontNeed on a descriptor or a mapping, they are
+/// called from the background thread and must not throw. Requests the thread has not reached yet when the reader
+/// runs further ahead are dropped.
+
+class Prefetcher : private NonCopyable {
+public:  // types
+    using Action = std::function<void(off_t offset, size_t length)>;
+
+    struct Statistics {
+        size_t requests_ = 0;  // willNeed calls
+        size_t bytes_    = 0;  // asked for by willNeed
+        size_t dropped_  = 0;  // requests not done in time
+    };
+
+public:  // methods
+    /// @param willNeed called for the ranges about to be read
+    /// @param depth number of reads predicted ahead
+    /// @param dontNeed if given, called for the ranges already read when reading sequentially
+    explicit Prefetcher(Action willNeed, size_t depth = 8, Action dontNeed = Action());
+
+    /// Stops the background thread, pending requests are dropped
+    ~Prefetcher();
+
+    /// Records a read of length bytes at offset
+    void observe(off_t offset, size_t length);
+
+    /// @returns true if the last reads follow a pattern
+    bool detected() const { return streak_ > 0; }
+
+    /// @returns the detected stride, 0 if none
+    off_t stride() const { return detected() ? stride_ : 0; }
+
+    Statistics statistics() const;
+
+private:  // types
+    struct Request {
+        off_t offset_;
+        size_t length_;
+        bool release_;
+    };
+
+private:  // methods
+    void push(off_t offset, size_t length, bool release);
+    void run();
+
+private:  // members
+    Action willNeed_;
+    Action dontNeed_;
+    size_t depth_;
+
+    // Pattern detection, only used by the reader
+    off_t last_     = -1;
+    off_t stride_   = 0;
+    size_t length_  = 0;
+    size_t streak_  = 0;  // reads following the stride
+    off_t ahead_    = 0;  // next predicted read not asked for yet
+    off_t released_ = 0;  // end of what was released
+
+    std::deque<Request> requests_;
+    bool stop_ = false;
+
+    std::atomic<size_t> issued_{0};
+    std::atomic<size_t> bytes_{0};
+    std::atomic<size_t> dropped_{0};
+
+    std::mutex mutex_;
+    std::condition_variable cond_;
+    std::thread thread_;
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // namespace eckit
+
+#endif
@@ -56,6 +56,10 @@ long InstantTCPSocketHandle::write(const void* buffer, long length) {
     return n;
 }
 
+int InstantTCPSocketHandle::fileDescriptor() const {
+    return connection_.socket();
+}
+
 void InstantTCPSocketHandle::close() {}
 
 void InstantTCPSocketHandle::rewind() {
@@ -52,6 +52,7 @@ public:
     void print(std::ostream&) const override;
     Offset seek(const Offset&) override;
     bool canSeek() const override { return true; }
+    int fileDescriptor() const override;
 
     // From Streamable
 
@@ -0,0 +1,376 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <exception>
+#include <mutex>
+#include <ostream>
+#include <thread>
+#include <utility>
+
+#include "eckit/container/Queue.h"
+#include "eckit/exception/Exceptions.h"
+#include "eckit/io/CompressedFrame.h"
+#include "eckit/io/TransferPipeline.h"
+#include "eckit/log/Bytes.h"
+#include "eckit/log/Log.h"
+#include "eckit/log/Progress.h"
+#include "eckit/log/Timer.h"
+#include "eckit/runtime/Metrics.h"
+#include "eckit/utils/Compressor.h"
+#include "eckit/utils/Hash.h"
+
+namespace eckit {
+
+//----------------------------------------------------------------------------------------------------------------------
+
+static_assert(CompressStage::headerSize == frame::headerSize, "CompressStage writes the frames of CompressedFrame.h");
+
+//----------------------------------------------------------------------------------------------------------------------
+
+PipelineStage::PipelineStage(size_t workers) :
+    workers_(workers) {
+    ASSERT(workers_ > 0);
+}
+
+PipelineStage::~PipelineStage() = default;
+
+//----------------------------------------------------------------------------------------------------------------------
+
+CompressStage::CompressStage(const std::string& compression, size_t workers) :
+    PipelineStage(workers), compression_(compression), compressor_(CompressorFactory::instance().build(compression)) {}
+
+CompressStage::~CompressStage() = default;
+
+void CompressStage::process(PipelineChunk& chunk) {
+    Buffer compressed;
+    size_t size = compressor_->compress(chunk.buffer_, chunk.size_, compressed);
+
+    Buffer framed(headerSize + size);
+    frame::encode(framed, size, chunk.size_);
+    ::memcpy(framed + headerSize, compressed, size);
+
+    chunk.buffer_ = std::move(framed);
+    chunk.size_   = headerSize + size;
+}
+
+void CompressStage::print(std::ostream& s) const {
+    s << "CompressStage[compression=" << compression_ << ",workers=" << workers() << "]";
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+UncompressStage::UncompressStage(const std::string& compression, size_t workers) :
+    PipelineStage(workers), compression_(compression), compressor_(CompressorFactory::instance().build(compression)) {}
+
+UncompressStage::~UncompressStage() = default;
+
+void UncompressStage::process(PipelineChunk& chunk) {
+    const size_t headerSize = CompressStage::headerSize;
+    ASSERT(chunk.size_ >= headerSize);
+
+    const char* data    = chunk.buffer_;
+    frame::Header sizes = frame::decode(data);
+    ASSERT(chunk.size_ == headerSize + sizes.compressed);
+
+    Buffer out(sizes.uncompressed);
+    compressor_->uncompress(data + headerSize, sizes.compressed, out, sizes.uncompressed);
+
+    chunk.buffer_ = std::move(out);
+    chunk.size_   = sizes.uncompressed;
+}
+
+void UncompressStage::print(std::ostream& s) const {
+    s << "UncompressStage[compression=" << compression_ << ",workers=" << workers() << "]";
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+HashStage::HashStage(const std::string& hash) :
+    PipelineStage(1), name_(hash), hash_(HashFactory::instance().build(hash)) {}
+
+HashStage::~HashStage() = default;
+
+void HashStage::process(PipelineChunk& chunk) {
+    hash_->add(static_cast<const void*>(chunk.buffer_), long(chunk.size_));
+}
+
+void HashStage::finish() {
+    digest_ = hash_->digest();
+}
+
+void HashStage::print(std::ostream& s) const {
+    s << "HashStage[hash=" << name_ << "]";
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+namespace {
+
+using Chunk      = std::unique_ptr<PipelineChunk>;
+using ChunkQueue = Queue<Chunk>;
+
+/// Keeps the first error, and interrupts everything waiting
+class PipelineErrors {
+public:
+    explicit PipelineErrors(std::vector<std::unique_ptr<ChunkQueue>>& queues) :
+        queues_(queues) {}
+
+    void fail(std::exception_ptr e) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (!error_) {
+                error_ = e;
+            }
+        }
+        failed_ = true;
+        for (auto& q : queues_) {
+            q->interrupt(e);
+        }
+        for (auto& w : waiting_) {
+            std::lock_guard<std::mutex> lock(*w.first);
+            w.second->notify_all();
+        }
+    }
+
+    bool failed() const { return failed_; }
+
+    void watch(std::mutex& m, std::condition_variable& c) { waiting_.emplace_back(&m, &c); }
+
+    void rethrow() {
+        if (error_) {
+            std::rethrow_exception(error_);
+        }
+    }
+
+private:
+    std::vector<std::unique_ptr<ChunkQueue>>& queues_;
+    std::vector<std::pair<std::mutex*, std::condition_variable*>> waiting_;
+    std::mutex mutex_;
+    std::exception_ptr error_;
+    std::atomic<bool> failed_{false};
+};
+
+/// Workers of a stage, putting the chunks back in order before the next queue
+class StageRunner {
+public:
+    StageRunner(PipelineStage& stage, ChunkQueue& in, ChunkQueue& out, PipelineErrors& errors) :
+        stage_(stage), in_(in), out_(out), errors_(errors), active_(stage.workers()) {
+        errors_.watch(mutex_, cond_);
+    }
+
+    void start(std::vector<std::thread>& threads) {
+        for (size_t i = 0; i < stage_.workers(); ++i) {
+            threads.emplace_back([this] { run(); });
+        }
+    }
+
+private:
+    void run() {
+        try {
+            Chunk chunk;
+            while (in_.pop(chunk) >= 0) {
+                stage_.process(*chunk);
+
+                std::unique_lock<std::mutex> lock(mutex_);
+                cond_.wait(lock, [this, &chunk] { return next_ == chunk->index_ || errors_.failed(); });
+                if (errors_.failed()) {
+                    break;
+                }
+                out_.emplace(std::move(chunk));
+                next_++;
+                cond_.notify_all();
+            }
+        }
+        catch (...) {
+            errors_.fail(std::current_exception());
+        }
+
+        bool last;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            last = --active_ == 0;
+        }
+
+        // Not under mutex_, which errors_.fail() takes to wake up the waiting workers
+        if (last && !errors_.failed()) {
+            try {
+                stage_.finish();
+                out_.close();
+            }
+            catch (...) {
+                errors_.fail(std::current_exception());
+            }
+        }
+    }
+
+    PipelineStage& stage_;
+    ChunkQueue& in_;
+    ChunkQueue& out_;
+    PipelineErrors& errors_;
+
+    std::mutex mutex_;
+    std::condition_variable cond_;
+    size_t next_ = 0;
+    size_t active_;
+};
+
+}  // namespace
+
+//----------------------------------------------------------------------------------------------------------------------
+
+TransferPipeline::TransferPipeline(size_t chunkSize, size_t depth, TransferWatcher& watcher) :
+    chunkSize_(chunkSize), depth_(depth), watcher_(watcher) {
+    ASSERT(chunkSize_ > 0);
+}
+
+TransferPipeline::~TransferPipeline() = default;
+
+TransferPipeline& TransferPipeline::add(PipelineStage* stage) {
+    ASSERT(stage);
+    if (stage->framed()) {
+        ASSERT_MSG(stages_.empty(), "TransferPipeline: a stage reading frames must come first");
+    }
+    stages_.emplace_back(stage);
+    return *this;
+}
+
+Length TransferPipeline::copy(DataHandle& in, DataHandle& out) {
+    Timer timer("Transfer pipeline");
+
+    inBytes_ = outBytes_ = 0;
+
+    const bool framed = !stages_.empty() && stages_.front()->framed();
+    const bool sized  = std::all_of(stages_.begin(), stages_.end(), [](const auto& s) { return s->preservesSize(); });
+
+    size_t widest = 1;
+    for (const auto& s : stages_) {
+        widest = std::max(widest, s->workers());
+    }
+    const size_t depth = depth_ > 0 ? depth_ : 2 * widest;
+
+    in.compress();
+
+    Length estimate = in.openForRead();
+    AutoClose closer1(in);
+    watcher_.fromHandleOpened();
+    out.openForWrite(sized ? estimate : Length(0));
+    AutoClose closer2(out);
+    watcher_.toHandleOpened();
+
+    Log::info() << "Transfer pipeline: " << stages_.size() << " stages, chunks of " << Bytes(chunkSize_) << std::endl;
+
+    std::vector<std::unique_ptr<ChunkQueue>> queues;
+    for (size_t i = 0; i <= stages_.size(); ++i) {
+        queues.emplace_back(new ChunkQueue(depth));
+    }
+
+    PipelineErrors errors(queues);
+
+    std::vector<std::unique_ptr<StageRunner>> runners;
+    for (size_t i = 0; i < stages_.size(); ++i) {
+        runners.emplace_back(new StageRunner(*stages_[i], *queues[i], *queues[i + 1], errors));
+    }
+
+    std::vector<std::thread> threads;
+
+    // Writer
+    threads.emplace_back([this, &out, &queues, &errors] {
+        try {
+            Chunk chunk;
+            while (queues.back()->pop(chunk) >= 0) {
+                if (out.write(chunk->buffer_, long(chunk->size_)) != long(chunk->size_)) {
+                    throw WriteError(out.name());
+                }
+                outBytes_ += chunk->size_;
+            }
+        }
+        catch (...) {
+            errors.fail(std::current_exception());
+        }
+    });
+
+    for (auto& r : runners) {
+        r->start(threads);
+    }
+
+    // Reader, in this thread
+    Progress progress("Reading data", 0, estimate);
+    double readTime = 0;
+    try {
+        for (size_t index = 0;; ++index) {
+            Chunk chunk(new PipelineChunk);
+            chunk->index_ = index;
+
+            double start = timer.elapsed();
+            if (framed) {
+                char header[frame::headerSize];
+                size_t n = frame::readFully(in, header, sizeof(header));
+                if (n == 0) {
+                    break;
+                }
+                if (n != sizeof(header)) {
+                    throw ReadError(in.name() + ": truncated frame header");
+                }
+
+                size_t size = frame::decode(header).compressed;
+                chunk->buffer_.resize(sizeof(header) + size);
+                ::memcpy(chunk->buffer_, header, sizeof(header));
+                if (frame::readFully(in, chunk->buffer_ + sizeof(header), size) != size) {
+                    throw ReadError(in.name() + ": truncated frame");
+                }
+                chunk->size_ = sizeof(header) + size;
+            }
+            else {
+                chunk->buffer_.resize(chunkSize_);
+                chunk->size_ = frame::readFully(in, chunk->buffer_, chunkSize_);
+                if (chunk->size_ == 0) {
+                    break;
+                }
+            }
+            readTime += timer.elapsed() - start;
+
+            watcher_.watch(chunk->buffer_, long(chunk->size_));
+            inBytes_ += chunk->size_;
+            progress(inBytes_);
+
+            queues.front()->emplace(std::move(chunk));
+        }
+        queues.front()->close();
+    }
+    catch (...) {
+        errors.fail(std::current_exception());
+    }
+
+    for (auto& t : threads) {
+        t.join();
+    }
+
+    errors.rethrow();
+
+    Log::info() << "Transfer pipeline: read " << Bytes(inBytes_) << ", wrote " << Bytes(outBytes_) << ", rate "
+                << Bytes(inBytes_, timer) << std::endl;
+
+    in.collectMetrics("source");
+    out.collectMetrics("target");
+    Metrics::set("size", inBytes_);
+    Metrics::set("read_time", readTime);
+    Metrics::set("time", timer.elapsed());
+
+    return outBytes_;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // namespace eckit
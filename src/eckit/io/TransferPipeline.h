@@ -0,0 +1,176 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+#ifndef eckit_io_TransferPipeline_h
+#define eckit_io_TransferPipeline_h
+
+#include <iosfwd>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "eckit/io/Buffer.h"
+#include "eckit/io/DataHandle.h"
+#include "eckit/io/Length.h"
+#include "eckit/io/TransferWatcher.h"
+#include "eckit/memory/NonCopyable.h"
+
+namespace eckit {
+
+class Compressor;
+class Hash;
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/// A chunk of the data going through a TransferPipeline
+struct PipelineChunk {
+    size_t index_ = 0;  // position in the stream, in chunks
+    Buffer buffer_;
+    size_t size_ = 0;  // bytes used in buffer_
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/// A step of a TransferPipeline, transforming each chunk of data.
+///
+/// With several workers, chunks are processed concurrently, in any order, and put back in order before the next
+/// stage. Stages that need to see the whole stream in order (e.g. hashing) have one worker.
+class PipelineStage : private NonCopyable {
+public:
+    explicit PipelineStage(size_t workers = 1);
+    virtual ~PipelineStage();
+
+    size_t workers() const { return workers_; }
+
+    /// Transforms a chunk, in place or by replacing its buffer
+    /// @note called concurrently if workers() > 1
+    virtual void process(PipelineChunk&) = 0;
+
+    /// If true, the stage must come first and gets whole frames of a CompressStage output
+    virtual bool framed() const { return false; }
+
+    /// If false, the output size differs from the input size, so it cannot be given to DataHandle::openForWrite
+    virtual bool preservesSize() const { return true; }
+
+    /// Called once the last chunk has been processed
+    virtual void finish() {}
+
+    virtual void print(std::ostream&) const = 0;
+
+    friend std::ostream& operator<<(std::ostream& s, const PipelineStage& p) {
+        p.print(s);
+        return s;
+    }
+
+private:
+    size_t workers_;
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/// Compresses each chunk independently, so it can be done in parallel.
+///
+/// Each chunk is written as a frame: the compressed and uncompressed sizes (8 bytes each, big-endian) followed by
+/// the compressed bytes, to be decoded by an UncompressStage.
+class CompressStage : public PipelineStage {
+public:
+    static constexpr size_t headerSize = 16;
+
+    CompressStage(const std::string& compression, size_t workers);
+    ~CompressStage() override;
+
+    void process(PipelineChunk&) override;
+    bool preservesSize() const override { return false; }
+    void print(std::ostream&) const override;
+
+private:
+    std::string compression_;
+    std::unique_ptr<Compressor> compressor_;
+};
+
+/// Decodes the frames written by a CompressStage, in parallel
+class UncompressStage : public PipelineStage {
+public:
+    UncompressStage(const std::string& compression, size_t workers);
+    ~UncompressStage() override;
+
+    void process(PipelineChunk&) override;
+    bool framed() const override { return true; }
+    bool preservesSize() const override { return false; }
+    void print(std::ostream&) const override;
+
+private:
+    std::string compression_;
+    std::unique_ptr<Compressor> compressor_;
+};
+
+/// Hashes the stream, leaving it unchanged
+class HashStage : public PipelineStage {
+public:
+    explicit HashStage(const std::string& hash);
+    ~HashStage() override;
+
+    void process(PipelineChunk&) override;
+    void finish() override;
+    void print(std::ostream&) const override;
+
+    /// @pre the transfer is finished
+    const std::string& digest() const { return digest_; }
+
+private:
+    std::string name_;
+    std::unique_ptr<Hash> hash_;
+    std::string digest_;
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/// Copies a DataHandle into another through a chain of stages, each running in its own threads and connected by
+/// bounded queues of chunks, so reading, writing and the CPU-heavy stages (compression, checksums) overlap.
+///
+/// The order of the data is preserved. Memory is bounded by about (stages + 2) * depth chunks, plus one chunk per
+/// worker.
+class TransferPipeline : private NonCopyable {
+public:
+    /// @param chunkSize bytes read from the input at a time
+    /// @param depth chunks queued between stages, 0 for twice the workers of the widest stage
+    TransferPipeline(size_t chunkSize = 4 * 1024 * 1024, size_t depth = 0,
+                     TransferWatcher& = TransferWatcher::dummy());
+
+    ~TransferPipeline();
+
+    /// Adds a stage, taking ownership; the data goes through the stages in the order they are added
+    TransferPipeline& add(PipelineStage*);
+
+    const PipelineStage& stage(size_t i) const { return *stages_.at(i); }
+    size_t stages() const { return stages_.size(); }
+
+    /// Opens, copies and closes the handles
+    /// @returns bytes written to out
+    Length copy(DataHandle& in, DataHandle& out);
+
+    Length bytesRead() const { return inBytes_; }
+    Length bytesWritten() const { return outBytes_; }
+
+private:
+    std::vector<std::unique_ptr<PipelineStage>> stages_;
+    size_t chunkSize_;
+    size_t depth_;
+    TransferWatcher& watcher_;
+
+    Length inBytes_;
+    Length outBytes_;
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // namespace eckit
+
+#endif
@@ -20,6 +20,7 @@ namespace eckit {
 
 struct DummyTransferWatcher : public TransferWatcher {
     void watch(const void*, long) {}
+    bool wantsData() const override { return false; }
 };
 
 TransferWatcher& TransferWatcher::dummy() {
@@ -27,6 +27,9 @@ public:
     // -- Methods
 
     virtual void watch(const void*, long) = 0;
+
+    /// If false, watch() may be given a null pointer and only the length, so the data can be moved in the kernel
+    virtual bool wantsData() const { return true; }
     virtual void restartFrom(const Offset&) {}
     virtual void fromHandleOpened() {}
     virtual void toHandleOpened() {}
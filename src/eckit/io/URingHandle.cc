@@ -0,0 +1,838 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+#include "eckit/eckit.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "eckit/config/Resource.h"
+#include "eckit/exception/Exceptions.h"
+#include "eckit/io/FDataSync.h"
+#include "eckit/io/URingHandle.h"
+#include "eckit/log/Bytes.h"
+#include "eckit/log/Log.h"
+#include "eckit/os/Stat.h"
+
+#if eckit_HAVE_IO_URING
+#include <linux/io_uring.h>
+#include <sys/syscall.h>
+#endif
+
+namespace eckit {
+
+//----------------------------------------------------------------------------------------------------------------------
+
+static constexpr size_t directAlignment = 4096;
+static constexpr size_t npos            = size_t(-1);
+
+/// Queue of reads and writes on the blocks of a URingHandle, identified by their index
+class URingQueue {
+public:
+    virtual ~URingQueue() = default;
+
+    virtual void read(size_t block, int fd, char* data, size_t length, off_t offset)  = 0;
+    virtual void write(size_t block, int fd, char* data, size_t length, off_t offset) = 0;
+
+    /// Submits the requests queued since the last call
+    virtual void submit() = 0;
+
+    /// Waits for a request to complete
+    /// @returns its block, and the bytes transferred or -errno
+    virtual std::pair<size_t, long> wait() = 0;
+
+    virtual bool uring() const = 0;
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+
+#if eckit_HAVE_IO_URING
+
+/// io_uring through the system calls, so there is no dependency on liburing
+class URing : public URingQueue {
+public:
+    /// @returns nullptr if the kernel does not provide io_uring, or it is not allowed, or it cannot read and write
+    static URing* make(unsigned entries, char* memory, size_t blockSize, size_t blocks) {
+        io_uring_params params;
+        ::memset(&params, 0, sizeof(params));
+
+        // Every handle would fall back for the same reason, so each warning is given once
+        static std::once_flag unavailable;
+        static std::once_flag unusable;
+
+        int fd = int(::syscall(__NR_io_uring_setup, entries, &params));
+        if (fd < 0) {
+            int error = errno;
+            std::call_once(unavailable, [error] {
+                Log::warning() << "URingHandle: io_uring not available, using threads: " << ::strerror(error)
+                               << std::endl;
+            });
+            return nullptr;
+        }
+
+        std::unique_ptr<URing> ring(new URing(fd, params, memory, blockSize, blocks));
+        if (!ring->usable()) {
+            std::call_once(unusable, [] {
+                Log::warning() << "URingHandle: io_uring cannot read or write, using threads" << std::endl;
+            });
+            return nullptr;
+        }
+
+        return ring.release();
+    }
+
+    void read(size_t block, int fd, char* data, size_t length, off_t offset) override {
+        prepare(registered_ ? IORING_OP_READ_FIXED : IORING_OP_READ, block, fd, data, length, offset);
+    }
+
+    void write(size_t block, int fd, char* data, size_t length, off_t offset) override {
+        prepare(registered_ ? IORING_OP_WRITE_FIXED : IORING_OP_WRITE, block, fd, data, length, offset);
+    }
+
+    void submit() override {
+        while (pending_ > 0) {
+            int n = enter(pending_, 0, 0);
+            if (n < 0) {
+                if (errno == EINTR || errno == EAGAIN) {
+                    continue;
+                }
+                throw FailedSystemCall("io_uring_enter");
+            }
+            pending_ -= unsigned(n);
+        }
+    }
+
+    std::pair<size_t, long> wait() override {
+        for (;;) {
+            unsigned head = *cqHead_;
+            if (head != __atomic_load_n(cqTail_, __ATOMIC_ACQUIRE)) {
+                const io_uring_cqe& cqe = cqes_[head & *cqMask_];
+                std::pair<size_t, long> result(size_t(cqe.user_data), long(cqe.res));
+                __atomic_store_n(cqHead_, head + 1, __ATOMIC_RELEASE);
+                return result;
+            }
+
+            int n = enter(pending_, 1, IORING_ENTER_GETEVENTS);
+            if (n < 0) {
+                if (errno == EINTR || errno == EAGAIN) {
+                    continue;
+                }
+                throw FailedSystemCall("io_uring_enter");
+            }
+            pending_ -= unsigned(n);
+        }
+    }
+
+    bool uring() const override { return true; }
+
+private:
+    /// Closes the ring
+    class Descriptor {
+    public:
+        explicit Descriptor(int fd) : fd_(fd) {}
+        ~Descriptor() { ::close(fd_); }
+
+        Descriptor(const Descriptor&)            = delete;
+        Descriptor& operator=(const Descriptor&) = delete;
+
+        operator int() const { return fd_; }
+
+    private:
+        int fd_;
+    };
+
+    /// A region of the ring shared with the kernel, unmapped on destruction
+    class Mapping {
+    public:
+        Mapping() = default;
+        ~Mapping() {
+            if (data_) {
+                ::munmap(data_, size_);
+            }
+        }
+
+        Mapping(const Mapping&)            = delete;
+        Mapping& operator=(const Mapping&) = delete;
+
+        char* map(int fd, size_t size, off_t offset) {
+            ASSERT(!data_);
+            void* p = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, offset);
+            if (p == MAP_FAILED) {
+                throw FailedSystemCall("mmap io_uring");
+            }
+            data_ = p;
+            size_ = size;
+            return static_cast<char*>(p);
+        }
+
+    private:
+        void* data_  = nullptr;
+        size_t size_ = 0;
+    };
+
+    URing(int fd, const io_uring_params& params, char* memory, size_t blockSize, size_t blocks) :
+        fd_(fd) {
+        size_t sqSize = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+        size_t cqSize = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+
+        const bool single = params.features & IORING_FEAT_SINGLE_MMAP;
+        if (single) {
+            sqSize = cqSize = std::max(sqSize, cqSize);
+        }
+
+        char* sq = sqRing_.map(fd_, sqSize, IORING_OFF_SQ_RING);
+        char* cq = single ? sq : cqRing_.map(fd_, cqSize, IORING_OFF_CQ_RING);
+
+        sqes_ = reinterpret_cast<io_uring_sqe*>(
+            sqesRing_.map(fd_, params.sq_entries * sizeof(io_uring_sqe), IORING_OFF_SQES));
+
+        sqTail_  = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+        sqMask_  = reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+        sqArray_ = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+
+        cqHead_  = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+        cqTail_  = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+        cqMask_  = reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+        cqes_    = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+
+        // Registered buffers save the kernel mapping them on each request, but count against RLIMIT_MEMLOCK
+        std::vector<iovec> iov(blocks);
+        for (size_t i = 0; i < blocks; ++i) {
+            iov[i].iov_base = memory + i * blockSize;
+            iov[i].iov_len  = blockSize;
+        }
+        registered_ =
+            ::syscall(__NR_io_uring_register, int(fd_), IORING_REGISTER_BUFFERS, iov.data(), unsigned(blocks)) == 0;
+        if (!registered_) {
+            Log::debug() << "URingHandle: buffers not registered" << Log::syserr << std::endl;
+        }
+    }
+
+    /// Registered buffers use the fixed opcodes, there since io_uring was added. The others came with Linux 5.6, as
+    /// did IORING_REGISTER_PROBE: if the probe fails, they are not there.
+    bool usable() const {
+        if (registered_) {
+            return true;
+        }
+
+        const unsigned ops = 256;
+        std::vector<char> buffer(sizeof(io_uring_probe) + ops * sizeof(io_uring_probe_op), 0);
+        auto* probe = reinterpret_cast<io_uring_probe*>(buffer.data());
+        if (::syscall(__NR_io_uring_register, int(fd_), IORING_REGISTER_PROBE, probe, ops) != 0) {
+            Log::debug() << "URingHandle: cannot probe io_uring" << Log::syserr << std::endl;
+            return false;
+        }
+
+        auto supported = [probe](unsigned op) {
+            return op <= probe->last_op && (probe->ops[op].flags & IO_URING_OP_SUPPORTED);
+        };
+        return supported(IORING_OP_READ) && supported(IORING_OP_WRITE);
+    }
+
+    int enter(unsigned submit, unsigned complete, unsigned flags) {
+        return int(::syscall(__NR_io_uring_enter, int(fd_), submit, complete, flags, nullptr, 0));
+    }
+
+    void prepare(unsigned op, size_t block, int fd, char* data, size_t length, off_t offset) {
+        // Only this thread produces, and there are never more requests in flight than entries
+        unsigned tail     = *sqTail_;
+        unsigned index    = tail & *sqMask_;
+        io_uring_sqe* sqe = &sqes_[index];
+
+        ::memset(sqe, 0, sizeof(*sqe));
+        sqe->opcode    = uint8_t(op);
+        sqe->fd        = fd;
+        sqe->addr      = reinterpret_cast<uint64_t>(data);
+        sqe->len       = unsigned(length);
+        sqe->off       = uint64_t(offset);
+        sqe->user_data = block;
+        if (registered_) {
+            sqe->buf_index = uint16_t(block);
+        }
+
+        sqArray_[index] = index;
+        __atomic_store_n(sqTail_, tail + 1, __ATOMIC_RELEASE);
+        pending_++;
+    }
+
+    // Declared first, so they are released if the constructor throws, and the ring is closed last
+    Descriptor fd_;
+    Mapping sqRing_;
+    Mapping cqRing_;
+    Mapping sqesRing_;
+
+    io_uring_sqe* sqes_ = nullptr;
+
+    unsigned* sqTail_  = nullptr;
+    unsigned* sqMask_  = nullptr;
+    unsigned* sqArray_ = nullptr;
+    unsigned* cqHead_  = nullptr;
+    unsigned* cqTail_  = nullptr;
+    unsigned* cqMask_  = nullptr;
+    io_uring_cqe* cqes_ = nullptr;
+
+    unsigned pending_ = 0;
+    bool registered_  = false;
+};
+
+#endif  // eckit_HAVE_IO_URING
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/// pread/pwrite on a few threads, where io_uring is not available
+class URingThreads : public URingQueue {
+public:
+    explicit URingThreads(size_t threads) {
+        for (size_t i = 0; i < threads; ++i) {
+            threads_.emplace_back([this] { run(); });
+        }
+    }
+
+    ~URingThreads() override {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stop_ = true;
+        }
+        ready_.notify_all();
+        for (auto& t : threads_) {
+            t.join();
+        }
+    }
+
+    void read(size_t block, int fd, char* data, size_t length, off_t offset) override {
+        queued_.push_back({block, fd, data, length, offset, false});
+    }
+
+    void write(size_t block, int fd, char* data, size_t length, off_t offset) override {
+        queued_.push_back({block, fd, data, length, offset, true});
+    }
+
+    void submit() override {
+        if (queued_.empty()) {
+            return;
+        }
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            requests_.insert(requests_.end(), queued_.begin(), queued_.end());
+        }
+        queued_.clear();
+        ready_.notify_all();
+    }
+
+    std::pair<size_t, long> wait() override {
+        std::unique_lock<std::mutex> lock(mutex_);
+        done_.wait(lock, [this] { return !completed_.empty(); });
+        auto result = completed_.front();
+        completed_.pop_front();
+        return result;
+    }
+
+    bool uring() const override { return false; }
+
+private:
+    struct Request {
+        size_t block_;
+        int fd_;
+        char* data_;
+        size_t length_;
+        off_t offset_;
+        bool write_;
+    };
+
+    void run() {
+        for (;;) {
+            Request r;
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                ready_.wait(lock, [this] { return stop_ || !requests_.empty(); });
+                if (requests_.empty()) {
+                    return;
+                }
+                r = requests_.front();
+                requests_.pop_front();
+            }
+
+            long result = transfer(r);
+
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                completed_.emplace_back(r.block_, result);
+            }
+            done_.notify_one();
+        }
+    }
+
+    static long transfer(const Request& r) {
+        size_t done = 0;
+        while (done < r.length_) {
+            ssize_t n = r.write_ ? ::pwrite(r.fd_, r.data_ + done, r.length_ - done, r.offset_ + done)
+                                 : ::pread(r.fd_, r.data_ + done, r.length_ - done, r.offset_ + done);
+            if (n < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                return -errno;
+            }
+            if (n == 0) {
+                break;
+            }
+            done += size_t(n);
+        }
+        return long(done);
+    }
+
+    std::vector<std::thread> threads_;
+    std::vector<Request> queued_;
+
+    std::mutex mutex_;
+    std::condition_variable ready_;
+    std::condition_variable done_;
+    std::deque<Request> requests_;
+    std::deque<std::pair<size_t, long>> completed_;
+    bool stop_ = false;
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+
+URingHandle::URingHandle(const PathName& path, size_t depth, size_t blockSize, bool direct, bool fsync) :
+    path_(path),
+    depth_(depth),
+    blockSize_(blockSize),
+    direct_(direct),
+    fsync_(fsync),
+    fd_(-1),
+    reading_(false),
+    memory_(nullptr),
+    next_(0),
+    fileSize_(0),
+    position_(0),
+    current_(npos),
+    cursor_(0) {
+    ASSERT(depth_ > 0);
+    ASSERT(blockSize_ > 0);
+    if (direct_) {
+        ASSERT(blockSize_ % directAlignment == 0);
+    }
+}
+
+URingHandle::~URingHandle() {
+    if (fd_ != -1) {
+        try {
+            close();
+        }
+        catch (std::exception& e) {
+            Log::error() << "** " << e.what() << " Caught in " << Here() << std::endl;
+            Log::error() << "** Exception is ignored" << std::endl;
+        }
+    }
+    queue_.reset();
+    ::free(memory_);
+}
+
+void URingHandle::start() {
+    if (!memory_) {
+        void* p = nullptr;
+        if (::posix_memalign(&p, directAlignment, depth_ * blockSize_) != 0) {
+            throw OutOfMemory();
+        }
+        memory_ = static_cast<char*>(p);
+
+        blocks_.resize(depth_);
+        for (size_t i = 0; i < depth_; ++i) {
+            blocks_[i].data_ = memory_ + i * blockSize_;
+        }
+    }
+
+    if (!queue_) {
+#if eckit_HAVE_IO_URING
+        static bool useURing = Resource<bool>("$ECKIT_IO_URING", true);
+        if (useURing) {
+            queue_.reset(URing::make(unsigned(depth_), memory_, blockSize_, depth_));
+        }
+#endif
+        if (!queue_) {
+            queue_.reset(new URingThreads(std::min<size_t>(depth_, 8)));
+        }
+    }
+
+    free_.clear();
+    for (size_t i = depth_; i > 0; --i) {
+        free_.push_back(i - 1);
+    }
+    order_.clear();
+
+    next_     = 0;
+    position_ = 0;
+    current_  = npos;
+    cursor_   = 0;
+}
+
+void URingHandle::open(int flags) {
+    ASSERT(fd_ == -1);
+
+#ifdef O_DIRECT
+    if (direct_) {
+        fd_ = ::open(path_.localPath(), flags | O_DIRECT, 0777);
+        if (fd_ < 0 && errno == EINVAL) {
+            Log::warning() << "URingHandle: " << path_ << " does not support O_DIRECT" << std::endl;
+        }
+    }
+#endif
+
+    if (fd_ < 0) {
+        SYSCALL2(fd_ = ::open(path_.localPath(), flags, 0777), path_);
+    }
+
+    start();
+}
+
+Length URingHandle::openForRead() {
+    open(O_RDONLY);
+    reading_ = true;
+
+    Stat::Struct info;
+    SYSCALL2(Stat::fstat(fd_, &info), path_);
+    fileSize_ = info.st_size;
+
+    while (!free_.empty() && next_ < fileSize_) {
+        size_t b = free_.back();
+        free_.pop_back();
+        submitRead(b);
+    }
+    queue_->submit();
+
+    return fileSize_;
+}
+
+void URingHandle::openForWrite(const Length&) {
+    open(O_WRONLY | O_CREAT | O_TRUNC);
+    reading_ = false;
+}
+
+void URingHandle::openForAppend(const Length&) {
+    open(O_WRONLY | O_CREAT);
+    reading_ = false;
+
+    SYSCALL2(next_ = ::lseek(fd_, 0, SEEK_END), path_);
+
+#ifdef O_DIRECT
+    if (next_ % directAlignment != 0) {
+        // Appending at an unaligned offset, so direct writes are not possible
+        int flags;
+        SYSCALL2(flags = ::fcntl(fd_, F_GETFL), path_);
+        SYSCALL2(::fcntl(fd_, F_SETFL, flags & ~O_DIRECT), path_);
+    }
+#endif
+}
+
+void URingHandle::submitRead(size_t b) {
+    Block& k     = blocks_[b];
+    k.offset_    = next_;
+    k.length_    = blockSize_;  // whole blocks, as direct reads must be aligned, shorter at the end of file
+    k.result_    = 0;
+    k.inFlight_  = true;
+    k.completed_ = false;
+
+    next_ += blockSize_;
+    order_.push_back(b);
+    queue_->read(b, fd_, k.data_, k.length_, k.offset_);
+}
+
+void URingHandle::submitWrite(size_t b) {
+    Block& k     = blocks_[b];
+    k.offset_    = next_;
+    k.result_    = 0;
+    k.inFlight_  = true;
+    k.completed_ = false;
+
+    next_ += k.length_;
+    order_.push_back(b);
+    queue_->write(b, fd_, k.data_, k.length_, k.offset_);
+}
+
+void URingHandle::complete() {
+    auto c       = queue_->wait();
+    Block& k     = blocks_[c.first];
+    k.result_    = c.second;
+    k.inFlight_  = false;
+    k.completed_ = true;
+}
+
+void URingHandle::wait(size_t b) {
+    while (!blocks_[b].completed_) {
+        complete();
+    }
+}
+
+long URingHandle::read(void* buffer, long length) {
+    ASSERT(reading_);
+
+    char* out = static_cast<char*>(buffer);
+    long done = 0;
+
+    while (done < length) {
+        if (current_ == npos || cursor_ == size_t(blocks_[current_].result_)) {
+
+            if (current_ != npos) {
+                free_.push_back(current_);
+                current_ = npos;
+
+                while (!free_.empty() && next_ < fileSize_) {
+                    size_t b = free_.back();
+                    free_.pop_back();
+                    submitRead(b);
+                }
+                queue_->submit();
+            }
+
+            if (order_.empty()) {
+                break;  // end of file
+            }
+
+            size_t b = order_.front();
+            order_.pop_front();
+            wait(b);
+
+            Block& k = blocks_[b];
+            if (k.result_ < 0) {
+                errno = int(-k.result_);
+                throw ReadError(std::string("URingHandle: ") + ::strerror(errno) + " reading " + path_.asString());
+            }
+
+            // A short read before the end of file, complete it
+            const long expected = long(std::min<off_t>(blockSize_, fileSize_ - k.offset_));
+            while (k.result_ < expected) {
+                ssize_t n;
+                SYSCALL2(n = ::pread(fd_, k.data_ + k.result_, expected - k.result_, k.offset_ + k.result_), path_);
+                if (n == 0) {
+                    break;
+                }
+                k.result_ += n;
+            }
+
+            current_ = b;
+            cursor_  = 0;
+            continue;
+        }
+
+        Block& k = blocks_[current_];
+        size_t n = std::min(size_t(length - done), size_t(k.result_) - cursor_);
+        ::memcpy(out + done, k.data_ + cursor_, n);
+        cursor_ += n;
+        done += long(n);
+    }
+
+    position_ += done;
+    return done;
+}
+
+void URingHandle::checkWritten(Block& k) {
+    if (k.result_ < 0) {
+        errno = int(-k.result_);
+        throw WriteError(std::string("URingHandle: ") + ::strerror(errno) + " writing " + path_.asString());
+    }
+
+    // A short write, complete it
+    while (size_t(k.result_) < k.length_) {
+        ssize_t n;
+        SYSCALL2(n = ::pwrite(fd_, k.data_ + k.result_, k.length_ - k.result_, k.offset_ + k.result_), path_);
+        if (n == 0) {
+            std::ostringstream os;
+            os << "URingHandle: only " << k.result_ << " bytes written instead of " << k.length_;
+            throw WriteError(os.str());
+        }
+        k.result_ += n;
+    }
+}
+
+size_t URingHandle::freeBlock() {
+    if (free_.empty()) {
+        size_t b = order_.front();
+        order_.pop_front();
+        wait(b);
+        checkWritten(blocks_[b]);
+        return b;
+    }
+
+    size_t b = free_.back();
+    free_.pop_back();
+    return b;
+}
+
+long URingHandle::write(const void* buffer, long length) {
+    ASSERT(!reading_);
+
+    const char* in = static_cast<const char*>(buffer);
+    long done      = 0;
+
+    while (done < length) {
+        if (current_ == npos) {
+            current_                  = freeBlock();
+            blocks_[current_].length_ = 0;
+        }
+
+        Block& k = blocks_[current_];
+        size_t n = std::min(size_t(length - done), blockSize_ - k.length_);
+        ::memcpy(k.data_ + k.length_, in + done, n);
+        k.length_ += n;
+        done += long(n);
+
+        if (k.length_ == blockSize_) {
+            submitWrite(current_);
+            queue_->submit();
+            current_ = npos;
+        }
+    }
+
+    position_ += done;
+    return done;
+}
+
+void URingHandle::drain() {
+    while (!order_.empty()) {
+        size_t b = order_.front();
+        order_.pop_front();
+        wait(b);
+        if (!reading_) {
+            checkWritten(blocks_[b]);
+        }
+        free_.push_back(b);
+    }
+}
+
+void URingHandle::flush() {
+    if (fd_ == -1 || reading_) {
+        return;
+    }
+
+    // A partial block is written now, unless it must wait to be completed for direct I/O
+    if (current_ != npos && blocks_[current_].length_ > 0) {
+        int flags = 0;
+        SYSCALL2(flags = ::fcntl(fd_, F_GETFL), path_);
+#ifdef O_DIRECT
+        const bool direct = flags & O_DIRECT;
+#else
+        const bool direct = false;
+#endif
+        if (!direct || blocks_[current_].length_ % directAlignment == 0) {
+            submitWrite(current_);
+            queue_->submit();
+            current_ = npos;
+        }
+    }
+
+    drain();
+
+    if (fsync_) {
+        SYSCALL2(eckit::fdatasync(fd_), path_);
+    }
+}
+
+void URingHandle::writeTail() {
+    if (current_ == npos || blocks_[current_].length_ == 0) {
+        return;
+    }
+
+#ifdef O_DIRECT
+    int flags;
+    SYSCALL2(flags = ::fcntl(fd_, F_GETFL), path_);
+    SYSCALL2(::fcntl(fd_, F_SETFL, flags & ~O_DIRECT), path_);
+#endif
+
+    Block& k  = blocks_[current_];
+    k.offset_ = next_;
+    k.result_ = 0;
+    checkWritten(k);
+
+    next_ += k.length_;
+    current_ = npos;
+
+    if (fsync_) {
+        SYSCALL2(eckit::fdatasync(fd_), path_);
+    }
+}
+
+void URingHandle::close() {
+    if (fd_ == -1) {
+        return;
+    }
+
+    if (reading_) {
+        drain();  // the kernel may still be writing into the blocks
+    }
+    else {
+        flush();
+        writeTail();
+    }
+
+    SYSCALL2(::close(fd_), path_);
+    fd_ = -1;
+}
+
+void URingHandle::rewind() {
+    ASSERT(reading_ && fd_ != -1);
+
+    drain();
+    start();
+
+    while (!free_.empty() && next_ < fileSize_) {
+        size_t b = free_.back();
+        free_.pop_back();
+        submitRead(b);
+    }
+    queue_->submit();
+}
+
+bool URingHandle::usingURing() const {
+    return queue_ && queue_->uring();
+}
+
+void URingHandle::print(std::ostream& s) const {
+    s << "URingHandle[path=" << path_ << ",depth=" << depth_ << ",blockSize=" << Bytes(blockSize_)
+      << ",direct=" << direct_ << ",uring=" << usingURing() << ']';
+}
+
+Length URingHandle::size() {
+    if (reading_ && fd_ != -1) {
+        return fileSize_;
+    }
+    Stat::Struct info;
+    SYSCALL2(Stat::stat(path_.localPath(), &info), path_);
+    return info.st_size;
+}
+
+Length URingHandle::estimate() {
+    return size();
+}
+
+Offset URingHandle::position() {
+    return position_;
+}
+
+std::string URingHandle::title() const {
+    return std::string("URing[") + PathName::shorten(path_) + "]";
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // namespace eckit
@@ -0,0 +1,121 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+#ifndef eckit_io_URingHandle_h
+#define eckit_io_URingHandle_h
+
+#include <deque>
+#include <memory>
+#include <vector>
+
+#include "eckit/filesystem/PathName.h"
+#include "eckit/io/DataHandle.h"
+
+namespace eckit {
+
+class URingQueue;
+
+/// Reads and writes a file with up to depth blocks in flight, so a single thread keeps fast devices busy.
+///
+/// Reads are issued ahead of the reader, writes are gathered into blocks and issued behind the writer. The blocks
+/// are allocated once, page aligned and registered with the kernel. Requests go through io_uring on Linux, or
+/// through a few threads doing pread/pwrite where io_uring is not available (older kernels, seccomp profiles), or
+/// if $ECKIT_IO_URING is 0.
+///
+/// With direct I/O the file is opened with O_DIRECT, bypassing the page cache: the block size must be a multiple
+/// of 4096, and the last partial block of a file is written without O_DIRECT.
+
+class URingHandle : public DataHandle {
+
+public:  // methods
+    URingHandle(const PathName& path, size_t depth = 32, size_t blockSize = 1024 * 1024, bool direct = false,
+                bool fsync = false);
+
+    ~URingHandle() override;
+
+    Length openForRead() override;
+    void openForWrite(const Length&) override;
+    void openForAppend(const Length&) override;
+
+    long read(void*, long) override;
+    long write(const void*, long) override;
+    void close() override;
+    void flush() override;
+    void rewind() override;
+    void print(std::ostream&) const override;
+
+    Length size() override;
+    Length estimate() override;
+    Offset position() override;
+
+    bool canSeek() const override { return false; }
+
+    /// @returns true if requests go through io_uring, false with the thread fallback (once opened)
+    bool usingURing() const;
+
+private:  // types
+    struct Block {
+        char* data_     = nullptr;
+        size_t length_  = 0;  // requested, or filled for writes
+        off_t offset_   = 0;
+        long result_    = 0;  // bytes transferred, or -errno
+        bool inFlight_  = false;
+        bool completed_ = false;
+    };
+
+private:  // methods
+    void open(int flags);
+    void start();
+
+    void submitRead(size_t block);
+    void submitWrite(size_t block);
+
+    /// Waits for the given block to complete
+    void wait(size_t block);
+
+    /// Waits for the next completion, whichever block it is
+    void complete();
+
+    void checkWritten(Block&);
+    size_t freeBlock();
+    void drain();
+    void writeTail();
+
+    std::string title() const override;
+
+private:  // members
+    PathName path_;
+
+    size_t depth_;
+    size_t blockSize_;
+    bool direct_;
+    bool fsync_;
+
+    int fd_;
+    bool reading_;
+
+    std::unique_ptr<URingQueue> queue_;
+    std::vector<Block> blocks_;
+    char* memory_;
+
+    std::deque<size_t> order_;  // blocks in file order, in flight or with data not yet read
+    std::vector<size_t> free_;
+
+    off_t next_;      // offset of the next block to request
+    off_t fileSize_;  // when reading
+    Offset position_;
+
+    size_t current_;  // block being read from, or written to
+    size_t cursor_;
+};
+
+}  // namespace eckit
+
+#endif
@@ -215,6 +215,22 @@ void SparseMatrix::reset() {
 
     spm_.reset();
     shape_.reset();
+    modified();
+}
+
+
+void SparseMatrix::modified() {
+    std::atomic_store(&derived_, std::shared_ptr<const Derived>());
+}
+
+
+std::shared_ptr<const SparseMatrix::Derived> SparseMatrix::derived() const {
+    return std::atomic_load(&derived_);
+}
+
+
+void SparseMatrix::derived(std::shared_ptr<const Derived> d) const {
+    std::atomic_store(&derived_, std::move(d));
 }
 
 
@@ -336,6 +352,7 @@ void SparseMatrix::swap(SparseMatrix& other) {
     std::swap(shape_, other.shape_);
 
     owner_.swap(other.owner_);
+    derived_.swap(other.derived_);
 }
 
 
@@ -353,6 +370,7 @@ const Index* SparseMatrix::outer() const {
 void SparseMatrix::cols(Size cols) {
     ASSERT(cols > 0);
     shape_.cols_ = cols;
+    modified();
 }
 
 
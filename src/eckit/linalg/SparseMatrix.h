@@ -221,6 +221,19 @@ public:
 
     const Allocator& owner() const;
 
+    // -- Derived data
+
+    /// Data derived from the matrix by a backend, such as a copy in another storage format
+    struct Derived {
+        virtual ~Derived() = default;
+    };
+
+    /// @returns data derived from the matrix, or nullptr if there is none or the matrix was modified since
+    std::shared_ptr<const Derived> derived() const;
+
+    /// Keeps data derived from the matrix with it, until the matrix is modified
+    void derived(std::shared_ptr<const Derived>) const;
+
     friend std::ostream& operator<<(std::ostream& os, const SparseMatrix& m) {
         m.print(os);
         return os;
@@ -279,18 +292,33 @@ public:  // iterators
     const_iterator begin() const { return {*this}; }
     const_iterator end() const { return {*this, rows()}; }
 
-    /// iterators to begin/end of row
-    iterator begin(Size row) { return {*this, row}; }
-    iterator end(Size row) { return {*this, row + 1}; }
+    /// iterators to begin/end of row (values may be modified, so derived data is dropped)
+    iterator begin(Size row) {
+        modified();
+        return {*this, row};
+    }
+    iterator end(Size row) {
+        modified();
+        return {*this, row + 1};
+    }
 
     /// const iterators to begin/end of matrix
-    iterator begin() { return {*this}; }
-    iterator end() { return {*this, rows()}; }
+    iterator begin() {
+        modified();
+        return {*this};
+    }
+    iterator end() {
+        modified();
+        return {*this, rows()};
+    }
 
 private:
     /// Resets the matrix to a deallocated state
     void reset();
 
+    /// Drops derived data
+    void modified();
+
     /// Serialise to a Stream
     void encode(Stream&) const;
 
@@ -304,6 +332,8 @@ private:
 
     std::unique_ptr<SparseMatrix::Allocator> owner_;  ///< Matrix memory manager/allocator
 
+    mutable std::shared_ptr<const Derived> derived_;  ///< Data derived by a backend (accessed atomically)
+
     friend Stream& operator<<(Stream&, const SparseMatrix&);
 };
 
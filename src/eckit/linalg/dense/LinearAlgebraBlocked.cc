@@ -0,0 +1,395 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation
+ * nor does it submit to any jurisdiction.
+ */
+
+
+#include "eckit/linalg/dense/LinearAlgebraBlocked.h"
+
+#include <algorithm>
+#include <ostream>
+#include <vector>
+
+#include "eckit/eckit_config.h"
+#include "eckit/exception/Exceptions.h"
+#include "eckit/linalg/Matrix.h"
+#include "eckit/linalg/Vector.h"
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define LINALG_BLOCKED_AVX2 1
+#include <immintrin.h>
+#else
+#define LINALG_BLOCKED_AVX2 0
+#endif
+
+namespace eckit::linalg::dense {
+
+static const LinearAlgebraBlocked __la_blocked("blocked");
+
+
+namespace {
+
+// Register tile of C, and the blocks of A (MC x KC, in L2) and B (KC x NC, in L3) packed for it
+constexpr Size MR = 8;
+constexpr Size NR = 4;
+constexpr Size MC = 128;
+constexpr Size KC = 256;
+constexpr Size NC = 2048;
+
+// Rows of y updated per pass of gemv, so they stay in L1
+constexpr Size GEMV_ROWS = 2048;
+
+
+struct Kernels {
+    const char* name;
+
+    /// Inner product of x and y of length n
+    Scalar (*dot)(const Scalar* x, const Scalar* y, Size n);
+
+    /// y[0..n) += A(0..n, 0..4) x[0..4), A with leading dimension lda
+    void (*gemv4)(const Scalar* a, Size lda, const Scalar* x, Scalar* y, Size n);
+
+    /// C(MR x NR) += A(MR x kc) B(kc x NR), from packed panels, C with leading dimension ldc
+    void (*tile)(Size kc, const Scalar* a, const Scalar* b, Scalar* c, Size ldc);
+};
+
+
+Scalar dotGeneric(const Scalar* x, const Scalar* y, Size n) {
+    Scalar s0 = 0.;
+    Scalar s1 = 0.;
+    Scalar s2 = 0.;
+    Scalar s3 = 0.;
+
+    Size i = 0;
+    for (; i + 4 <= n; i += 4) {
+        s0 += x[i] * y[i];
+        s1 += x[i + 1] * y[i + 1];
+        s2 += x[i + 2] * y[i + 2];
+        s3 += x[i + 3] * y[i + 3];
+    }
+    for (; i < n; ++i) {
+        s0 += x[i] * y[i];
+    }
+
+    return (s0 + s1) + (s2 + s3);
+}
+
+
+void gemv4Generic(const Scalar* a, Size lda, const Scalar* x, Scalar* y, Size n) {
+    const Scalar* a0 = a;
+    const Scalar* a1 = a + lda;
+    const Scalar* a2 = a + 2 * lda;
+    const Scalar* a3 = a + 3 * lda;
+
+    for (Size i = 0; i < n; ++i) {
+        y[i] += a0[i] * x[0] + a1[i] * x[1] + a2[i] * x[2] + a3[i] * x[3];
+    }
+}
+
+
+void tileGeneric(Size kc, const Scalar* a, const Scalar* b, Scalar* c, Size ldc) {
+    Scalar acc[NR][MR] = {};
+
+    for (Size p = 0; p < kc; ++p, a += MR, b += NR) {
+        for (Size j = 0; j < NR; ++j) {
+            for (Size i = 0; i < MR; ++i) {
+                acc[j][i] += a[i] * b[j];
+            }
+        }
+    }
+
+    for (Size j = 0; j < NR; ++j) {
+        for (Size i = 0; i < MR; ++i) {
+            c[j * ldc + i] += acc[j][i];
+        }
+    }
+}
+
+
+#if LINALG_BLOCKED_AVX2
+__attribute__((target("avx2,fma"))) Scalar dotAVX2(const Scalar* x, const Scalar* y, Size n) {
+    __m256d s0 = _mm256_setzero_pd();
+    __m256d s1 = _mm256_setzero_pd();
+    __m256d s2 = _mm256_setzero_pd();
+    __m256d s3 = _mm256_setzero_pd();
+
+    Size i = 0;
+    for (; i + 16 <= n; i += 16) {
+        s0 = _mm256_fmadd_pd(_mm256_loadu_pd(x + i), _mm256_loadu_pd(y + i), s0);
+        s1 = _mm256_fmadd_pd(_mm256_loadu_pd(x + i + 4), _mm256_loadu_pd(y + i + 4), s1);
+        s2 = _mm256_fmadd_pd(_mm256_loadu_pd(x + i + 8), _mm256_loadu_pd(y + i + 8), s2);
+        s3 = _mm256_fmadd_pd(_mm256_loadu_pd(x + i + 12), _mm256_loadu_pd(y + i + 12), s3);
+    }
+    for (; i + 4 <= n; i += 4) {
+        s0 = _mm256_fmadd_pd(_mm256_loadu_pd(x + i), _mm256_loadu_pd(y + i), s0);
+    }
+
+    alignas(32) Scalar s[4];
+    _mm256_store_pd(s, _mm256_add_pd(_mm256_add_pd(s0, s1), _mm256_add_pd(s2, s3)));
+
+    Scalar sum = (s[0] + s[1]) + (s[2] + s[3]);
+    for (; i < n; ++i) {
+        sum += x[i] * y[i];
+    }
+    return sum;
+}
+
+
+__attribute__((target("avx2,fma"))) void gemv4AVX2(const Scalar* a, Size lda, const Scalar* x, Scalar* y, Size n) {
+    const Scalar* a0 = a;
+    const Scalar* a1 = a + lda;
+    const Scalar* a2 = a + 2 * lda;
+    const Scalar* a3 = a + 3 * lda;
+
+    const __m256d x0 = _mm256_broadcast_sd(x);
+    const __m256d x1 = _mm256_broadcast_sd(x + 1);
+    const __m256d x2 = _mm256_broadcast_sd(x + 2);
+    const __m256d x3 = _mm256_broadcast_sd(x + 3);
+
+    Size i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m256d v = _mm256_loadu_pd(y + i);
+        v         = _mm256_fmadd_pd(_mm256_loadu_pd(a0 + i), x0, v);
+        v         = _mm256_fmadd_pd(_mm256_loadu_pd(a1 + i), x1, v);
+        v         = _mm256_fmadd_pd(_mm256_loadu_pd(a2 + i), x2, v);
+        v         = _mm256_fmadd_pd(_mm256_loadu_pd(a3 + i), x3, v);
+        _mm256_storeu_pd(y + i, v);
+    }
+    for (; i < n; ++i) {
+        y[i] += a0[i] * x[0] + a1[i] * x[1] + a2[i] * x[2] + a3[i] * x[3];
+    }
+}
+
+
+__attribute__((target("avx2,fma"))) void tileAVX2(Size kc, const Scalar* a, const Scalar* b, Scalar* c, Size ldc) {
+    static_assert(MR == 8 && NR == 4, "tileAVX2: register tile is 2 x 4 vectors of 4 doubles");
+
+    __m256d c00 = _mm256_setzero_pd();
+    __m256d c01 = _mm256_setzero_pd();
+    __m256d c10 = _mm256_setzero_pd();
+    __m256d c11 = _mm256_setzero_pd();
+    __m256d c20 = _mm256_setzero_pd();
+    __m256d c21 = _mm256_setzero_pd();
+    __m256d c30 = _mm256_setzero_pd();
+    __m256d c31 = _mm256_setzero_pd();
+
+    for (Size p = 0; p < kc; ++p, a += MR, b += NR) {
+        const __m256d a0 = _mm256_loadu_pd(a);
+        const __m256d a1 = _mm256_loadu_pd(a + 4);
+
+        __m256d bj = _mm256_broadcast_sd(b);
+        c00        = _mm256_fmadd_pd(a0, bj, c00);
+        c01        = _mm256_fmadd_pd(a1, bj, c01);
+
+        bj  = _mm256_broadcast_sd(b + 1);
+        c10 = _mm256_fmadd_pd(a0, bj, c10);
+        c11 = _mm256_fmadd_pd(a1, bj, c11);
+
+        bj  = _mm256_broadcast_sd(b + 2);
+        c20 = _mm256_fmadd_pd(a0, bj, c20);
+        c21 = _mm256_fmadd_pd(a1, bj, c21);
+
+        bj  = _mm256_broadcast_sd(b + 3);
+        c30 = _mm256_fmadd_pd(a0, bj, c30);
+        c31 = _mm256_fmadd_pd(a1, bj, c31);
+    }
+
+    _mm256_storeu_pd(c, _mm256_add_pd(_mm256_loadu_pd(c), c00));
+    _mm256_storeu_pd(c + 4, _mm256_add_pd(_mm256_loadu_pd(c + 4), c01));
+    c += ldc;
+    _mm256_storeu_pd(c, _mm256_add_pd(_mm256_loadu_pd(c), c10));
+    _mm256_storeu_pd(c + 4, _mm256_add_pd(_mm256_loadu_pd(c + 4), c11));
+    c += ldc;
+    _mm256_storeu_pd(c, _mm256_add_pd(_mm256_loadu_pd(c), c20));
+    _mm256_storeu_pd(c + 4, _mm256_add_pd(_mm256_loadu_pd(c + 4), c21));
+    c += ldc;
+    _mm256_storeu_pd(c, _mm256_add_pd(_mm256_loadu_pd(c), c30));
+    _mm256_storeu_pd(c + 4, _mm256_add_pd(_mm256_loadu_pd(c + 4), c31));
+}
+#endif
+
+
+const Kernels& kernels() {
+    static const Kernels generic{"generic", dotGeneric, gemv4Generic, tileGeneric};
+
+#if LINALG_BLOCKED_AVX2
+    static const Kernels avx2{"avx2", dotAVX2, gemv4AVX2, tileAVX2};
+    static const bool hasAVX2 = __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+    if (hasAVX2) {
+        return avx2;
+    }
+#endif
+
+    return generic;
+}
+
+
+/// Packs A(0..mc, 0..kc) into panels of MR rows, each stored k-major and padded with zeros
+void packA(const Scalar* a, Size lda, Size mc, Size kc, Scalar* packed) {
+    for (Size ir = 0; ir < mc; ir += MR) {
+        const Size mr = std::min(MR, mc - ir);
+        for (Size p = 0; p < kc; ++p) {
+            const Scalar* col = a + p * lda + ir;
+            Size i            = 0;
+            for (; i < mr; ++i) {
+                *packed++ = col[i];
+            }
+            for (; i < MR; ++i) {
+                *packed++ = 0.;
+            }
+        }
+    }
+}
+
+
+/// Packs B(0..kc, 0..nc) into panels of NR columns, each stored k-major and padded with zeros
+void packB(const Scalar* b, Size ldb, Size kc, Size nc, Scalar* packed) {
+    for (Size jr = 0; jr < nc; jr += NR) {
+        const Size nr = std::min(NR, nc - jr);
+        for (Size p = 0; p < kc; ++p) {
+            Size j = 0;
+            for (; j < nr; ++j) {
+                *packed++ = b[(jr + j) * ldb + p];
+            }
+            for (; j < NR; ++j) {
+                *packed++ = 0.;
+            }
+        }
+    }
+}
+
+
+/// C(0..mc, 0..nc) += packed A block x packed B block
+void macroKernel(const Kernels& k, Size mc, Size nc, Size kc, const Scalar* a, const Scalar* b, Scalar* c, Size ldc) {
+    Scalar edge[MR * NR];
+
+    for (Size jr = 0; jr < nc; jr += NR) {
+        const Size nr = std::min(NR, nc - jr);
+
+        for (Size ir = 0; ir < mc; ir += MR) {
+            const Size mr = std::min(MR, mc - ir);
+
+            const Scalar* ap = a + ir * kc;
+            const Scalar* bp = b + jr * kc;
+            Scalar* cp       = c + jr * ldc + ir;
+
+            if (mr == MR && nr == NR) {
+                k.tile(kc, ap, bp, cp, ldc);
+                continue;
+            }
+
+            // Partial tile at the edges of C
+            std::fill(edge, edge + MR * NR, 0.);
+            k.tile(kc, ap, bp, edge, MR);
+            for (Size j = 0; j < nr; ++j) {
+                for (Size i = 0; i < mr; ++i) {
+                    cp[j * ldc + i] += edge[j * MR + i];
+                }
+            }
+        }
+    }
+}
+
+}  // namespace
+
+
+void LinearAlgebraBlocked::print(std::ostream& out) const {
+    out << "LinearAlgebraBlocked[kernels=" << kernels().name << "]";
+}
+
+
+Scalar LinearAlgebraBlocked::dot(const Vector& x, const Vector& y) const {
+    const auto Ni = x.size();
+    ASSERT(y.size() == Ni);
+
+    return kernels().dot(x.data(), y.data(), Ni);
+}
+
+
+void LinearAlgebraBlocked::gemv(const Matrix& A, const Vector& x, Vector& y) const {
+    const auto Ni = A.rows();
+    const auto Nj = A.cols();
+
+    ASSERT(y.rows() == Ni);
+    ASSERT(x.rows() == Nj);
+
+    const auto& k    = kernels();
+    const Scalar* a  = A.data();
+    const Scalar* xp = x.data();
+    Scalar* yp       = y.data();
+
+    // A is column-major: accumulate y from columns of A, a block of rows of y at a time
+#if eckit_HAVE_OMP
+#pragma omp parallel for
+#endif
+    for (Size ib = 0; ib < Ni; ib += GEMV_ROWS) {
+        const Size n = std::min(GEMV_ROWS, Ni - ib);
+        Scalar* yb   = yp + ib;
+        std::fill(yb, yb + n, 0.);
+
+        Size j = 0;
+        for (; j + 4 <= Nj; j += 4) {
+            k.gemv4(a + j * Ni + ib, Ni, xp + j, yb, n);
+        }
+        for (; j < Nj; ++j) {
+            const Scalar* col = a + j * Ni + ib;
+            for (Size i = 0; i < n; ++i) {
+                yb[i] += col[i] * xp[j];
+            }
+        }
+    }
+}
+
+
+void LinearAlgebraBlocked::gemm(const Matrix& A, const Matrix& B, Matrix& C) const {
+    const auto Ni = A.rows();
+    const auto Nj = B.cols();
+    const auto Nk = A.cols();
+
+    ASSERT(C.rows() == Ni);
+    ASSERT(C.cols() == Nj);
+    ASSERT(B.rows() == Nk);
+
+    std::fill(C.begin(), C.end(), 0.);
+    if (Ni == 0 || Nj == 0 || Nk == 0) {
+        return;
+    }
+
+    const auto& k = kernels();
+
+    std::vector<Scalar> packedB(KC * ((std::min(NC, Nj) + NR - 1) / NR * NR));
+
+    for (Size jc = 0; jc < Nj; jc += NC) {
+        const Size nc = std::min(NC, Nj - jc);
+
+        for (Size pc = 0; pc < Nk; pc += KC) {
+            const Size kc = std::min(KC, Nk - pc);
+
+            packB(B.data() + jc * Nk + pc, Nk, kc, nc, packedB.data());
+
+#if eckit_HAVE_OMP
+#pragma omp parallel
+#endif
+            {
+                std::vector<Scalar> packedA(MC * KC);
+
+#if eckit_HAVE_OMP
+#pragma omp for
+#endif
+                for (Size ic = 0; ic < Ni; ic += MC) {
+                    const Size mc = std::min(MC, Ni - ic);
+
+                    packA(A.data() + pc * Ni + ic, Ni, mc, kc, packedA.data());
+                    macroKernel(k, mc, nc, kc, packedA.data(), packedB.data(), C.data() + jc * Ni + ic, Ni);
+                }
+            }
+        }
+    }
+}
+
+}  // namespace eckit::linalg::dense
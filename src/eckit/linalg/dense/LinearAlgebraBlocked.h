@@ -0,0 +1,34 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation
+ * nor does it submit to any jurisdiction.
+ */
+
+
+#pragma once
+
+#include "eckit/linalg/LinearAlgebraDense.h"
+
+namespace eckit::linalg::dense {
+
+/// Dense backend without external dependencies, for when no BLAS is available.
+///
+/// gemm packs cache-sized blocks of A and B into contiguous panels and computes C in register tiles (as GotoBLAS
+/// does); gemv and dot are unrolled over several accumulators. The kernels use AVX2/FMA where the CPU supports them,
+/// detected at run time, and portable C++ otherwise.
+struct LinearAlgebraBlocked final : public LinearAlgebraDense {
+    LinearAlgebraBlocked() {}
+    LinearAlgebraBlocked(const std::string& name) :
+        LinearAlgebraDense(name) {}
+
+    Scalar dot(const Vector&, const Vector&) const override;
+    void gemv(const Matrix&, const Vector&, Vector&) const override;
+    void gemm(const Matrix&, const Matrix&, Matrix&) const override;
+    void print(std::ostream&) const override;
+};
+
+}  // namespace eckit::linalg::dense
@@ -0,0 +1,372 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation
+ * nor does it submit to any jurisdiction.
+ */
+
+
+#include "eckit/linalg/sparse/LinearAlgebraSELL.h"
+
+#include <algorithm>
+#include <memory>
+#include <numeric>
+#include <ostream>
+#include <utility>
+#include <vector>
+
+#include "eckit/eckit.h"
+#include "eckit/exception/Exceptions.h"
+#include "eckit/linalg/Matrix.h"
+#include "eckit/linalg/SparseMatrix.h"
+#include "eckit/linalg/Vector.h"
+#include "eckit/linalg/sparse/LinearAlgebraGeneric.h"
+
+#if eckit_HAVE_OMP
+#include <omp.h>
+#endif
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define LINALG_SELL_AVX2 1
+#include <immintrin.h>
+#else
+#define LINALG_SELL_AVX2 0
+#endif
+
+namespace eckit::linalg::sparse {
+
+static const LinearAlgebraSELL __la_sell("sell");
+
+
+namespace {
+
+// Rows per slice, rows sorted by length per window, and right-hand side columns per pass of spmm
+constexpr Size SLICE = 8;  // the C of SELL-C-sigma
+constexpr Size SIGMA = 256;
+constexpr Size RHS   = 4;
+
+static_assert(SIGMA % SLICE == 0, "windows are whole slices");
+static_assert(sizeof(Index) == 4, "kernels gather with 32-bit indices");
+
+
+struct SELL final : SparseMatrix::Derived {
+    explicit SELL(const SparseMatrix&);
+
+    /// Slices [first, last) of part t of n, with about the same number of stored entries in each part
+    std::pair<Size, Size> part(Size t, Size n) const;
+
+    Size rows_;
+    Size slices_;
+    std::vector<Size> start_;  ///< offset of each slice in col_ and val_, sized slices_ + 1
+    std::vector<Size> row_;    ///< row of each slot of the slices, rows_ for padding
+    std::vector<Index> col_;   ///< column indices, per slice column by column, padded with 0
+    std::vector<Scalar> val_;  ///< values, as col_, padded with 0
+};
+
+
+SELL::SELL(const SparseMatrix& A) :
+    rows_(A.rows()), slices_((A.rows() + SLICE - 1) / SLICE) {
+    const auto* const outer = A.outerIndex();
+    const auto* const inner = A.inner();
+    const auto* const val   = A.data();
+
+    auto length = [outer](Size i) { return static_cast<Size>(outer[i + 1] - outer[i]); };
+
+    std::vector<Size> order(rows_);
+    std::iota(order.begin(), order.end(), 0);
+    for (Size w = 0; w < rows_; w += SIGMA) {
+        std::stable_sort(order.begin() + w, order.begin() + std::min(w + SIGMA, rows_),
+                         [&length](Size a, Size b) { return length(a) > length(b); });
+    }
+
+    row_.assign(slices_ * SLICE, rows_);
+    std::copy(order.begin(), order.end(), row_.begin());
+
+    start_.assign(slices_ + 1, 0);
+    for (Size s = 0; s < slices_; ++s) {
+        Size width = 0;
+        for (Size r = 0; r < SLICE && s * SLICE + r < rows_; ++r) {
+            width = std::max(width, length(row_[s * SLICE + r]));
+        }
+        start_[s + 1] = start_[s] + width * SLICE;
+    }
+
+    col_.assign(start_.back(), 0);
+    val_.assign(start_.back(), 0.);
+    for (Size s = 0; s < slices_; ++s) {
+        for (Size r = 0; r < SLICE && s * SLICE + r < rows_; ++r) {
+            const Size i = row_[s * SLICE + r];
+            for (Size k = 0, c = outer[i]; k < length(i); ++k, ++c) {
+                col_[start_[s] + k * SLICE + r] = inner[c];
+                val_[start_[s] + k * SLICE + r] = val[c];
+            }
+        }
+    }
+}
+
+
+std::pair<Size, Size> SELL::part(Size t, Size n) const {
+    auto boundary = [this, n](Size t) -> Size {
+        if (t == n) {
+            return slices_;
+        }
+        const Size target = start_.back() / n * t + start_.back() % n * t / n;
+        return std::lower_bound(start_.begin(), start_.end() - 1, target) - start_.begin();
+    };
+    return {boundary(t), boundary(t + 1)};
+}
+
+
+std::shared_ptr<const SELL> sell(const SparseMatrix& A) {
+    if (auto s = std::dynamic_pointer_cast<const SELL>(A.derived())) {
+        return s;
+    }
+
+    auto s = std::make_shared<const SELL>(A);
+    A.derived(s);
+    return s;
+}
+
+
+struct Kernels {
+    const char* name;
+
+    /// y[0..SLICE) = products of the rows of a slice of width w with x
+    void (*spmv)(const Index* col, const Scalar* val, Size w, const Scalar* x, Scalar* y);
+
+    /// y[j * SLICE + r] = products of the rows of a slice of width w with the RHS columns of b (leading dimension ldb)
+    void (*spmm)(const Index* col, const Scalar* val, Size w, const Scalar* b, Size ldb, Scalar* y);
+};
+
+
+void spmvGeneric(const Index* col, const Scalar* val, Size w, const Scalar* x, Scalar* y) {
+    Scalar acc[SLICE] = {};
+    for (Size k = 0; k < w; ++k, col += SLICE, val += SLICE) {
+        for (Size r = 0; r < SLICE; ++r) {
+            acc[r] += val[r] * x[col[r]];
+        }
+    }
+    std::copy(acc, acc + SLICE, y);
+}
+
+
+void spmmGeneric(const Index* col, const Scalar* val, Size w, const Scalar* b, Size ldb, Scalar* y) {
+    Scalar acc[RHS][SLICE] = {};
+    for (Size k = 0; k < w; ++k, col += SLICE, val += SLICE) {
+        for (Size j = 0; j < RHS; ++j) {
+            const Scalar* bj = b + j * ldb;
+            for (Size r = 0; r < SLICE; ++r) {
+                acc[j][r] += val[r] * bj[col[r]];
+            }
+        }
+    }
+    for (Size j = 0; j < RHS; ++j) {
+        std::copy(acc[j], acc[j] + SLICE, y + j * SLICE);
+    }
+}
+
+
+#if LINALG_SELL_AVX2
+__attribute__((target("avx2,fma"))) void spmvAVX2(const Index* col, const Scalar* val, Size w, const Scalar* x,
+                                                  Scalar* y) {
+    static_assert(SLICE == 8, "spmvAVX2: a slice is 2 vectors of 4 doubles");
+
+    __m256d acc0 = _mm256_setzero_pd();
+    __m256d acc1 = _mm256_setzero_pd();
+
+    for (Size k = 0; k < w; ++k, col += SLICE, val += SLICE) {
+        const __m128i c0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(col));
+        const __m128i c1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(col + 4));
+
+        acc0 = _mm256_fmadd_pd(_mm256_loadu_pd(val), _mm256_i32gather_pd(x, c0, 8), acc0);
+        acc1 = _mm256_fmadd_pd(_mm256_loadu_pd(val + 4), _mm256_i32gather_pd(x, c1, 8), acc1);
+    }
+
+    _mm256_storeu_pd(y, acc0);
+    _mm256_storeu_pd(y + 4, acc1);
+}
+
+
+__attribute__((target("avx2,fma"))) void spmmAVX2(const Index* col, const Scalar* val, Size w, const Scalar* b,
+                                                  Size ldb, Scalar* y) {
+    static_assert(SLICE == 8 && RHS == 4, "spmmAVX2: 4 columns of 2 vectors of 4 doubles");
+
+    const Scalar* b0 = b;
+    const Scalar* b1 = b + ldb;
+    const Scalar* b2 = b + 2 * ldb;
+    const Scalar* b3 = b + 3 * ldb;
+
+    __m256d acc00 = _mm256_setzero_pd();
+    __m256d acc01 = _mm256_setzero_pd();
+    __m256d acc10 = _mm256_setzero_pd();
+    __m256d acc11 = _mm256_setzero_pd();
+    __m256d acc20 = _mm256_setzero_pd();
+    __m256d acc21 = _mm256_setzero_pd();
+    __m256d acc30 = _mm256_setzero_pd();
+    __m256d acc31 = _mm256_setzero_pd();
+
+    for (Size k = 0; k < w; ++k, col += SLICE, val += SLICE) {
+        const __m128i c0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(col));
+        const __m128i c1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(col + 4));
+        const __m256d v0 = _mm256_loadu_pd(val);
+        const __m256d v1 = _mm256_loadu_pd(val + 4);
+
+        acc00 = _mm256_fmadd_pd(v0, _mm256_i32gather_pd(b0, c0, 8), acc00);
+        acc01 = _mm256_fmadd_pd(v1, _mm256_i32gather_pd(b0, c1, 8), acc01);
+        acc10 = _mm256_fmadd_pd(v0, _mm256_i32gather_pd(b1, c0, 8), acc10);
+        acc11 = _mm256_fmadd_pd(v1, _mm256_i32gather_pd(b1, c1, 8), acc11);
+        acc20 = _mm256_fmadd_pd(v0, _mm256_i32gather_pd(b2, c0, 8), acc20);
+        acc21 = _mm256_fmadd_pd(v1, _mm256_i32gather_pd(b2, c1, 8), acc21);
+        acc30 = _mm256_fmadd_pd(v0, _mm256_i32gather_pd(b3, c0, 8), acc30);
+        acc31 = _mm256_fmadd_pd(v1, _mm256_i32gather_pd(b3, c1, 8), acc31);
+    }
+
+    _mm256_storeu_pd(y, acc00);
+    _mm256_storeu_pd(y + 4, acc01);
+    _mm256_storeu_pd(y + 8, acc10);
+    _mm256_storeu_pd(y + 12, acc11);
+    _mm256_storeu_pd(y + 16, acc20);
+    _mm256_storeu_pd(y + 20, acc21);
+    _mm256_storeu_pd(y + 24, acc30);
+    _mm256_storeu_pd(y + 28, acc31);
+}
+#endif
+
+
+const Kernels& kernels() {
+    static const Kernels generic{"generic", spmvGeneric, spmmGeneric};
+
+#if LINALG_SELL_AVX2
+    static const Kernels avx2{"avx2", spmvAVX2, spmmAVX2};
+    static const bool hasAVX2 = __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+    if (hasAVX2) {
+        return avx2;
+    }
+#endif
+
+    return generic;
+}
+
+
+/// Calls f(first, last) on the slices of the part of the calling thread
+template <typename F>
+void parallel(const SELL& A, F f) {
+#if eckit_HAVE_OMP
+#pragma omp parallel
+    {
+        auto p = A.part(static_cast<Size>(omp_get_thread_num()), static_cast<Size>(omp_get_num_threads()));
+        f(p.first, p.second);
+    }
+#else
+    f(0, A.slices_);
+#endif
+}
+
+}  // namespace
+
+
+void LinearAlgebraSELL::print(std::ostream& out) const {
+    out << "LinearAlgebraSELL[C=" << SLICE << ",sigma=" << SIGMA << ",kernels=" << kernels().name << "]";
+}
+
+
+void LinearAlgebraSELL::spmv(const SparseMatrix& A, const Vector& x, Vector& y) const {
+    const auto Ni = A.rows();
+    const auto Nj = A.cols();
+
+    ASSERT(y.rows() == Ni);
+    ASSERT(x.rows() == Nj);
+
+    if (A.empty()) {
+        return;
+    }
+
+    ASSERT(A.outerIndex()[0] == 0);  // expect indices to be 0-based
+
+    const auto keep = sell(A);
+    const auto& S   = *keep;
+    const auto& k = kernels();
+
+    const Scalar* xp = x.data();
+    Scalar* yp       = y.data();
+
+    parallel(S, [&](Size first, Size last) {
+        Scalar result[SLICE];
+        for (Size s = first; s < last; ++s) {
+            const Size o = S.start_[s];
+            k.spmv(S.col_.data() + o, S.val_.data() + o, (S.start_[s + 1] - o) / SLICE, xp, result);
+
+            for (Size r = 0; r < SLICE; ++r) {
+                const Size i = S.row_[s * SLICE + r];
+                if (i < Ni) {
+                    yp[i] = result[r];
+                }
+            }
+        }
+    });
+}
+
+
+void LinearAlgebraSELL::spmm(const SparseMatrix& A, const Matrix& B, Matrix& C) const {
+    const auto Ni = A.rows();
+    const auto Nj = A.cols();
+    const auto Nk = B.cols();
+
+    ASSERT(C.rows() == Ni);
+    ASSERT(B.rows() == Nj);
+    ASSERT(C.cols() == Nk);
+
+    if (A.empty()) {
+        return;
+    }
+
+    ASSERT(A.outerIndex()[0] == 0);  // expect indices to be 0-based
+
+    const auto keep = sell(A);
+    const auto& S   = *keep;
+    const auto& k = kernels();
+
+    parallel(S, [&](Size first, Size last) {
+        Scalar result[RHS * SLICE];
+        for (Size s = first; s < last; ++s) {
+            const Size o     = S.start_[s];
+            const Size width = (S.start_[s + 1] - o) / SLICE;
+
+            Size j = 0;
+            for (; j + RHS <= Nk; j += RHS) {
+                k.spmm(S.col_.data() + o, S.val_.data() + o, width, B.data() + j * Nj, Nj, result);
+
+                for (Size jj = 0; jj < RHS; ++jj) {
+                    for (Size r = 0; r < SLICE; ++r) {
+                        const Size i = S.row_[s * SLICE + r];
+                        if (i < Ni) {
+                            C(i, j + jj) = result[jj * SLICE + r];
+                        }
+                    }
+                }
+            }
+
+            for (; j < Nk; ++j) {
+                k.spmv(S.col_.data() + o, S.val_.data() + o, width, B.data() + j * Nj, result);
+
+                for (Size r = 0; r < SLICE; ++r) {
+                    const Size i = S.row_[s * SLICE + r];
+                    if (i < Ni) {
+                        C(i, j) = result[r];
+                    }
+                }
+            }
+        }
+    });
+}
+
+
+void LinearAlgebraSELL::dsptd(const Vector& x, const SparseMatrix& A, const Vector& y, SparseMatrix& B) const {
+    static const sparse::LinearAlgebraGeneric generic;
+    generic.dsptd(x, A, y, B);
+}
+
+}  // namespace eckit::linalg::sparse
@@ -0,0 +1,39 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation
+ * nor does it submit to any jurisdiction.
+ */
+
+
+#pragma once
+
+#include "eckit/linalg/LinearAlgebraSparse.h"
+
+namespace eckit::linalg::sparse {
+
+/// Sparse backend converting matrices to SELL-C-sigma format for spmv/spmm.
+///
+/// Rows are sorted by length within windows of sigma rows, then stored in slices of C rows, each slice padded to its
+/// longest row and stored column by column, so the kernels process C rows at once with vector instructions (AVX2
+/// gathers where the CPU supports them, detected at run time). Slices are shared out over threads by number of
+/// stored entries, not rows, and spmm processes several columns of the right-hand side per pass.
+///
+/// The converted matrix is kept with the SparseMatrix (SparseMatrix::derived) and reused until the matrix is
+/// modified, so the first product with a matrix is slower than the following ones.
+/// @note values modified through const_cast of SparseMatrix::data() are not seen after the first product
+struct LinearAlgebraSELL final : public LinearAlgebraSparse {
+    LinearAlgebraSELL() {}
+    LinearAlgebraSELL(const std::string& name) :
+        LinearAlgebraSparse(name) {}
+
+    void spmv(const SparseMatrix&, const Vector&, Vector&) const override;
+    void spmm(const SparseMatrix&, const Matrix&, Matrix&) const override;
+    void dsptd(const Vector&, const SparseMatrix&, const Vector&, SparseMatrix&) const override;
+    void print(std::ostream&) const override;
+};
+
+}  // namespace eckit::linalg::sparse
@@ -0,0 +1,399 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+#include <pthread.h>
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+#include "eckit/config/Resource.h"
+#include "eckit/exception/Exceptions.h"
+#include "eckit/log/AsyncTarget.h"
+
+namespace eckit {
+
+//----------------------------------------------------------------------------------------------------------------------
+
+namespace {
+
+// Text not flushed by the channel is queued past this size
+constexpr size_t max_pending = 64 * 1024;
+
+size_t lines(const std::string& text) {
+    return std::max<size_t>(1, std::count(text.begin(), text.end(), '\n'));
+}
+
+/// Bounded multi-producer single-consumer ring: each cell carries a sequence number telling whether it is free for
+/// position p (sequence == p) or holds the entry of position p (sequence == p + 1), so producers only contend on the
+/// tail with a compare-and-swap, and the consumer on nothing.
+class AsyncQueue {
+public:
+    static AsyncQueue& instance() {
+        // Never deleted, the channels of other threads may still be writing at exit
+        static AsyncQueue* queue = new AsyncQueue();
+        return *queue;
+    }
+
+    /// @returns false if the entries have to be written synchronously
+    bool accepts() const { return !stopping_ && std::this_thread::get_id() != writer_; }
+
+    /// @returns the ticket of the entry, 0 if the queue is full. text is moved from on success only
+    size_t tryPush(LogTarget* target, std::string& text, bool flush) {
+        size_t pos = tail_.load(std::memory_order_relaxed);
+        Cell* cell;
+
+        for (;;) {
+            cell        = &cells_[pos & mask_];
+            size_t seq  = cell->sequence_.load(std::memory_order_acquire);
+            auto diff   = std::ptrdiff_t(seq) - std::ptrdiff_t(pos);
+            if (diff == 0) {
+                if (tail_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            }
+            else if (diff < 0) {
+                return 0;
+            }
+            else {
+                pos = tail_.load(std::memory_order_relaxed);
+            }
+        }
+
+        cell->target_ = target;
+        cell->text_   = std::move(text);
+        cell->flush_  = flush;
+        cell->sequence_.store(pos + 1, std::memory_order_seq_cst);
+
+        if (stopping_.load(std::memory_order_seq_cst)) {
+            // Passed accepts() as stop() began, the final batches may have missed the entry
+            late();
+        }
+        else if (sleeping_.load(std::memory_order_seq_cst)) {
+            wakeup();
+        }
+
+        return pos + 1;
+    }
+
+    /// Waits until the entry of the ticket is written
+    void wait(size_t ticket) {
+        if (std::this_thread::get_id() == writer_) {
+            return;
+        }
+        while (done_.load(std::memory_order_acquire) < ticket && !stopped_) {
+            wakeup();
+            backoff();
+        }
+    }
+
+    void backoff() { std::this_thread::sleep_for(std::chrono::microseconds(50)); }
+
+private:
+    struct Cell {
+        std::atomic<size_t> sequence_;
+        LogTarget* target_;
+        std::string text_;
+        bool flush_;
+    };
+
+    AsyncQueue() : head_(0), tail_(0), done_(0), sleeping_(false), stopping_(false), stopped_(false) {
+        static size_t size = Resource<size_t>("asyncLogQueueSize;$ECKIT_ASYNC_LOG_QUEUE_SIZE", 4096);
+
+        size_t capacity = 2;
+        while (capacity < size) {
+            capacity *= 2;
+        }
+
+        cells_.reset(new Cell[capacity]);
+        mask_ = capacity - 1;
+        for (size_t i = 0; i < capacity; ++i) {
+            cells_[i].sequence_.store(i, std::memory_order_relaxed);
+        }
+
+        thread_ = std::thread([this] { run(); });
+        writer_ = thread_.get_id();
+
+        ::atexit(&AsyncQueue::exiting);
+        ::pthread_atfork(&AsyncQueue::prepare, &AsyncQueue::parent, &AsyncQueue::child);
+    }
+
+    static void exiting() { instance().stop(); }
+
+    // The locks are taken over fork(), so that the child does not inherit them locked
+    static void prepare() {
+        instance().stopMutex_.lock();
+        instance().mutex_.lock();
+    }
+
+    static void parent() {
+        instance().mutex_.unlock();
+        instance().stopMutex_.unlock();
+    }
+
+    // The writer thread is not forked: the child writes its lines itself, and leaves those queued to the parent
+    static void child() {
+        AsyncQueue& queue = instance();
+        queue.stopping_   = true;
+        queue.stopped_    = true;
+        queue.mutex_.unlock();
+        queue.stopMutex_.unlock();
+    }
+
+    void stop() {
+        std::lock_guard<std::mutex> lock(stopMutex_);
+        if (stopped_) {
+            return;
+        }
+
+        stopping_ = true;
+        wakeup();
+        thread_.join();
+
+        // Pairs with the producers storing the sequence before looking at stopping_: those that saw it false have
+        // their entries written here, the others by late()
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        while (batch()) {
+        }
+        stopped_ = true;
+    }
+
+    /// Writes the entries pushed once stop() has begun, as soon as it is done
+    void late() {
+        std::lock_guard<std::mutex> lock(stopMutex_);
+        while (batch()) {
+        }
+    }
+
+    void wakeup() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        cv_.notify_one();
+    }
+
+    void run() {
+        for (;;) {
+            if (batch()) {
+                continue;
+            }
+
+            if (stopping_) {
+                return;
+            }
+
+            std::unique_lock<std::mutex> lock(mutex_);
+            sleeping_.store(true, std::memory_order_seq_cst);
+
+            // Pairs with the producers storing the sequence before looking at sleeping_
+            Cell& cell = cells_[head_ & mask_];
+            if (cell.sequence_.load(std::memory_order_seq_cst) != head_ + 1 && !stopping_) {
+                cv_.wait_for(lock, std::chrono::milliseconds(100));
+            }
+
+            sleeping_.store(false, std::memory_order_relaxed);
+        }
+    }
+
+    /// Writes what is queued, consecutive entries of a target are written at once
+    /// @returns the number of entries written
+    size_t batch() {
+        const size_t capacity = mask_ + 1;
+        const size_t start    = head_;
+
+        LogTarget* current = nullptr;
+        std::string text;
+        flushes_.clear();
+
+        while (head_ - start < capacity) {
+            Cell& cell = cells_[head_ & mask_];
+            if (cell.sequence_.load(std::memory_order_acquire) != head_ + 1) {
+                break;
+            }
+
+            LogTarget* target = cell.target_;
+            if (target != current) {
+                write(current, text);
+                current = target;
+                text.clear();
+            }
+
+            text += cell.text_;
+            cell.text_.clear();
+            if (cell.flush_ && std::find(flushes_.begin(), flushes_.end(), target) == flushes_.end()) {
+                flushes_.push_back(target);
+            }
+
+            // Free for the next round of the ring
+            cell.sequence_.store(head_ + capacity, std::memory_order_release);
+            head_++;
+        }
+
+        write(current, text);
+
+        for (LogTarget* target : flushes_) {
+            try {
+                target->flush();
+            }
+            catch (std::exception& e) {
+                std::cerr << "AsyncTarget: flush failed: " << e.what() << std::endl;
+            }
+        }
+
+        done_.store(head_, std::memory_order_release);
+
+        return head_ - start;
+    }
+
+    void write(LogTarget* target, const std::string& text) {
+        if (target && !text.empty()) {
+            try {
+                target->write(text.data(), text.data() + text.size());
+            }
+            catch (std::exception& e) {
+                std::cerr << "AsyncTarget: write failed: " << e.what() << std::endl;
+            }
+        }
+    }
+
+private:
+    std::unique_ptr<Cell[]> cells_;
+    size_t mask_;
+
+    size_t head_;  // only used by the writer
+    alignas(64) std::atomic<size_t> tail_;
+    alignas(64) std::atomic<size_t> done_;
+
+    std::vector<LogTarget*> flushes_;
+
+    std::atomic<bool> sleeping_;
+    std::atomic<bool> stopping_;
+    std::atomic<bool> stopped_;
+
+    std::mutex mutex_;
+    std::condition_variable cv_;
+
+    std::mutex stopMutex_;  // serialises the batches written once the writer thread is stopped
+
+    std::thread thread_;
+    std::thread::id writer_;
+};
+
+}  // namespace
+
+//----------------------------------------------------------------------------------------------------------------------
+
+AsyncTarget::AsyncTarget(LogTarget* target, Policy policy) :
+    target_(target), policy_(policy), unflushed_(false), ticket_(0), dropped_(0), reported_(0) {
+    ASSERT(target_);
+    target_->attach();
+}
+
+AsyncTarget::~AsyncTarget() {
+    try {
+        flush();
+        drain();
+    }
+    catch (std::exception& e) {
+        std::cerr << "AsyncTarget: " << e.what() << std::endl;
+    }
+    target_->detach();
+}
+
+AsyncTarget::Policy AsyncTarget::defaultPolicy() {
+    static std::string policy = Resource<std::string>("asyncLogPolicy;$ECKIT_ASYNC_LOG_POLICY", "block");
+    if (policy == "block") {
+        return Block;
+    }
+    if (policy == "drop") {
+        return Drop;
+    }
+    throw UserError("asyncLogPolicy must be 'block' or 'drop', not '" + policy + "'");
+}
+
+void AsyncTarget::write(const char* start, const char* end) {
+    if (start >= end) {
+        return;
+    }
+
+    pending_.append(start, end);
+    unflushed_ = true;
+
+    if (pending_.size() >= max_pending) {
+        push(false);
+    }
+}
+
+void AsyncTarget::flush() {
+    if (unflushed_) {
+        push(true);
+        unflushed_ = false;
+    }
+}
+
+void AsyncTarget::drain() {
+    if (ticket_) {
+        AsyncQueue::instance().wait(ticket_);
+    }
+}
+
+void AsyncTarget::push(bool flush) {
+    AsyncQueue& queue = AsyncQueue::instance();
+
+    std::string text;
+
+    size_t dropped = dropped_;
+    if (dropped > reported_) {
+        std::ostringstream oss;
+        oss << "AsyncTarget: " << (dropped - reported_) << " log lines dropped" << std::endl;
+        text = oss.str();
+    }
+    text += pending_;
+
+    while (queue.accepts()) {
+        if (size_t ticket = queue.tryPush(target_, text, flush)) {
+            ticket_   = ticket;
+            reported_ = dropped;
+            pending_.clear();
+            return;
+        }
+
+        if (policy_ == Drop) {
+            dropped_ += lines(pending_);
+            pending_.clear();
+            return;
+        }
+
+        queue.backoff();
+    }
+
+    // Called from the background thread itself, or at exit
+    target_->write(text.data(), text.data() + text.size());
+    if (flush) {
+        target_->flush();
+    }
+    reported_ = dropped;
+    pending_.clear();
+}
+
+void AsyncTarget::print(std::ostream& s) const {
+    s << "AsyncTarget(policy=" << (policy_ == Block ? "block" : "drop") << ", dropped=" << dropped_
+      << ", target=" << *target_ << ")";
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // namespace eckit
@@ -0,0 +1,83 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+/// @file AsyncTarget.h
+/// @date October 2026
+
+#ifndef eckit_log_AsyncTarget_h
+#define eckit_log_AsyncTarget_h
+
+#include <atomic>
+#include <string>
+
+#include "eckit/log/LogTarget.h"
+
+namespace eckit {
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/// Hands the text written to it to a background thread, which writes it to the wrapped target.
+///
+/// Text is kept until the channel flushes (usually at std::endl), then queued on a bounded lock-free ring shared by
+/// all the AsyncTargets of the process, so the calling thread neither writes nor waits for a lock. The background
+/// thread writes in batches and flushes each target once per batch. When the ring is full, lines are either dropped
+/// and counted, or the caller waits for room (see Policy, resources asyncLogPolicy and asyncLogQueueSize).
+///
+/// Like the other targets, an AsyncTarget is written to by a single channel, so by a single thread. Lines still
+/// queued are written before the target is destroyed and when the process exits; they are lost on a crash. A child
+/// process created by fork() has no background thread, it writes its lines synchronously.
+
+class AsyncTarget : public LogTarget {
+public:  // types
+    enum Policy
+    {
+        Block,  // wait for room in the queue
+        Drop    // drop the lines and count them
+    };
+
+public:  // methods
+    AsyncTarget(LogTarget* target, Policy policy = defaultPolicy());
+
+    ~AsyncTarget() override;
+
+    /// @returns the number of lines dropped so far
+    size_t dropped() const { return dropped_; }
+
+    /// Waits until all the lines queued so far are written to the wrapped target
+    void drain();
+
+    static Policy defaultPolicy();
+
+protected:
+    void print(std::ostream& s) const override;
+
+private:
+    void write(const char* start, const char* end) override;
+    void flush() override;
+
+    void push(bool flush);
+
+private:
+    LogTarget* target_;
+    Policy policy_;
+
+    std::string pending_;  // not queued yet
+    bool unflushed_;
+
+    size_t ticket_;  // of the last line queued
+    std::atomic<size_t> dropped_;
+    size_t reported_;  // dropped lines already noted in the output
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // namespace eckit
+
+#endif
@@ -0,0 +1,278 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+#include <sys/mman.h>
+#include <unistd.h>
+
+#if defined(__linux__)
+#include <sys/syscall.h>
+#endif
+
+#include <atomic>
+#include <cerrno>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+#include <ostream>
+#include <vector>
+
+#include "eckit/config/Resource.h"
+#include "eckit/exception/Exceptions.h"
+#include "eckit/log/Log.h"
+#include "eckit/memory/BufferAllocator.h"
+#include "eckit/runtime/Main.h"
+
+namespace eckit {
+
+//----------------------------------------------------------------------------------------------------------------------
+
+namespace {
+
+const size_t hugePageSize = 2 * 1024 * 1024;
+
+// From <numaif.h>, so we do not depend on libnuma
+const int mpolInterleave     = 3;
+const int mpolLocal          = 4;
+const int mpolFMemsAllowed   = 1 << 2;
+const unsigned long maxNodes = 1024;
+
+size_t roundUp(size_t size, size_t unit) {
+    return (size + unit - 1) / unit * unit;
+}
+
+size_t pageSize() {
+    static size_t size = size_t(::sysconf(_SC_PAGESIZE));
+    return size;
+}
+
+size_t alignment() {
+    if (!Main::ready()) {
+        return 4096;
+    }
+    static size_t align = Resource<size_t>("bufferAlignment;$ECKIT_BUFFER_ALIGNMENT", 4096);
+    return align;
+}
+
+/// Warns once per kind of problem, allocations keep going without the feature
+void warnOnce(std::atomic<bool>& warned, const std::string& what) {
+    if (!warned.exchange(true)) {
+        Log::warning() << "BufferAllocator: " << what << Log::syserr << ", continuing without" << std::endl;
+    }
+}
+
+BufferAllocator::Kind kindOf(const std::string& name) {
+    if (name == "standard" || name == "default") {
+        return BufferAllocator::Kind::Standard;
+    }
+    if (name == "aligned") {
+        return BufferAllocator::Kind::Aligned;
+    }
+    if (name == "thp") {
+        return BufferAllocator::Kind::TransparentHugePages;
+    }
+    if (name == "hugetlb") {
+        return BufferAllocator::Kind::HugeTLB;
+    }
+    throw BadValue("BufferAllocator: unknown allocation '" + name + "', expected standard, aligned, thp or hugetlb");
+}
+
+BufferAllocator::Numa numaOf(const std::string& name) {
+    if (name == "none") {
+        return BufferAllocator::Numa::None;
+    }
+    if (name == "local") {
+        return BufferAllocator::Numa::Local;
+    }
+    if (name == "interleave") {
+        return BufferAllocator::Numa::Interleave;
+    }
+    throw BadValue("BufferAllocator: unknown NUMA placement '" + name + "', expected none, local or interleave");
+}
+
+}  // namespace
+
+//----------------------------------------------------------------------------------------------------------------------
+
+BufferAllocator::BufferAllocator(Kind kind, Numa numa) :
+    kind_(kind), numa_(numa) {}
+
+const BufferAllocator& BufferAllocator::get(const std::string& kind, const std::string& numa) {
+    Kind k = kindOf(kind);
+    Numa n = numaOf(numa);
+
+    // One of each, never destroyed as buffers may outlive static destruction
+    static const std::vector<BufferAllocator*> all = [] {
+        std::vector<BufferAllocator*> v;
+        for (int i = 0; i < 4; ++i) {
+            for (int j = 0; j < 3; ++j) {
+                v.push_back(new BufferAllocator(Kind(i), Numa(j)));
+            }
+        }
+        return v;
+    }();
+
+    return *all[3 * int(k) + int(n)];
+}
+
+const BufferAllocator& BufferAllocator::standard() {
+    static const BufferAllocator& a = get("standard", "none");
+    return a;
+}
+
+const BufferAllocator& BufferAllocator::get(size_t size) {
+    // Resources are not available to buffers created before main()
+    if (!Main::ready()) {
+        return standard();
+    }
+
+    static size_t threshold = Resource<size_t>("bufferAllocationThreshold;$ECKIT_BUFFER_ALLOCATION_THRESHOLD",
+                                               1024 * 1024);
+    static const BufferAllocator& selected = get(Resource<std::string>("bufferAllocation;$ECKIT_BUFFER_ALLOCATION",
+                                                                       "standard"),
+                                                 Resource<std::string>("bufferNuma;$ECKIT_BUFFER_NUMA", "none"));
+
+    return size < threshold ? standard() : selected;
+}
+
+bool BufferAllocator::mapped() const {
+    return kind_ == Kind::TransparentHugePages || kind_ == Kind::HugeTLB || numa_ != Numa::None;
+}
+
+size_t BufferAllocator::mappedSize(size_t size) const {
+    if (kind_ == Kind::TransparentHugePages || kind_ == Kind::HugeTLB) {
+        return roundUp(size, hugePageSize);
+    }
+    return roundUp(size, pageSize());
+}
+
+char* BufferAllocator::map(size_t size) const {
+    const size_t length = mappedSize(size);
+    const int prot      = PROT_READ | PROT_WRITE;
+    const int flags     = MAP_PRIVATE | MAP_ANONYMOUS;
+
+#if defined(MAP_HUGETLB)
+    if (kind_ == Kind::HugeTLB) {
+        void* p = ::mmap(nullptr, length, prot, flags | MAP_HUGETLB, -1, 0);
+        if (p != MAP_FAILED) {
+            return static_cast<char*>(p);
+        }
+        static std::atomic<bool> warned{false};
+        warnOnce(warned, "cannot map reserved huge pages (see vm.nr_hugepages)");
+    }
+#endif
+
+    if (kind_ == Kind::Standard || kind_ == Kind::Aligned) {
+        void* p = ::mmap(nullptr, length, prot, flags, -1, 0);
+        if (p == MAP_FAILED) {
+            throw std::bad_alloc();
+        }
+        return static_cast<char*>(p);
+    }
+
+    // Over-map, then trim so that the region starts on a huge page boundary
+    void* p = ::mmap(nullptr, length + hugePageSize, prot, flags, -1, 0);
+    if (p == MAP_FAILED) {
+        throw std::bad_alloc();
+    }
+
+    char* start   = static_cast<char*>(p);
+    char* aligned = reinterpret_cast<char*>(roundUp(reinterpret_cast<uintptr_t>(start), hugePageSize));
+    if (aligned > start) {
+        ::munmap(start, size_t(aligned - start));
+    }
+    size_t tail = size_t(start + length + hugePageSize - (aligned + length));
+    if (tail) {
+        ::munmap(aligned + length, tail);
+    }
+
+#if defined(MADV_HUGEPAGE)
+    if (::madvise(aligned, length, MADV_HUGEPAGE) != 0) {
+        static std::atomic<bool> warned{false};
+        warnOnce(warned, "madvise(MADV_HUGEPAGE) failed");
+    }
+#endif
+
+    return aligned;
+}
+
+void BufferAllocator::place(char* p, size_t length) const {
+    if (numa_ == Numa::None) {
+        return;
+    }
+
+#if defined(__linux__) && defined(SYS_mbind) && defined(SYS_get_mempolicy)
+    unsigned long nodes[maxNodes / (8 * sizeof(unsigned long))] = {};
+    int mode = 0;
+
+    if (numa_ == Numa::Interleave) {
+        if (::syscall(SYS_get_mempolicy, &mode, nodes, maxNodes, nullptr, mpolFMemsAllowed) != 0) {
+            static std::atomic<bool> warned{false};
+            warnOnce(warned, "get_mempolicy failed");
+            return;
+        }
+    }
+
+    int policy = numa_ == Numa::Interleave ? mpolInterleave : mpolLocal;
+    if (::syscall(SYS_mbind, p, length, policy, numa_ == Numa::Interleave ? nodes : nullptr,
+                  numa_ == Numa::Interleave ? maxNodes : 0, 0) != 0) {
+        static std::atomic<bool> warned{false};
+        warnOnce(warned, "mbind failed");
+    }
+#else
+    static std::atomic<bool> warned{false};
+    warnOnce(warned, "NUMA placement is not supported on this platform");
+#endif
+}
+
+char* BufferAllocator::allocate(size_t size) const {
+    if (mapped() && size > 0) {
+        char* p = map(size);
+        place(p, mappedSize(size));
+        return p;
+    }
+
+    if (kind_ == Kind::Aligned) {
+        void* p = nullptr;
+        if (::posix_memalign(&p, alignment(), size ? size : 1) != 0) {
+            throw std::bad_alloc();
+        }
+        return static_cast<char*>(p);
+    }
+
+    return new char[size];
+}
+
+void BufferAllocator::deallocate(char* p, size_t size) const {
+    if (!p) {
+        return;
+    }
+
+    if (mapped() && size > 0) {
+        ::munmap(p, mappedSize(size));
+        return;
+    }
+
+    if (kind_ == Kind::Aligned) {
+        ::free(p);
+        return;
+    }
+
+    delete[] p;
+}
+
+void BufferAllocator::print(std::ostream& s) const {
+    static const char* kinds[] = {"standard", "aligned", "thp", "hugetlb"};
+    static const char* numas[] = {"none", "local", "interleave"};
+    s << "BufferAllocator[" << kinds[int(kind_)] << "," << numas[int(numa_)] << "]";
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // namespace eckit
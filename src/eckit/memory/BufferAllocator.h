@@ -0,0 +1,102 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+#ifndef eckit_memory_BufferAllocator_h
+#define eckit_memory_BufferAllocator_h
+
+#include <cstddef>
+#include <iosfwd>
+#include <string>
+
+#include "eckit/memory/NonCopyable.h"
+
+namespace eckit {
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/// How the memory of Buffer and MemoryBuffer is allocated.
+///
+/// The kinds of allocation are:
+///   - "standard":  new[]
+///   - "aligned":   aligned on bufferAlignment bytes ($ECKIT_BUFFER_ALIGNMENT, 4096)
+///   - "thp":       mapped on 2 MiB boundaries and advised to use transparent huge pages
+///   - "hugetlb":   mapped from the reserved huge pages (vm.nr_hugepages), or "thp" if there are not enough
+///
+/// and the placement on NUMA nodes, for mapped memory:
+///   - "none":       the first thread to touch a page decides
+///   - "local":      the node of the thread touching the page
+///   - "interleave": spread across the allowed nodes, page by page
+///
+/// Buffers of at least bufferAllocationThreshold bytes ($ECKIT_BUFFER_ALLOCATION_THRESHOLD, 1 MiB) are allocated as
+/// given by the resources bufferAllocation ($ECKIT_BUFFER_ALLOCATION, "standard") and bufferNuma
+/// ($ECKIT_BUFFER_NUMA, "none"). Smaller buffers always use new[].
+///
+/// Where huge pages or NUMA policies are not supported, the memory is still allocated, without them.
+
+class BufferAllocator : private NonCopyable {
+public:  // types
+    enum class Kind
+    {
+        Standard,
+        Aligned,
+        TransparentHugePages,
+        HugeTLB
+    };
+
+    enum class Numa
+    {
+        None,
+        Local,
+        Interleave
+    };
+
+public:  // methods
+    /// @returns the allocator selected by the resources for a buffer of this size
+    static const BufferAllocator& get(size_t size);
+
+    /// @returns the allocator of that kind and NUMA placement, by name (e.g. "thp", "interleave")
+    /// @throws BadValue for unknown names
+    static const BufferAllocator& get(const std::string& kind, const std::string& numa = "none");
+
+    static const BufferAllocator& standard();
+
+    char* allocate(size_t) const;
+    void deallocate(char*, size_t) const;
+
+    Kind kind() const { return kind_; }
+    Numa numa() const { return numa_; }
+
+    /// @returns true if the memory is mapped, and so starts on a page boundary
+    bool mapped() const;
+
+    void print(std::ostream&) const;
+
+    friend std::ostream& operator<<(std::ostream& s, const BufferAllocator& a) {
+        a.print(s);
+        return s;
+    }
+
+private:  // methods
+    BufferAllocator(Kind, Numa);
+
+    size_t mappedSize(size_t) const;
+    char* map(size_t) const;
+    void place(char*, size_t) const;
+
+private:  // members
+    Kind kind_;
+    Numa numa_;
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // namespace eckit
+
+#endif
@@ -11,6 +11,7 @@
 #include <cstring>
 
 #include "eckit/exception/Exceptions.h"
+#include "eckit/memory/BufferAllocator.h"
 #include "eckit/memory/MemoryBuffer.h"
 
 namespace eckit {
@@ -18,18 +19,18 @@ namespace eckit {
 //----------------------------------------------------------------------------------------------------------------------
 
 MemoryBuffer::MemoryBuffer(size_t size) :
-    buffer_(0), size_(size) {
+    buffer_(0), size_(size), allocator_(0) {
     create();
 }
 
 MemoryBuffer::MemoryBuffer(const char* p, size_t size) :
-    buffer_(0), size_(size) {
+    buffer_(0), size_(size), allocator_(0) {
     create();
     copy(p, size);
 }
 
 MemoryBuffer::MemoryBuffer(const std::string& s) :
-    buffer_(0), size_(s.length() + 1) {
+    buffer_(0), size_(s.length() + 1), allocator_(0) {
     create();
     copy(s);
 }
@@ -40,13 +41,16 @@ MemoryBuffer::~MemoryBuffer() {
 }
 
 void MemoryBuffer::create() {
-    buffer_ = new char[size_];
+    allocator_ = &BufferAllocator::get(size_);
+    buffer_    = allocator_->allocate(size_);
     ASSERT(buffer_);
 }
 
 void MemoryBuffer::destroy() {
-    char* p = static_cast<char*>(buffer_);
-    delete[] p;
+    if (allocator_) {
+        allocator_->deallocate(static_cast<char*>(buffer_), size_);
+    }
+    buffer_ = 0;
 }
 
 void MemoryBuffer::copy(const std::string& s) {
@@ -60,6 +64,7 @@ void MemoryBuffer::copy(const char* p, size_t size) {
 void MemoryBuffer::swap(MemoryBuffer& rhs) {
     std::swap(buffer_, rhs.buffer_);
     std::swap(size_, rhs.size_);
+    std::swap(allocator_, rhs.allocator_);
 }
 
 void eckit::MemoryBuffer::resize(size_t size) {
@@ -23,9 +23,11 @@
 
 namespace eckit {
 
+class BufferAllocator;
+
 //----------------------------------------------------------------------------------------------------------------------
 
-// A simple class to implement buffers
+// A simple class to implement buffers, large ones are allocated as configured for BufferAllocator
 
 class MemoryBuffer : private NonCopyable {
 
@@ -61,6 +63,7 @@ protected:  // methods
 private:  // members
     void* buffer_;
     size_t size_;
+    const BufferAllocator* allocator_;
 };
 
 //----------------------------------------------------------------------------------------------------------------------
@@ -8,18 +8,62 @@
  * does it submit to any jurisdiction.
  */
 
+#include <cerrno>
+
+#include "eckit/config/Resource.h"
+#include "eckit/exception/Exceptions.h"
+#include "eckit/log/Log.h"
 #include "eckit/net/TCPStream.h"
 
 namespace eckit::net {
 
+namespace {
+
+void flushQuietly(Stream& s) {
+    try {
+        s.flush();
+    }
+    catch (std::exception& e) {
+        Log::error() << "** " << e.what() << " Caught in " << Here() << std::endl;
+        Log::error() << "** Exception is ignored" << std::endl;
+    }
+}
+
+}  // namespace
+
 TCPStream::TCPStream(net::TCPSocket& socket) :
-    socket_(socket) {}
+    socket_(socket) {
+    static size_t bufferSize = Resource<size_t>("tcpStreamBufferSize;$ECKIT_TCP_STREAM_BUFFER_SIZE", 0);
+    if (bufferSize) {
+        writeBufferSize(bufferSize);
+        readBufferSize(bufferSize);
+    }
+}
 
-TCPStream::~TCPStream() {}
+TCPStream::~TCPStream() {
+    flushQuietly(*this);
+}
 
 void TCPStream::closeOutput() {
+    flush();
     socket_.closeOutput();
 }
+
+InstantTCPStream::~InstantTCPStream() {
+    flushQuietly(*this);
+}
+
+long TCPStreamBase::readSome(void* buf, long len) {
+    long n;
+    while ((n = socket().rawRead(buf, len)) < 0 && errno == EINTR) {
+        ;
+    }
+    if (n < 0) {
+        Log::error() << "Socket read failed (" << socket() << ")" << Log::syserr << std::endl;
+    }
+    return n;
+}
+
 //----------------------------------------------------------------------------------------------------------------------
 // Tricky solution to be removed when 'mutable' is available
 //
@@ -34,6 +34,8 @@ public:
 
     long read(void* buf, long len) override { return socket().read(buf, len); }
 
+    long readSome(void* buf, long len) override;
+
 protected:
     std::string name() const override;
 
@@ -45,11 +47,15 @@ private:  // methods
 
 //----------------------------------------------------------------------------------------------------------------------
 
+/// Owns its socket. Buffering is set from the resource tcpStreamBufferSize ($ECKIT_TCP_STREAM_BUFFER_SIZE), 0 by
+/// default as reading ahead is only safe if nothing else reads from the socket.
+
 class TCPStream : public TCPStreamBase {
 public:
     /// @note Takes ownership of TCPSocket;
     TCPStream(net::TCPSocket&);
 
+    /// Flushes the buffered writes, if any
     ~TCPStream() override;
 
     TCPSocket& socket() override { return socket_; }
@@ -72,6 +78,9 @@ public:
     InstantTCPStream(net::TCPSocket& socket) :
         socket_(socket) {}
 
+    /// Flushes the buffered writes, if any
+    ~InstantTCPStream() override;
+
     TCPSocket& socket() override { return socket_; }
 
 private:
@@ -13,6 +13,7 @@
 
 #include "eckit/eckit.h"
 
+#include "eckit/config/Resource.h"
 #include "eckit/io/FDataSync.h"
 #include "eckit/exception/Exceptions.h"
 #include "eckit/log/Log.h"
@@ -22,7 +23,15 @@ namespace eckit {
 
 
 FileStream::FileStream(const PathName& name, const char* mode) :
-    file_(name.localPath(), mode), read_(std::string(mode) == "r"), name_(name) {}
+    file_(name.localPath(), mode), read_(std::string(mode) == "r"), name_(name) {
+    static size_t bufferSize = Resource<size_t>("fileStreamBufferSize;$ECKIT_FILE_STREAM_BUFFER_SIZE", 64 * 1024);
+    if (read_) {
+        readBufferSize(bufferSize);
+    }
+    else {
+        writeBufferSize(bufferSize);
+    }
+}
 
 FileStream::~FileStream() {
     ASSERT_MSG(!file_.isOpen(), "FileStream being destructed is still open");
@@ -30,6 +39,8 @@ FileStream::~FileStream() {
 
 void FileStream::close() {
     if (!read_) {
+        flush();
+
         if (::fflush(file_)) {
             throw WriteError(std::string("FileStream::~FileStream(fflush(") + name_ + "))");
         }
@@ -91,6 +102,8 @@ std::string FileStream::name() const {
 }
 
 void FileStream::rewind() {
+    flush();
+    clearReadAhead();
     ::fflush(file_);
     fseeko(file_, 0, SEEK_SET);
     resetBytesWritten();
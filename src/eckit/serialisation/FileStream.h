@@ -24,6 +24,9 @@
 namespace eckit {
 
 /// Stream to serialise to FILE*
+///
+/// Writes are combined, and reads done ahead, in a buffer sized by the resource fileStreamBufferSize
+/// ($ECKIT_FILE_STREAM_BUFFER_SIZE, 64 KiB by default, 0 to disable), saving a stdio call per value.
 
 class FileStream : public Stream {
 
@@ -14,15 +14,19 @@
 #include <stdint.h>
 #include <sys/types.h>
 
+#include <algorithm>
 #include <cassert>
 #include <cstring>
+#include <vector>
 
+#include "eckit/eckit_config.h"
 #include "eckit/exception/Exceptions.h"
 #include "eckit/io/Buffer.h"
 #include "eckit/log/Log.h"
 #include "eckit/maths/Functions.h"
 #include "eckit/os/BackTrace.h"
 #include "eckit/serialisation/BadTag.h"
+#include "eckit/utils/ByteSwap.h"
 
 namespace eckit {
 
@@ -58,13 +62,14 @@ static const char* tag_names[] = {"0",
                                   "start of record",
                                   "end of record",
                                   "end of file",
-                                  "large blob"};
+                                  "large blob",
+                                  "array"};
 
 const int tag_count = sizeof(tag_names) / sizeof(tag_names[0]);
 
 
 Stream::Stream() :
-    lastTag_(tag_zero), writeCount_(0) {}
+    lastTag_(tag_zero), writeCount_(0), outUsed_(0), inPos_(0), inEnd_(0) {}
 
 void Stream::print(std::ostream& s) const {
     s << name();
@@ -74,9 +79,88 @@ Stream::~Stream() {}
 
 void Stream::putBytes(const void* buf, long len) {
     writeCount_ += len;
-    if (write(buf, len) != len) {
-        throw WriteError(name());
+
+    if (outUsed_ + size_t(len) > out_.size()) {
+        flush();
+    }
+
+    if (size_t(len) >= out_.size()) {
+        if (write(buf, len) != len) {
+            throw WriteError(name());
+        }
+        return;
+    }
+
+    ::memcpy(out_.data() + outUsed_, buf, len);
+    outUsed_ += len;
+}
+
+void Stream::flush() {
+    if (outUsed_ > 0) {
+        long len = long(outUsed_);
+        outUsed_ = 0;
+        if (write(out_.data(), len) != len) {
+            throw WriteError(name());
+        }
+    }
+}
+
+void Stream::writeBufferSize(size_t size) {
+    flush();
+    out_.resize(size);
+    out_.shrink_to_fit();
+}
+
+void Stream::readBufferSize(size_t size) {
+    // Keep what was read ahead
+    ASSERT_MSG(inEnd_ - inPos_ <= size, "Stream: the data read ahead does not fit in the new buffer");
+    std::vector<char> in(size);
+    std::copy(in_.begin() + inPos_, in_.begin() + inEnd_, in.begin());
+    inEnd_ -= inPos_;
+    inPos_ = 0;
+    in_.swap(in);
+}
+
+void Stream::clearReadAhead() {
+    inPos_ = inEnd_ = 0;
+}
+
+long Stream::readSome(void* buf, long len) {
+    return read(buf, len);
+}
+
+long Stream::readBytes(void* buf, long len) {
+    char* p   = static_cast<char*>(buf);
+    long done = 0;
+
+    while (done < len) {
+        if (inPos_ == inEnd_) {
+            // The peer may be waiting for what we have to say
+            flush();
+
+            if (size_t(len - done) >= in_.size()) {
+                long n = read(p + done, len - done);
+                if (n < 0 && done == 0) {
+                    return n;
+                }
+                return done + std::max(n, 0L);
+            }
+
+            long n = readSome(in_.data(), long(in_.size()));
+            if (n <= 0) {
+                return done > 0 ? done : n;
+            }
+            inPos_ = 0;
+            inEnd_ = size_t(n);
+        }
+
+        size_t n = std::min(size_t(len - done), inEnd_ - inPos_);
+        ::memcpy(p + done, in_.data() + inPos_, n);
+        inPos_ += n;
+        done += long(n);
     }
+
+    return done;
 }
 
 std::ostream& operator<<(std::ostream& out, const Stream& s) {
@@ -85,7 +169,7 @@ std::ostream& operator<<(std::ostream& out, const Stream& s) {
 }
 
 void Stream::getBytes(void* buf, long len) {
-    if (read(buf, len) != len) {
+    if (readBytes(buf, len) != len) {
         throw ReadError(name());
     }
 }
@@ -185,7 +269,7 @@ Stream::tag Stream::nextTag() {
     unsigned char c = 0;
     int len;
 
-    if ((len = read(&c, 1)) == 0) {
+    if ((len = readBytes(&c, 1)) == 0) {
         //      Log::debug() << "End of stream" << tag_zero << std::endl;
         return tag_eof;
     }
@@ -568,6 +652,154 @@ void Stream::readLargeBlob(void* buffer, size_t size) {
     }
 }
 
+namespace {
+
+// Values converted at a time, to swap the bytes into
+constexpr size_t array_chunk = 64 * 1024;
+
+constexpr long max_bytes = 0x40000000;
+
+}  // namespace
+
+template <typename T>
+void Stream::putArray(Stream::tag type, const T* values, size_t size) {
+    writeTag(tag_array);
+    writeTag(type);
+
+    unsigned long long len = size;
+    putLong(len >> 32);
+    putLong(len & 0xffffffff);
+
+#if eckit_LITTLE_ENDIAN
+    std::vector<T> swapped(std::min(size, array_chunk));
+    while (size > 0) {
+        size_t n = std::min(size, array_chunk);
+        std::copy(values, values + n, swapped.data());
+        byteswap(swapped.data(), n);
+        putBytes(swapped.data(), long(n * sizeof(T)));
+        values += n;
+        size -= n;
+    }
+#else
+    const char* p = reinterpret_cast<const char*>(values);
+    size_t bytes  = size * sizeof(T);
+    while (bytes > 0) {
+        long l = bytes > size_t(max_bytes) ? max_bytes : long(bytes);
+        putBytes(p, l);
+        p += l;
+        bytes -= l;
+    }
+#endif
+}
+
+size_t Stream::getArraySize(Stream::tag type) {
+    readTag(tag_array);
+
+    tag t = nextTag();
+    if (t != type) {
+        badTag(type, t);
+    }
+
+    unsigned long long u1 = getLong();
+    unsigned long long u2 = getLong();
+    return size_t((u1 << 32) | u2);
+}
+
+template <typename T>
+void Stream::getArray(T* values, size_t size) {
+    char* p      = reinterpret_cast<char*>(values);
+    size_t bytes = size * sizeof(T);
+    while (bytes > 0) {
+        long l = bytes > size_t(max_bytes) ? max_bytes : long(bytes);
+        getBytes(p, l);
+        p += l;
+        bytes -= l;
+    }
+#if eckit_LITTLE_ENDIAN
+    byteswap(values, size);
+#endif
+}
+
+void Stream::writeArray(const int32_t* values, size_t size) {
+    T("w array int", size);
+    putArray(tag_int, values, size);
+}
+
+void Stream::writeArray(const int64_t* values, size_t size) {
+    T("w array long long", size);
+    putArray(tag_long_long, values, size);
+}
+
+void Stream::writeArray(const float* values, size_t size) {
+    T("w array float", size);
+    putArray(tag_float, values, size);
+}
+
+void Stream::writeArray(const double* values, size_t size) {
+    T("w array double", size);
+    putArray(tag_double, values, size);
+}
+
+void Stream::writeArray(const std::vector<int32_t>& v) {
+    writeArray(v.data(), v.size());
+}
+
+void Stream::writeArray(const std::vector<int64_t>& v) {
+    writeArray(v.data(), v.size());
+}
+
+void Stream::writeArray(const std::vector<float>& v) {
+    writeArray(v.data(), v.size());
+}
+
+void Stream::writeArray(const std::vector<double>& v) {
+    writeArray(v.data(), v.size());
+}
+
+void Stream::readArray(int32_t* values, size_t size) {
+    size_t n = getArraySize(tag_int);
+    ASSERT(n == size);
+    getArray(values, size);
+}
+
+void Stream::readArray(int64_t* values, size_t size) {
+    size_t n = getArraySize(tag_long_long);
+    ASSERT(n == size);
+    getArray(values, size);
+}
+
+void Stream::readArray(float* values, size_t size) {
+    size_t n = getArraySize(tag_float);
+    ASSERT(n == size);
+    getArray(values, size);
+}
+
+void Stream::readArray(double* values, size_t size) {
+    size_t n = getArraySize(tag_double);
+    ASSERT(n == size);
+    getArray(values, size);
+}
+
+void Stream::readArray(std::vector<int32_t>& v) {
+    v.resize(getArraySize(tag_int));
+    getArray(v.data(), v.size());
+}
+
+void Stream::readArray(std::vector<int64_t>& v) {
+    v.resize(getArraySize(tag_long_long));
+    getArray(v.data(), v.size());
+}
+
+void Stream::readArray(std::vector<float>& v) {
+    v.resize(getArraySize(tag_float));
+    getArray(v.data(), v.size());
+}
+
+void Stream::readArray(std::vector<double>& v) {
+    v.resize(getArraySize(tag_double));
+    getArray(v.data(), v.size());
+}
+
 void Stream::rewind() {
     NOTIMP;
 }
@@ -14,8 +14,10 @@
 #ifndef eckit_Stream_h
 #define eckit_Stream_h
 
+#include <cstdint>
 #include <map>
 #include <string>
+#include <vector>
 
 #include "eckit/memory/NonCopyable.h"
 #include "eckit/thread/Mutex.h"
@@ -114,10 +116,49 @@ public:
     void writeLargeBlob(const void*, size_t);
     void readLargeBlob(void*, size_t);
 
+    // Arrays of numbers, sent as a single header followed by the values in big-endian order.
+    // Much faster than sending the values one by one, but not readable as such
+
+    void writeArray(const int32_t*, size_t);
+    void writeArray(const int64_t*, size_t);
+    void writeArray(const float*, size_t);
+    void writeArray(const double*, size_t);
+
+    void writeArray(const std::vector<int32_t>&);
+    void writeArray(const std::vector<int64_t>&);
+    void writeArray(const std::vector<float>&);
+    void writeArray(const std::vector<double>&);
+
+    /// @pre the next item is an array of the same type and size
+    void readArray(int32_t*, size_t);
+    void readArray(int64_t*, size_t);
+    void readArray(float*, size_t);
+    void readArray(double*, size_t);
+
+    /// Resizes the vector to the size of the array
+    void readArray(std::vector<int32_t>&);
+    void readArray(std::vector<int64_t>&);
+    void readArray(std::vector<float>&);
+    void readArray(std::vector<double>&);
+
     virtual void rewind();
     virtual void closeOutput();
     virtual void closeInput();
 
+    // Buffering, disabled by default.
+    // Small writes (tags, numbers) are combined into a buffer of the given size, written out by flush(),
+    // when full, and before any read from the underlying stream, so a request is sent before waiting for
+    // its reply. Reads are done ahead into a buffer of the given size with readSome().
+    // A size of 0 disables the buffer. Data read ahead belongs to the stream: do not read from the underlying socket
+    // or file directly while buffering.
+
+    void writeBufferSize(size_t);
+    void readBufferSize(size_t);
+
+    /// Writes out the combined writes, if any.
+    /// @note not done by ~Stream(), subclasses flush in their own destructor or when closing
+    void flush();
+
     long long bytesWritten() { return writeCount_; }
     void resetBytesWritten() { writeCount_ = 0; }
 
@@ -144,6 +185,9 @@ protected:
 
     size_t blobSize();
 
+    /// Forgets what was read ahead, for instance after repositioning the underlying stream
+    void clearReadAhead();
+
 private:
     enum tag
     {
@@ -169,6 +213,7 @@ private:
         tag_end_rec,
         tag_eof,
         tag_large_blob,  // For blobs >= 2Gb
+        tag_array,       // Followed by the element tag, the 64 bits size and the values
         last_tag
     };
 
@@ -178,6 +223,13 @@ private:
     Mutex mutex_;
     long writeCount_;
 
+    std::vector<char> out_;
+    size_t outUsed_;
+
+    std::vector<char> in_;
+    size_t inPos_;
+    size_t inEnd_;
+
     // -- Methods
 
     // These are the two methods to override
@@ -185,6 +237,13 @@ private:
     virtual long write(const void*, long) = 0;
     virtual long read(void*, long)        = 0;
 
+    // Used to read ahead, returns as soon as some bytes are available, 0 at the end.
+    // The default calls read(), override it for streams where read() waits for all the bytes, such as sockets
+
+    virtual long readSome(void*, long);
+
+    long readBytes(void*, long);
+
     unsigned char getChar();
     unsigned long getLong();
 
@@ -199,6 +258,12 @@ private:
     void getBytes(void*, long);
     void putBytes(const void*, long);
 
+    template <typename T>
+    void putArray(tag, const T*, size_t);
+    size_t getArraySize(tag);
+    template <typename T>
+    void getArray(T*, size_t);
+
     friend std::ostream& operator<<(std::ostream&, tag);
 
     friend class BufferedWriter<Stream>;
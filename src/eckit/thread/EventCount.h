@@ -0,0 +1,110 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+/// @date   Oct 2026
+
+#ifndef eckit_thread_EventCount_h
+#define eckit_thread_EventCount_h
+
+#include <atomic>
+#include <climits>
+#include <cstdint>
+
+#if defined(__linux__)
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#else
+#include <condition_variable>
+#include <mutex>
+#endif
+
+#include "eckit/memory/NonCopyable.h"
+
+namespace eckit {
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/// Lets threads block until some lock-free condition may have changed, without the notifier paying
+/// for a lock or a system call when nobody is waiting.
+///
+///     uint32_t key = ec.prepareWait();
+///     if (conditionHolds()) { ec.cancelWait(); } else { ec.wait(key); }
+///
+/// Uses a futex on Linux, a mutex and condition variable elsewhere.
+
+class EventCount : private NonCopyable {
+public:
+    EventCount() :
+        epoch_(0), waiters_(0) {}
+
+    uint32_t prepareWait() {
+        waiters_.fetch_add(1, std::memory_order_seq_cst);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        return epoch_.load(std::memory_order_acquire);
+    }
+
+    void cancelWait() { waiters_.fetch_sub(1, std::memory_order_relaxed); }
+
+    void wait(uint32_t key) {
+#if defined(__linux__)
+        while (epoch_.load(std::memory_order_acquire) == key) {
+            ::syscall(SYS_futex, reinterpret_cast<uint32_t*>(&epoch_), FUTEX_WAIT_PRIVATE, key, nullptr, nullptr, 0);
+        }
+#else
+        std::unique_lock<std::mutex> lock(mutex_);
+        while (epoch_.load(std::memory_order_acquire) == key) {
+            cv_.wait(lock);
+        }
+#endif
+        waiters_.fetch_sub(1, std::memory_order_relaxed);
+    }
+
+    void notifyOne() { notify(false); }
+
+    void notifyAll() { notify(true); }
+
+private:
+    void notify(bool all) {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (!waiters_.load(std::memory_order_seq_cst)) {
+            return;
+        }
+        epoch_.fetch_add(1, std::memory_order_acq_rel);
+#if defined(__linux__)
+        ::syscall(SYS_futex, reinterpret_cast<uint32_t*>(&epoch_), FUTEX_WAKE_PRIVATE, all ? INT_MAX : 1, nullptr,
+                  nullptr, 0);
+#else
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (all) {
+            cv_.notify_all();
+        }
+        else {
+            cv_.notify_one();
+        }
+#endif
+    }
+
+    static_assert(sizeof(std::atomic<uint32_t>) == sizeof(uint32_t), "futex word must be a plain 32-bit integer");
+
+    std::atomic<uint32_t> epoch_;
+    std::atomic<uint32_t> waiters_;
+
+#if !defined(__linux__)
+    std::mutex mutex_;
+    std::condition_variable cv_;
+#endif
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // namespace eckit
+
+#endif
@@ -11,11 +11,16 @@
 // File ThreadPool.cc
 // Baudouin Raoult - (c) ECMWF Feb 12
 
+#include <algorithm>
+#include <exception>
+#include <thread>
+
 #include "eckit/thread/ThreadPool.h"
 #include "eckit/runtime/Monitor.h"
 #include "eckit/thread/AutoLock.h"
 #include "eckit/thread/Thread.h"
 #include "eckit/thread/ThreadControler.h"
+#include "eckit/thread/WorkStealingDeque.h"
 
 //----------------------------------------------------------------------------------------------------------------------
 
@@ -33,8 +38,6 @@ public:
 };
 
 void ThreadPoolThread::run() {
-    owner_.notifyStart();
-
     Monitor::instance().name(owner_.name());
 
     // Log::info() << "Start of ThreadPoolThread " << std::endl;
@@ -49,39 +52,177 @@ void ThreadPoolThread::run() {
         }
         Monitor::instance().show(true);
 
-        r->pool_ = &owner_;
+        owner_.execute(r);
+    }
 
 
-        try {
-            r->execute();
-        }
-        catch (std::exception& e) {
-            Log::error() << "** " << e.what() << " Caught in " << Here() << std::endl;
-            Log::error() << "** Exception is reported" << std::endl;
-            owner_.error(e.what());
-        }
+    // Log::info() << "End of ThreadPoolThread " << std::endl;
 
-        try {
-            delete r;
-        }
-        catch (std::exception& e) {
-            Log::error() << "** " << e.what() << " Caught in " << Here() << std::endl;
-            Log::error() << "** Exception is reported" << std::endl;
-            owner_.error(e.what());
-        }
+    owner_.notifyEnd();
+}
 
-        owner_.endTask();
+//----------------------------------------------------------------------------------------------------------------------
+
+class ThreadPoolWorker : private NonCopyable {
+public:
+    ThreadPoolWorker(ThreadPool& pool, size_t index) :
+        pool_(pool), index_(index), seed_(index * 2654435761u + 1), deque_(256) {}
+
+    ThreadPool& pool_;
+    size_t index_;
+    uint64_t seed_;
+    WorkStealingDeque<ThreadPoolTask*> deque_;
+
+    // xorshift, to spread thieves across victims
+    size_t random() {
+        seed_ ^= seed_ << 13;
+        seed_ ^= seed_ >> 7;
+        seed_ ^= seed_ << 17;
+        return size_t(seed_);
     }
+};
 
+// Worker of the calling thread, if it belongs to a pool in Scheduling::WorkStealing
+static thread_local ThreadPoolWorker* currentWorker = nullptr;
 
-    // Log::info() << "End of ThreadPoolThread " << std::endl;
+class WorkStealingThread : public Thread {
+    ThreadPool& owner_;
+    void run() override;
+
+public:
+    WorkStealingThread(ThreadPool& owner) :
+        owner_(owner) {}
+};
+
+void WorkStealingThread::run() {
+    Monitor::instance().name(owner_.name());
+
+    ThreadPoolWorker* worker = owner_.attach();
+    currentWorker            = worker;
+
+    Monitor::instance().show(true);
+
+    while (ThreadPoolTask* r = owner_.take(*worker)) {
+        owner_.execute(r);
+    }
+
+    Monitor::instance().show(false);
+
+    currentWorker = nullptr;
+    owner_.detach(worker);
 
     owner_.notifyEnd();
 }
 
-ThreadPool::ThreadPool(const std::string& name, size_t count, size_t stack) :
-    count_(0), stack_(stack), running_(0), tasks_(0), name_(name), error_(false) {
+//----------------------------------------------------------------------------------------------------------------------
+
+/// Shared state of one ThreadPool::parallel_for call, chunks are claimed by the caller and by helper tasks alike
+
+class ParallelFor {
+public:
+    ParallelFor(size_t begin, size_t end, size_t grain, void (*body)(void*, size_t, size_t), void* context) :
+        begin_(begin),
+        end_(end),
+        grain_(grain),
+        chunks_((end - begin + grain - 1) / grain),
+        body_(body),
+        context_(context),
+        next_(0),
+        completed_(0),
+        cancelled_(false) {}
+
+    void work() {
+        for (;;) {
+            size_t c = next_.fetch_add(1, std::memory_order_relaxed);
+            if (c >= chunks_) {
+                return;
+            }
+
+            if (!cancelled_.load(std::memory_order_relaxed)) {
+                size_t first = begin_ + c * grain_;
+                try {
+                    body_(context_, first, std::min(first + grain_, end_));
+                }
+                catch (...) {
+                    AutoLock<MutexCond> lock(cond_);
+                    if (!error_) {
+                        error_ = std::current_exception();
+                    }
+                    cancelled_.store(true, std::memory_order_relaxed);
+                }
+            }
+
+            if (completed_.fetch_add(1, std::memory_order_acq_rel) + 1 == chunks_) {
+                AutoLock<MutexCond> lock(cond_);
+                cond_.broadcast();
+            }
+        }
+    }
+
+    void wait() {
+        AutoLock<MutexCond> lock(cond_);
+        while (completed_.load(std::memory_order_acquire) < chunks_) {
+            cond_.wait();
+        }
+        if (error_) {
+            std::rethrow_exception(error_);
+        }
+    }
+
+    size_t chunks() const { return chunks_; }
+
+private:
+    size_t begin_;
+    size_t end_;
+    size_t grain_;
+    size_t chunks_;
+    void (*body_)(void*, size_t, size_t);
+    void* context_;
+
+    std::atomic<size_t> next_;
+    std::atomic<size_t> completed_;
+    std::atomic<bool> cancelled_;
+
+    MutexCond cond_;
+    std::exception_ptr error_;
+};
+
+class ParallelForTask : public ThreadPoolTask {
+    std::shared_ptr<ParallelFor> state_;
+    void execute() override { state_->work(); }
+
+public:
+    ParallelForTask(const std::shared_ptr<ParallelFor>& state) :
+        state_(state) {}
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+
+ThreadPool::ThreadPool(const std::string& name, size_t count, size_t stack, Scheduling scheduling) :
+    count_(0),
+    stack_(stack),
+    running_(0),
+    tasks_(0),
+    name_(name),
+    error_(false),
+    scheduling_(scheduling),
+    activeWorkers_(0),
+    injectedCount_(0),
+    sleeping_(0) {
     // Log::info() << "ThreadPool::ThreadPool " << nme_ << " " << count << std::endl;
+
+    if (scheduling_ == Scheduling::WorkStealing) {
+        // Thieves scan the workers without locking, so the slots are allocated once and never move
+        size_t slots = std::max<size_t>({count, std::thread::hardware_concurrency(), 64});
+        workers_.reserve(slots);
+        for (size_t i = 0; i < slots; ++i) {
+            workers_.emplace_back(new ThreadPoolWorker(*this, i));
+        }
+        for (size_t i = slots; i > 0; --i) {
+            freeWorkers_.push_back(workers_[i - 1].get());
+        }
+    }
+
     resize(count);
 }
 
@@ -117,6 +258,30 @@ void ThreadPool::waitForThreads() {
     }
 }
 
+void ThreadPool::execute(ThreadPoolTask* r) {
+    r->pool_ = this;
+
+    try {
+        r->execute();
+    }
+    catch (std::exception& e) {
+        Log::error() << "** " << e.what() << " Caught in " << Here() << std::endl;
+        Log::error() << "** Exception is reported" << std::endl;
+        error(e.what());
+    }
+
+    try {
+        delete r;
+    }
+    catch (std::exception& e) {
+        Log::error() << "** " << e.what() << " Caught in " << Here() << std::endl;
+        Log::error() << "** Exception is reported" << std::endl;
+        error(e.what());
+    }
+
+    endTask();
+}
+
 void ThreadPool::notifyStart() {
     AutoLock<MutexCond> lock(done_);
     running_++;
@@ -133,17 +298,15 @@ void ThreadPool::notifyEnd() {
 
 
 void ThreadPool::startTask() {
-    AutoLock<MutexCond> lock(active_);
-    tasks_++;
-    active_.signal();
-    // Log::info() << "ThreadPool::notifyStart " << name_ << " running: " << running_ << std::endl;
+    tasks_.fetch_add(1, std::memory_order_relaxed);
 }
 
 void ThreadPool::endTask() {
-    AutoLock<MutexCond> lock(active_);
-    tasks_--;
-    active_.signal();
-    // Log::info() << "ThreadPool::notifyStart " << name_ << " running: " << running_ << std::endl;
+    // Only the last task takes the lock, wait() checks the counter while holding it
+    if (tasks_.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        AutoLock<MutexCond> lock(active_);
+        active_.broadcast();
+    }
 }
 
 void ThreadPool::error(const std::string& msg) {
@@ -160,12 +323,43 @@ void ThreadPool::push(ThreadPoolTask* r) {
         startTask();
     }
 
+    if (scheduling_ == Scheduling::WorkStealing) {
+        if (r && currentWorker && &currentWorker->pool_ == this) {
+            currentWorker->deque_.push(r);
+        }
+        else {
+            AutoLock<Mutex> lock(injectedMutex_);
+            injected_.push_back(r);
+            injectedCount_.fetch_add(1, std::memory_order_relaxed);
+        }
+        wake(1);
+        return;
+    }
+
     AutoLock<MutexCond> lock(ready_);
     queue_.push_back(r);
     ready_.signal();
 }
 
 void ThreadPool::push(std::list<ThreadPoolTask*>& l) {
+    size_t n = 0;
+    for (std::list<ThreadPoolTask*>::iterator j = l.begin(); j != l.end(); ++j) {
+        if (*j) {
+            startTask();
+        }
+        n++;
+    }
+
+    if (scheduling_ == Scheduling::WorkStealing) {
+        {
+            AutoLock<Mutex> lock(injectedMutex_);
+            injectedCount_.fetch_add(n, std::memory_order_relaxed);
+            injected_.splice(injected_.end(), l);
+        }
+        wake(n);
+        return;
+    }
+
     AutoLock<MutexCond> lock(ready_);
 
     for (std::list<ThreadPoolTask*>::iterator j = l.begin(); j != l.end(); ++j) {
@@ -193,6 +387,9 @@ ThreadPoolTask* ThreadPool::next() {
 }
 
 bool ThreadPool::done() {
+    if (scheduling_ == Scheduling::WorkStealing) {
+        return !tasks_;
+    }
     return (queue_.empty() && !tasks_);
 }
 
@@ -212,12 +409,193 @@ void ThreadPool::resize(size_t size) {
     }
 
     while (count_ < size) {
-        ThreadControler c(new ThreadPoolThread(*this), true, stack_);
-        c.start();
+        Thread* thread = nullptr;
+        if (scheduling_ == Scheduling::WorkStealing) {
+            ASSERT_MSG(count_ < workers_.size(), "ThreadPool::resize: cannot grow a work-stealing pool beyond "
+                                                 "max(initial size, hardware concurrency)");
+            thread = new WorkStealingThread(*this);
+        }
+        else {
+            thread = new ThreadPoolThread(*this);
+        }
+
+        // Counted before the thread starts, so waitForThreads() cannot miss a thread that has not run yet
+        notifyStart();
+        try {
+            ThreadControler c(thread, true, stack_);
+            c.start();
+        }
+        catch (...) {
+            notifyEnd();
+            throw;
+        }
         count_++;
     }
 }
 
+void ThreadPool::parallelFor(size_t begin, size_t end, size_t grain, void (*body)(void*, size_t, size_t),
+                             void* context) {
+    if (begin >= end) {
+        return;
+    }
+
+    if (grain == 0) {
+        // A few chunks per thread, to balance uneven iterations
+        grain = std::max<size_t>(1, (end - begin) / (8 * (count_ + 1)));
+    }
+
+    std::shared_ptr<ParallelFor> state(new ParallelFor(begin, end, grain, body, context));
+
+    // Helpers that start after all chunks are claimed return immediately
+    size_t helpers = std::min(state->chunks() - 1, count_);
+    if (helpers) {
+        std::list<ThreadPoolTask*> tasks;
+        for (size_t i = 0; i < helpers; ++i) {
+            tasks.push_back(new ParallelForTask(state));
+        }
+        if (currentWorker && &currentWorker->pool_ == this) {
+            for (auto* t : tasks) {
+                push(t);
+            }
+        }
+        else {
+            push(tasks);
+        }
+    }
+
+    state->work();
+    state->wait();
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+ThreadPoolWorker* ThreadPool::attach() {
+    AutoLock<MutexCond> lock(freeWorkersCond_);
+    // After a shrink then grow, a new thread may start before the old ones have left
+    while (freeWorkers_.empty()) {
+        freeWorkersCond_.wait();
+    }
+
+    // Lowest free slot first, so thieves only scan up to the high-water mark
+    auto j = std::min_element(freeWorkers_.begin(), freeWorkers_.end(),
+                              [](ThreadPoolWorker* a, ThreadPoolWorker* b) { return a->index_ < b->index_; });
+    ThreadPoolWorker* w = *j;
+    freeWorkers_.erase(j);
+
+    if (w->index_ >= activeWorkers_.load(std::memory_order_relaxed)) {
+        activeWorkers_.store(w->index_ + 1, std::memory_order_release);
+    }
+    return w;
+}
+
+void ThreadPool::detach(ThreadPoolWorker* w) {
+    // Workers only leave with an empty deque, see take()
+    ASSERT(w->deque_.empty());
+    AutoLock<MutexCond> lock(freeWorkersCond_);
+    freeWorkers_.push_back(w);
+    freeWorkersCond_.signal();
+}
+
+ThreadPoolTask* ThreadPool::take(ThreadPoolWorker& w) {
+    for (;;) {
+        if (ThreadPoolTask* r = w.deque_.pop()) {
+            return r;
+        }
+
+        size_t n = activeWorkers_.load(std::memory_order_acquire);
+        size_t k = w.random();
+        for (size_t i = 0; i < n; ++i) {
+            ThreadPoolWorker& victim = *workers_[(k + i) % n];
+            if (&victim != &w) {
+                if (ThreadPoolTask* r = victim.deque_.steal()) {
+                    return r;
+                }
+            }
+        }
+
+        ThreadPoolTask* r = nullptr;
+        if (takeInjected(w, r)) {
+            return r;  // nullptr is the stop sentinel
+        }
+
+        park();
+    }
+}
+
+bool ThreadPool::takeInjected(ThreadPoolWorker& w, ThreadPoolTask*& r) {
+    if (!injectedCount_.load(std::memory_order_relaxed)) {
+        return false;
+    }
+
+    size_t moved = 0;
+    {
+        AutoLock<Mutex> lock(injectedMutex_);
+        if (injected_.empty()) {
+            return false;
+        }
+
+        r = injected_.front();
+        injected_.pop_front();
+        injectedCount_.fetch_sub(1, std::memory_order_relaxed);
+
+        if (!r) {
+            return true;  // stop sentinel
+        }
+
+        // Take a share of the backlog into our own deque, where other workers can steal it without locking
+        size_t share = std::min<size_t>(injected_.size() / (count_ + 1), 64);
+        while (moved < share && injected_.front()) {
+            w.deque_.push(injected_.front());
+            injected_.pop_front();
+            moved++;
+        }
+        injectedCount_.fetch_sub(moved, std::memory_order_relaxed);
+    }
+
+    if (moved) {
+        wake(moved);
+    }
+
+    return true;
+}
+
+bool ThreadPool::hasWork() const {
+    if (injectedCount_.load(std::memory_order_relaxed)) {
+        return true;
+    }
+    size_t n = activeWorkers_.load(std::memory_order_acquire);
+    for (size_t i = 0; i < n; ++i) {
+        if (!workers_[i]->deque_.empty()) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void ThreadPool::park() {
+    AutoLock<MutexCond> lock(idle_);
+    sleeping_.fetch_add(1, std::memory_order_seq_cst);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    // Pairs with the fence in wake(): either we see the new work, or the pusher sees us sleeping
+    if (!hasWork()) {
+        idle_.wait();
+    }
+    sleeping_.fetch_sub(1, std::memory_order_relaxed);
+}
+
+void ThreadPool::wake(size_t n) {
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (sleeping_.load(std::memory_order_seq_cst)) {
+        AutoLock<MutexCond> lock(idle_);
+        if (n == 1) {
+            idle_.signal();
+        }
+        else {
+            idle_.broadcast();
+        }
+    }
+}
+
 ThreadPoolTask::~ThreadPoolTask() {}
 
 //----------------------------------------------------------------------------------------------------------------------
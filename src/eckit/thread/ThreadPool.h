@@ -11,9 +11,16 @@
 #ifndef eckit_ThreadPool_h
 #define eckit_ThreadPool_h
 
+#include <atomic>
+#include <future>
 #include <list>
+#include <memory>
 #include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
 
+#include "eckit/thread/Mutex.h"
 #include "eckit/thread/MutexCond.h"
 
 
@@ -22,6 +29,7 @@ namespace eckit {
 //-----------------------------------------------------------------------------
 
 class ThreadPool;
+class ThreadPoolWorker;
 
 
 class ThreadPoolTask {
@@ -29,7 +37,7 @@ public:
     virtual ~ThreadPoolTask();
     virtual void execute() = 0;
 
-    friend class ThreadPoolThread;
+    friend class ThreadPool;
 
 protected:
     ThreadPool& pool() { return *pool_; }
@@ -40,15 +48,57 @@ private:
 
 //-----------------------------------------------------------------------------
 
+/// Wraps a callable so it can be pushed to a ThreadPool, the result (or exception) is delivered through a std::future
+
+template <typename R>
+class ThreadPoolFunctionTask : public ThreadPoolTask {
+public:
+    template <typename F>
+    explicit ThreadPoolFunctionTask(F&& f) :
+        task_(std::forward<F>(f)) {}
+
+    std::future<R> future() { return task_.get_future(); }
+
+private:
+    void execute() override { task_(); }
+
+    std::packaged_task<R()> task_;
+};
+
+//-----------------------------------------------------------------------------
+
 class ThreadPool : private NonCopyable {
 
+public:  // types
+    /// Shared: all tasks go through a single queue guarded by a mutex and condition variable
+    /// WorkStealing: each worker owns a lock-free deque, tasks pushed from a worker stay local, idle workers steal
+    ///               from the others and park on a condition variable instead of polling.
+    ///               Such a pool cannot be resized beyond max(count, hardware concurrency, 64) threads.
+    enum class Scheduling
+    {
+        Shared,
+        WorkStealing
+    };
+
 public:  // methods
-    ThreadPool(const std::string& name, size_t count, size_t stack = 0);
+    ThreadPool(const std::string& name, size_t count, size_t stack = 0, Scheduling = Scheduling::Shared);
 
     ~ThreadPool();
 
     void push(ThreadPoolTask*);
     void push(std::list<ThreadPoolTask*>&);
+
+    /// Wraps the callable in a task and returns a future to its result
+    template <typename F>
+    auto submit(F&& f) -> std::future<std::invoke_result_t<std::decay_t<F>>>;
+
+    /// Calls f(i) for every i in [begin, end), split in chunks of grain indices (0 selects a default).
+    /// The calling thread takes part and the call returns once all chunks completed.
+    /// It is safe to call from within a task of the same pool. The first exception thrown by f is rethrown.
+    template <typename F>
+    void parallel_for(size_t begin, size_t end, F&& f, size_t grain = 0);
+
+    /// Next task from the shared queue, only meaningful with Scheduling::Shared
     ThreadPoolTask* next();
     void notifyStart();
     void notifyEnd();
@@ -59,10 +109,29 @@ public:  // methods
     void wait();
     bool done();
     void resize(size_t);
+    size_t size() const { return count_; }
+    Scheduling scheduling() const { return scheduling_; }
 
     void startTask();
     void endTask();
 
+private:  // methods
+    friend class ThreadPoolThread;
+    friend class WorkStealingThread;
+
+    void execute(ThreadPoolTask*);
+
+    void parallelFor(size_t begin, size_t end, size_t grain, void (*body)(void*, size_t, size_t), void* context);
+
+    // Scheduling::WorkStealing
+    ThreadPoolWorker* attach();
+    void detach(ThreadPoolWorker*);
+    ThreadPoolTask* take(ThreadPoolWorker&);
+    bool takeInjected(ThreadPoolWorker&, ThreadPoolTask*&);
+    bool hasWork() const;
+    void park();
+    void wake(size_t);
+
 private:  // members
     MutexCond ready_;
     MutexCond done_;
@@ -71,17 +140,55 @@ private:  // members
     size_t count_;
     size_t stack_;
     size_t running_;
-    size_t tasks_;
+    std::atomic<size_t> tasks_;
 
     std::string errorMessage_;
     std::string name_;
     std::list<ThreadPoolTask*> queue_;
 
     bool error_;
+
+    Scheduling scheduling_;
+
+    // Scheduling::WorkStealing
+    std::vector<std::unique_ptr<ThreadPoolWorker>> workers_;  // fixed size, slots are reused as threads come and go
+    std::vector<ThreadPoolWorker*> freeWorkers_;
+    MutexCond freeWorkersCond_;
+    std::atomic<size_t> activeWorkers_;  // high-water mark of the slots in use
+
+    Mutex injectedMutex_;
+    std::list<ThreadPoolTask*> injected_;  // tasks pushed from outside the pool, and the stop sentinels
+    std::atomic<size_t> injectedCount_;
+
+    MutexCond idle_;
+    std::atomic<size_t> sleeping_;
 };
 
 //-----------------------------------------------------------------------------
 
+template <typename F>
+auto ThreadPool::submit(F&& f) -> std::future<std::invoke_result_t<std::decay_t<F>>> {
+    using R    = std::invoke_result_t<std::decay_t<F>>;
+    auto* task = new ThreadPoolFunctionTask<R>(std::forward<F>(f));
+    auto fut   = task->future();
+    push(task);
+    return fut;
+}
+
+template <typename F>
+void ThreadPool::parallel_for(size_t begin, size_t end, F&& f, size_t grain) {
+    using Body = std::remove_reference_t<F>;
+    auto body  = [](void* context, size_t first, size_t last) {
+        Body& g = *static_cast<Body*>(context);
+        for (size_t i = first; i < last; ++i) {
+            g(i);
+        }
+    };
+    parallelFor(begin, end, grain, body, const_cast<void*>(static_cast<const void*>(std::addressof(f))));
+}
+
+//-----------------------------------------------------------------------------
+
 }  // namespace eckit
 
 #endif
@@ -0,0 +1,151 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+/// @date   Oct 2026
+
+#ifndef eckit_thread_WorkStealingDeque_h
+#define eckit_thread_WorkStealingDeque_h
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+#include "eckit/exception/Exceptions.h"
+#include "eckit/memory/NonCopyable.h"
+
+namespace eckit {
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/// Chase-Lev work-stealing deque of pointers (Le, Pop, Cohen & Zappa Nardelli, PPoPP 2013).
+///
+/// The owning thread pushes and pops at the bottom without locking; any other thread may steal from the top,
+/// with a single CAS on contention. The ring grows on demand; retired rings are kept until destruction because
+/// thieves may still be reading from them.
+
+template <typename T>
+class WorkStealingDeque : private NonCopyable {
+
+    static_assert(std::is_pointer<T>::value, "WorkStealingDeque only stores pointers");
+
+    class Ring {
+    public:
+        explicit Ring(size_t capacity) :
+            capacity_(capacity), mask_(capacity - 1), slots_(new std::atomic<T>[capacity]) {
+            ASSERT(capacity > 0 && (capacity & mask_) == 0);
+        }
+
+        size_t capacity() const { return capacity_; }
+
+        T get(int64_t i) const { return slots_[size_t(i) & mask_].load(std::memory_order_relaxed); }
+
+        void put(int64_t i, T x) { slots_[size_t(i) & mask_].store(x, std::memory_order_relaxed); }
+
+        Ring* grow(int64_t bottom, int64_t top) const {
+            Ring* r = new Ring(2 * capacity_);
+            for (int64_t i = top; i != bottom; ++i) {
+                r->put(i, get(i));
+            }
+            return r;
+        }
+
+    private:
+        size_t capacity_;
+        size_t mask_;
+        std::unique_ptr<std::atomic<T>[]> slots_;
+    };
+
+public:  // methods
+    explicit WorkStealingDeque(size_t capacity = 1024) :
+        top_(0), bottom_(0), ring_(new Ring(capacity)) {
+        retired_.emplace_back(ring_.load(std::memory_order_relaxed));
+    }
+
+    /// Owner only
+    void push(T x) {
+        int64_t b = bottom_.load(std::memory_order_relaxed);
+        int64_t t = top_.load(std::memory_order_acquire);
+        Ring* r   = ring_.load(std::memory_order_relaxed);
+        if (b - t > int64_t(r->capacity()) - 1) {
+            r = r->grow(b, t);
+            retired_.emplace_back(r);
+            ring_.store(r, std::memory_order_release);
+        }
+        r->put(b, x);
+        std::atomic_thread_fence(std::memory_order_release);
+        bottom_.store(b + 1, std::memory_order_relaxed);
+    }
+
+    /// Owner only, returns nullptr when empty
+    T pop() {
+        int64_t b = bottom_.load(std::memory_order_relaxed) - 1;
+        Ring* r   = ring_.load(std::memory_order_relaxed);
+        bottom_.store(b, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        int64_t t = top_.load(std::memory_order_relaxed);
+
+        if (t > b) {
+            bottom_.store(b + 1, std::memory_order_relaxed);
+            return nullptr;
+        }
+
+        T x = r->get(b);
+        if (t == b) {
+            // Last element, race against thieves
+            if (!top_.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+                x = nullptr;
+            }
+            bottom_.store(b + 1, std::memory_order_relaxed);
+        }
+        return x;
+    }
+
+    /// Any thread, returns nullptr when empty or when losing a race
+    T steal() {
+        int64_t t = top_.load(std::memory_order_acquire);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        int64_t b = bottom_.load(std::memory_order_acquire);
+
+        if (t >= b) {
+            return nullptr;
+        }
+
+        Ring* r = ring_.load(std::memory_order_acquire);
+        T x     = r->get(t);
+        if (!top_.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+            return nullptr;
+        }
+        return x;
+    }
+
+    /// Approximate when called concurrently with push/pop/steal
+    size_t size() const {
+        int64_t b = bottom_.load(std::memory_order_relaxed);
+        int64_t t = top_.load(std::memory_order_relaxed);
+        return b > t ? size_t(b - t) : 0;
+    }
+
+    bool empty() const { return size() == 0; }
+
+private:  // members
+    alignas(64) std::atomic<int64_t> top_;
+    alignas(64) std::atomic<int64_t> bottom_;
+    alignas(64) std::atomic<Ring*> ring_;
+
+    std::vector<std::unique_ptr<Ring>> retired_;  // owner only, includes the live ring
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // namespace eckit
+
+#endif
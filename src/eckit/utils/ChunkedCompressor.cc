@@ -0,0 +1,275 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+#include "eckit/utils/ChunkedCompressor.h"
+
+#include "eckit/config/Resource.h"
+#include "eckit/exception/Exceptions.h"
+#include "eckit/io/Buffer.h"
+#include "eckit/io/CompressedFrame.h"
+#include "eckit/thread/ThreadPool.h"
+#include "eckit/utils/StringTools.h"
+
+namespace eckit {
+
+//----------------------------------------------------------------------------------------------------------------------
+
+namespace {
+
+// magic (4), version (1), length of the name (1), unused (2), block size (8), uncompressed size (8), name
+const char magic[]      = {'E', 'C', 'K', 'C'};
+const uint8_t version   = 1;
+const size_t fixedSize  = 24;
+const size_t maxNameLen = 255;
+
+using frame::get64;
+using frame::put64;
+
+size_t blocksOf(size_t len, size_t blockSize) {
+    return (len + blockSize - 1) / blockSize;
+}
+
+}  // namespace
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/// Where things are in a chunked stream
+struct ChunkedCompressor::Layout {
+
+    Layout(const void* in, size_t len) :
+        base_(static_cast<const char*>(in)) {
+        if (!isChunked(in, len)) {
+            throw BadValue("ChunkedCompressor: not a chunked stream");
+        }
+
+        size_t nameLen = static_cast<unsigned char>(base_[5]);
+        blockSize_     = get64(base_ + 8);
+        length_        = get64(base_ + 16);
+        if (blockSize_ == 0 || len < fixedSize + nameLen) {
+            throw BadValue("ChunkedCompressor: corrupted header");
+        }
+        compression_.assign(base_ + fixedSize, nameLen);
+
+        blocks_            = blocksOf(length_, blockSize_);
+        const char* index  = base_ + fixedSize + nameLen;
+        size_t dataStart   = fixedSize + nameLen + 8 * blocks_;
+        if (len < dataStart) {
+            throw BadValue("ChunkedCompressor: truncated index");
+        }
+
+        offsets_.resize(blocks_ + 1);
+        offsets_[0] = dataStart;
+        for (size_t i = 0; i < blocks_; ++i) {
+            offsets_[i + 1] = offsets_[i] + get64(index + 8 * i);
+        }
+        if (offsets_.back() > len) {
+            throw BadValue("ChunkedCompressor: truncated data");
+        }
+    }
+
+    const char* data(size_t i) const { return base_ + offsets_[i]; }
+    size_t compressedSize(size_t i) const { return offsets_[i + 1] - offsets_[i]; }
+    size_t uncompressedSize(size_t i) const { return std::min(blockSize_, length_ - i * blockSize_); }
+
+    const char* base_;
+    size_t blockSize_;
+    size_t length_;
+    size_t blocks_;
+    std::string compression_;
+    std::vector<size_t> offsets_;
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+
+ChunkedCompressor::ChunkedCompressor() {
+    static std::string compression = Resource<std::string>("chunkedCompressor;$ECKIT_CHUNKED_COMPRESSOR", "");
+    static size_t blockSize = Resource<size_t>("chunkedCompressorBlockSize;$ECKIT_CHUNKED_COMPRESSOR_BLOCK_SIZE",
+                                               4 * 1024 * 1024);
+    static size_t threads   = Resource<size_t>("chunkedCompressorThreads;$ECKIT_CHUNKED_COMPRESSOR_THREADS", 0);
+
+    compression_ = compression;
+    if (compression_.empty()) {
+        compression_ = Resource<std::string>("defaultCompression;ECKIT_DEFAULT_COMPRESSION", "snappy");
+        if (!CompressorFactory::instance().has(compression_)) {
+            compression_ = "none";
+        }
+    }
+    blockSize_ = blockSize;
+    threads_   = threads;
+
+    init();
+}
+
+ChunkedCompressor::ChunkedCompressor(const std::string& compression, size_t blockSize, size_t threads) :
+    compression_(compression), blockSize_(blockSize), threads_(threads) {
+    init();
+}
+
+ChunkedCompressor::~ChunkedCompressor() {}
+
+void ChunkedCompressor::init() {
+    compression_ = StringTools::lower(compression_);
+
+    ASSERT(blockSize_ > 0);
+    ASSERT(compression_.size() <= maxNameLen);
+    ASSERT_MSG(compression_ != "chunked", "ChunkedCompressor cannot contain chunked blocks");
+
+    if (threads_ == 0) {
+        threads_ = std::max(1U, std::thread::hardware_concurrency());
+    }
+
+    compressor_.reset(CompressorFactory::instance().build(compression_));
+
+    // The calling thread takes part in the work
+    if (threads_ > 1) {
+        pool_.reset(new ThreadPool("chunked-compressor", threads_ - 1));
+    }
+}
+
+template <typename F>
+void ChunkedCompressor::forEach(size_t n, F&& f) const {
+    if (pool_ && n > 1) {
+        pool_->parallel_for(0, n, f, 1);
+    }
+    else {
+        for (size_t i = 0; i < n; ++i) {
+            f(i);
+        }
+    }
+}
+
+const Compressor& ChunkedCompressor::blockCompressor(const std::string& name, std::unique_ptr<Compressor>& other) const {
+    if (name == compression_) {
+        return *compressor_;
+    }
+    other.reset(CompressorFactory::instance().build(name));
+    return *other;
+}
+
+size_t ChunkedCompressor::compress(const void* in, size_t len, Buffer& out) const {
+    const char* input = static_cast<const char*>(in);
+    const size_t n    = blocksOf(len, blockSize_);
+
+    std::vector<Buffer> blocks(n);
+    std::vector<size_t> sizes(n);
+
+    forEach(n, [&](size_t i) {
+        size_t start = i * blockSize_;
+        sizes[i]     = compressor_->compress(input + start, std::min(blockSize_, len - start), blocks[i]);
+    });
+
+    const size_t headerSize = fixedSize + compression_.size() + 8 * n;
+
+    std::vector<size_t> offsets(n + 1);
+    offsets[0] = headerSize;
+    for (size_t i = 0; i < n; ++i) {
+        offsets[i + 1] = offsets[i] + sizes[i];
+    }
+
+    const size_t total = offsets.back();
+    if (out.size() < total) {
+        out.resize(total);
+    }
+
+    char* p = out;
+    ::memcpy(p, magic, sizeof(magic));
+    p[4] = char(version);
+    p[5] = char(compression_.size());
+    p[6] = p[7] = 0;
+    put64(p + 8, blockSize_);
+    put64(p + 16, len);
+    ::memcpy(p + fixedSize, compression_.data(), compression_.size());
+
+    char* index = p + fixedSize + compression_.size();
+    for (size_t i = 0; i < n; ++i) {
+        put64(index + 8 * i, sizes[i]);
+    }
+
+    forEach(n, [&](size_t i) { ::memcpy(p + offsets[i], blocks[i], sizes[i]); });
+
+    return total;
+}
+
+void ChunkedCompressor::uncompress(const void* in, size_t len, Buffer& out, size_t outlen) const {
+    ASSERT(outlen == uncompressedSize(in, len));
+
+    if (out.size() < outlen) {
+        out.resize(outlen);
+    }
+
+    uncompress(in, len, 0, outlen, out);
+}
+
+size_t ChunkedCompressor::uncompress(const void* in, size_t len, size_t offset, size_t length, Buffer& out) const {
+    Layout layout(in, len);
+
+    if (offset >= layout.length_ || length == 0) {
+        return 0;
+    }
+    length = std::min(length, layout.length_ - offset);
+
+    if (out.size() < length) {
+        out.resize(length);
+    }
+
+    std::unique_ptr<Compressor> other;
+    const Compressor& compressor = blockCompressor(layout.compression_, other);
+
+    const size_t first = offset / layout.blockSize_;
+    const size_t last  = (offset + length - 1) / layout.blockSize_;
+
+    char* output = out;
+
+    forEach(last - first + 1, [&](size_t k) {
+        size_t i          = first + k;
+        size_t blockStart = i * layout.blockSize_;
+        size_t blockLen   = layout.uncompressedSize(i);
+
+        // Part of the block within the range
+        size_t from = std::max(offset, blockStart) - blockStart;
+        size_t to   = std::min(offset + length, blockStart + blockLen) - blockStart;
+
+        Buffer block(blockLen);
+        compressor.uncompress(layout.data(i), layout.compressedSize(i), block, blockLen);
+        ::memcpy(output + (blockStart + from - offset), static_cast<const char*>(block) + from, to - from);
+    });
+
+    return length;
+}
+
+bool ChunkedCompressor::isChunked(const void* in, size_t len) {
+    const char* p = static_cast<const char*>(in);
+    return len >= fixedSize && ::memcmp(p, magic, sizeof(magic)) == 0 && uint8_t(p[4]) == version;
+}
+
+size_t ChunkedCompressor::uncompressedSize(const void* in, size_t len) {
+    if (!isChunked(in, len)) {
+        throw BadValue("ChunkedCompressor: not a chunked stream");
+    }
+    return get64(static_cast<const char*>(in) + 16);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+namespace {
+
+CompressorBuilder<ChunkedCompressor> builder("chunked");
+
+}  // namespace
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // namespace eckit
@@ -0,0 +1,93 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+#ifndef eckit_utils_ChunkedCompressor_H
+#define eckit_utils_ChunkedCompressor_H
+
+#include <memory>
+#include <string>
+
+#include "eckit/utils/Compressor.h"
+
+namespace eckit {
+
+class Buffer;
+class ThreadPool;
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/// Splits the data in blocks compressed independently by another compressor, on several threads.
+///
+/// The output starts with a header (magic, block size, uncompressed size, name of the compressor) and an index of
+/// the compressed size of each block, followed by the blocks. As the blocks are independent, a byte range can be
+/// uncompressed without inflating the rest.
+///
+/// Built as "chunked" from the CompressorFactory, it uses the compressor, block size and threads given by the
+/// resources chunkedCompressor ($ECKIT_CHUNKED_COMPRESSOR, default compressor if not set),
+/// chunkedCompressorBlockSize ($ECKIT_CHUNKED_COMPRESSOR_BLOCK_SIZE, 4 MiB) and chunkedCompressorThreads
+/// ($ECKIT_CHUNKED_COMPRESSOR_THREADS, 0 for the hardware concurrency).
+///
+/// @note the compressor in the blocks must be reentrant, as all the compressors of eckit are
+
+class ChunkedCompressor : public eckit::Compressor {
+
+public:  // methods
+    ChunkedCompressor();
+
+    /// @param threads 0 for the hardware concurrency
+    ChunkedCompressor(const std::string& compression, size_t blockSize, size_t threads = 0);
+
+    ~ChunkedCompressor() override;
+
+    size_t compress(const void* in, size_t len, eckit::Buffer& out) const override;
+
+    /// @note the blocks are uncompressed with the compressor recorded in the header
+    void uncompress(const void* in, size_t len, eckit::Buffer& out, size_t outlen) const override;
+
+    /// Uncompresses length bytes from offset, only inflating the blocks they span
+    /// @returns the bytes copied into out, less than length if the range goes past the end
+    size_t uncompress(const void* in, size_t len, size_t offset, size_t length, eckit::Buffer& out) const;
+
+    const std::string& compression() const { return compression_; }
+    size_t blockSize() const { return blockSize_; }
+    size_t threads() const { return threads_; }
+
+    /// @returns true if the bytes start with the header of a chunked stream
+    static bool isChunked(const void* in, size_t len);
+
+    /// @returns the uncompressed size recorded in the header
+    static size_t uncompressedSize(const void* in, size_t len);
+
+private:  // types
+    struct Layout;
+
+private:  // methods
+    void init();
+
+    /// Calls f(i) for i in [0, n), on the threads if there are several
+    template <typename F>
+    void forEach(size_t n, F&& f) const;
+
+    const Compressor& blockCompressor(const std::string& name, std::unique_ptr<Compressor>& other) const;
+
+private:  // members
+    std::string compression_;
+    size_t blockSize_;
+    size_t threads_;
+
+    std::unique_ptr<Compressor> compressor_;
+    std::unique_ptr<ThreadPool> pool_;
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // end namespace eckit
+
+#endif
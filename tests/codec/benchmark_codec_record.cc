@@ -0,0 +1,104 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ *
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+
+#include <cmath>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "eckit/codec/codec.h"
+#include "eckit/config/Resource.h"
+#include "eckit/filesystem/PathName.h"
+#include "eckit/log/Bytes.h"
+#include "eckit/log/Timer.h"
+#include "eckit/testing/Test.h"
+
+namespace eckit::test {
+
+//-----------------------------------------------------------------------------
+
+// Set $BENCHMARK_CODEC_ARRAYS and $BENCHMARK_CODEC_ARRAY_SIZE (values) to shape the record, and
+// $ECKIT_CODEC_READ_THREADS, $ECKIT_CODEC_WRITE_THREADS to compare thread counts
+static size_t fromEnv(const char* name, size_t value) {
+    const char* e = ::getenv(name);
+    return e ? size_t(::atoll(e)) : value;
+}
+
+static void report(const std::string& compression, const char* what, size_t bytes, Timer& timer) {
+    std::cout << std::setw(10) << compression << " " << std::setw(6) << what << " : " << std::setw(10)
+              << timer.elapsed() << "s, " << std::setw(10) << Bytes(bytes, timer) << std::endl;
+}
+
+//-----------------------------------------------------------------------------
+
+CASE("Records of many arrays") {
+    const size_t arrays = fromEnv("BENCHMARK_CODEC_ARRAYS", 500);
+    const size_t size   = fromEnv("BENCHMARK_CODEC_ARRAY_SIZE", 64 * 1024);
+    const size_t bytes  = arrays * size * sizeof(double);
+
+    std::vector<std::vector<double>> fields(arrays, std::vector<double>(size));
+    for (size_t i = 0; i < arrays; ++i) {
+        for (size_t j = 0; j < size; ++j) {
+            fields[i][j] = std::sin(double(i + 1) * double(j) * 1e-4);
+        }
+    }
+
+    std::string base = Resource<std::string>("$TMPDIR", "/tmp");
+    PathName path    = PathName::unique(base + "/benchmark") + ".codec";
+
+    std::vector<std::string> compressions{"none"};
+    if (codec::defaults::compression_algorithm() != "none") {
+        compressions.push_back(codec::defaults::compression_algorithm());
+    }
+
+    for (const auto& compression : compressions) {
+        {
+            codec::RecordWriter record;
+            record.compression(compression);
+            for (size_t i = 0; i < arrays; ++i) {
+                record.set("field" + std::to_string(i), codec::ref(fields[i]));
+            }
+
+            Timer timer;
+            record.write(path);
+            timer.stop();
+            report(compression, "write", bytes, timer);
+        }
+
+        {
+            std::vector<std::vector<double>> read(arrays);
+
+            Timer timer;
+            codec::RecordReader record(path);
+            for (size_t i = 0; i < arrays; ++i) {
+                record.read("field" + std::to_string(i), read[i]);
+            }
+            record.wait();
+            timer.stop();
+            report(compression, "read", bytes, timer);
+
+            EXPECT(read == fields);
+        }
+
+        path.unlink();
+    }
+}
+
+//-----------------------------------------------------------------------------
+
+}  // namespace eckit::test
+
+int main(int argc, char** argv) {
+    return eckit::testing::run_tests(argc, argv);
+}
@@ -451,6 +451,52 @@ CASE("Async read") {
 
 //-----------------------------------------------------------------------------
 
+CASE("Read started in the background") {
+    Arrays data1;
+    Arrays data2;
+    codec::RecordReader record1(globals::records[1]);
+    codec::RecordReader record2("record.atlas" + suffix());
+
+    record1.read("v3", data1.v3);
+    record1.read("v1", data1.v1);
+
+    // Linked items
+    record2.read("v4", data2.v1);
+    record2.read("v5", data2.v2);
+    record2.read("v6", data2.v3);
+
+    record1.start();
+    record2.start();
+
+    // Requests made after start() are completed by wait()
+    record1.read("v2", data1.v2);
+
+    record1.wait("v1");
+    record2.wait();
+    record1.wait();
+
+    EXPECT(data1 == globals::record2.data);
+    EXPECT(data2 == globals::record2.data);
+}
+
+//-----------------------------------------------------------------------------
+
+CASE("Errors are reported once all requests are completed") {
+    Arrays data;
+    std::vector<double> missing;
+    codec::RecordReader record("record1.atlas" + suffix());
+
+    record.read("v1", data.v1);
+    record.read("missing", missing);
+    record.read("v3", data.v3);
+
+    EXPECT_THROWS_AS(record.wait(), codec::InvalidRecord);
+    EXPECT(data.v1 == globals::record1.data.v1);
+    EXPECT(data.v3.size() == globals::record1.data.v3.size());
+}
+
+//-----------------------------------------------------------------------------
+
 CASE("Recursive Write/read records in nested subdirectories") {
     auto reference_path = eckit::PathName{"atlas_test_io_refpath"};
 
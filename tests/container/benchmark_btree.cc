@@ -0,0 +1,154 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+#include <algorithm>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include "eckit/container/BTree.h"
+#include "eckit/filesystem/PathName.h"
+#include "eckit/log/Bytes.h"
+#include "eckit/log/Timer.h"
+
+#include "eckit/testing/Test.h"
+
+using namespace eckit;
+using namespace eckit::testing;
+
+namespace eckit::test {
+
+//----------------------------------------------------------------------------------------------------------------------
+
+// Set $BENCHMARK_BTREE_ENTRIES to build a multi-GB tree, e.g. 100000000 entries of 16 bytes
+static size_t entries() {
+    const char* e = ::getenv("BENCHMARK_BTREE_ENTRIES");
+    return e ? size_t(::atoll(e)) : 1000000;
+}
+
+#define NGETS 1000000
+
+typedef BTree<unsigned long, unsigned long, 4096, BTreeNoLock> btree_t;
+
+static const PathName path("benchmark_btree.idx");
+
+static void build(size_t n, bool bulk) {
+    path.unlink(false);
+
+    btree_t btree(path);
+    btree.cacheLimit(256 * 1024 * 1024);
+
+    Timer timer;
+    if (bulk) {
+        std::vector<btree_t::result_type> entries;
+        entries.reserve(n);
+        for (size_t i = 0; i < n; ++i) {
+            entries.emplace_back(i, 2 * i);
+        }
+        btree.bulkLoad(entries.begin(), entries.end());
+    }
+    else {
+        for (size_t i = 0; i < n; ++i) {
+            btree.set(i, 2 * i);
+        }
+        btree.flush();
+    }
+    timer.stop();
+
+    std::cout << (bulk ? "bulk loaded " : "built ") << n << " entries in " << timer.elapsed() << "s, "
+              << Bytes(path.size()) << std::endl;
+}
+
+static void randomGets(const char* name, size_t n, size_t cacheLimit, bool mmap) {
+    btree_t btree(path, true);
+    btree.cacheLimit(cacheLimit);
+    btree.memoryMap(mmap);
+
+    std::mt19937_64 rng(42);
+    std::uniform_int_distribution<unsigned long> dist(0, n - 1);
+
+    Timer timer;
+    unsigned long v;
+    for (size_t i = 0; i < NGETS; ++i) {
+        unsigned long k = dist(rng);
+        ASSERT(btree.get(k, v) && v == 2 * k);
+    }
+    timer.stop();
+
+    const BTreeCacheStats& stats = btree.cacheStats();
+    double ratio                 = double(stats.hits_) / double(stats.hits_ + stats.misses_);
+
+    std::cout << std::setw(24) << name << " : " << std::setw(10) << size_t(NGETS / timer.elapsed())
+              << " gets/s, hit ratio " << std::setprecision(3) << ratio << ", " << stats << std::endl;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+CASE("Random get throughput") {
+    size_t n = entries();
+    build(n, false);
+    build(n, true);
+
+    size_t fileSize = size_t(path.size());
+
+    randomGets("cache 1 page", n, 1, false);
+    randomGets("cache 1% of file", n, fileSize / 100, false);
+    randomGets("cache 10% of file", n, fileSize / 10, false);
+    randomGets("cache unbounded", n, 0, false);
+    randomGets("mmap", n, 0, true);
+
+    path.unlink();
+}
+
+CASE("Batched lookups") {
+    size_t n = entries();
+    build(n, true);
+
+    std::mt19937_64 rng(42);
+    std::uniform_int_distribution<unsigned long> dist(0, n - 1);
+
+    std::vector<unsigned long> keys(NGETS);
+    for (auto& k : keys) {
+        k = dist(rng);
+    }
+    std::sort(keys.begin(), keys.end());
+
+    btree_t btree(path, true);
+    btree.cacheLimit(size_t(path.size()) / 100);
+
+    Timer timer;
+    unsigned long v;
+    for (unsigned long k : keys) {
+        ASSERT(btree.get(k, v));
+    }
+    timer.stop();
+    std::cout << std::setw(24) << "sorted get" << " : " << std::setw(10) << size_t(NGETS / timer.elapsed())
+              << " gets/s, " << btree.cacheStats() << std::endl;
+
+    btree.resetCacheStats();
+    std::vector<btree_t::result_type> result;
+    timer.start();
+    ASSERT(btree.getMany(keys, result) == keys.size());
+    timer.stop();
+    std::cout << std::setw(24) << "getMany" << " : " << std::setw(10) << size_t(NGETS / timer.elapsed())
+              << " gets/s, " << btree.cacheStats() << std::endl;
+
+    path.unlink();
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // namespace eckit::test
+
+int main(int argc, char** argv) {
+    return run_tests(argc, argv);
+}
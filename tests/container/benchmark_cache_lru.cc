@@ -0,0 +1,117 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "eckit/container/CacheLRU.h"
+#include "eckit/container/ConcurrentCacheLRU.h"
+#include "eckit/log/Timer.h"
+
+#include "eckit/testing/Test.h"
+
+using namespace eckit;
+using namespace eckit::testing;
+
+namespace eckit::test {
+
+//----------------------------------------------------------------------------------------------------------------------
+
+#define NOPS 1000000
+#define CAPACITY 100000
+#define KEYS 200000
+
+// How consumers use CacheLRU today: one global mutex around it
+class LockedCacheLRU {
+public:
+    explicit LockedCacheLRU(size_t capacity) :
+        cache_(capacity) {}
+
+    bool access(size_t key, size_t& value) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!cache_.exists(key)) {
+            return false;
+        }
+        value = cache_.access(key);
+        return true;
+    }
+
+    void insert(size_t key, size_t value) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        cache_.insert(key, value);
+    }
+
+private:
+    std::mutex mutex_;
+    CacheLRU<size_t, size_t> cache_;
+};
+
+template <typename CACHE>
+void benchmark(const char* name, size_t threads) {
+    CACHE cache(CAPACITY);
+
+    const size_t count = NOPS / threads;
+
+    Timer timer;
+
+    std::vector<std::thread> workers;
+    for (size_t t = 0; t < threads; ++t) {
+        workers.emplace_back([&cache, count, t] {
+            // Skewed towards a hot subset of the keys, as lookups of fields and files are
+            std::mt19937_64 rng(t);
+            std::geometric_distribution<size_t> dist(1.0 / CAPACITY);
+            size_t value;
+            for (size_t i = 0; i < count; ++i) {
+                size_t key = dist(rng) % KEYS;
+                if (!cache.access(key, value)) {
+                    cache.insert(key, key);
+                }
+            }
+        });
+    }
+    for (auto& w : workers) {
+        w.join();
+    }
+
+    timer.stop();
+
+    std::cout << std::setw(20) << name << " threads " << std::setw(3) << threads << " : " << std::setw(12)
+              << size_t(threads * count / timer.elapsed()) << " ops/s" << std::endl;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+CASE("Mixed lookups and inserts") {
+    size_t hw = std::max<size_t>(std::thread::hardware_concurrency(), 1);
+
+    std::vector<size_t> counts;
+    for (size_t n = 1; n < 2 * hw; n *= 2) {
+        counts.push_back(n);
+    }
+    counts.push_back(2 * hw);
+
+    for (size_t threads : counts) {
+        benchmark<LockedCacheLRU>("CacheLRU + mutex", threads);
+        benchmark<ConcurrentCacheLRU<size_t, size_t> >("ConcurrentCacheLRU", threads);
+    }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // namespace eckit::test
+
+int main(int argc, char** argv) {
+    return run_tests(argc, argv);
+}
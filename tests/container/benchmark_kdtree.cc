@@ -0,0 +1,216 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+#include <algorithm>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "eckit/container/KDFlat.h"
+#include "eckit/container/KDTree.h"
+#include "eckit/geometry/Point3.h"
+#include "eckit/log/Timer.h"
+#include "eckit/thread/ThreadPool.h"
+
+#include "eckit/testing/Test.h"
+
+using namespace eckit;
+using namespace eckit::testing;
+
+namespace eckit::test {
+
+//----------------------------------------------------------------------------------------------------------------------
+
+// Set $BENCHMARK_KDTREE_POINTS and $BENCHMARK_KDTREE_QUERIES for interpolation-sized runs, e.g. 10000000 each
+static size_t fromEnv(const char* name, size_t value) {
+    const char* e = ::getenv(name);
+    return e ? size_t(::atoll(e)) : value;
+}
+
+struct TreeTraits {
+    typedef geometry::Point3 Point;
+    typedef size_t Payload;
+};
+
+typedef KDTreeMemory<TreeTraits> Tree;
+typedef Tree::PointType Point;
+
+static std::vector<Tree::Value> points(size_t n) {
+    std::mt19937_64 rng(42);
+    std::uniform_real_distribution<double> dist(-1., 1.);
+
+    std::vector<Tree::Value> v;
+    v.reserve(n);
+    for (size_t i = 0; i < n; ++i) {
+        v.emplace_back(Point(dist(rng), dist(rng), dist(rng)), i);
+    }
+    return v;
+}
+
+static std::vector<Point> queries(size_t n) {
+    std::mt19937_64 rng(7);
+    std::uniform_real_distribution<double> dist(-1., 1.);
+
+    std::vector<Point> v;
+    v.reserve(n);
+    for (size_t i = 0; i < n; ++i) {
+        v.emplace_back(dist(rng), dist(rng), dist(rng));
+    }
+    return v;
+}
+
+static std::vector<size_t> threadCounts() {
+    size_t hw = std::max<size_t>(std::thread::hardware_concurrency(), 1);
+    std::vector<size_t> counts;
+    for (size_t n = 1; n < hw; n *= 2) {
+        counts.push_back(n);
+    }
+    counts.push_back(hw);
+    return counts;
+}
+
+static void report(const char* what, size_t threads, size_t count, Timer& timer) {
+    std::cout << std::setw(24) << what << " threads " << std::setw(3) << threads << " : " << std::setw(8)
+              << timer.elapsed() << "s, " << std::setw(12) << size_t(count / timer.elapsed()) << " /s" << std::endl;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+CASE("Build") {
+    const size_t n = fromEnv("BENCHMARK_KDTREE_POINTS", 1000000);
+
+    {
+        std::vector<Tree::Value> v = points(n);
+        Tree tree;
+        Timer timer;
+        tree.build(v);
+        timer.stop();
+        report("build", 1, n, timer);
+    }
+
+    for (size_t threads : threadCounts()) {
+        std::vector<Tree::Value> v = points(n);
+        ThreadPool pool("kdtree", threads);
+        Tree tree;
+        Timer timer;
+        tree.build(v, pool);
+        timer.stop();
+        report("parallel build", threads, n, timer);
+    }
+}
+
+CASE("k nearest neighbours") {
+    const size_t n = fromEnv("BENCHMARK_KDTREE_POINTS", 1000000);
+    const size_t q = fromEnv("BENCHMARK_KDTREE_QUERIES", 100000);
+
+    std::vector<Tree::Value> v = points(n);
+    std::vector<Point> p       = queries(q);
+
+    Tree tree;
+    tree.build(v);
+
+    for (size_t k : {1, 4, 16}) {
+        std::cout << "k = " << k << std::endl;
+
+        {
+            size_t sink = 0;
+            Timer timer;
+            for (const Point& x : p) {
+                sink += tree.kNearestNeighbours(x, k).size();
+            }
+            timer.stop();
+            EXPECT(sink == q * k);
+            report("kNearestNeighbours", 1, q, timer);
+        }
+
+        for (size_t threads : threadCounts()) {
+            ThreadPool pool("kdtree", threads);
+            std::vector<Tree::NodeList> result;
+            Timer timer;
+            tree.kNearestNeighbours(p, k, result, pool);
+            timer.stop();
+            EXPECT(result.size() == q);
+            report("batched", threads, q, timer);
+        }
+    }
+}
+
+CASE("Flat tree") {
+    const size_t n = fromEnv("BENCHMARK_KDTREE_POINTS", 1000000);
+    const size_t q = fromEnv("BENCHMARK_KDTREE_QUERIES", 100000);
+
+    std::vector<Tree::Value> v = points(n);
+    std::vector<Point> p       = queries(q);
+
+    Tree tree;
+    KDTreeFlat<TreeTraits> flat;
+
+    {
+        Timer timer;
+        flat.build(v);
+        timer.stop();
+        report("flat build", 1, n, timer);
+    }
+    tree.build(v);
+
+    size_t expected = 0;
+    {
+        Timer timer;
+        for (const Point& x : p) {
+            expected += tree.nearestNeighbour(x).payload();
+        }
+        timer.stop();
+        report("nearestNeighbour", 1, q, timer);
+    }
+
+    {
+        size_t sink = 0;
+        Timer timer;
+        for (const Point& x : p) {
+            sink += flat.nearestNeighbour(x).payload();
+        }
+        timer.stop();
+        EXPECT(sink == expected);
+        report("flat nearestNeighbour", 1, q, timer);
+    }
+
+    for (size_t k : {4, 16}) {
+        std::cout << "k = " << k << std::endl;
+
+        {
+            Timer timer;
+            for (const Point& x : p) {
+                tree.kNearestNeighbours(x, k);
+            }
+            timer.stop();
+            report("kNearestNeighbours", 1, q, timer);
+        }
+
+        {
+            Timer timer;
+            for (const Point& x : p) {
+                flat.kNearestNeighbours(x, k);
+            }
+            timer.stop();
+            report("flat kNearestNeighbours", 1, q, timer);
+        }
+    }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // namespace eckit::test
+
+int main(int argc, char** argv) {
+    return run_tests(argc, argv);
+}
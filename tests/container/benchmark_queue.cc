@@ -0,0 +1,109 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+#include <atomic>
+#include <iomanip>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+#include "eckit/container/Queue.h"
+#include "eckit/container/RingQueue.h"
+#include "eckit/log/Timer.h"
+
+#include "eckit/testing/Test.h"
+
+using namespace eckit;
+using namespace eckit::testing;
+
+namespace eckit::test {
+
+//----------------------------------------------------------------------------------------------------------------------
+
+#define NITEMS 1000000
+
+template <typename QUEUE>
+void benchmark(const char* name, size_t nprod, size_t ncons, size_t depth) {
+    QUEUE q(depth);
+    const size_t count = NITEMS / nprod;
+
+    std::atomic<size_t> sum(0);
+
+    Timer timer;
+
+    std::vector<std::thread> consumers;
+    for (size_t id = 0; id < ncons; ++id) {
+        consumers.emplace_back(std::thread([&q, &sum] {
+            size_t e;
+            size_t s = 0;
+            while (q.pop(e) >= 0) {
+                s += e;
+            }
+            sum += s;
+        }));
+    }
+
+    std::vector<std::thread> producers;
+    for (size_t id = 0; id < nprod; ++id) {
+        producers.emplace_back(std::thread([&q, count] {
+            for (size_t j = 1; j <= count; ++j) {
+                q.push(j);
+            }
+        }));
+    }
+
+    for (auto& p : producers) {
+        p.join();
+    }
+    q.close();
+    for (auto& c : consumers) {
+        c.join();
+    }
+
+    timer.stop();
+
+    EXPECT(sum == nprod * count * (count + 1) / 2);
+
+    std::cout << std::setw(14) << name << " producers " << std::setw(3) << nprod << " consumers " << std::setw(3)
+              << ncons << " depth " << std::setw(5) << depth << " : " << std::setw(12)
+              << size_t(nprod * count / timer.elapsed()) << " items/s" << std::endl;
+}
+
+void compare(size_t nprod, size_t ncons, size_t depth) {
+    benchmark<Queue<size_t>>("Queue", nprod, ncons, depth);
+    benchmark<RingQueue<size_t>>("RingQueue", nprod, ncons, depth);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+CASE("Single producer single consumer") {
+    for (size_t depth : {16, 1024}) {
+        compare(1, 1, depth);
+        benchmark<SPSCRingQueue<size_t>>("SPSCRingQueue", 1, 1, depth);
+    }
+}
+
+CASE("Multiple producers and consumers") {
+    size_t hw = std::max<size_t>(std::thread::hardware_concurrency(), 2);
+    for (size_t depth : {16, 1024}) {
+        compare(hw / 2, hw / 2, depth);
+        compare(hw, 1, depth);
+        compare(1, hw, depth);
+        compare(4 * hw, 4 * hw, depth);
+    }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // namespace eckit::test
+
+int main(int argc, char** argv) {
+    return run_tests(argc, argv);
+}
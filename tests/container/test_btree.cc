@@ -11,6 +11,7 @@
 #include <random>
 
 #include "eckit/container/BTree.h"
+#include "eckit/filesystem/TmpFile.h"
 #include "eckit/os/Semaphore.h"
 #include "eckit/types/FixedString.h"
 #include "eckit/types/Types.h"
@@ -344,6 +345,235 @@ CASE("test_eckit_container_fixedsttring_fixedsttring") {
     //  btree.dump();
 }
 
+CASE("test_eckit_container_btree_bounded_cache") {
+    TmpFile path(false);
+
+    const int N = 20000;
+
+    std::vector<int> keys(N);
+    for (int i = 0; i < N; ++i) {
+        keys[i] = i;
+    }
+    std::shuffle(keys.begin(), keys.end(), std::mt19937(42));
+
+    typedef BTree<int, int, 1024, BTreeNoLock> btree_t;
+
+    {
+        btree_t btree(path);
+        btree.cacheLimit(16 * 1024);  // 16 pages, far fewer than the tree
+
+        for (int k : keys) {
+            btree.set(k, -k);
+        }
+
+        EXPECT(btree.cacheStats().evictions_ > 0);
+        EXPECT(btree.cacheStats().writeBacks_ > 0);
+
+        // Dirty pages that were evicted were written back
+        for (int k : keys) {
+            int v;
+            EXPECT(btree.get(k, v));
+            EXPECT(v == -k);
+        }
+        EXPECT(btree.count() == size_t(N));
+    }
+
+    {
+        btree_t btree(path, true);
+        btree.cacheLimit(64 * 1024);
+
+        int v;
+        for (int i = 0; i < N; ++i) {
+            EXPECT(btree.get(i, v));
+        }
+        EXPECT(btree.cacheStats().misses_ > 0);
+
+        btree.resetCacheStats();
+        for (int i = 0; i < 100; ++i) {
+            EXPECT(btree.get(i, v));
+        }
+        EXPECT(btree.cacheStats().hits_ > btree.cacheStats().misses_);
+
+        std::vector<std::pair<int, int> > res;
+        btree.range(100, 4099, res);
+        EXPECT(res.size() == 4000);
+        EXPECT(res.front().first == 100 && res.back().first == 4099);
+    }
+}
+
+CASE("test_eckit_container_btree_mmap") {
+    TmpFile path(false);
+
+    typedef BTree<int, int, 512, BTreeNoLock> btree_t;
+
+    {
+        btree_t btree(path);
+        for (int k = 0; k < 5000; ++k) {
+            btree.set(k, 2 * k);
+        }
+        btree.sync();
+    }
+
+    btree_t btree(path, true);
+    btree.memoryMap(true);
+
+    int v;
+    for (int k = 0; k < 5000; ++k) {
+        EXPECT(btree.get(k, v));
+        EXPECT(v == 2 * k);
+    }
+    EXPECT(!btree.get(5000, v));
+    EXPECT(btree.cacheStats().misses_ == 0);
+
+    std::vector<std::pair<int, int> > res;
+    btree.range(10, 19, res);
+    EXPECT(res.size() == 10);
+
+    btree_t writable(path);
+    EXPECT_THROWS_AS(writable.memoryMap(true), AssertionFailed);
+
+    // The file grows under the mapping: new pages are appended, and the root now points to them
+    for (int k = 5000; k < 20000; ++k) {
+        writable.set(k, 2 * k);
+    }
+    writable.sync();
+
+    std::vector<int> keys;
+    for (int k = 0; k < 20000; k += 7) {
+        keys.push_back(k);
+    }
+    EXPECT(btree.getMany(keys, res) == keys.size());
+    for (size_t i = 0; i < keys.size(); ++i) {
+        EXPECT(res[i].first == keys[i] && res[i].second == 2 * keys[i]);
+    }
+}
+
+CASE("test_eckit_container_btree_bulk_load") {
+    TmpFile path(false);
+    typedef BTree<int, int, 256, BTreeNoLock> btree_t;
+
+    for (int n : {0, 1, 10, 20000}) {
+        path.unlink(false);
+
+        std::vector<std::pair<int, int> > entries;
+        for (int i = 0; i < n; ++i) {
+            entries.emplace_back(2 * i, -i);
+        }
+
+        {
+            btree_t btree(path);
+            EXPECT(btree.bulkLoad(entries.begin(), entries.end()) == size_t(n));
+            EXPECT(btree.count() == size_t(n));
+        }
+
+        btree_t btree(path);
+
+        int v;
+        for (int i = 0; i < n; ++i) {
+            EXPECT(btree.get(2 * i, v));
+            EXPECT(v == -i);
+            EXPECT(!btree.get(2 * i + 1, v));
+        }
+
+        std::vector<std::pair<int, int> > res;
+        btree.range(-1, 2 * n, res);
+        EXPECT(res == entries);
+
+        // The tree grows with ordinary inserts afterwards
+        for (int i = 0; i < n; ++i) {
+            btree.set(2 * i + 1, i);
+        }
+        EXPECT(btree.count() == size_t(2 * n));
+        for (int i = 0; i < 2 * n; ++i) {
+            EXPECT(btree.get(i, v));
+        }
+
+        if (n > 0) {
+            btree_t full(path);
+            EXPECT_THROWS_AS(full.bulkLoad(entries.begin(), entries.end()), AssertionFailed);
+        }
+    }
+
+    // Unsorted input, with duplicates
+    path.unlink(false);
+
+    std::vector<std::pair<int, int> > entries;
+    for (int i = 0; i < 1000; ++i) {
+        entries.emplace_back(i, i);
+    }
+    std::shuffle(entries.begin(), entries.end(), std::mt19937(42));
+    entries.emplace_back(500, -1);
+
+    {
+        btree_t btree(path);
+        std::vector<std::pair<int, int> > unsorted(entries);
+        EXPECT_THROWS_AS(btree.bulkLoad(unsorted.begin(), unsorted.end()), AssertionFailed);
+    }
+
+    path.unlink(false);
+    btree_t btree(path);
+    EXPECT(btree.bulkLoad(entries) == 1000);
+
+    int v;
+    EXPECT(btree.get(500, v) && v == -1);
+    EXPECT(btree.get(999, v) && v == 999);
+}
+
+CASE("test_eckit_container_btree_get_many") {
+    TmpFile path(false);
+
+    typedef BTree<int, int, 256, BTreeNoLock> btree_t;
+
+    btree_t btree(path);
+    for (int i = 0; i < 20000; ++i) {
+        btree.set(3 * i, i);
+    }
+
+    std::vector<int> keys;
+    for (int k = -10; k < 60010; k += 2) {
+        keys.push_back(k);
+    }
+    keys.push_back(60010);
+    keys.push_back(60010);
+
+    std::vector<std::pair<int, int> > res;
+    EXPECT(btree.getMany(keys, res) == 10000);
+
+    size_t j = 0;
+    for (int k : keys) {
+        int v;
+        if (btree.get(k, v)) {
+            EXPECT(j < res.size());
+            EXPECT(res[j].first == k && res[j].second == v);
+            j++;
+        }
+    }
+    EXPECT(j == res.size());
+
+    // A sorted batch fetches each page once, rather than every page on the path of every key
+    std::vector<int> all;
+    for (int i = 0; i < 20000; ++i) {
+        all.push_back(3 * i);
+    }
+
+    btree.resetCacheStats();
+    EXPECT(btree.getMany(all, res) == all.size());
+    size_t fetches = btree.cacheStats().hits_ + btree.cacheStats().misses_;
+
+    btree.resetCacheStats();
+    int v;
+    for (int k : all) {
+        EXPECT(btree.get(k, v));
+    }
+    EXPECT(fetches * 10 < btree.cacheStats().hits_ + btree.cacheStats().misses_);
+
+    std::vector<int> unsorted{3, 1};
+    EXPECT_THROWS_AS(btree.getMany(unsorted, res), AssertionFailed);
+
+    std::vector<int> none;
+    EXPECT(btree.getMany(none, res) == 0);
+}
+
 //----------------------------------------------------------------------------------------------------------------------
 
 }  // namespace eckit::test
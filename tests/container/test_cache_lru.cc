@@ -8,9 +8,14 @@
  * does it submit to any jurisdiction.
  */
 
+#include <atomic>
+#include <chrono>
 #include <string>
+#include <thread>
+#include <vector>
 
 #include "eckit/container/CacheLRU.h"
+#include "eckit/container/ConcurrentCacheLRU.h"
 #include "eckit/exception/Exceptions.h"
 
 #include "eckit/testing/Test.h"
@@ -178,6 +183,163 @@ CASE("test_cache_lru_purge") {
     EXPECT(purgeCalls == 3);
 }
 
+CASE("test_concurrent_cache_lru_basic") {
+    // A single shard behaves exactly like CacheLRU
+    eckit::ConcurrentCacheLRU<std::string, size_t> cache(3, nullptr, nullptr, 1);
+
+    EXPECT(cache.size() == 0);
+    EXPECT(cache.capacity() == 3);
+    EXPECT(cache.shards() == 1);
+
+    EXPECT(!cache.insert("ddd", 40));
+    EXPECT(!cache.insert("aaa", 5));
+    EXPECT(cache.insert("aaa", 10));
+    EXPECT(cache.size() == 2);
+
+    EXPECT(cache.access("aaa") == 10);
+    EXPECT(cache.access("ddd") == 40);
+
+    EXPECT(!cache.insert("ccc", 30));
+    EXPECT(!cache.insert("eee", 50));
+    EXPECT(!cache.insert("bbb", 20));
+    EXPECT(cache.size() == 3);
+
+    EXPECT(!cache.exists("aaa"));
+    EXPECT(!cache.exists("ddd"));
+    EXPECT_THROWS_AS(cache.access("ddd"), eckit::OutOfRange);
+
+    size_t v;
+    EXPECT(cache.access("eee", v) && v == 50);
+    EXPECT(!cache.access("aaa", v));
+
+    // eee was used last, ccc is the least recently used
+    cache.capacity(2);
+    EXPECT(!cache.exists("ccc"));
+    EXPECT(cache.exists("bbb"));
+    EXPECT(cache.exists("eee"));
+
+    EXPECT(cache.extract("bbb") == 20);
+    EXPECT_THROWS_AS(cache.extract("bbb"), eckit::OutOfRange);
+    EXPECT(!cache.remove("bbb"));
+    EXPECT(cache.remove("eee"));
+    EXPECT(cache.size() == 0);
+
+    CacheLRUStats stats = cache.stats();
+    EXPECT(stats.hits_ == 3);
+    EXPECT(stats.misses_ == 2);
+    EXPECT(stats.evictions_ == 3);
+}
+
+CASE("test_concurrent_cache_lru_purge") {
+    purgeCalls = 0;
+    {
+        eckit::ConcurrentCacheLRU<std::string, size_t> cache(4, purge, nullptr, 1);
+
+        EXPECT(!cache.insert("aaa", 10));
+        EXPECT(!cache.insert("bbb", 20));
+        EXPECT(!cache.insert("ccc", 30));
+        EXPECT(!cache.insert("ddd", 40));
+        EXPECT(purgeCalls == 0);
+
+        cache.capacity(3);
+        EXPECT(purgeCalls == 1);
+
+        EXPECT(cache.extract("bbb") == 20);
+        EXPECT(purgeCalls == 1);
+
+        EXPECT(cache.remove("ccc"));
+        EXPECT(purgeCalls == 2);
+
+        cache.clear();
+        EXPECT(purgeCalls == 3);
+
+        EXPECT(!cache.insert("eee", 50));
+    }
+    // The destructor purges
+    EXPECT(purgeCalls == 4);
+}
+
+static size_t sizeOf(const std::string& key, const std::string& value) {
+    return key.size() + value.size();
+}
+
+CASE("test_concurrent_cache_lru_bytes") {
+    eckit::ConcurrentCacheLRU<std::string, std::string> cache(1000, nullptr, sizeOf, 4);
+    EXPECT(cache.shards() == 4);
+
+    for (size_t i = 0; i < 1000; ++i) {
+        cache.insert(std::to_string(i), std::string(i % 50, 'x'));
+        EXPECT(cache.footprint() <= 1000);
+    }
+    EXPECT(cache.footprint() > 500);
+    EXPECT(cache.stats().evictions_ > 0);
+
+    // An entry larger than a shard stays, alone in its shard
+    cache.insert("half", std::string(500, 'x'));
+    EXPECT(cache.exists("half"));
+    EXPECT(cache.access("half").size() == 500);
+
+    // An entry larger than the cache does not
+    cache.insert("big", std::string(1000, 'x'));
+    EXPECT(!cache.exists("big"));
+}
+
+CASE("test_concurrent_cache_lru_ttl") {
+    eckit::ConcurrentCacheLRU<int, int> cache(100);
+    cache.ttl(0.05);
+
+    cache.insert(1, 1);
+    EXPECT(cache.exists(1));
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+    EXPECT(!cache.exists(1));
+    int v;
+    EXPECT(!cache.access(1, v));
+    EXPECT(cache.stats().expirations_ == 1);
+    EXPECT(cache.size() == 0);
+
+    cache.ttl(0);
+    cache.insert(2, 2);
+    std::this_thread::sleep_for(std::chrono::milliseconds(60));
+    EXPECT(cache.access(2) == 2);
+}
+
+CASE("test_concurrent_cache_lru_threads") {
+    eckit::ConcurrentCacheLRU<int, int> cache(1024);
+
+    std::atomic<size_t> errors(0);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 8; ++t) {
+        threads.emplace_back([&cache, &errors, t] {
+            for (int i = 0; i < 20000; ++i) {
+                int k = (i * 7 + t) % 4096;
+                int v;
+                if (cache.access(k, v)) {
+                    if (v != -k) {
+                        errors++;
+                    }
+                }
+                else {
+                    cache.insert(k, -k);
+                }
+                if (i % 100 == 0) {
+                    cache.remove(k);
+                }
+            }
+        });
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+
+    EXPECT(errors == 0);
+    EXPECT(cache.size() <= 1024);
+
+    CacheLRUStats stats = cache.stats();
+    EXPECT(stats.hits_ + stats.misses_ == 8 * 20000);
+}
+
 //----------------------------------------------------------------------------------------------------------------------
 
 }  // namespace eckit::test
@@ -9,6 +9,7 @@
  */
 
 #include "eckit/container/Queue.h"
+#include "eckit/container/RingQueue.h"
 #include "eckit/log/Log.h"
 #include "eckit/testing/Test.h"
 
@@ -80,6 +81,103 @@ CASE("Multi Producer Multi Consumer Queue access size = 1") {
     }
 }
 
+CASE("RingQueue capacity and non-blocking access") {
+    RingQueue<std::string> q(5);
+    EXPECT(q.maxSize() == 8);
+    EXPECT(q.empty());
+
+    std::string e;
+    EXPECT(!q.tryPop(e));
+
+    for (size_t i = 0; i < q.maxSize(); ++i) {
+        EXPECT(q.tryPush(std::to_string(i)));
+    }
+    EXPECT(!q.tryPush("full"));
+    EXPECT(q.size() == 8);
+
+    for (size_t i = 0; i < 4; ++i) {
+        EXPECT(q.tryPop(e));
+        EXPECT(e == std::to_string(i));
+    }
+
+    std::vector<std::string> elems(10);
+    EXPECT(q.pop(elems) == 4);
+    EXPECT(elems[0] == "4");
+    EXPECT(elems[3] == "7");
+
+    // Elements left behind are destroyed with the queue
+    q.emplace(3, 'x');
+    EXPECT(q.size() == 1);
+}
+
+CASE("RingQueue close and interrupt") {
+    RingQueue<int> q(4);
+    q.push(1);
+    q.close();
+    EXPECT(q.closed());
+
+    int e = 0;
+    EXPECT(q.pop(e) == 0);
+    EXPECT(e == 1);
+    EXPECT(q.pop(e) == -1);
+    EXPECT_THROWS_AS(q.push(2), AssertionFailed);
+
+    RingQueue<int> r(4);
+    std::thread consumer([&r] {
+        int e;
+        EXPECT_THROWS_AS(r.pop(e), QueueInterruptedError);
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    r.interrupt(std::make_exception_ptr(QueueInterruptedError("test", Here())));
+    consumer.join();
+}
+
+template <typename QUEUE>
+void exchange(size_t nprod, size_t ncons, size_t depth) {
+    QUEUE q(depth);
+    const size_t count = MULT * 1000;
+
+    std::atomic<size_t> sum(0);
+    std::vector<std::thread> consumers;
+    for (size_t id = 0; id < ncons; ++id) {
+        consumers.emplace_back(std::thread([&q, &sum] {
+            size_t e;
+            while (q.pop(e) >= 0) {
+                sum += e;
+            }
+        }));
+    }
+
+    std::vector<std::thread> producers;
+    for (size_t id = 0; id < nprod; ++id) {
+        producers.emplace_back(std::thread([&q, count] {
+            for (size_t j = 1; j <= count; ++j) {
+                q.push(j);
+            }
+        }));
+    }
+
+    for (auto& p : producers) {
+        p.join();
+    }
+    q.close();
+    for (auto& c : consumers) {
+        c.join();
+    }
+
+    EXPECT(sum == nprod * count * (count + 1) / 2);
+}
+
+CASE("RingQueue multi producer multi consumer") {
+    exchange<RingQueue<size_t>>(13, 7, 1);
+    exchange<RingQueue<size_t>>(7, 13, 16);
+}
+
+CASE("RingQueue single producer single consumer") {
+    exchange<SPSCRingQueue<size_t>>(1, 1, 1);
+    exchange<SPSCRingQueue<size_t>>(1, 1, 64);
+}
+
 //----------------------------------------------------------------------------------------------------------------------
 
 }  // namespace eckit::test
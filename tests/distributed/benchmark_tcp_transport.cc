@@ -0,0 +1,186 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "eckit/distributed/Consumer.h"
+#include "eckit/distributed/Message.h"
+#include "eckit/distributed/Producer.h"
+#include "eckit/distributed/Transport.h"
+#include "eckit/log/Timer.h"
+#include "eckit/net/TCPServer.h"
+#include "eckit/option/CmdArgs.h"
+#include "eckit/testing/Test.h"
+
+using namespace eckit;
+using namespace eckit::testing;
+using namespace eckit::distributed;
+
+namespace eckit::test {
+
+//----------------------------------------------------------------------------------------------------------------------
+
+// Set $BENCHMARK_TRANSPORT_MESSAGES and $BENCHMARK_TRANSPORT_WORKERS to change the load
+static size_t fromEnv(const char* name, size_t value) {
+    const char* e = ::getenv(name);
+    return e ? size_t(::atoll(e)) : value;
+}
+
+static long long now() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+static void usage(const std::string&) {}
+
+struct Latency {
+    size_t count_       = 0;
+    long long total_    = 0;
+    long long maximum_  = 0;
+};
+
+/// Sends small messages stamped with the time they were produced
+class BenchmarkProducer : public Producer {
+public:
+    BenchmarkProducer(Transport& transport, size_t messages) : Producer(transport), messages_(messages) {}
+
+    bool produce(Message& message) override {
+        if (sent_ == messages_) {
+            return false;
+        }
+        message << sent_++ << now();
+        return true;
+    }
+
+    void messageFromWorker(Message& message, int) const override {
+        Latency l;
+        message >> l.count_ >> l.total_ >> l.maximum_;
+
+        latency_.count_ += l.count_;
+        latency_.total_ += l.total_;
+        latency_.maximum_ = std::max(latency_.maximum_, l.maximum_);
+    }
+
+    void finalise() override {}
+
+    const Latency& latency() const { return latency_; }
+
+private:
+    size_t messages_;
+    size_t sent_ = 0;
+
+    mutable Latency latency_;
+};
+
+/// Measures the time from production to consumption
+class BenchmarkConsumer : public Consumer {
+public:
+    using Consumer::Consumer;
+
+    void consume(Message& message) override {
+        size_t id;
+        long long produced;
+        message >> id >> produced;
+
+        long long latency = now() - produced;
+        latency_.count_++;
+        latency_.total_ += latency;
+        latency_.maximum_ = std::max(latency_.maximum_, latency);
+    }
+
+    void shutdown(Message& message) override { message << latency_.count_ << latency_.total_ << latency_.maximum_; }
+
+    void finalise() override {}
+
+private:
+    void getNextMessage(Message& message) const override { getNextWorkMessage(message); }
+
+    Latency latency_;
+};
+
+static int freePort() {
+    net::TCPServer server(0);
+    return server.localPort();
+}
+
+static void run(size_t messages, size_t workers, size_t credits, size_t batch) {
+    const int port = freePort();
+
+    // Listening before the workers connect
+    option::CmdArgs producerArgs(&usage);
+    producerArgs.set("transport", "tcp");
+    producerArgs.set("port", size_t(port));
+    producerArgs.set("credits", credits);
+    producerArgs.set("batch", batch);
+    std::unique_ptr<Transport> producerTransport(TransportFactory::build(producerArgs));
+
+    std::vector<std::thread> threads;
+    for (size_t i = 0; i < workers; ++i) {
+        threads.emplace_back([&] {
+            option::CmdArgs args(&usage);
+            args.set("transport", "tcp");
+            args.set("host", "localhost");
+            args.set("port", size_t(port));
+            args.set("credits", credits);
+            std::unique_ptr<Transport> transport(TransportFactory::build(args));
+            BenchmarkConsumer consumer(*transport);
+            static_cast<Actor&>(consumer).run();
+        });
+    }
+
+    BenchmarkProducer producer(*producerTransport, messages);
+
+    Timer timer;
+    producer.run();
+    timer.stop();
+
+    for (auto& t : threads) {
+        t.join();
+    }
+
+    const Latency& latency = producer.latency();
+    EXPECT(latency.count_ == messages);
+
+    std::cout << std::setw(2) << workers << " workers, credits " << std::setw(3) << credits << ", batch "
+              << std::setw(3) << batch << " : " << std::setw(10) << size_t(double(messages) / timer.elapsed())
+              << " messages per second, latency mean " << std::setw(8)
+              << double(latency.total_) / double(latency.count_) / 1000. << "us, max " << std::setw(8)
+              << double(latency.maximum_) / 1000. << "us" << std::endl;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+CASE("Producer and workers on localhost") {
+    const size_t messages = fromEnv("BENCHMARK_TRANSPORT_MESSAGES", 20000);
+    const size_t workers  = fromEnv("BENCHMARK_TRANSPORT_WORKERS", 2);
+
+    // A single slot and no batching is a round trip per message
+    run(messages, workers, 1, 1);
+    run(messages, workers, 16, 1);
+    run(messages, workers, 16, 8);
+    run(messages, workers, 64, 32);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // namespace eckit::test
+
+int main(int argc, char** argv) {
+    return run_tests(argc, argv);
+}
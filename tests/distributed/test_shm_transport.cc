@@ -0,0 +1,276 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "eckit/distributed/Consumer.h"
+#include "eckit/distributed/Message.h"
+#include "eckit/distributed/Producer.h"
+#include "eckit/distributed/Transport.h"
+#include "eckit/exception/Exceptions.h"
+#include "eckit/log/Timer.h"
+#include "eckit/option/CmdArgs.h"
+#include "eckit/testing/Test.h"
+
+using namespace eckit;
+using namespace eckit::testing;
+using namespace eckit::distributed;
+
+namespace eckit::test {
+
+//----------------------------------------------------------------------------------------------------------------------
+
+// Set $BENCHMARK_TRANSPORT_MESSAGES to change the load
+static size_t fromEnv(const char* name, size_t value) {
+    const char* e = ::getenv(name);
+    return e ? size_t(::atoll(e)) : value;
+}
+
+static void usage(const std::string&) {}
+
+static std::string segment(const char* name) {
+    std::ostringstream oss;
+    oss << "/eckit-test-shm-" << name << "-" << ::getpid();
+    return oss.str();
+}
+
+// Streamed as unsigned long long, unsigned long are sent as 32 bits
+struct Totals {
+    unsigned long long count_ = 0;
+    unsigned long long sum_   = 0;
+    unsigned long long bytes_ = 0;
+};
+
+/// Sends numbered messages with a payload of a given size
+class TestProducer : public Producer {
+public:
+    TestProducer(Transport& transport, size_t messages, size_t size) :
+        Producer(transport), messages_(messages), payload_(size, 'x') {}
+
+    bool produce(Message& message) override {
+        if (sent_ == messages_) {
+            return false;
+        }
+        message << sent_++ << payload_;
+        return true;
+    }
+
+    void messageFromWorker(Message& message, int) const override {
+        Totals t;
+        message >> t.count_ >> t.sum_ >> t.bytes_;
+
+        totals_.count_ += t.count_;
+        totals_.sum_ += t.sum_;
+        totals_.bytes_ += t.bytes_;
+        workers_++;
+    }
+
+    void finalise() override {}
+
+    const Totals& totals() const { return totals_; }
+    size_t workers() const { return workers_; }
+
+private:
+    size_t messages_;
+    size_t sent_ = 0;
+    std::string payload_;
+
+    mutable Totals totals_;
+    mutable size_t workers_ = 0;
+};
+
+class TestConsumer : public Consumer {
+public:
+    using Consumer::Consumer;
+
+    void consume(Message& message) override {
+        size_t id;
+        std::string payload;
+        message >> id >> payload;
+
+        totals_.count_++;
+        totals_.sum_ += id;
+        totals_.bytes_ += payload.size();
+    }
+
+    void shutdown(Message& message) override { message << totals_.count_ << totals_.sum_ << totals_.bytes_; }
+
+    void finalise() override {}
+
+private:
+    void getNextMessage(Message& message) const override { getNextWorkMessage(message); }
+
+    Totals totals_;
+};
+
+static Transport* transport(const std::string& name, bool worker) {
+    option::CmdArgs args(&usage);
+    args.set("transport", "shm");
+    args.set("shm", name);
+    args.set("slots", size_t(16));
+    args.set("slot-size", size_t(64 * 1024));
+    args.set("worker", worker);
+    return TransportFactory::build(args);
+}
+
+static void consume(const std::string& name) {
+    std::unique_ptr<Transport> t(transport(name, true));
+    TestConsumer consumer(*t);
+    static_cast<Actor&>(consumer).run();
+}
+
+static void check(const TestProducer& producer, size_t messages, size_t size, size_t workers) {
+    EXPECT(producer.workers() == workers);
+    EXPECT(producer.totals().count_ == messages);
+    EXPECT(producer.totals().sum_ == messages * (messages - 1) / 2);
+    EXPECT(producer.totals().bytes_ == messages * size);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+CASE("Every message is consumed once by worker threads") {
+    const size_t messages = fromEnv("BENCHMARK_TRANSPORT_MESSAGES", 100000);
+
+    for (size_t workers : {1, 4}) {
+        for (size_t size : {16, 32 * 1024}) {
+            std::string name = segment("threads");
+
+            std::unique_ptr<Transport> producerTransport(transport(name, false));
+
+            std::vector<std::thread> threads;
+            for (size_t i = 0; i < workers; ++i) {
+                threads.emplace_back([&] { consume(name); });
+            }
+
+            TestProducer producer(*producerTransport, messages, size);
+
+            Timer timer;
+            producer.run();
+            timer.stop();
+
+            for (auto& t : threads) {
+                t.join();
+            }
+
+            check(producer, messages, size, workers);
+
+            std::cout << std::setw(2) << workers << " workers, " << std::setw(6) << size << " bytes : "
+                      << std::setw(10) << size_t(double(messages) / timer.elapsed()) << " messages per second"
+                      << std::endl;
+        }
+    }
+}
+
+CASE("Worker processes") {
+    const size_t messages = 10000;
+    const size_t workers  = 3;
+
+    std::string name = segment("processes");
+
+    std::unique_ptr<Transport> producerTransport(transport(name, false));
+
+    std::vector<pid_t> pids;
+    for (size_t i = 0; i < workers; ++i) {
+        pid_t pid = ::fork();
+        if (pid == 0) {
+            int status = 0;
+            try {
+                consume(name);
+            }
+            catch (std::exception& e) {
+                std::cerr << e.what() << std::endl;
+                status = 1;
+            }
+            ::_exit(status);
+        }
+        EXPECT(pid > 0);
+        pids.push_back(pid);
+    }
+
+    TestProducer producer(*producerTransport, messages, 100);
+    producer.run();
+
+    for (pid_t pid : pids) {
+        int status;
+        EXPECT(::waitpid(pid, &status, 0) == pid);
+        EXPECT(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+    }
+
+    check(producer, messages, 100, workers);
+}
+
+CASE("Messages larger than the slots are rejected") {
+    std::string name = segment("large");
+
+    std::unique_ptr<Transport> producerTransport(transport(name, false));
+
+    bool aborted = false;
+    std::thread thread([&] {
+        try {
+            consume(name);
+        }
+        catch (SeriousBug&) {
+            aborted = true;
+        }
+    });
+
+    TestProducer producer(*producerTransport, 1, 128 * 1024);
+    EXPECT_THROWS_AS(producer.run(), BadValue);
+
+    producerTransport->abort();
+    thread.join();
+    EXPECT(aborted);
+}
+
+CASE("The producer does not wait for workers that have died") {
+    std::string name = segment("dead");
+
+    std::unique_ptr<Transport> producerTransport(transport(name, false));
+
+    // Attaches, then exits without reading anything
+    pid_t pid = ::fork();
+    if (pid == 0) {
+        std::unique_ptr<Transport> t(transport(name, true));
+        ::_exit(0);
+    }
+    EXPECT(pid > 0);
+
+    int status;
+    EXPECT(::waitpid(pid, &status, 0) == pid);
+
+    // More messages than slots
+    TestProducer producer(*producerTransport, 100, 16);
+    EXPECT_THROWS_AS(producer.run(), SeriousBug);
+}
+
+CASE("The segment of a running producer is not replaced") {
+    std::string name = segment("running");
+
+    std::unique_ptr<Transport> producerTransport(transport(name, false));
+    EXPECT_THROWS_AS(transport(name, false), UserError);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // namespace eckit::test
+
+int main(int argc, char** argv) {
+    return run_tests(argc, argv);
+}
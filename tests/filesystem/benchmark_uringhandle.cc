@@ -0,0 +1,125 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+#include <cstdlib>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <vector>
+
+#include "eckit/config/Resource.h"
+#include "eckit/eckit.h"
+#include "eckit/filesystem/PathName.h"
+#include "eckit/io/AutoCloser.h"
+#include "eckit/io/FileHandle.h"
+#include "eckit/io/URingHandle.h"
+#include "eckit/log/Bytes.h"
+#include "eckit/log/Timer.h"
+#include "eckit/testing/Test.h"
+
+#if eckit_HAVE_AIO
+#include "eckit/io/AIOHandle.h"
+#endif
+
+using namespace eckit;
+using namespace eckit::testing;
+
+namespace eckit::test {
+
+//----------------------------------------------------------------------------------------------------------------------
+
+// Set $BENCHMARK_IO_SIZE (bytes) and $TMPDIR to measure a device, e.g. 8589934592 on an NVMe mount
+static size_t fromEnv(const char* name, size_t value) {
+    const char* e = ::getenv(name);
+    return e ? size_t(::atoll(e)) : value;
+}
+
+struct Candidate {
+    const char* name;
+    std::function<DataHandle*(const PathName&)> make;
+    bool reads;
+};
+
+static std::vector<Candidate> candidates() {
+    std::vector<Candidate> c;
+    c.push_back({"FileHandle", [](const PathName& p) { return new FileHandle(p); }, true});
+#if eckit_HAVE_AIO
+    // AIOHandle does not read
+    c.push_back({"AIOHandle", [](const PathName& p) { return new AIOHandle(p); }, false});
+#endif
+    c.push_back({"URingHandle", [](const PathName& p) { return new URingHandle(p); }, true});
+    c.push_back({"URingHandle[direct]", [](const PathName& p) { return new URingHandle(p, 32, 1024 * 1024, true); },
+                 true});
+    return c;
+}
+
+static void report(const char* name, const char* what, size_t bytes, Timer& timer) {
+    std::cout << std::setw(20) << name << " " << std::setw(6) << what << " : " << std::setw(10) << timer.elapsed()
+              << "s, " << std::setw(10) << Bytes(bytes, timer) << std::endl;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+CASE("Throughput") {
+    const size_t size  = fromEnv("BENCHMARK_IO_SIZE", 256 * 1024 * 1024);
+    const size_t chunk = fromEnv("BENCHMARK_IO_CHUNK", 64 * 1024);
+
+    std::vector<char> buffer(chunk);
+    for (size_t i = 0; i < chunk; ++i) {
+        buffer[i] = char(i * 7);
+    }
+
+    std::string base = Resource<std::string>("$TMPDIR", "/tmp");
+    PathName path    = PathName::unique(base + "/benchmark") + ".dat";
+
+    for (const auto& c : candidates()) {
+        {
+            std::unique_ptr<DataHandle> h(c.make(path));
+            Timer timer;
+            h->openForWrite(size);
+            {
+                auto close = closer(*h);
+                for (size_t done = 0; done < size; done += chunk) {
+                    h->write(buffer.data(), long(std::min(chunk, size - done)));
+                }
+            }
+            timer.stop();
+            report(c.name, "write", size, timer);
+        }
+
+        if (c.reads) {
+            std::unique_ptr<DataHandle> h(c.make(path));
+            Timer timer;
+            size_t total = 0;
+            h->openForRead();
+            {
+                auto close = closer(*h);
+                long n;
+                while ((n = h->read(buffer.data(), long(chunk))) > 0) {
+                    total += size_t(n);
+                }
+            }
+            timer.stop();
+            EXPECT(total == size);
+            report(c.name, "read", size, timer);
+        }
+
+        path.unlink();
+    }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // namespace eckit::test
+
+int main(int argc, char** argv) {
+    return run_tests(argc, argv);
+}
@@ -0,0 +1,250 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+#include "eckit/config/Resource.h"
+#include "eckit/filesystem/PathName.h"
+#include "eckit/io/AutoCloser.h"
+#include "eckit/io/FileHandle.h"
+#include "eckit/io/URingHandle.h"
+#include "eckit/log/Log.h"
+#include "eckit/testing/Test.h"
+
+using namespace std;
+using namespace eckit;
+using namespace eckit::testing;
+
+namespace eckit::test {
+
+//----------------------------------------------------------------------------------------------------------------------
+
+// size is prime number 89
+const char tbuf[] = "74e1feb8d0b1d328cbea63832c2dcfb2b4fa1adfeb8d0b1d328cb53d50e63a50fba73f0151028a695a238ff0";
+
+class TestURing {
+public:
+    TestURing() {
+        std::string base = Resource<std::string>("$TMPDIR", "/tmp");
+        path_            = PathName::unique(base + "/file") + ".dat";
+        reference_       = PathName::unique(base + "/reference") + ".dat";
+
+        std::unique_ptr<DataHandle> fh(reference_.fileHandle());
+        writeTo(*fh);
+    }
+
+    size_t writeTo(DataHandle& dh) {
+        long sz = sizeof(tbuf);
+
+        dh.openForWrite(0);
+        auto close = closer(dh);
+
+        // not a multiple of the block size, so the last block is partial
+        size_t nblocks = 3 * 1024 * 1024 / sz;
+        size_t total   = 0;
+
+        for (size_t i = 0; i < nblocks; ++i) {
+            total += dh.write(tbuf, sz);
+        }
+
+        return total;
+    }
+
+    bool verify() {
+        std::unique_ptr<DataHandle> fh(path_.fileHandle());
+        std::unique_ptr<DataHandle> rh(reference_.fileHandle());
+        return rh->compare(*fh);
+    }
+
+    bool verifyRead(DataHandle& dh, long chunk) {
+        std::unique_ptr<DataHandle> rh(reference_.fileHandle());
+
+        Length size = dh.openForRead();
+        auto close  = closer(dh);
+        EXPECT(size == reference_.size());
+
+        rh->openForRead();
+        auto closeReference = closer(*rh);
+
+        std::vector<char> a(chunk);
+        std::vector<char> b(chunk);
+
+        long total = 0;
+        for (;;) {
+            long n = dh.read(a.data(), chunk);
+            long m = rh->read(b.data(), chunk);
+            if (n != m || ::memcmp(a.data(), b.data(), n) != 0) {
+                return false;
+            }
+            if (n == 0) {
+                break;
+            }
+            total += n;
+        }
+
+        return total == long(reference_.size()) && dh.position() == Offset(total);
+    }
+
+    ~TestURing() {
+        if (path_.exists()) {
+            path_.unlink();
+        }
+        reference_.unlink();
+    }
+
+    PathName path_;
+    PathName reference_;
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+
+CASE("Write and read") {
+
+    TestURing test;
+
+    SECTION("Multiple writes") {
+        URingHandle h(test.path_, 4, 64 * 1024);
+        test.writeTo(h);
+        EXPECT(test.verify());
+        EXPECT(h.position() == Offset(test.reference_.size()));
+    }
+
+    SECTION("Save into") {
+        std::unique_ptr<DataHandle> rh(test.reference_.fileHandle());
+        URingHandle h(test.path_);
+        rh->saveInto(h);
+        EXPECT(test.verify());
+    }
+
+    SECTION("Small blocks, deep queue") {
+        URingHandle h(test.path_, 64, 4096);
+        test.writeTo(h);
+        EXPECT(test.verify());
+    }
+
+    SECTION("Read in chunks") {
+        for (long chunk : {1L, 89L, 4096L, 65536L, 1000000L}) {
+            URingHandle h(test.reference_, 4, 64 * 1024);
+            EXPECT(test.verifyRead(h, chunk));
+        }
+    }
+
+    SECTION("Read, rewind and read again") {
+        URingHandle h(test.reference_, 8, 32 * 1024);
+        EXPECT(test.verifyRead(h, 1000));
+
+        h.openForRead();
+        auto close = closer(h);
+
+        std::vector<char> a(5000);
+        EXPECT(h.read(a.data(), a.size()) == long(a.size()));
+        h.rewind();
+        EXPECT(h.position() == Offset(0));
+
+        {
+            std::unique_ptr<DataHandle> copy(test.path_.fileHandle());
+            copy->openForWrite(0);
+            auto closeCopy = closer(*copy);
+            long n;
+            while ((n = h.read(a.data(), a.size())) > 0) {
+                copy->write(a.data(), n);
+            }
+        }
+        EXPECT(test.verify());
+    }
+
+    SECTION("Close with reads in flight") {
+        URingHandle h(test.reference_, 16, 64 * 1024);
+        h.openForRead();
+        char c;
+        EXPECT(h.read(&c, 1) == 1);
+        h.close();
+    }
+
+    SECTION("Append") {
+        {
+            URingHandle h(test.path_, 4, 64 * 1024);
+            h.openForWrite(0);
+            auto close = closer(h);
+            h.write(tbuf, 10);
+        }
+        {
+            URingHandle h(test.path_, 4, 64 * 1024);
+            h.openForAppend(0);
+            auto close = closer(h);
+            h.write(tbuf + 10, sizeof(tbuf) - 10);
+        }
+
+        std::vector<char> a(sizeof(tbuf));
+        std::unique_ptr<DataHandle> fh(test.path_.fileHandle());
+        EXPECT(fh->openForRead() == Length(sizeof(tbuf)));
+        auto close = closer(*fh);
+        EXPECT(fh->read(a.data(), a.size()) == long(sizeof(tbuf)));
+        EXPECT(::memcmp(a.data(), tbuf, sizeof(tbuf)) == 0);
+    }
+
+    SECTION("Direct I/O") {
+        // O_DIRECT is not supported by all file systems (e.g. tmpfs), then the handle falls back to buffered I/O
+        {
+            URingHandle h(test.path_, 8, 64 * 1024, true, true);
+            test.writeTo(h);
+        }
+        EXPECT(test.verify());
+
+        URingHandle h(test.path_, 8, 64 * 1024, true);
+        EXPECT(test.verifyRead(h, 12345));
+    }
+}
+
+CASE("Empty file") {
+    TestURing test;
+    {
+        URingHandle h(test.path_);
+        h.openForWrite(0);
+        h.close();
+    }
+    EXPECT(test.path_.size() == Length(0));
+
+    URingHandle h(test.path_);
+    EXPECT(h.openForRead() == Length(0));
+    auto close = closer(h);
+    char c;
+    EXPECT(h.read(&c, 1) == 0);
+}
+
+CASE("Queue selection") {
+    TestURing test;
+    URingHandle h(test.reference_);
+    h.openForRead();
+    auto close = closer(h);
+
+    // $ECKIT_IO_URING=0 forces the thread fallback, otherwise io_uring is used if the kernel allows it
+    const char* env = ::getenv("ECKIT_IO_URING");
+    if (env && std::string(env) == "0") {
+        EXPECT(!h.usingURing());
+    }
+    Log::info() << h << std::endl;
+}
+
+CASE("Read errors") {
+    URingHandle h("/this/does/not/exist");
+    EXPECT_THROWS_AS(h.openForRead(), FailedSystemCall);
+}
+
+}  // namespace eckit::test
+
+//----------------------------------------------------------------------------------------------------------------------
+
+int main(int argc, char** argv) {
+    return run_tests(argc, argv);
+}
@@ -9,11 +9,14 @@
  */
 
 #include <list>
+#include <random>
 
+#include "eckit/container/KDFlat.h"
 #include "eckit/container/KDTree.h"
 #include "eckit/geometry/Point2.h"
 #include "eckit/os/Semaphore.h"
 #include "eckit/testing/Test.h"
+#include "eckit/thread/ThreadPool.h"
 
 using namespace std;
 using namespace eckit;
@@ -354,6 +357,160 @@ CASE("test_kdtree_mapped") {
     }
 }
 
+CASE("test_kdtree_parallel_build_and_batched_queries") {
+    using Tree  = KDTreeMemory<TestTreeTrait>;
+    using Point = Tree::PointType;
+
+    std::mt19937 rng(42);
+    std::uniform_real_distribution<double> dist(-100., 100.);
+
+    std::vector<Tree::Value> points;
+    for (size_t i = 0; i < 20000; ++i) {
+        points.emplace_back(Point(dist(rng), dist(rng)), double(i));
+    }
+    std::vector<Tree::Value> copy(points);
+
+    ThreadPool pool("kdtree", 4);
+
+    Tree serial;
+    serial.build(points);
+
+    Tree parallel;
+    parallel.build(copy, pool);
+
+    // The same splits, so the same tree
+    EXPECT_EQUAL(parallel.size(), serial.size());
+    for (size_t i = 0; i < points.size(); ++i) {
+        EXPECT(points[i].payload() == copy[i].payload());
+    }
+
+    std::vector<Point> queries;
+    for (size_t i = 0; i < 5000; ++i) {
+        queries.emplace_back(dist(rng), dist(rng));
+    }
+
+    std::vector<Tree::NodeList> results;
+    for (size_t k : {1, 4}) {
+        parallel.kNearestNeighbours(queries, k, results, pool);
+        EXPECT_EQUAL(results.size(), queries.size());
+
+        for (size_t i = 0; i < queries.size(); ++i) {
+            Tree::NodeList expected = serial.kNearestNeighbours(queries[i], k);
+            EXPECT_EQUAL(results[i].size(), k);
+            for (size_t j = 0; j < k; ++j) {
+                EXPECT(results[i][j].payload() == expected[j].payload());
+            }
+        }
+    }
+
+    Tree empty;
+    std::vector<Tree::Value> none;
+    empty.build(none, pool);
+    EXPECT_EQUAL(empty.size(), 0);
+}
+
+CASE("test_kdtree_flat") {
+    using Tree  = KDTreeMemory<TestTreeTrait>;
+    using Flat  = KDTreeFlat<TestTreeTrait>;
+    using Point = Tree::PointType;
+
+    std::mt19937 rng(42);
+    std::uniform_real_distribution<double> dist(-100., 100.);
+
+    std::vector<Tree::Value> points;
+    for (size_t i = 0; i < 10000; ++i) {
+        points.emplace_back(Point(dist(rng), dist(rng)), double(i));
+    }
+
+    Tree reference;
+    std::vector<Tree::Value> copy(points);
+    reference.build(copy);
+
+    auto sameResults = [&](const Flat& flat) {
+        std::mt19937 rng(7);
+        for (size_t i = 0; i < 1000; ++i) {
+            Point p(dist(rng), dist(rng));
+
+            if (flat.nearestNeighbour(p).payload() != reference.nearestNeighbour(p).payload()) {
+                return false;
+            }
+
+            Flat::NodeList knn     = flat.kNearestNeighbours(p, 5);
+            Tree::NodeList expected = reference.kNearestNeighbours(p, 5);
+            if (knn.size() != expected.size()) {
+                return false;
+            }
+            for (size_t j = 0; j < knn.size(); ++j) {
+                if (knn[j].payload() != expected[j].payload() || knn[j].distance() != expected[j].distance()) {
+                    return false;
+                }
+            }
+
+            Flat::NodeList sphere = flat.findInSphere(p, 10.);
+            expected              = reference.findInSphere(p, 10.);
+            if (sphere.size() != expected.size()) {
+                return false;
+            }
+            for (size_t j = 0; j < sphere.size(); ++j) {
+                if (sphere[j].payload() != expected[j].payload()) {
+                    return false;
+                }
+            }
+        }
+        return true;
+    };
+
+    SECTION("in memory") {
+        for (size_t bucketSize : {1, 7, 16, 64}) {
+            Flat flat(bucketSize);
+            EXPECT(flat.empty());
+            EXPECT(flat.findInSphere(Point(0., 0.), 1.).empty());
+
+            flat.build(points);
+            EXPECT_EQUAL(flat.size(), points.size());
+            EXPECT(std::distance(flat.begin(), flat.end()) == points.size());
+            EXPECT(sameResults(flat));
+        }
+
+        // Fewer points than asked for
+        Flat flat;
+        flat.build(points.begin(), points.begin() + 3);
+        EXPECT_EQUAL(flat.kNearestNeighbours(Point(0., 0.), 5).size(), 3);
+    }
+
+    SECTION("mapped") {
+        eckit::PathName path("test_kdtree_flat.kdtree");
+        if (path.exists()) {
+            path.unlink();
+        }
+
+        {
+            Flat flat(path, points.size(), sizeof(Flat::Metadata));
+            EXPECT_EQUAL(flat.size(), 0);
+            flat.build(points);
+            flat.setMetadata(Point(1., 2.), Point(3., 4.));
+            EXPECT(sameResults(flat));
+        }
+
+        {
+            Flat flat(path, 0, 0);
+            EXPECT_EQUAL(flat.size(), points.size());
+
+            // Cannot build as the tree is read-only
+            EXPECT_THROWS_AS(flat.build(points), eckit::AssertionFailed);
+
+            Point offset;
+            Point scale;
+            flat.getMetadata(offset, scale);
+            EXPECT(offset == Point(1., 2.) && scale == Point(3., 4.));
+
+            EXPECT(sameResults(flat));
+        }
+
+        path.unlink();
+    }
+}
+
 CASE("test_kdtree_iterate_empty") {
     using Tree = KDTreeMemory<TestTreeTrait>;
 
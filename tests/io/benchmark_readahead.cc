@@ -0,0 +1,148 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "eckit/config/Resource.h"
+#include "eckit/filesystem/PathName.h"
+#include "eckit/io/AccessAdvice.h"
+#include "eckit/io/AutoCloser.h"
+#include "eckit/io/FileHandle.h"
+#include "eckit/io/MMappedFileHandle.h"
+#include "eckit/io/PooledFile.h"
+#include "eckit/log/Bytes.h"
+#include "eckit/log/Timer.h"
+#include "eckit/testing/Test.h"
+
+using namespace eckit;
+using namespace eckit::testing;
+
+namespace eckit::test {
+
+//----------------------------------------------------------------------------------------------------------------------
+
+// Set $BENCHMARK_IO_SIZE (bytes) and $TMPDIR to measure a device. The file is dropped from the page cache before each
+// run, use a file larger than memory where that is not allowed.
+static size_t fromEnv(const char* name, size_t value) {
+    const char* e = ::getenv(name);
+    return e ? size_t(::atoll(e)) : value;
+}
+
+struct Setup {
+    const char* name;
+    AccessPattern access;
+    bool prefetch;
+};
+
+static const std::vector<Setup> setups = {
+    {"none", AccessPattern::Normal, false},
+    {"sequential", AccessPattern::Sequential, false},
+    {"random", AccessPattern::Random, false},
+    {"prefetch", AccessPattern::Normal, true},
+    {"sequential+prefetch", AccessPattern::Sequential, true},
+};
+
+static void report(const char* handle, const char* setup, const char* what, size_t bytes, Timer& timer) {
+    std::cout << std::setw(18) << handle << " " << std::setw(20) << setup << " " << std::setw(10) << what << " : "
+              << std::setw(10) << timer.elapsed() << "s, " << std::setw(10) << Bytes(bytes, timer) << std::endl;
+}
+
+static void evict(const PathName& path) {
+    int fd = ::open(path.localPath(), O_RDONLY);
+    if (fd >= 0) {
+        AccessAdvice::dontNeed(fd, 0, 0);
+        ::close(fd);
+    }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+CASE("Read throughput with access hints") {
+    const size_t size   = fromEnv("BENCHMARK_IO_SIZE", 256 * 1024 * 1024);
+    const size_t chunk  = fromEnv("BENCHMARK_IO_CHUNK", 64 * 1024);
+    const size_t stride = fromEnv("BENCHMARK_IO_STRIDE", 4 * chunk);
+
+    std::vector<char> buffer(chunk);
+    for (size_t i = 0; i < chunk; ++i) {
+        buffer[i] = char(i * 7);
+    }
+
+    std::string base = Resource<std::string>("$TMPDIR", "/tmp");
+    PathName path    = PathName::unique(base + "/benchmark") + ".dat";
+    {
+        FileHandle h(path);
+        h.openForWrite(size);
+        auto c = closer(h);
+        for (size_t done = 0; done < size; done += chunk) {
+            h.write(buffer.data(), long(std::min(chunk, size - done)));
+        }
+    }
+
+    for (const char* what : {"sequential", "strided"}) {
+        const size_t step = std::string(what) == "sequential" ? chunk : stride;
+
+        for (const auto& s : setups) {
+            evict(path);
+            MMappedFileHandle h(path);
+            h.advise(s.access);
+            h.prefetch(s.prefetch);
+
+            Timer timer;
+            size_t total = 0;
+            h.openForRead();
+            {
+                auto c = closer(h);
+                for (size_t o = 0; o + chunk <= size; o += step) {
+                    h.seek(o);
+                    total += size_t(h.read(buffer.data(), long(chunk)));
+                }
+            }
+            timer.stop();
+            report("MMappedFileHandle", s.name, what, total, timer);
+        }
+
+        for (const auto& s : setups) {
+            evict(path);
+            PooledFile f(path);
+            f.prefetch(s.prefetch);
+
+            Timer timer;
+            size_t total = 0;
+            f.open();
+            {
+                auto c = closer(f);
+                f.advise(s.access);
+                for (size_t o = 0; o + chunk <= size; o += step) {
+                    f.seek(o);
+                    total += size_t(f.read(buffer.data(), long(chunk)));
+                }
+            }
+            timer.stop();
+            report("PooledFile", s.name, what, total, timer);
+        }
+    }
+
+    path.unlink();
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // namespace eckit::test
+
+int main(int argc, char** argv) {
+    return run_tests(argc, argv);
+}
@@ -5,7 +5,11 @@
 
 #include <algorithm>
 
+#include <cstdint>
+
+#include "eckit/exception/Exceptions.h"
 #include "eckit/io/Buffer.h"
+#include "eckit/memory/BufferAllocator.h"
 #include "eckit/testing/Test.h"
 
 
@@ -141,6 +145,52 @@ CASE("Test eckit Buffer resize") {
     EXPECT(buf.size() == newSize);
 }
 
+CASE("Test eckit Buffer allocation policies") {
+
+    for (const std::string kind : {"standard", "aligned", "thp", "hugetlb"}) {
+        for (const std::string numa : {"none", "local", "interleave"}) {
+            SECTION(kind + " " + numa) {
+                const BufferAllocator& allocator = BufferAllocator::get(kind, numa);
+
+                const size_t sz = 3 * 1024 * 1024 + 5;
+                Buffer buf(sz, allocator);
+                EXPECT(&buf.allocator() == &allocator);
+                EXPECT(buf.size() == sz);
+
+                if (allocator.mapped() || kind == "aligned") {
+                    EXPECT(reinterpret_cast<uintptr_t>(buf.data()) % 4096 == 0);
+                }
+                if (kind == "thp") {
+                    EXPECT(reinterpret_cast<uintptr_t>(buf.data()) % (2 * 1024 * 1024) == 0);
+                }
+
+                buf.copy(msg, std::strlen(msg) + 1, sz - 100);
+                EXPECT(std::strcmp(msg, static_cast<const char*>(buf) + sz - 100) == 0);
+
+                // Keeps its allocator when resized and moved
+                buf.resize(sz / 3, false);
+                EXPECT(&buf.allocator() == &allocator);
+
+                Buffer other(std::move(buf));
+                EXPECT(&other.allocator() == &allocator);
+                Buffer third;
+                third = std::move(other);
+                EXPECT(&third.allocator() == &allocator);
+            }
+        }
+    }
+
+    SECTION("Unknown policies") {
+        EXPECT_THROWS_AS(BufferAllocator::get("gigantic"), BadValue);
+        EXPECT_THROWS_AS(BufferAllocator::get("thp", "everywhere"), BadValue);
+    }
+
+    SECTION("Small buffers use new[]") {
+        Buffer buf(100);
+        EXPECT(&buf.allocator() == &BufferAllocator::standard());
+    }
+}
+
 CASE("Test copying and construction from of std::string") {
 
     class TestProtectedBuffer : public Buffer {
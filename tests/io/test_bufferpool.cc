@@ -0,0 +1,173 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+#include <thread>
+#include <vector>
+
+#include "eckit/io/BufferPool.h"
+#include "eckit/testing/Test.h"
+
+using namespace eckit;
+using namespace eckit::testing;
+
+namespace eckit::test {
+
+//----------------------------------------------------------------------------------------------------------------------
+
+CASE("BufferPool reuses released buffers") {
+    BufferPool pool(10 * 1024 * 1024);
+
+    Buffer a = pool.acquire(1024 * 1024);
+    EXPECT(a.size() == 1024 * 1024);
+    const void* p = a.data();
+
+    pool.release(std::move(a));
+    EXPECT(pool.cached() == 1024 * 1024);
+
+    SECTION("same size") {
+        Buffer b = pool.acquire(1024 * 1024);
+        EXPECT(b.data() == p);
+        EXPECT(pool.cached() == 0);
+        EXPECT(pool.statistics().hits_ == 1);
+        EXPECT(pool.statistics().misses_ == 1);
+    }
+
+    SECTION("smaller, down to half the size") {
+        Buffer b = pool.acquire(600 * 1024);
+        EXPECT(b.data() == p);
+        EXPECT(b.size() == 1024 * 1024);
+    }
+
+    SECTION("too small or too large") {
+        Buffer b = pool.acquire(100 * 1024);
+        EXPECT(b.data() != p);
+        Buffer c = pool.acquire(2 * 1024 * 1024);
+        EXPECT(c.data() != p);
+        EXPECT(pool.cached() == 1024 * 1024);
+        EXPECT(pool.statistics().misses_ == 3);
+    }
+
+    SECTION("best fit") {
+        pool.release(Buffer(700 * 1024));
+        pool.release(Buffer(2 * 1024 * 1024));
+
+        Buffer b = pool.acquire(650 * 1024);
+        EXPECT(b.size() == 700 * 1024);
+        Buffer c = pool.acquire(1000 * 1024);
+        EXPECT(c.data() == p);
+    }
+
+    SECTION("clear") {
+        pool.clear();
+        EXPECT(pool.cached() == 0);
+        Buffer b = pool.acquire(1024 * 1024);
+        EXPECT(pool.statistics().hits_ == 0);
+    }
+}
+
+CASE("BufferPool is bounded") {
+    BufferPool pool(3 * 1024 * 1024);
+
+    std::vector<Buffer> buffers;
+    for (size_t i = 0; i < 5; ++i) {
+        buffers.emplace_back(pool.acquire(1024 * 1024));
+    }
+    const void* last = buffers.back().data();
+
+    for (auto& b : buffers) {
+        pool.release(std::move(b));
+    }
+
+    // The least recently released are dropped
+    EXPECT(pool.cached() == 3 * 1024 * 1024);
+    Buffer b = pool.acquire(1024 * 1024);
+    EXPECT(b.data() == last);
+
+    // Larger than the pool
+    pool.release(Buffer(4 * 1024 * 1024));
+    EXPECT(pool.cached() == 2 * 1024 * 1024);
+}
+
+CASE("BufferPool holds a bounded number of buffers") {
+    BufferPool pool(64 * 1024 * 1024, 0, 4);
+
+    std::vector<Buffer> buffers;
+    for (size_t i = 0; i < 10; ++i) {
+        buffers.emplace_back(pool.acquire(1024));
+    }
+    const void* last = buffers.back().data();
+
+    for (auto& b : buffers) {
+        pool.release(std::move(b));
+    }
+
+    EXPECT(pool.cached() == 4 * 1024);
+    Buffer b = pool.acquire(1024);
+    EXPECT(b.data() == last);
+}
+
+CASE("BufferPool ignores small buffers") {
+    BufferPool pool(8 * 1024 * 1024, 64 * 1024);
+
+    pool.release(Buffer(1024));
+    EXPECT(pool.cached() == 0);
+
+    pool.release(Buffer(64 * 1024));
+    EXPECT(pool.cached() == 64 * 1024);
+
+    // Not looked for either
+    Buffer b = pool.acquire(40 * 1024);
+    EXPECT(b.size() == 40 * 1024);
+    EXPECT(pool.cached() == 64 * 1024);
+    EXPECT(pool.statistics().hits_ + pool.statistics().misses_ == 0);
+}
+
+CASE("PooledBuffer returns its buffer to the pool") {
+    BufferPool pool(8 * 1024 * 1024);
+
+    const void* p = nullptr;
+    {
+        PooledBuffer b(1024 * 1024, pool);
+        EXPECT(b.size() == 1024 * 1024);
+        p = b.data();
+    }
+    EXPECT(pool.cached() == 1024 * 1024);
+
+    PooledBuffer b(1024 * 1024, pool);
+    EXPECT(b.data() == p);
+}
+
+CASE("BufferPool is thread safe") {
+    BufferPool pool(4 * 1024 * 1024);
+
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < 4; ++t) {
+        threads.emplace_back([&pool, t] {
+            for (size_t i = 0; i < 1000; ++i) {
+                PooledBuffer b(64 * 1024 * (1 + (i + t) % 3), pool);
+                static_cast<char*>(b)[0] = char(i);
+            }
+        });
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+
+    EXPECT(pool.cached() <= 4 * 1024 * 1024);
+    EXPECT(pool.statistics().hits_ + pool.statistics().misses_ == 4000);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // namespace eckit::test
+
+int main(int argc, char** argv) {
+    return run_tests(argc, argv);
+}
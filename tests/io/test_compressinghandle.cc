@@ -0,0 +1,192 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "eckit/config/Resource.h"
+#include "eckit/filesystem/PathName.h"
+#include "eckit/io/CompressingHandle.h"
+#include "eckit/io/FileHandle.h"
+#include "eckit/io/MemoryHandle.h"
+#include "eckit/io/TransferPipeline.h"
+#include "eckit/testing/Test.h"
+#include "eckit/utils/Compressor.h"
+
+using namespace eckit;
+using namespace eckit::testing;
+
+namespace eckit::test {
+
+//----------------------------------------------------------------------------------------------------------------------
+
+static std::vector<std::string> compressions{"none", "snappy", "lz4", "bzip2", "aec"};
+
+class Tester {
+public:
+    Tester() :
+        data_(2 * 1024 * 1024 + 999) {
+        for (size_t i = 0; i < data_.size(); ++i) {
+            data_[i] = char((i / 11) % 23 + 'a');
+        }
+
+        std::string base = Resource<std::string>("$TMPDIR", "/tmp");
+        source_          = PathName::unique(base + "/source") + ".dat";
+        packed_          = PathName::unique(base + "/packed") + ".dat";
+        target_          = PathName::unique(base + "/target") + ".dat";
+
+        FileHandle f(source_);
+        f.openForWrite(0);
+        f.write(data_.data(), long(data_.size()));
+        f.close();
+    }
+
+    ~Tester() {
+        for (auto* p : {&source_, &packed_, &target_}) {
+            if (p->exists()) {
+                p->unlink(false);
+            }
+        }
+    }
+
+    bool verify(const PathName& path) const {
+        std::vector<char> result(data_.size() + 1);
+        FileHandle f(path);
+        f.openForRead();
+        long n = f.read(result.data(), long(result.size()));
+        f.close();
+        return n == long(data_.size()) && std::equal(data_.begin(), data_.end(), result.begin());
+    }
+
+    std::vector<char> data_;
+    PathName source_;
+    PathName packed_;
+    PathName target_;
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+
+CASE("CompressingHandle and DecompressingHandle round trip with saveInto") {
+    Tester test;
+
+    for (const auto& compression : compressions) {
+        if (!CompressorFactory::instance().has(compression)) {
+            continue;
+        }
+
+        SECTION("CASE " + compression) {
+            {
+                FileHandle in(test.source_);
+                CompressingHandle out(new FileHandle(test.packed_), compression, 256 * 1024);
+                in.saveInto(out);
+                EXPECT(out.position() == Offset(test.data_.size()));
+                EXPECT(out.compressedSize() == test.packed_.size());
+            }
+
+            {
+                DecompressingHandle in(new FileHandle(test.packed_), compression);
+                FileHandle out(test.target_);
+                EXPECT(in.saveInto(out) == Length(test.data_.size()));
+            }
+
+            EXPECT(test.verify(test.target_));
+        }
+    }
+}
+
+CASE("CompressingHandle with uneven writes and reads") {
+    Tester test;
+
+    const size_t blockSize = 64 * 1024;
+    std::vector<size_t> sizes{1, 7, 1000, blockSize - 1, blockSize, 3 * blockSize + 5, 100000};
+
+    {
+        CompressingHandle out(new FileHandle(test.packed_), "none", blockSize);
+        out.openForWrite(0);
+        size_t pos = 0;
+        for (size_t i = 0; pos < test.data_.size(); ++i) {
+            size_t n = std::min(sizes[i % sizes.size()], test.data_.size() - pos);
+            EXPECT(out.write(test.data_.data() + pos, long(n)) == long(n));
+            pos += n;
+        }
+        out.close();
+
+        // One frame per block, the last one partial
+        size_t blocks = (test.data_.size() + blockSize - 1) / blockSize;
+        EXPECT(out.compressedSize() == Length(test.data_.size() + 16 * blocks));
+    }
+
+    DecompressingHandle in(new FileHandle(test.packed_), "none");
+    in.openForRead();
+    std::vector<char> result(test.data_.size());
+    size_t pos = 0;
+    for (size_t i = 0; pos < result.size(); ++i) {
+        long n = in.read(result.data() + pos, long(sizes[(i + 3) % sizes.size()]));
+        EXPECT(n > 0);
+        pos += size_t(n);
+    }
+    char c;
+    EXPECT(in.read(&c, 1) == 0);
+    in.close();
+
+    EXPECT(pos == test.data_.size());
+    EXPECT(std::equal(test.data_.begin(), test.data_.end(), result.begin()));
+}
+
+CASE("CompressingHandle writes the frames of a TransferPipeline") {
+    Tester test;
+
+    {
+        FileHandle in(test.source_);
+        CompressingHandle out(new FileHandle(test.packed_), "none", 100 * 1024);
+        in.saveInto(out);
+    }
+
+    TransferPipeline pipeline;
+    pipeline.add(new UncompressStage("none", 2));
+    FileHandle in(test.packed_);
+    FileHandle out(test.target_);
+    pipeline.copy(in, out);
+
+    EXPECT(test.verify(test.target_));
+}
+
+CASE("DecompressingHandle reports truncated streams") {
+    Tester test;
+
+    std::vector<char> packed(1024 * 1024);
+    size_t size = 0;
+    {
+        MemoryHandle out(packed.data(), packed.size());
+        CompressingHandle h(out, "none", 1024);
+        h.openForWrite(0);
+        h.write(test.data_.data(), 10000);
+        h.close();
+        size = size_t(h.compressedSize());
+    }
+
+    for (size_t cut : {size_t(5), size_t(100), size - 1}) {
+        MemoryHandle in(packed.data(), cut);
+        DecompressingHandle h(in, "none");
+        std::vector<char> result(20000);
+        h.openForRead();
+        EXPECT_THROWS_AS(h.read(result.data(), long(result.size())), ReadError);
+        h.close();
+    }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // namespace eckit::test
+
+int main(int argc, char** argv) {
+    return run_tests(argc, argv);
+}
@@ -8,7 +8,11 @@
  * does it submit to any jurisdiction.
  */
 
+#include <algorithm>
 #include <cstring>
+#include <memory>
+#include <random>
+#include <vector>
 
 #include "eckit/config/Resource.h"
 #include "eckit/filesystem/PathName.h"
@@ -17,6 +21,8 @@
 #include "eckit/io/MemoryHandle.h"
 #include "eckit/io/MultiHandle.h"
 #include "eckit/io/PartFileHandle.h"
+#include "eckit/io/SharedHandle.h"
+#include "eckit/io/StatsHandle.h"
 #include "eckit/log/Log.h"
 #include "eckit/memory/Zero.h"
 #include "eckit/runtime/Tool.h"
@@ -186,6 +192,134 @@ CASE("PartFileHandle with multiple parts") {
     ph.close();
 }
 
+CASE("PartFileHandle coalesces reads of many parts") {
+
+    Tester test;
+
+    // A larger file, with one byte per position
+    const size_t size = 4 * 1024 * 1024;
+    std::vector<char> data(size);
+    for (size_t i = 0; i < size; ++i) {
+        data[i] = char(i * 31 + i / 251);
+    }
+    {
+        FileHandle f(test.path1_);
+        f.openForWrite(0);
+        f.write(data.data(), size);
+        f.close();
+    }
+
+    // Parts of a few hundred bytes, out of order, some overlapping, some far apart
+    std::mt19937 rng(7);
+    OffsetList offsets;
+    LengthList lengths;
+    for (size_t i = 0; i < 4000; ++i) {
+        size_t length = 1 + rng() % 700;
+        size_t offset = (i < 2000 ? i * 1000 : rng() % (size - length));
+        offsets.push_back(offset);
+        lengths.push_back(length);
+    }
+    std::shuffle(offsets.begin() + 1000, offsets.begin() + 2000, rng);
+
+    std::string expected;
+    for (size_t i = 0; i < offsets.size(); ++i) {
+        expected.append(data.data() + (long long)offsets[i], size_t(lengths[i]));
+    }
+
+    auto readAll = [](DataHandle& h, long chunk) {
+        std::string result;
+        std::vector<char> buffer(chunk);
+        long n;
+        while ((n = h.read(buffer.data(), chunk)) > 0) {
+            result.append(buffer.data(), n);
+        }
+        return result;
+    };
+
+    SECTION("Large reads") {
+        PartFileHandle ph(test.path1_, offsets, lengths);
+        ph.openForRead();
+        EXPECT(readAll(ph, 16 * 1024 * 1024) == expected);
+        ph.close();
+
+        const auto& s = ph.statistics();
+        EXPECT(s.bytesDelivered_ == expected.size());
+        EXPECT(s.reads_ < offsets.size() / 2);
+    }
+
+    SECTION("Small reads") {
+        for (long chunk : {1L, 100L, 4096L, 100000L}) {
+            PartFileHandle ph(test.path1_, offsets, lengths);
+            ph.openForRead();
+            EXPECT(readAll(ph, chunk) == expected);
+            EXPECT(ph.statistics().reads_ < offsets.size() / 2);
+            ph.close();
+        }
+    }
+
+    SECTION("Seek, then read") {
+        PartFileHandle ph(test.path1_, offsets, lengths);
+        ph.openForRead();
+
+        std::vector<char> buffer(1000);
+        EXPECT(ph.read(buffer.data(), 1000) == 1000);
+
+        for (size_t position : {size_t(123456), size_t(7), expected.size() - 10}) {
+            ph.seek(position);
+            EXPECT(ph.position() == Offset(position));
+            long n = ph.read(buffer.data(), 1000);
+            EXPECT(n == long(std::min<size_t>(1000, expected.size() - position)));
+            EXPECT(std::string(buffer.data(), n) == expected.substr(position, n));
+            EXPECT(ph.position() == Offset(position + n));
+        }
+        ph.close();
+    }
+
+    SECTION("MultiHandle of parts of the same file") {
+        MultiHandle mh;
+        for (size_t i = 0; i < offsets.size(); ++i) {
+            mh += new PartFileHandle(test.path1_, offsets[i], lengths[i]);
+        }
+
+        mh.openForRead();
+        EXPECT(readAll(mh, 64 * 1024) == expected);
+        mh.close();
+    }
+
+    SECTION("MultiHandle from a list") {
+        MultiHandle::HandleList handles;
+        for (size_t i = 0; i < offsets.size(); ++i) {
+            handles.push_back(new PartFileHandle(test.path1_, offsets[i], lengths[i]));
+        }
+
+        MultiHandle mh(handles);
+        mh.openForRead();
+        EXPECT(readAll(mh, 64 * 1024) == expected);
+        mh.close();
+    }
+
+    SECTION("MultiHandle of handles that do not merge") {
+        // A SharedHandle leaves opening and closing to the owner of the handle
+        std::vector<std::unique_ptr<PartFileHandle>> shared;
+        MultiHandle::HandleList handles;
+        for (size_t i = 0; i + 1 < offsets.size(); ++i) {
+            shared.emplace_back(new PartFileHandle(test.path1_, offsets[i], lengths[i]));
+            shared.back()->openForRead();
+            handles.push_back(new SharedHandle(*shared.back()));
+        }
+        handles.push_back(new StatsHandle(new PartFileHandle(test.path1_, offsets.back(), lengths.back())));
+
+        MultiHandle mh(handles);
+        mh.openForRead();
+        EXPECT(readAll(mh, 64 * 1024) == expected);
+        mh.close();
+
+        for (auto& h : shared) {
+            h->close();
+        }
+    }
+}
+
 //----------------------------------------------------------------------------------------------------------------------
 
 }  // namespace eckit::test
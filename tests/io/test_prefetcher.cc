@@ -0,0 +1,251 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+#include <chrono>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "eckit/config/Resource.h"
+#include "eckit/filesystem/PathName.h"
+#include "eckit/io/AccessAdvice.h"
+#include "eckit/io/AutoCloser.h"
+#include "eckit/io/FileHandle.h"
+#include "eckit/io/MMappedFileHandle.h"
+#include "eckit/io/PooledFile.h"
+#include "eckit/io/Prefetcher.h"
+#include "eckit/testing/Test.h"
+
+using namespace eckit;
+using namespace eckit::testing;
+
+namespace eckit::test {
+
+//----------------------------------------------------------------------------------------------------------------------
+
+using Ranges = std::vector<std::pair<off_t, size_t>>;
+
+struct Recorder {
+    Ranges ranges_;
+    std::mutex mutex_;
+
+    Prefetcher::Action action() {
+        return [this](off_t offset, size_t length) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            ranges_.emplace_back(offset, length);
+        };
+    }
+
+    /// Waits for the background thread to catch up
+    Ranges wait(size_t count) {
+        for (int i = 0; i < 1000; ++i) {
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                if (ranges_.size() >= count) {
+                    return ranges_;
+                }
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        }
+        std::lock_guard<std::mutex> lock(mutex_);
+        return ranges_;
+    }
+};
+
+class TestFile {
+public:
+    explicit TestFile(size_t size) : data_(size) {
+        for (size_t i = 0; i < size; ++i) {
+            data_[i] = char(i * 31 + i / 251);
+        }
+        std::string base = Resource<std::string>("$TMPDIR", "/tmp");
+        path_            = PathName::unique(base + "/prefetcher") + ".dat";
+        FileHandle f(path_);
+        f.openForWrite(size);
+        auto c = closer(f);
+        f.write(data_.data(), long(size));
+    }
+
+    ~TestFile() { path_.unlink(false); }
+
+    PathName path_;
+    std::vector<char> data_;
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+
+CASE("Access patterns") {
+    EXPECT(AccessAdvice::pattern("normal") == AccessPattern::Normal);
+    EXPECT(AccessAdvice::pattern("sequential") == AccessPattern::Sequential);
+    EXPECT(AccessAdvice::pattern("random") == AccessPattern::Random);
+    EXPECT(std::string(AccessAdvice::name(AccessPattern::Random)) == "random");
+    EXPECT_THROWS_AS(AccessAdvice::pattern("backwards"), BadValue);
+}
+
+CASE("Pattern detection") {
+    Recorder willNeed;
+    Recorder dontNeed;
+
+    SECTION("Sequential reads are coalesced") {
+        Prefetcher p(willNeed.action(), 4, dontNeed.action());
+
+        p.observe(0, 100);
+        p.observe(100, 100);
+        EXPECT(!p.detected());
+
+        p.observe(200, 100);
+        EXPECT(p.detected());
+        EXPECT(p.stride() == 100);
+
+        // The next 4 reads
+        Ranges r = willNeed.wait(1);
+        EXPECT(r.size() == 1);
+        EXPECT(r[0] == std::make_pair(off_t(300), size_t(400)));
+
+        // Only the read beyond
+        p.observe(300, 100);
+        r = willNeed.wait(2);
+        EXPECT(r.size() == 2);
+        EXPECT(r[1] == std::make_pair(off_t(700), size_t(100)));
+
+        // What was read before the pattern started is released
+        Ranges d = dontNeed.wait(2);
+        EXPECT(d.size() == 2);
+        EXPECT(d[0] == std::make_pair(off_t(0), size_t(200)));
+        EXPECT(d[1] == std::make_pair(off_t(200), size_t(100)));
+    }
+
+    SECTION("Strided reads") {
+        Prefetcher p(willNeed.action(), 3, dontNeed.action());
+
+        p.observe(1000, 10);
+        p.observe(2000, 10);
+        p.observe(3000, 10);
+        EXPECT(p.stride() == 1000);
+
+        Ranges r = willNeed.wait(3);
+        EXPECT(r.size() == 3);
+        EXPECT(r[0] == std::make_pair(off_t(4000), size_t(10)));
+        EXPECT(r[2] == std::make_pair(off_t(6000), size_t(10)));
+
+        p.observe(4000, 10);
+        r = willNeed.wait(4);
+        EXPECT(r.size() == 4);
+        EXPECT(r[3] == std::make_pair(off_t(7000), size_t(10)));
+
+        // Only released when reading sequentially
+        EXPECT(dontNeed.wait(0).empty());
+        EXPECT(p.statistics().requests_ == 4);
+        EXPECT(p.statistics().bytes_ == 40);
+    }
+
+    SECTION("Random and backward reads are not prefetched") {
+        Prefetcher p(willNeed.action(), 4);
+
+        for (off_t o : {500, 100, 900, 50, 3000, 2000, 1000, 0}) {
+            p.observe(o, 10);
+            EXPECT(!p.detected());
+        }
+
+        // Changing the length breaks the pattern
+        p.observe(10, 10);
+        p.observe(20, 20);
+        p.observe(40, 20);
+        EXPECT(!p.detected());
+
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        EXPECT(willNeed.wait(0).empty());
+    }
+}
+
+CASE("Hints on MMappedFileHandle") {
+    TestFile file(1024 * 1024 + 123);
+
+    for (auto access : {AccessPattern::Normal, AccessPattern::Sequential, AccessPattern::Random}) {
+        for (bool prefetch : {false, true}) {
+            MMappedFileHandle h(file.path_);
+            h.advise(access);
+            h.prefetch(prefetch);
+            h.openForRead();
+            auto c = closer(h);
+
+            EXPECT((h.prefetcher() != nullptr) == prefetch);
+
+            h.willNeed(0, 4096);
+            h.willNeed(1024 * 1024, 1024 * 1024);  // clipped to the file
+
+            // Sequential, then strided
+            std::vector<char> out(file.data_.size());
+            const long chunk = 4096;
+            long n;
+            size_t total = 0;
+            while (total < 512 * 1024 && (n = h.read(out.data() + total, chunk)) > 0) {
+                total += size_t(n);
+            }
+            for (size_t o = total; o < out.size(); o += 3 * chunk) {
+                h.seek(o);
+                size_t len = std::min(size_t(chunk), out.size() - o);
+                EXPECT(h.read(out.data() + o, long(len)) == long(len));
+                EXPECT(std::equal(out.begin() + o, out.begin() + o + len, file.data_.begin() + o));
+            }
+
+            EXPECT(std::equal(out.begin(), out.begin() + total, file.data_.begin()));
+
+            h.dontNeed(0, total);
+            h.seek(0);
+            EXPECT(h.read(out.data(), 100) == 100);
+            EXPECT(std::equal(out.begin(), out.begin() + 100, file.data_.begin()));
+        }
+    }
+}
+
+CASE("Hints on PooledFile") {
+    TestFile file(300 * 1000);
+
+    PooledFile f1(file.path_);
+    PooledFile f2(file.path_);
+    f1.prefetch(true);
+
+    f1.open();
+    f2.open();
+    f1.advise(AccessPattern::Sequential);
+    f1.willNeed(0, 100000);
+
+    EXPECT(f1.prefetcher() != nullptr);
+    EXPECT(f2.prefetcher() == nullptr);
+
+    // Interlaced readers, only f1 reads sequentially
+    std::vector<char> b1(file.data_.size());
+    std::vector<char> b2(1000);
+    for (size_t o = 0; o < b1.size(); o += 1000) {
+        EXPECT(f1.read(b1.data() + o, 1000) == 1000);
+        EXPECT(f2.seek(off_t((o * 7) % b1.size())) == off_t((o * 7) % b1.size()));
+        EXPECT(f2.read(b2.data(), 1000) == 1000);
+        EXPECT(std::equal(b2.begin(), b2.end(), file.data_.begin() + (o * 7) % b1.size()));
+    }
+
+    EXPECT(b1 == file.data_);
+    EXPECT(f1.prefetcher()->stride() == 1000);
+
+    f1.dontNeed(0, 0);
+    f1.close();
+    f2.close();
+
+    EXPECT(f1.prefetcher() == nullptr);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // namespace eckit::test
+
+int main(int argc, char** argv) {
+    return run_tests(argc, argv);
+}
@@ -0,0 +1,187 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "eckit/config/Resource.h"
+#include "eckit/filesystem/PathName.h"
+#include "eckit/io/FileDescHandle.h"
+#include "eckit/io/FileHandle.h"
+#include "eckit/io/MemoryHandle.h"
+#include "eckit/io/TransferWatcher.h"
+#include "eckit/testing/Test.h"
+
+using namespace eckit;
+using namespace eckit::testing;
+
+namespace eckit::test {
+
+//----------------------------------------------------------------------------------------------------------------------
+
+class Tester {
+public:
+    Tester() :
+        data_(5 * 1024 * 1024 + 17) {
+        for (size_t i = 0; i < data_.size(); ++i) {
+            data_[i] = char(i * 13 + i / 1021);
+        }
+
+        std::string base = Resource<std::string>("$TMPDIR", "/tmp");
+        source_          = PathName::unique(base + "/source") + ".dat";
+        target_          = PathName::unique(base + "/target") + ".dat";
+
+        FileHandle f(source_);
+        f.openForWrite(0);
+        f.write(data_.data(), long(data_.size()));
+        f.close();
+    }
+
+    ~Tester() {
+        source_.unlink(false);
+        if (target_.exists()) {
+            target_.unlink(false);
+        }
+    }
+
+    bool verify(const PathName& path) const {
+        std::vector<char> result(data_.size() + 1);
+        FileHandle f(path);
+        f.openForRead();
+        long n = f.read(result.data(), long(result.size()));
+        f.close();
+        return n == long(data_.size()) && std::equal(data_.begin(), data_.end(), result.begin());
+    }
+
+    std::vector<char> data_;
+    PathName source_;
+    PathName target_;
+};
+
+/// Counts the bytes, without looking at them
+struct Counter : public TransferWatcher {
+    explicit Counter(bool data) :
+        data_(data) {}
+    void watch(const void* p, long n) override {
+        total_ += n;
+        if (n > 0 && p == nullptr) {
+            inKernel_ = true;
+        }
+    }
+    bool wantsData() const override { return data_; }
+
+    bool data_;
+    long total_    = 0;
+    bool inKernel_ = false;
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+
+CASE("File to file") {
+    Tester test;
+
+    SECTION("In the kernel") {
+        Counter counter(false);
+        FileHandle in(test.source_);
+        FileHandle out(test.target_);
+        EXPECT(in.saveInto(out, counter) == Length(test.data_.size()));
+        EXPECT(test.verify(test.target_));
+        EXPECT(counter.total_ == long(test.data_.size()));
+        EXPECT(counter.inKernel_);
+    }
+
+    SECTION("Watcher wants the data") {
+        Counter counter(true);
+        FileHandle in(test.source_);
+        FileHandle out(test.target_);
+        EXPECT(in.saveInto(out, counter) == Length(test.data_.size()));
+        EXPECT(test.verify(test.target_));
+        EXPECT(counter.total_ == long(test.data_.size()));
+        EXPECT(!counter.inKernel_);
+    }
+
+    SECTION("Default watcher") {
+        std::unique_ptr<DataHandle> in(test.source_.fileHandle());
+        EXPECT(in->saveInto(test.target_) == Length(test.data_.size()));
+        EXPECT(test.verify(test.target_));
+    }
+
+    SECTION("Into memory") {
+        std::vector<char> result(test.data_.size());
+        MemoryHandle out(result.data(), result.size());
+        FileHandle in(test.source_);
+        EXPECT(in.saveInto(out) == Length(test.data_.size()));
+        EXPECT(result == test.data_);
+    }
+}
+
+CASE("File to socket, socket to file") {
+    Tester test;
+
+    int sv[2];
+    EXPECT(::socketpair(AF_UNIX, SOCK_STREAM, 0, sv) == 0);
+
+    Counter counter(false);
+    std::thread receiver([&] {
+        FileDescHandle in(sv[1], true);
+        FileHandle out(test.target_);
+        Counter c(false);
+        in.saveInto(out, c);
+    });
+
+    {
+        FileHandle in(test.source_);
+        FileDescHandle out(sv[0], true);
+        EXPECT(in.saveInto(out, counter) == Length(test.data_.size()));
+    }
+
+    receiver.join();
+
+    EXPECT(counter.inKernel_);
+    EXPECT(test.verify(test.target_));
+}
+
+CASE("Pipe to file") {
+    Tester test;
+
+    int p[2];
+    EXPECT(::pipe(p) == 0);
+
+    std::thread writer([&] {
+        FileHandle in(test.source_);
+        FileDescHandle out(p[1], true);
+        in.saveInto(out);
+    });
+
+    {
+        Counter counter(false);
+        FileDescHandle in(p[0], true);
+        FileHandle out(test.target_);
+        in.saveInto(out, counter);
+        EXPECT(counter.inKernel_);
+    }
+
+    writer.join();
+
+    EXPECT(test.verify(test.target_));
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // namespace eckit::test
+
+int main(int argc, char** argv) {
+    return run_tests(argc, argv);
+}
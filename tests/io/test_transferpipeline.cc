@@ -0,0 +1,255 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "eckit/config/Resource.h"
+#include "eckit/filesystem/PathName.h"
+#include "eckit/io/FileHandle.h"
+#include "eckit/io/MemoryHandle.h"
+#include "eckit/io/TransferPipeline.h"
+#include "eckit/testing/Test.h"
+#include "eckit/utils/Compressor.h"
+#include "eckit/utils/Hash.h"
+
+using namespace eckit;
+using namespace eckit::testing;
+
+namespace eckit::test {
+
+//----------------------------------------------------------------------------------------------------------------------
+
+class Tester {
+public:
+    Tester() :
+        data_(3 * 1024 * 1024 + 4321) {
+        for (size_t i = 0; i < data_.size(); ++i) {
+            data_[i] = char(i * 7 + i / 513);
+        }
+
+        std::string base = Resource<std::string>("$TMPDIR", "/tmp");
+        source_          = PathName::unique(base + "/source") + ".dat";
+        packed_          = PathName::unique(base + "/packed") + ".dat";
+        target_          = PathName::unique(base + "/target") + ".dat";
+
+        FileHandle f(source_);
+        f.openForWrite(0);
+        f.write(data_.data(), long(data_.size()));
+        f.close();
+    }
+
+    ~Tester() {
+        for (auto* p : {&source_, &packed_, &target_}) {
+            if (p->exists()) {
+                p->unlink(false);
+            }
+        }
+    }
+
+    std::string md5() const {
+        std::unique_ptr<Hash> h(HashFactory::instance().build("md5"));
+        h->add(data_.data(), long(data_.size()));
+        return h->digest();
+    }
+
+    bool verify(const PathName& path) const {
+        std::vector<char> result(data_.size() + 1);
+        FileHandle f(path);
+        f.openForRead();
+        long n = f.read(result.data(), long(result.size()));
+        f.close();
+        return n == long(data_.size()) && std::equal(data_.begin(), data_.end(), result.begin());
+    }
+
+    void roundTrip(const std::string& compression, size_t chunkSize, size_t workers) {
+        TransferPipeline pack(chunkSize);
+        pack.add(new HashStage("md5")).add(new CompressStage(compression, workers));
+        {
+            FileHandle in(source_);
+            FileHandle out(packed_);
+            pack.copy(in, out);
+        }
+        EXPECT(pack.bytesRead() == Length(data_.size()));
+        EXPECT(pack.bytesWritten() == Length(packed_.size()));
+
+        TransferPipeline unpack(chunkSize);
+        unpack.add(new UncompressStage(compression, workers)).add(new HashStage("md5"));
+        {
+            FileHandle in(packed_);
+            FileHandle out(target_);
+            unpack.copy(in, out);
+        }
+        EXPECT(unpack.bytesWritten() == Length(data_.size()));
+
+        EXPECT(verify(target_));
+        EXPECT(dynamic_cast<const HashStage&>(pack.stage(0)).digest() == md5());
+        EXPECT(dynamic_cast<const HashStage&>(unpack.stage(1)).digest() == md5());
+    }
+
+    std::vector<char> data_;
+    PathName source_;
+    PathName packed_;
+    PathName target_;
+};
+
+/// Takes a random time on each chunk, so workers finish out of order
+class Jitter : public PipelineStage {
+public:
+    explicit Jitter(size_t workers) :
+        PipelineStage(workers) {}
+
+    void process(PipelineChunk& chunk) override {
+        std::this_thread::sleep_for(std::chrono::microseconds((chunk.index_ * 7919) % 500));
+    }
+
+    void print(std::ostream& s) const override { s << "Jitter"; }
+};
+
+class Failing : public PipelineStage {
+public:
+    Failing(size_t workers, size_t at) :
+        PipelineStage(workers), at_(at) {}
+
+    void process(PipelineChunk& chunk) override {
+        if (chunk.index_ == at_) {
+            throw SeriousBug("Failing stage");
+        }
+    }
+
+    void print(std::ostream& s) const override { s << "Failing"; }
+
+private:
+    size_t at_;
+};
+
+class FailingFinish : public PipelineStage {
+public:
+    explicit FailingFinish(size_t workers) :
+        PipelineStage(workers) {}
+
+    void process(PipelineChunk&) override {}
+
+    void finish() override { throw SeriousBug("Failing finish"); }
+
+    void print(std::ostream& s) const override { s << "FailingFinish"; }
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+
+CASE("TransferPipeline copies and hashes") {
+    Tester test;
+
+    TransferPipeline pipeline(64 * 1024);
+    pipeline.add(new HashStage("md5"));
+
+    FileHandle in(test.source_);
+    FileHandle out(test.target_);
+    EXPECT(pipeline.copy(in, out) == Length(test.data_.size()));
+
+    EXPECT(test.verify(test.target_));
+    EXPECT(dynamic_cast<const HashStage&>(pipeline.stage(0)).digest() == test.md5());
+}
+
+CASE("TransferPipeline without stages") {
+    Tester test;
+
+    TransferPipeline pipeline(100 * 1024);
+
+    FileHandle in(test.source_);
+    FileHandle out(test.target_);
+    EXPECT(pipeline.copy(in, out) == Length(test.data_.size()));
+    EXPECT(test.verify(test.target_));
+}
+
+CASE("TransferPipeline compresses in parallel") {
+    Tester test;
+
+    SECTION("none") {
+        test.roundTrip("none", 128 * 1024, 4);
+    }
+
+    SECTION("single worker") {
+        test.roundTrip("none", 1024 * 1024, 1);
+    }
+
+    if (CompressorFactory::instance().has("bzip2")) {
+        SECTION("bzip2") {
+            test.roundTrip("bzip2", 256 * 1024, 4);
+        }
+    }
+}
+
+CASE("TransferPipeline preserves the order") {
+    Tester test;
+
+    TransferPipeline pipeline(4096, 3);
+    pipeline.add(new Jitter(8)).add(new HashStage("md5")).add(new Jitter(3));
+
+    FileHandle in(test.source_);
+    FileHandle out(test.target_);
+    pipeline.copy(in, out);
+
+    EXPECT(test.verify(test.target_));
+    EXPECT(dynamic_cast<const HashStage&>(pipeline.stage(1)).digest() == test.md5());
+}
+
+CASE("TransferPipeline reports errors") {
+    Tester test;
+
+    SECTION("from a stage") {
+        TransferPipeline pipeline(4096, 2);
+        pipeline.add(new Jitter(4)).add(new Failing(4, 100)).add(new HashStage("md5"));
+
+        FileHandle in(test.source_);
+        FileHandle out(test.target_);
+        EXPECT_THROWS_AS(pipeline.copy(in, out), SeriousBug);
+    }
+
+    SECTION("from the end of a stage") {
+        TransferPipeline pipeline(4096, 2);
+        pipeline.add(new Jitter(4)).add(new FailingFinish(4)).add(new HashStage("md5"));
+
+        FileHandle in(test.source_);
+        FileHandle out(test.target_);
+        EXPECT_THROWS_AS(pipeline.copy(in, out), SeriousBug);
+    }
+
+    SECTION("from a truncated frame") {
+        std::string frames(CompressStage::headerSize + 10, '\0');
+        frames[7] = 100;  // claims more bytes than there are
+        MemoryHandle in(frames.data(), frames.size());
+
+        std::vector<char> sink(1024);
+        MemoryHandle out(sink.data(), sink.size());
+
+        TransferPipeline pipeline;
+        pipeline.add(new UncompressStage("none", 2));
+        EXPECT_THROWS_AS(pipeline.copy(in, out), ReadError);
+    }
+
+    SECTION("framed stage not first") {
+        TransferPipeline pipeline;
+        pipeline.add(new HashStage("md5"));
+        EXPECT_THROWS_AS(pipeline.add(new UncompressStage("none", 2)), AssertionFailed);
+    }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // namespace eckit::test
+
+int main(int argc, char** argv) {
+    return run_tests(argc, argv);
+}
@@ -0,0 +1,129 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation
+ * nor does it submit to any jurisdiction.
+ */
+
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <random>
+
+#include "eckit/linalg/LinearAlgebraDense.h"
+#include "eckit/linalg/Matrix.h"
+#include "eckit/linalg/Vector.h"
+#include "eckit/log/Timer.h"
+#include "eckit/runtime/Main.h"
+#include "eckit/testing/Test.h"
+
+using namespace eckit;
+using namespace eckit::linalg;
+using namespace eckit::testing;
+
+namespace eckit::test {
+
+//----------------------------------------------------------------------------------------------------------------------
+
+// Set $BENCHMARK_LINALG_SIZE for larger runs, e.g. 2000
+static Size fromEnv(const char* name, Size value) {
+    const char* e = ::getenv(name);
+    return e ? Size(::atoll(e)) : value;
+}
+
+static std::vector<std::string> backends() {
+    std::vector<std::string> names;
+    for (const char* name : {"generic", "blocked", "eigen", "mkl", "lapack", "armadillo"}) {
+        if (LinearAlgebraDense::hasBackend(name)) {
+            names.emplace_back(name);
+        }
+    }
+    return names;
+}
+
+static void random(Scalar* v, Size n) {
+    std::mt19937_64 rng(42);
+    std::uniform_real_distribution<Scalar> dist(-1., 1.);
+    for (Size i = 0; i < n; ++i) {
+        v[i] = dist(rng);
+    }
+}
+
+static void report(const std::string& backend, double flops, Timer& timer) {
+    std::cout << std::setw(12) << backend << " : " << std::setw(10) << timer.elapsed() << "s, " << std::setw(8)
+              << std::setprecision(3) << flops / timer.elapsed() * 1e-9 << " GFlop/s" << std::endl;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+CASE("gemm") {
+    const Size n = fromEnv("BENCHMARK_LINALG_SIZE", 512);
+
+    Matrix A(n, n);
+    Matrix B(n, n);
+    random(A.data(), A.size());
+    random(B.data(), B.size());
+
+    std::cout << "gemm " << n << " x " << n << std::endl;
+    for (const auto& name : backends()) {
+        Matrix C(n, n);
+        Timer timer;
+        LinearAlgebraDense::getBackend(name).gemm(A, B, C);
+        timer.stop();
+        report(name, 2. * n * n * n, timer);
+    }
+}
+
+CASE("gemv") {
+    const Size n = 2 * fromEnv("BENCHMARK_LINALG_SIZE", 512);
+    const Size r = 20;
+
+    Matrix A(n, n);
+    Vector x(n);
+    random(A.data(), A.size());
+    random(x.data(), x.size());
+
+    std::cout << "gemv " << n << " x " << n << std::endl;
+    for (const auto& name : backends()) {
+        Vector y(n);
+        Timer timer;
+        for (Size i = 0; i < r; ++i) {
+            LinearAlgebraDense::getBackend(name).gemv(A, x, y);
+        }
+        timer.stop();
+        report(name, 2. * n * n * r, timer);
+    }
+}
+
+CASE("dot") {
+    const Size n = 1000 * fromEnv("BENCHMARK_LINALG_SIZE", 512);
+    const Size r = 20;
+
+    Vector x(n);
+    Vector y(n);
+    random(x.data(), x.size());
+    random(y.data(), y.size());
+
+    std::cout << "dot " << n << std::endl;
+    for (const auto& name : backends()) {
+        Scalar sum = 0;
+        Timer timer;
+        for (Size i = 0; i < r; ++i) {
+            sum += LinearAlgebraDense::getBackend(name).dot(x, y);
+        }
+        timer.stop();
+        report(name, 2. * n * r, timer);
+    }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // namespace eckit::test
+
+int main(int argc, char** argv) {
+    eckit::Main::initialise(argc, argv);
+    return run_tests(argc, argv, false);
+}
@@ -0,0 +1,145 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation
+ * nor does it submit to any jurisdiction.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include "eckit/linalg/LinearAlgebraSparse.h"
+#include "eckit/linalg/Matrix.h"
+#include "eckit/linalg/SparseMatrix.h"
+#include "eckit/linalg/Triplet.h"
+#include "eckit/linalg/Vector.h"
+#include "eckit/log/Timer.h"
+#include "eckit/runtime/Main.h"
+#include "eckit/testing/Test.h"
+
+using namespace eckit;
+using namespace eckit::linalg;
+using namespace eckit::testing;
+
+namespace eckit::test {
+
+//----------------------------------------------------------------------------------------------------------------------
+
+// Set $BENCHMARK_LINALG_ROWS for grid-sized runs, e.g. 6599680 (O1280)
+static Size fromEnv(const char* name, Size value) {
+    const char* e = ::getenv(name);
+    return e ? Size(::atoll(e)) : value;
+}
+
+static std::vector<std::string> backends() {
+    std::vector<std::string> names;
+    for (const char* name : {"generic", "sell", "eigen", "mkl"}) {
+        if (LinearAlgebraSparse::hasBackend(name)) {
+            names.emplace_back(name);
+        }
+    }
+    return names;
+}
+
+/// Remapping matrices: Ni target points from Nj source points, each row a few neighbouring columns
+struct Remapping {
+    const char* name;
+    Size (*length)(Size i, Size Ni);  // non-zeros of row i
+};
+
+static const Remapping remappings[] = {
+    // bilinear, 4 points per target
+    {"bilinear", [](Size, Size) -> Size { return 4; }},
+    // k-nearest neighbours
+    {"knn-16", [](Size, Size) -> Size { return 16; }},
+    // conservative on a reduced Gaussian grid: source cells per target grow towards the poles
+    {"conservative", [](Size i, Size Ni) -> Size {
+         const double lat = M_PI * (double(i) + 0.5) / double(Ni) - M_PI_2;
+         return std::min<Size>(3 + Size(2. / std::max(std::cos(lat), 0.01)), 200);
+     }},
+};
+
+static SparseMatrix matrix(const Remapping& r, Size Ni, Size Nj) {
+    std::mt19937_64 rng(42);
+    std::uniform_real_distribution<double> dist(0., 1.);
+
+    std::vector<Triplet> triplets;
+    for (Size i = 0; i < Ni; ++i) {
+        const Size n     = std::min(r.length(i, Ni), Nj);
+        const Size first = std::min(i * Nj / Ni, Nj - n);
+        for (Size c = 0; c < n; ++c) {
+            triplets.emplace_back(i, first + c, dist(rng) / double(n));
+        }
+    }
+    return {Ni, Nj, triplets};
+}
+
+static void report(const std::string& backend, const char* what, double flops, Timer& timer) {
+    std::cout << std::setw(12) << backend << " " << std::setw(10) << what << " : " << std::setw(10) << timer.elapsed()
+              << "s, " << std::setw(8) << std::setprecision(3) << flops / timer.elapsed() * 1e-9 << " GFlop/s"
+              << std::endl;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+CASE("Remapping matrices") {
+    const Size Ni = fromEnv("BENCHMARK_LINALG_ROWS", 400000);
+    const Size Nj = Ni / 2;
+    const Size r  = 10;
+    const Size Nk = 8;
+
+    Vector x(Nj);
+    Matrix B(Nj, Nk);
+    std::fill(x.begin(), x.end(), 1.);
+    std::fill(B.begin(), B.end(), 1.);
+
+    for (const auto& remapping : remappings) {
+        SparseMatrix A = matrix(remapping, Ni, Nj);
+        std::cout << remapping.name << " " << Ni << " x " << Nj << ", nnz " << A.nonZeros() << std::endl;
+
+        for (const auto& name : backends()) {
+            const auto& backend = LinearAlgebraSparse::getBackend(name);
+            Vector y(Ni);
+            Matrix C(Ni, Nk);
+
+            // The first product includes setup (e.g. conversion of the matrix) for some backends
+            {
+                Timer timer;
+                backend.spmv(A, x, y);
+                timer.stop();
+                report(name, "first", 2. * A.nonZeros(), timer);
+            }
+            {
+                Timer timer;
+                for (Size i = 0; i < r; ++i) {
+                    backend.spmv(A, x, y);
+                }
+                timer.stop();
+                report(name, "spmv", 2. * A.nonZeros() * r, timer);
+            }
+            {
+                Timer timer;
+                backend.spmm(A, B, C);
+                timer.stop();
+                report(name, "spmm", 2. * A.nonZeros() * Nk, timer);
+            }
+        }
+    }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // namespace eckit::test
+
+int main(int argc, char** argv) {
+    eckit::Main::initialise(argc, argv);
+    return run_tests(argc, argv, false);
+}
@@ -66,6 +66,48 @@ CASE("test backend") {
     }
 }
 
+CASE("test backend against generic") {
+    using linalg::Matrix;
+    using linalg::Size;
+    using linalg::Vector;
+
+    const auto& linalg  = linalg::LinearAlgebraDense::backend();
+    const auto& generic = linalg::LinearAlgebraDense::getBackend("generic");
+
+    // Sizes that are not multiples of the blocks and tiles of optimised backends
+    auto fill = [](Size n, double* v) {
+        for (Size i = 0; i < n; ++i) {
+            v[i] = double((i * 7919) % 23) - 11.;
+        }
+    };
+
+    for (Size n : {1, 3, 17, 130, 301}) {
+        const Size m = n + 5;
+        const Size k = 2 * n + 1;
+
+        Matrix A(m, k);
+        Matrix B(k, n);
+        fill(A.size(), A.data());
+        fill(B.size(), B.data());
+
+        Matrix C(m, n);
+        Matrix C_check(m, n);
+        linalg.gemm(A, B, C);
+        generic.gemm(A, B, C_check);
+        EXPECT(equal_dense_matrix(C, C_check));
+
+        Vector x(k);
+        Vector y(m);
+        Vector y_check(m);
+        fill(x.size(), x.data());
+        linalg.gemv(A, x, y);
+        generic.gemv(A, x, y_check);
+        EXPECT(equal_dense_matrix(y, y_check));
+
+        EXPECT(linalg.dot(x, x) == generic.dot(x, x));
+    }
+}
+
 //----------------------------------------------------------------------------------------------------------------------
 
 }  // namespace eckit::test
@@ -8,6 +8,9 @@
  * nor does it submit to any jurisdiction.
  */
 
+#include <algorithm>
+#include <vector>
+
 #include "eckit/config/Resource.h"
 #include "eckit/linalg/LinearAlgebraSparse.h"
 #include "util.h"
@@ -149,6 +152,65 @@ CASE("test backend") {
     }
 }
 
+CASE("test backend against generic") {
+    using linalg::Matrix;
+    using linalg::Size;
+    using linalg::SparseMatrix;
+    using linalg::Triplet;
+    using linalg::Vector;
+
+    const auto& linalg  = linalg::LinearAlgebraSparse::backend();
+    const auto& generic = linalg::LinearAlgebraSparse::getBackend("generic");
+
+    // Rows of very different lengths, including empty rows, and sizes that are not multiples of blocks
+    const Size Ni = 1001;
+    const Size Nj = 517;
+
+    std::vector<Triplet> triplets;
+    for (Size i = 0; i < Ni; ++i) {
+        const Size n = (i % 97 == 0) ? 300 : (i * 7) % 13;
+        for (Size c = 0; c < n; ++c) {
+            triplets.emplace_back(i, (i + c * 31) % Nj, double((i + c) % 7) + 1.);
+        }
+    }
+    std::sort(triplets.begin(), triplets.end());
+
+    SparseMatrix A(Ni, Nj, triplets);
+
+    Vector x(Nj);
+    for (Size j = 0; j < Nj; ++j) {
+        x[j] = double(j % 11) - 5.;
+    }
+
+    Matrix B(Nj, 6);
+    for (Size k = 0; k < B.size(); ++k) {
+        B.data()[k] = double(k % 5) - 2.;
+    }
+
+    auto check = [&]() {
+        Vector y(Ni);
+        Vector y_check(Ni);
+        linalg.spmv(A, x, y);
+        generic.spmv(A, x, y_check);
+        EXPECT(equal_dense_matrix(y, y_check));
+
+        Matrix C(Ni, B.cols());
+        Matrix C_check(Ni, B.cols());
+        linalg.spmm(A, B, C);
+        generic.spmm(A, B, C_check);
+        EXPECT(equal_dense_matrix(C, C_check));
+    };
+
+    check();
+    check();
+
+    // Backends may keep a converted copy of A, it must follow changes
+    for (auto it = A.begin(); it != A.end(); ++it) {
+        *it *= 2.;
+    }
+    check();
+}
+
 //----------------------------------------------------------------------------------------------------------------------
 
 }  // namespace eckit::test
@@ -0,0 +1,309 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <condition_variable>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "eckit/log/AsyncTarget.h"
+#include "eckit/log/Channel.h"
+#include "eckit/log/Timer.h"
+
+#include "eckit/testing/Test.h"
+
+using namespace eckit;
+using namespace eckit::testing;
+
+namespace eckit::test {
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/// Collects the lines written, optionally holding the writer until released
+class CollectingTarget : public LogTarget {
+public:
+    void write(const char* start, const char* end) override {
+        std::unique_lock<std::mutex> lock(mutex_);
+        cv_.wait(lock, [this] { return !held_; });
+        writes_++;
+        text_.append(start, end);
+    }
+
+    void flush() override { flushes_++; }
+
+    void hold() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        held_ = true;
+    }
+
+    void release() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        held_ = false;
+        cv_.notify_all();
+    }
+
+    std::vector<std::string> lines() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        std::vector<std::string> result;
+        std::istringstream in(text_);
+        std::string line;
+        while (std::getline(in, line)) {
+            result.push_back(line);
+        }
+        return result;
+    }
+
+    size_t writes() const { return writes_; }
+
+private:
+    mutable std::mutex mutex_;
+    std::condition_variable cv_;
+    bool held_ = false;
+
+    std::string text_;
+    std::atomic<size_t> writes_{0};
+    std::atomic<size_t> flushes_{0};
+};
+
+static std::string line(size_t thread, size_t i) {
+    std::ostringstream oss;
+    oss << "thread " << thread << " line " << i;
+    return oss.str();
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+CASE("Lines are written in order by the background thread") {
+    CollectingTarget* collector = new CollectingTarget();
+    collector->attach();
+
+    {
+        AsyncTarget* target = new AsyncTarget(collector, AsyncTarget::Block);
+        Channel channel(target);
+
+        for (size_t i = 0; i < 1000; ++i) {
+            channel << line(0, i) << std::endl;
+        }
+        channel << "no newline yet";
+        channel.flush();
+
+        target->drain();
+
+        auto lines = collector->lines();
+        EXPECT(lines.size() == 1001);
+        for (size_t i = 0; i < 1000; ++i) {
+            EXPECT(lines[i] == line(0, i));
+        }
+        EXPECT(lines.back() == "no newline yet");
+        EXPECT(target->dropped() == 0);
+
+        channel << " and completed" << std::endl;
+    }
+
+    // Drained when the channel and its target are destroyed
+    EXPECT(collector->lines().back() == "no newline yet and completed");
+
+    collector->detach();
+}
+
+CASE("Channels of several threads") {
+    const size_t threads = 8;
+    const size_t lines   = 10000;
+
+    CollectingTarget* collector = new CollectingTarget();
+    collector->attach();
+
+    Timer timer;
+
+    std::vector<std::thread> workers;
+    for (size_t t = 0; t < threads; ++t) {
+        workers.emplace_back([&, t] {
+            Channel channel(new AsyncTarget(collector, AsyncTarget::Block));
+            for (size_t i = 0; i < lines; ++i) {
+                channel << line(t, i) << std::endl;
+            }
+        });
+    }
+
+    for (auto& w : workers) {
+        w.join();
+    }
+
+    timer.stop();
+
+    std::cout << std::setw(10) << size_t(double(threads * lines) / timer.elapsed()) << " lines per second, "
+              << collector->writes() << " writes" << std::endl;
+
+    // Each thread's lines are in order
+    std::vector<size_t> next(threads, 0);
+    for (const auto& l : collector->lines()) {
+        std::istringstream in(l);
+        std::string word;
+        size_t t;
+        size_t i;
+        in >> word >> t >> word >> i;
+        EXPECT(t < threads);
+        EXPECT(i == next[t]);
+        next[t]++;
+    }
+
+    for (size_t t = 0; t < threads; ++t) {
+        EXPECT(next[t] == lines);
+    }
+
+    collector->detach();
+}
+
+CASE("Lines are dropped and counted when the queue is full") {
+    const size_t lines = 100000;
+
+    CollectingTarget* collector = new CollectingTarget();
+    collector->attach();
+
+    AsyncTarget* target = new AsyncTarget(collector, AsyncTarget::Drop);
+    target->attach();
+
+    {
+        Channel channel(target);
+
+        collector->hold();
+        for (size_t i = 0; i < lines; ++i) {
+            channel << line(0, i) << std::endl;
+        }
+        collector->release();
+
+        EXPECT(target->dropped() > 0);
+        target->drain();
+
+        // The next line notes the ones dropped
+        channel << "after" << std::endl;
+        target->drain();
+    }
+
+    auto output = collector->lines();
+
+    size_t notes = 0;
+    for (const auto& l : output) {
+        if (l.find("log lines dropped") != std::string::npos) {
+            notes++;
+        }
+    }
+
+    EXPECT(notes >= 1);
+    EXPECT(output.size() - notes + target->dropped() == lines + 1);
+    EXPECT(output.back() == "after");
+
+    target->detach();
+    collector->detach();
+}
+
+CASE("Callers wait for room when blocking") {
+    const size_t lines = 100000;
+
+    CollectingTarget* collector = new CollectingTarget();
+    collector->attach();
+
+    AsyncTarget* target = new AsyncTarget(collector, AsyncTarget::Block);
+    target->attach();
+
+    std::atomic<bool> done{false};
+
+    collector->hold();
+
+    std::thread writer([&] {
+        Channel channel(target);
+        for (size_t i = 0; i < lines; ++i) {
+            channel << line(0, i) << std::endl;
+        }
+        done = true;
+    });
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    EXPECT(!done);
+
+    collector->release();
+    writer.join();
+    target->drain();
+
+    EXPECT(target->dropped() == 0);
+    EXPECT(collector->lines().size() == lines);
+
+    target->detach();
+    collector->detach();
+}
+
+CASE("A forked child writes its lines itself") {
+    const size_t lines = 10000;
+
+    CollectingTarget* collector = new CollectingTarget();
+    collector->attach();
+
+    AsyncTarget* target = new AsyncTarget(collector, AsyncTarget::Block);
+    target->attach();
+
+    {
+        // The queue and its thread are created in the parent
+        Channel channel(target);
+        channel << "parent" << std::endl;
+        target->drain();
+    }
+
+    pid_t pid = ::fork();
+    if (pid == 0) {
+        {
+            Channel channel(target);
+            for (size_t i = 0; i < lines; ++i) {
+                channel << line(1, i) << std::endl;
+            }
+            target->drain();
+        }
+        // Runs the handlers registered with atexit()
+        ::exit(collector->lines().size() == lines + 1 ? 0 : 1);
+    }
+    EXPECT(pid > 0);
+
+    int status = 0;
+    pid_t done = 0;
+    for (size_t i = 0; i < 200 && done == 0; ++i) {
+        done = ::waitpid(pid, &status, WNOHANG);
+        if (done == 0) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        }
+    }
+    if (done == 0) {
+        ::kill(pid, SIGKILL);
+        ::waitpid(pid, &status, 0);
+    }
+
+    EXPECT(done == pid);
+    EXPECT(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+    EXPECT(collector->lines().size() == 1);
+
+    target->detach();
+    collector->detach();
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // namespace eckit::test
+
+int main(int argc, char** argv) {
+    return run_tests(argc, argv);
+}
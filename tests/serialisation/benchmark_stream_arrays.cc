@@ -0,0 +1,94 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+#include "eckit/io/Buffer.h"
+#include "eckit/log/Bytes.h"
+#include "eckit/log/Timer.h"
+#include "eckit/serialisation/MemoryStream.h"
+#include "eckit/testing/Test.h"
+#include "eckit/types/Types.h"
+
+using namespace eckit;
+using namespace eckit::testing;
+
+namespace eckit::test {
+
+//----------------------------------------------------------------------------------------------------------------------
+
+// Set $BENCHMARK_STREAM_VALUES to change the number of doubles sent
+static size_t fromEnv(const char* name, size_t value) {
+    const char* e = ::getenv(name);
+    return e ? size_t(::atoll(e)) : value;
+}
+
+static void report(const char* name, const char* what, size_t bytes, Timer& timer) {
+    std::cout << std::setw(12) << name << " " << std::setw(6) << what << " : " << std::setw(10) << timer.elapsed()
+              << "s, " << std::setw(10) << Bytes(bytes, timer) << std::endl;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+CASE("Serialisation throughput of a vector of doubles") {
+    const size_t n     = fromEnv("BENCHMARK_STREAM_VALUES", 10 * 1000 * 1000);
+    const size_t bytes = n * sizeof(double);
+
+    std::vector<double> values(n);
+    for (size_t i = 0; i < n; ++i) {
+        values[i] = double(i) * 0.5;
+    }
+
+    // Each element costs a tag and 8 bytes
+    Buffer buffer(n * 9 + 1024);
+
+    {
+        MemoryStream out(buffer);
+        Timer timer;
+        out << values;
+        timer.stop();
+        report("operator<<", "write", bytes, timer);
+
+        MemoryStream in(buffer);
+        std::vector<double> result;
+        timer.start();
+        in >> result;
+        timer.stop();
+        report("operator>>", "read", bytes, timer);
+        EXPECT(result == values);
+    }
+
+    {
+        MemoryStream out(buffer);
+        Timer timer;
+        out.writeArray(values);
+        timer.stop();
+        report("writeArray", "write", bytes, timer);
+
+        MemoryStream in(buffer);
+        std::vector<double> result;
+        timer.start();
+        in.readArray(result);
+        timer.stop();
+        report("readArray", "read", bytes, timer);
+        EXPECT(result == values);
+    }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // namespace eckit::test
+
+int main(int argc, char** argv) {
+    return run_tests(argc, argv);
+}
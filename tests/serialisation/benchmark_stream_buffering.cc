@@ -0,0 +1,154 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+
+#include "eckit/io/AutoCloser.h"
+#include "eckit/log/Timer.h"
+#include "eckit/net/TCPClient.h"
+#include "eckit/net/TCPServer.h"
+#include "eckit/net/TCPStream.h"
+#include "eckit/serialisation/FileStream.h"
+#include "eckit/testing/Test.h"
+
+using namespace eckit;
+using namespace eckit::testing;
+
+namespace eckit::test {
+
+//----------------------------------------------------------------------------------------------------------------------
+
+// Set $BENCHMARK_STREAM_MESSAGES to change the number of messages exchanged
+static size_t fromEnv(const char* name, size_t value) {
+    const char* e = ::getenv(name);
+    return e ? size_t(::atoll(e)) : value;
+}
+
+static void report(const char* name, size_t buffer, size_t messages, Timer& timer) {
+    std::cout << std::setw(10) << name << " buffer " << std::setw(6) << buffer << " : " << std::setw(10)
+              << timer.elapsed() << "s, " << std::setw(10) << size_t(double(messages) / timer.elapsed())
+              << " messages per second" << std::endl;
+}
+
+static void buffering(Stream& s, size_t size) {
+    s.writeBufferSize(size);
+    s.readBufferSize(size);
+}
+
+// A typical small request, a dozen of fields
+static void request(Stream& s, long id) {
+    s.startObject();
+    s << std::string("retrieve") << id << std::string("class=od,stream=oper,type=fc") << int(2) << 0.25 << true;
+    s << std::string("user") << (unsigned long long)(id * 4096);
+    s.endObject();
+}
+
+static long serve(Stream& s) {
+    std::string verb;
+    long id;
+    std::string keys;
+    int level;
+    double grid;
+    bool flag;
+    std::string user;
+    unsigned long long offset;
+
+    if (!s.next()) {
+        return -1;
+    }
+    s >> verb >> id >> keys >> level >> grid >> flag >> user >> offset;
+    s.skipEndObject();
+    return id;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+CASE("Request/response exchanges over TCPStream") {
+    const size_t messages = fromEnv("BENCHMARK_STREAM_MESSAGES", 20000);
+
+    for (size_t size : {size_t(0), size_t(64 * 1024)}) {
+        net::TCPServer server(0);
+        int port = server.localPort();
+
+        std::thread thread([&] {
+            net::TCPStream s(server.accept());
+            buffering(s, size);
+            long id;
+            while ((id = serve(s)) >= 0) {
+                s << id << std::string("ok");
+            }
+        });
+
+        {
+            net::TCPStream s(net::TCPClient().connect("localhost", port));
+            buffering(s, size);
+
+            Timer timer;
+            for (size_t i = 0; i < messages; ++i) {
+                request(s, long(i));
+
+                long id;
+                std::string status;
+                s >> id >> status;
+                EXPECT(id == long(i));
+            }
+            timer.stop();
+            report("TCPStream", size, messages, timer);
+        }
+
+        thread.join();
+    }
+}
+
+CASE("Messages written to and read from a FileStream") {
+    const size_t messages = fromEnv("BENCHMARK_STREAM_MESSAGES", 20000) * 10;
+    PathName path         = PathName::unique("benchmark") + ".stream";
+
+    for (size_t size : {size_t(0), size_t(64 * 1024)}) {
+        {
+            FileStream out(path, "w");
+            auto c = closer(out);
+            buffering(out, size);
+
+            Timer timer;
+            for (size_t i = 0; i < messages; ++i) {
+                request(out, long(i));
+            }
+            timer.stop();
+            report("write", size, messages, timer);
+        }
+        {
+            FileStream in(path, "r");
+            auto c = closer(in);
+            buffering(in, size);
+
+            Timer timer;
+            for (size_t i = 0; i < messages; ++i) {
+                EXPECT(serve(in) == long(i));
+            }
+            timer.stop();
+            report("read", size, messages, timer);
+        }
+    }
+
+    path.unlink();
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // namespace eckit::test
+
+int main(int argc, char** argv) {
+    return run_tests(argc, argv);
+}
@@ -0,0 +1,131 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <vector>
+
+#include "eckit/io/Buffer.h"
+#include "eckit/serialisation/BadTag.h"
+#include "eckit/serialisation/MemoryStream.h"
+#include "eckit/serialisation/ResizableMemoryStream.h"
+#include "eckit/testing/Test.h"
+
+using namespace eckit;
+using namespace eckit::testing;
+
+namespace eckit::test {
+
+//----------------------------------------------------------------------------------------------------------------------
+
+template <typename T>
+std::vector<T> values(size_t n) {
+    std::vector<T> v(n);
+    for (size_t i = 0; i < n; ++i) {
+        v[i] = T(i * 3) - T(n) + T(0.25);
+    }
+    if (n > 2) {
+        v[1] = std::numeric_limits<T>::max();
+        v[2] = std::numeric_limits<T>::lowest();
+    }
+    return v;
+}
+
+template <typename T>
+void roundtrip(size_t n) {
+    auto in = values<T>(n);
+
+    Buffer buffer(1024);
+    {
+        ResizableMemoryStream s(buffer);
+        s << int(42);
+        s.writeArray(in);
+        s.writeArray(in.data(), in.size());
+        s << std::string("end");
+    }
+
+    MemoryStream s(buffer);
+    int i;
+    s >> i;
+    EXPECT(i == 42);
+
+    std::vector<T> out{T(1), T(2)};
+    s.readArray(out);
+    EXPECT(out == in);
+
+    std::vector<T> raw(n);
+    s.readArray(raw.data(), raw.size());
+    EXPECT(raw == in);
+
+    std::string end;
+    s >> end;
+    EXPECT(end == "end");
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+CASE("Arrays round trip") {
+    for (size_t n : {0, 1, 7, 64 * 1024 + 3, 200000}) {
+        roundtrip<int32_t>(n);
+        roundtrip<int64_t>(n);
+        roundtrip<float>(n);
+        roundtrip<double>(n);
+    }
+}
+
+CASE("Arrays are sent in big-endian order") {
+    Buffer buffer(64);
+    MemoryStream out(buffer);
+    int32_t v[] = {0x01020304, -2};
+    out.writeArray(v, 2);
+
+    const unsigned char* p = reinterpret_cast<const unsigned char*>(buffer.data());
+    EXPECT(out.position() == 2 + 8 + 8);
+
+    // tag, element tag, 64 bits size
+    EXPECT(p[0] == 22);
+    EXPECT(p[1] == 5);
+    EXPECT(std::memcmp(p + 2, "\0\0\0\0\0\0\0\2", 8) == 0);
+    EXPECT(std::memcmp(p + 10, "\1\2\3\4\xff\xff\xff\xfe", 8) == 0);
+}
+
+CASE("Mismatching arrays are rejected") {
+    Buffer buffer(1024);
+    {
+        MemoryStream s(buffer);
+        s.writeArray(values<double>(10));
+        s.writeArray(values<double>(10));
+        s << 1.0;
+    }
+
+    MemoryStream s(buffer);
+
+    std::vector<float> f;
+    EXPECT_THROWS_AS(s.readArray(f), BadTag);
+
+    s.rewind();
+    std::vector<double> d(5);
+    EXPECT_THROWS_AS(s.readArray(d.data(), d.size()), AssertionFailed);
+
+    s.rewind();
+    s.readArray(d);
+    s.readArray(d);
+    EXPECT(d.size() == 10);
+    EXPECT_THROWS_AS(s.readArray(d), BadTag);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // namespace eckit::test
+
+int main(int argc, char** argv) {
+    return run_tests(argc, argv);
+}
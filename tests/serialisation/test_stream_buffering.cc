@@ -0,0 +1,226 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+#include <algorithm>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "eckit/io/AutoCloser.h"
+#include "eckit/serialisation/FileStream.h"
+#include "eckit/testing/Test.h"
+
+using namespace eckit;
+using namespace eckit::testing;
+
+namespace eckit::test {
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/// In memory stream counting the calls made to the underlying device
+class CountingStream : public Stream {
+public:
+    explicit CountingStream(long chunk = 1024) : chunk_(chunk) {}
+
+    long write(const void* buf, long len) override {
+        writes_++;
+        data_.append(static_cast<const char*>(buf), len);
+        return len;
+    }
+
+    long read(void* buf, long len) override {
+        reads_++;
+        return take(buf, len);
+    }
+
+    long readSome(void* buf, long len) override {
+        readSomes_++;
+        return take(buf, std::min(len, chunk_));
+    }
+
+    std::string name() const override { return "CountingStream"; }
+
+    std::string data_;
+    size_t position_  = 0;
+    size_t writes_    = 0;
+    size_t reads_     = 0;
+    size_t readSomes_ = 0;
+
+private:
+    long take(void* buf, long len) {
+        long n = std::min(len, long(data_.size() - position_));
+        ::memcpy(buf, data_.data() + position_, n);
+        position_ += n;
+        return n;
+    }
+
+    long chunk_;
+};
+
+void writeMessage(Stream& s, int i) {
+    s.startObject();
+    s << i << std::string("message") << double(i) * 0.5 << (i % 2 == 0);
+    s.endObject();
+}
+
+void readMessage(Stream& s, int i) {
+    int n;
+    std::string m;
+    double d;
+    bool b;
+    EXPECT(s.next());
+    s >> n >> m >> d >> b;
+    EXPECT(n == i);
+    EXPECT(m == "message");
+    EXPECT(d == double(i) * 0.5);
+    EXPECT(b == (i % 2 == 0));
+    s.skipEndObject();
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+CASE("Writes are combined") {
+    CountingStream plain;
+    CountingStream buffered;
+    buffered.writeBufferSize(1024);
+
+    for (int i = 0; i < 100; ++i) {
+        writeMessage(plain, i);
+        writeMessage(buffered, i);
+    }
+
+    // Only full buffers went out so far
+    EXPECT(buffered.data_.size() < plain.data_.size());
+    EXPECT(buffered.data_.size() + 1024 > plain.data_.size());
+    EXPECT(buffered.writes_ < 10);
+    EXPECT(plain.writes_ > 1000);
+
+    buffered.flush();
+    EXPECT(buffered.data_ == plain.data_);
+    EXPECT(buffered.bytesWritten() == plain.bytesWritten());
+
+    size_t writes = buffered.writes_;
+    buffered.flush();
+    EXPECT(buffered.writes_ == writes);
+
+    // Large writes go straight through
+    std::string large(4096, 'x');
+    buffered << 1;
+    buffered << large;
+    EXPECT(buffered.writes_ == writes + 2);
+    EXPECT(buffered.data_.size() == plain.data_.size() + 1 + 4 + 1 + 4 + large.size());
+}
+
+CASE("Reads are done ahead") {
+    CountingStream s(100);
+    for (int i = 0; i < 100; ++i) {
+        writeMessage(s, i);
+    }
+
+    s.readBufferSize(256);
+
+    for (int i = 0; i < 100; ++i) {
+        readMessage(s, i);
+    }
+    EXPECT(!s.next());
+
+    EXPECT(s.reads_ == 0);
+    EXPECT(s.readSomes_ < s.data_.size() / 100 + 3);
+
+    // Large reads go straight through, after what was read ahead
+    s.data_.clear();
+    s.position_ = 0;
+    std::vector<double> values(1000, 1.5);
+    s.writeArray(values);
+    s << 42;
+
+    std::vector<double> result;
+    s.readArray(result);
+    EXPECT(result == values);
+    EXPECT(s.reads_ == 1);
+
+    int n;
+    s >> n;
+    EXPECT(n == 42);
+}
+
+CASE("Pending writes are flushed before reading") {
+    CountingStream s;
+    s.writeBufferSize(1024);
+    s.readBufferSize(1024);
+
+    // A request answered by itself
+    writeMessage(s, 1);
+    EXPECT(s.writes_ == 0);
+    readMessage(s, 1);
+    EXPECT(s.writes_ == 1);
+
+    writeMessage(s, 2);
+    writeMessage(s, 3);
+    readMessage(s, 2);
+    readMessage(s, 3);
+    EXPECT(s.writes_ == 2);
+}
+
+CASE("Changing the buffer sizes") {
+    CountingStream s;
+    s.writeBufferSize(1024);
+    writeMessage(s, 1);
+    writeMessage(s, 2);
+
+    // Pending writes are sent
+    s.writeBufferSize(0);
+    EXPECT(s.writes_ == 1);
+
+    // What was read ahead is kept
+    s.readBufferSize(1024);
+    readMessage(s, 1);
+    EXPECT_THROWS_AS(s.readBufferSize(1), AssertionFailed);
+    s.readBufferSize(512);
+    readMessage(s, 2);
+    s.readBufferSize(0);
+    EXPECT(!s.next());
+}
+
+CASE("FileStream") {
+    PathName path = PathName::unique("data");
+
+    {
+        FileStream out(path, "w");
+        auto c = closer(out);
+        for (int i = 0; i < 10000; ++i) {
+            writeMessage(out, i);
+        }
+    }
+
+    {
+        FileStream in(path, "r");
+        auto c = closer(in);
+        for (int i = 0; i < 10000; ++i) {
+            readMessage(in, i);
+        }
+        EXPECT(!in.next());
+
+        // What was read ahead is forgotten
+        in.rewind();
+        readMessage(in, 0);
+        readMessage(in, 1);
+    }
+
+    path.unlink();
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // namespace eckit::test
+
+int main(int argc, char** argv) {
+    return run_tests(argc, argv);
+}
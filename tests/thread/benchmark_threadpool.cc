@@ -0,0 +1,164 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <iomanip>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+#include "eckit/log/Timer.h"
+#include "eckit/thread/ThreadPool.h"
+
+#include "eckit/testing/Test.h"
+
+using namespace eckit;
+using namespace eckit::testing;
+
+namespace eckit::test {
+
+//----------------------------------------------------------------------------------------------------------------------
+
+#define NTASKS 200000
+#define WORK 200
+
+// A short, decoding-like task: a bit of arithmetic, no I/O
+static size_t work(size_t seed) {
+    size_t x = seed;
+    for (size_t i = 0; i < WORK; ++i) {
+        x = x * 6364136223846793005ULL + 1442695040888963407ULL;
+    }
+    return x;
+}
+
+class ShortTask : public ThreadPoolTask {
+public:
+    ShortTask(std::atomic<size_t>& sink, size_t seed) :
+        sink_(sink), seed_(seed) {}
+
+private:
+    void execute() override { sink_.fetch_add(work(seed_) & 1, std::memory_order_relaxed); }
+    std::atomic<size_t>& sink_;
+    size_t seed_;
+};
+
+class ForkTask : public ThreadPoolTask {
+public:
+    ForkTask(std::atomic<size_t>& sink, size_t depth) :
+        sink_(sink), depth_(depth) {}
+
+private:
+    void execute() override {
+        if (depth_) {
+            pool().push(new ForkTask(sink_, depth_ - 1));
+            pool().push(new ForkTask(sink_, depth_ - 1));
+        }
+        sink_.fetch_add(work(depth_) & 1, std::memory_order_relaxed);
+    }
+    std::atomic<size_t>& sink_;
+    size_t depth_;
+};
+
+static const char* name(ThreadPool::Scheduling s) {
+    return s == ThreadPool::Scheduling::Shared ? "shared" : "work-stealing";
+}
+
+static void report(const char* what, ThreadPool::Scheduling s, size_t threads, size_t tasks, Timer& timer) {
+    std::cout << std::setw(14) << what << " " << std::setw(14) << name(s) << " threads " << std::setw(3) << threads
+              << " : " << std::setw(12) << size_t(tasks / timer.elapsed()) << " tasks/s" << std::endl;
+}
+
+static std::vector<size_t> threadCounts() {
+    size_t hw = std::max<size_t>(std::thread::hardware_concurrency(), 1);
+    std::vector<size_t> counts;
+    for (size_t n = 1; n < hw; n *= 2) {
+        counts.push_back(n);
+    }
+    counts.push_back(hw);
+    return counts;
+}
+
+const ThreadPool::Scheduling schedulings[] = {ThreadPool::Scheduling::Shared, ThreadPool::Scheduling::WorkStealing};
+
+//----------------------------------------------------------------------------------------------------------------------
+
+CASE("Tasks pushed from outside the pool") {
+    for (size_t threads : threadCounts()) {
+        for (auto s : schedulings) {
+            std::atomic<size_t> sink(0);
+            ThreadPool pool("bench", threads, 0, s);
+
+            Timer timer;
+            for (size_t i = 0; i < NTASKS; ++i) {
+                pool.push(new ShortTask(sink, i));
+            }
+            pool.wait();
+            timer.stop();
+
+            report("push", s, threads, NTASKS, timer);
+        }
+    }
+}
+
+CASE("Tasks pushed from tasks") {
+    const size_t depth = 17;  // 2^18 - 1 tasks
+    for (size_t threads : threadCounts()) {
+        for (auto s : schedulings) {
+            std::atomic<size_t> sink(0);
+            ThreadPool pool("bench", threads, 0, s);
+
+            Timer timer;
+            pool.push(new ForkTask(sink, depth));
+            pool.wait();
+            timer.stop();
+
+            report("fork", s, threads, (size_t(1) << (depth + 1)) - 1, timer);
+        }
+    }
+}
+
+CASE("submit and parallel_for") {
+    for (size_t threads : threadCounts()) {
+        for (auto s : schedulings) {
+            ThreadPool pool("bench", threads, 0, s);
+
+            {
+                std::vector<std::future<size_t>> results;
+                results.reserve(NTASKS);
+                Timer timer;
+                for (size_t i = 0; i < NTASKS; ++i) {
+                    results.push_back(pool.submit([i] { return work(i); }));
+                }
+                for (auto& r : results) {
+                    r.get();
+                }
+                timer.stop();
+                report("submit", s, threads, NTASKS, timer);
+            }
+
+            {
+                std::vector<size_t> out(NTASKS * 10);
+                Timer timer;
+                pool.parallel_for(0, out.size(), [&out](size_t i) { out[i] = work(i); });
+                timer.stop();
+                report("parallel_for", s, threads, out.size(), timer);
+            }
+        }
+    }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // namespace eckit::test
+
+int main(int argc, char** argv) {
+    return run_tests(argc, argv);
+}
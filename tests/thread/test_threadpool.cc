@@ -0,0 +1,197 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+#include <atomic>
+#include <future>
+#include <list>
+#include <stdexcept>
+#include <vector>
+
+#include "eckit/thread/ThreadPool.h"
+#include "eckit/thread/WorkStealingDeque.h"
+
+#include "eckit/testing/Test.h"
+
+using namespace eckit;
+using namespace eckit::testing;
+
+namespace eckit::test {
+
+//----------------------------------------------------------------------------------------------------------------------
+
+class Counter : public ThreadPoolTask {
+public:
+    Counter(std::atomic<size_t>& count) :
+        count_(count) {}
+
+private:
+    void execute() override { count_++; }
+    std::atomic<size_t>& count_;
+};
+
+class Spawner : public ThreadPoolTask {
+public:
+    Spawner(std::atomic<size_t>& count, size_t depth) :
+        count_(count), depth_(depth) {}
+
+private:
+    void execute() override {
+        count_++;
+        if (depth_) {
+            pool().push(new Spawner(count_, depth_ - 1));
+            pool().push(new Spawner(count_, depth_ - 1));
+        }
+    }
+    std::atomic<size_t>& count_;
+    size_t depth_;
+};
+
+const ThreadPool::Scheduling schedulings[] = {ThreadPool::Scheduling::Shared, ThreadPool::Scheduling::WorkStealing};
+
+//----------------------------------------------------------------------------------------------------------------------
+
+CASE("WorkStealingDeque push/pop/steal") {
+    WorkStealingDeque<int*> deque(2);  // forces the ring to grow
+    std::vector<int> values(100);
+
+    for (auto& v : values) {
+        deque.push(&v);
+    }
+    EXPECT(deque.size() == values.size());
+
+    EXPECT(deque.steal() == &values.front());  // FIFO end
+    EXPECT(deque.pop() == &values.back());     // LIFO end
+
+    size_t n = 0;
+    while (deque.pop()) {
+        n++;
+    }
+    EXPECT(n == values.size() - 2);
+    EXPECT(deque.empty());
+    EXPECT(deque.pop() == nullptr);
+    EXPECT(deque.steal() == nullptr);
+}
+
+CASE("ThreadPoolTask interface") {
+    for (auto scheduling : schedulings) {
+        std::atomic<size_t> count(0);
+        {
+            ThreadPool pool("test", 4, 0, scheduling);
+
+            for (size_t i = 0; i < 1000; ++i) {
+                pool.push(new Counter(count));
+            }
+
+            std::list<ThreadPoolTask*> tasks;
+            for (size_t i = 0; i < 1000; ++i) {
+                tasks.push_back(new Counter(count));
+            }
+            pool.push(tasks);
+            EXPECT(tasks.empty());
+
+            pool.wait();
+            EXPECT(count == 2000);
+            EXPECT(pool.done());
+        }
+        EXPECT(count == 2000);
+    }
+}
+
+CASE("Tasks pushed from tasks") {
+    for (auto scheduling : schedulings) {
+        std::atomic<size_t> count(0);
+        ThreadPool pool("test", 4, 0, scheduling);
+
+        pool.push(new Spawner(count, 10));
+        pool.wait();
+
+        EXPECT(count == (1 << 11) - 1);
+    }
+}
+
+CASE("submit returns futures") {
+    for (auto scheduling : schedulings) {
+        ThreadPool pool("test", 3, 0, scheduling);
+
+        std::vector<std::future<size_t>> results;
+        for (size_t i = 0; i < 100; ++i) {
+            results.push_back(pool.submit([i] { return i * i; }));
+        }
+        for (size_t i = 0; i < 100; ++i) {
+            EXPECT(results[i].get() == i * i);
+        }
+
+        auto failed = pool.submit([]() -> int { throw std::runtime_error("expected"); });
+        EXPECT_THROWS_AS(failed.get(), std::runtime_error);
+
+        // Exceptions travel through the future, the pool is not in error
+        EXPECT_NO_THROW(pool.waitForThreads());
+    }
+}
+
+CASE("parallel_for") {
+    for (auto scheduling : schedulings) {
+        ThreadPool pool("test", 4, 0, scheduling);
+
+        std::vector<int> v(100000, 0);
+        pool.parallel_for(0, v.size(), [&v](size_t i) { v[i] += int(i % 7); });
+        for (size_t i = 0; i < v.size(); ++i) {
+            EXPECT(v[i] == int(i % 7));
+        }
+
+        // Empty range, grain larger than range
+        pool.parallel_for(5, 5, [](size_t) { throw std::runtime_error("unexpected"); });
+        std::atomic<size_t> count(0);
+        pool.parallel_for(0, 10, [&count](size_t) { count++; }, 100);
+        EXPECT(count == 10);
+
+        // Nested, from within the pool
+        std::atomic<size_t> nested(0);
+        pool.parallel_for(
+            0, 8, [&](size_t) { pool.parallel_for(0, 100, [&nested](size_t) { nested++; }, 10); }, 1);
+        EXPECT(nested == 800);
+
+        EXPECT_THROWS_AS(pool.parallel_for(0, 1000,
+                                           [](size_t i) {
+                                               if (i == 500) {
+                                                   throw std::runtime_error("expected");
+                                               }
+                                           }),
+                         std::runtime_error);
+    }
+}
+
+CASE("resize") {
+    for (auto scheduling : schedulings) {
+        std::atomic<size_t> count(0);
+        ThreadPool pool("test", 1, 0, scheduling);
+
+        pool.resize(2);
+        EXPECT(pool.size() == 2);
+        for (size_t i = 0; i < 100; ++i) {
+            pool.push(new Counter(count));
+        }
+        pool.resize(1);
+        EXPECT(pool.size() == 1);
+        for (size_t i = 0; i < 100; ++i) {
+            pool.push(new Counter(count));
+        }
+        pool.wait();
+        EXPECT(count == 200);
+    }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // namespace eckit::test
+
+int main(int argc, char** argv) {
+    return run_tests(argc, argv);
+}
@@ -8,7 +8,9 @@
  * does it submit to any jurisdiction.
  */
 
+#include <chrono>
 #include <cmath>
+#include <thread>
 
 #include "eckit/config/Resource.h"
 #include "eckit/config/ResourceMgr.h"
@@ -179,6 +181,131 @@ CASE("test_insert") {
 
 //----------------------------------------------------------------------------------------------------------------------
 
+CASE("test_insert_expired") {
+    Cache<string, Obj> cache;
+
+    EXPECT(cache.insert("a", Obj("aaa", 11111)));
+    EXPECT(cache.insert("b", Obj("bbb", 22222)));
+
+    EXPECT(cache.expire("a"));
+    EXPECT(!cache.expire("c"));
+    EXPECT(cache.size() == 2);
+    EXPECT(cache.validSize() == 1);
+
+    Obj o;
+    EXPECT(!cache.fetch("a", o));
+
+    // An expired entry can be inserted again
+    EXPECT(cache.insert("a", Obj("AAA", 1)));
+    EXPECT(cache.fetch("a", o));
+    EXPECT(o.s_ == "AAA");
+    EXPECT(cache.validSize() == 2);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+CASE("test_expire_lru") {
+    Cache<int, int> cache;
+    for (int i = 0; i < 10; ++i) {
+        cache.insert(i, i);
+    }
+
+    int v;
+    EXPECT(cache.fetch(0, v));
+    EXPECT(cache.fetch(1, v));
+
+    EXPECT(cache.expireLRU(5) == 5);
+    EXPECT(cache.expireLRU(5) == 0);
+
+    for (int i : {0, 1, 7, 8, 9}) {
+        EXPECT(cache.valid(i));
+    }
+    for (int i : {2, 3, 4, 5, 6}) {
+        EXPECT(!cache.valid(i));
+    }
+
+    EXPECT(cache.size() == 10);
+    cache.purge();
+    EXPECT(cache.size() == 5);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+CASE("test_expire_lfu") {
+    Cache<int, int> cache;
+    for (int i = 0; i < 10; ++i) {
+        cache.insert(i, i);
+    }
+
+    int v;
+    for (int i = 0; i < 10; ++i) {
+        for (int j = 0; j < i; ++j) {
+            EXPECT(cache.fetch(i, v));
+        }
+    }
+
+    EXPECT(cache.expireLFU(4) == 6);
+    for (int i = 0; i < 10; ++i) {
+        EXPECT(cache.valid(i) == (i >= 6));
+    }
+
+    // With aging, new entries start from the priority of the last eviction, so these replace old
+    // entries that had more hits (up to 9), but are no longer used
+    for (int i = 10; i < 14; ++i) {
+        cache.insert(i, i);
+        for (int j = 0; j < 4; ++j) {
+            EXPECT(cache.fetch(i, v));
+        }
+    }
+    EXPECT(cache.expireLFU(4) == 4);
+    for (int i = 6; i < 14; ++i) {
+        EXPECT(cache.valid(i) == (i >= 10));
+    }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+CASE("test_expire_age") {
+    Cache<int, int> cache;
+    for (int i = 0; i < 5; ++i) {
+        cache.insert(i, i);
+    }
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+
+    for (int i = 5; i < 10; ++i) {
+        cache.insert(i, i);
+    }
+    cache.update(0, 0);
+
+    EXPECT(cache.expireAge(0.025) == 4);
+    for (int i = 0; i < 10; ++i) {
+        EXPECT(cache.valid(i) == (i == 0 || i >= 5));
+    }
+
+    EXPECT(cache.expireAge(60) == 0);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+CASE("test_purge_large") {
+    Cache<int, int> cache;
+    const int N = 200000;
+    for (int i = 0; i < N; ++i) {
+        cache.insert(i, i);
+    }
+
+    EXPECT(cache.expireLRU(N - 10) == 10);
+    cache.purge();
+    EXPECT(cache.size() == size_t(N - 10));
+
+    int v;
+    EXPECT(!cache.fetch(9, v));
+    EXPECT(cache.fetch(10, v) && v == 10);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
 }  // namespace eckit::test
 
 int main(int argc, char** argv) {
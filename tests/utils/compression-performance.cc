@@ -15,6 +15,7 @@
 #include <iostream>
 #include <locale>
 #include <memory>
+#include <thread>
 
 #include "eckit/filesystem/PathName.h"
 #include "eckit/io/Buffer.h"
@@ -23,6 +24,7 @@
 #include "eckit/log/Seconds.h"
 #include "eckit/log/Timer.h"
 
+#include "eckit/utils/ChunkedCompressor.h"
 #include "eckit/utils/Compressor.h"
 
 #include "eckit/testing/Test.h"
@@ -137,6 +139,32 @@ CASE("Test compression performance") {
             }
         }
     }
+
+    // Chunked, in blocks compressed on several threads
+    const size_t blockSize = 256 * 1024;
+
+    std::vector<size_t> threads{1};
+    for (size_t t = 2; t <= std::max(1U, std::thread::hardware_concurrency()); t *= 2) {
+        threads.push_back(t);
+    }
+
+    for (const auto& name : compressors) {
+
+        if (eckit::CompressorFactory::instance().has(name)) {
+
+            std::cout << "chunked " << name << " (blocks of " << Bytes(blockSize) << ")" << std::endl;
+
+            for (auto t : threads) {
+                eckit::ChunkedCompressor compressor(name, blockSize, t);
+
+                std::cout << "  " << t << " thread(s)" << std::endl;
+                for (auto& d : data) {
+                    std::cout << "    " << d.description << std::endl;
+                    test_case(compressor, d);
+                }
+            }
+        }
+    }
 }
 
 //----------------------------------------------------------------------------------------------------------------------
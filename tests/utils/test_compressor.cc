@@ -8,11 +8,16 @@
  * does it submit to any jurisdiction.
  */
 
+#include <algorithm>
 #include <cstring>
 #include <iostream>
 #include <memory>
+#include <utility>
+#include <vector>
 
+#include "eckit/exception/Exceptions.h"
 #include "eckit/io/Buffer.h"
+#include "eckit/utils/ChunkedCompressor.h"
 #include "eckit/utils/Compressor.h"
 #include "eckit/utils/MD5.h"
 
@@ -118,6 +123,76 @@ CASE("Compression") {
     }
 }
 
+CASE("Chunked compression") {
+
+    // Several blocks, the last one partial
+    const size_t len = 1000 * 1000 + 7;
+    Buffer in(len);
+    char* p = in;
+    for (size_t i = 0; i < len; ++i) {
+        p[i] = msg[(i / 7) % msg.size()];
+    }
+
+    for (const auto& compression : compressions) {
+        if (!CompressorFactory::instance().has(compression)) {
+            continue;
+        }
+
+        SECTION("CASE chunked " + compression) {
+            ChunkedCompressor c(compression, 64 * 1024, 4);
+            EXPECT_compress_uncompress_1(c, in, len);
+            EXPECT_compress_uncompress_2(c, in, len);
+
+            Buffer compressed;
+            size_t clen = c.compress(in, len, compressed);
+            EXPECT(ChunkedCompressor::isChunked(compressed, clen));
+            EXPECT(ChunkedCompressor::uncompressedSize(compressed, clen) == len);
+
+            // Same bytes whatever the number of threads
+            ChunkedCompressor serial(compression, 64 * 1024, 1);
+            Buffer compressed1;
+            EXPECT(serial.compress(in, len, compressed1) == clen);
+            EXPECT(std::memcmp(compressed, compressed1, clen) == 0);
+
+            // Ranges within a block, across blocks and past the end
+            std::vector<std::pair<size_t, size_t>> ranges{
+                {0, 10}, {100, 1000}, {65530, 20}, {30000, 300000}, {len - 5, 5}, {len - 5, 100}, {0, len}};
+
+            for (const auto& r : ranges) {
+                Buffer part;
+                size_t n = c.uncompress(compressed, clen, r.first, r.second, part);
+                EXPECT(n == std::min(r.second, len - r.first));
+                EXPECT(std::memcmp(part, p + r.first, n) == 0);
+            }
+
+            Buffer part;
+            EXPECT(c.uncompress(compressed, clen, len, 10, part) == 0);
+        }
+    }
+
+    SECTION("CASE chunked empty") {
+        ChunkedCompressor c("none", 1024, 2);
+        Buffer compressed;
+        size_t clen = c.compress(in, 0, compressed);
+        EXPECT(ChunkedCompressor::uncompressedSize(compressed, clen) == 0);
+        Buffer uncompressed;
+        c.uncompress(compressed, clen, uncompressed, 0);
+    }
+
+    SECTION("CASE chunked from the factory") {
+        std::unique_ptr<Compressor> c(CompressorFactory::instance().build("chunked"));
+        EXPECT_compress_uncompress_1(*c, in, len);
+        EXPECT_reproducible_compression(*c, 2);
+    }
+
+    SECTION("CASE chunked rejects other streams") {
+        ChunkedCompressor c("none", 1024, 1);
+        Buffer uncompressed;
+        EXPECT(!ChunkedCompressor::isChunked(in, len));
+        EXPECT_THROWS_AS(c.uncompress(in, len, uncompressed, len), BadValue);
+    }
+}
+
 //----------------------------------------------------------------------------------------------------------------------
 
 }  // namespace eckit::test